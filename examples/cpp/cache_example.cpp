@@ -1,7 +1,7 @@
 /**
  * FastCollection v1.0.0 - Cache Example (C++)
  * 
- * Demonstrates using FastMap as a key-value cache with TTL.
+ * Demonstrates using FastMap as a key-value cache with TTL and a size bound.
  * 
  * Compile:
  *   g++ -std=c++20 -O3 -I../src/main/cpp/include \
@@ -30,9 +30,17 @@ private:
     FastMap store;
     int defaultTTL;
     
+    static CacheConfig bounded(uint64_t maxEntries) {
+        CacheConfig config;
+        config.max_entries = maxEntries;
+        config.policy = EvictionPolicy::TINY_LFU;
+        return config;
+    }
+    
 public:
-    Cache(const std::string& path, int defaultTTLSeconds = 300)
-        : store(path, 64 * 1024 * 1024, true)
+    Cache(const std::string& path, int defaultTTLSeconds = 300, uint64_t maxEntries = 10000)
+        : store(path, 64 * 1024 * 1024, true, HashTableHeader::DEFAULT_BUCKET_COUNT,
+                MapEngine::CHAINED, bounded(maxEntries))
         , defaultTTL(defaultTTLSeconds) {}
     
     void put(const std::string& key, const std::string& value) {
@@ -96,6 +104,10 @@ public:
     int cleanup() {
         return store.removeExpired();
     }
+    
+    const CollectionStats& stats() const {
+        return store.stats();
+    }
 };
 
 int main() {
@@ -165,6 +177,18 @@ int main() {
         int removed = cache.cleanup();
         std::cout << std::endl << "Cleaned up " << removed << " expired entries" << std::endl;
         
+        // Overfill a small bounded cache: it evicts instead of growing
+        Cache small("/tmp/cache_example_small_cpp.fc", -1, 100);
+        for (int i = 0; i < 1000; i++) {
+            small.put("item:" + std::to_string(i), "payload");
+        }
+        const CollectionStats& stats = small.stats();
+        std::cout << std::endl << "Bounded cache (100 entries) after 1000 puts:" << std::endl;
+        std::cout << "  Size: " << small.size() << std::endl;
+        std::cout << "  Evictions: " << stats.eviction_count << std::endl;
+        std::cout << "  Rejected by admission: " << stats.rejection_count << std::endl;
+        std::cout << "  Hits/misses: " << stats.hit_count << "/" << stats.miss_count << std::endl;
+        
         std::cout << std::endl << "Example completed successfully!" << std::endl;
         
     } catch (const std::exception& e) {
@@ -1,7 +1,8 @@
 /**
  * FastCollection v1.0.0 - Leaderboard Example
  * 
- * Implements a game leaderboard with rankings using FastCollectionMap.
+ * Implements a game leaderboard with FastCollectionMap for player records
+ * and a FastCollectionSortedMap index for rankings.
  * 
  * Copyright © 2025-2030, Ashutosh Sinha (ajsinha@gmail.com)
  * Patent Pending
@@ -10,8 +11,9 @@ package examples;
 
 import com.kuber.fastcollection.*;
 import java.io.Serializable;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
 import java.util.*;
-import java.util.stream.Collectors;
 
 public class LeaderboardExample {
     
@@ -59,11 +61,25 @@ public class LeaderboardExample {
     
     public static class Leaderboard {
         private final FastCollectionMap<String, PlayerScore> scores;
+        // Ordered by (score, playerId); the value is the player ID
+        private final FastCollectionSortedMap<byte[], String> ranking;
         private final String name;
         
         public Leaderboard(String name, String path) {
             this.name = name;
             this.scores = new FastCollectionMap<>(path, 32 * 1024 * 1024, true);
+            this.ranking = new FastCollectionSortedMap<>(path + ".rank",
+                FastCollectionSortedMap.KeyCodec.BYTES, 32 * 1024 * 1024, true);
+        }
+        
+        // Big-endian score with the sign bit flipped, so byte order is score
+        // order, followed by the player ID to keep equal scores apart
+        private static byte[] rankKey(long score, String playerId) {
+            byte[] id = playerId.getBytes(StandardCharsets.UTF_8);
+            return ByteBuffer.allocate(8 + id.length)
+                .putLong(score ^ Long.MIN_VALUE)
+                .put(id)
+                .array();
         }
         
         public void recordScore(String playerId, String playerName, long points) {
@@ -71,10 +87,13 @@ public class LeaderboardExample {
             
             if (player == null) {
                 player = new PlayerScore(playerId, playerName);
+            } else {
+                ranking.remove(rankKey(player.score, playerId));
             }
             
             player.addScore(points);
             scores.put(playerId, player);
+            ranking.put(rankKey(player.score, playerId), playerId);
             
             System.out.printf("  %s scored %,d points (total: %,d)\n",
                 playerName, points, player.score);
@@ -85,51 +104,27 @@ public class LeaderboardExample {
         }
         
         public List<PlayerScore> getTopPlayers(int count) {
-            List<PlayerScore> allPlayers = new ArrayList<>();
-            
-            // Collect all players
-            // In a real implementation, you'd have an iterator
-            // For now, we'll track player IDs separately
-            
-            return allPlayers.stream()
-                .sorted()
-                .limit(count)
-                .collect(Collectors.toList());
-        }
-        
-        public List<PlayerScore> getAllPlayersSorted() {
-            // This is a simplified implementation
-            // In production, you'd maintain a sorted index
-            List<PlayerScore> players = new ArrayList<>();
-            
-            // Iterate through known players
-            for (String playerId : getKnownPlayerIds()) {
-                PlayerScore player = scores.get(playerId);
+            // Highest scores first, straight off the end of the index
+            List<PlayerScore> top = new ArrayList<>();
+            for (Map.Entry<byte[], String> entry : ranking.range(null, null, true, count)) {
+                PlayerScore player = scores.get(entry.getValue());
                 if (player != null) {
-                    players.add(player);
+                    top.add(player);
                 }
             }
-            
-            Collections.sort(players);
-            return players;
+            return top;
         }
         
-        // In real implementation, maintain player ID index
-        private Set<String> knownPlayerIds = new HashSet<>();
-        
-        public Set<String> getKnownPlayerIds() {
-            return knownPlayerIds;
-        }
-        
-        public void trackPlayer(String playerId) {
-            knownPlayerIds.add(playerId);
+        public List<PlayerScore> getAllPlayersSorted() {
+            return getTopPlayers(0);
         }
         
         public int getPlayerCount() {
-            return knownPlayerIds.size();
+            return ranking.size();
         }
         
         public void close() {
+            ranking.close();
             scores.close();
         }
     }
@@ -141,20 +136,6 @@ public class LeaderboardExample {
         Leaderboard leaderboard = new Leaderboard("GameLeaderboard", "/tmp/leaderboard.fc");
         
         try {
-            // Define players
-            String[][] players = {
-                {"p1", "Alice"},
-                {"p2", "Bob"},
-                {"p3", "Charlie"},
-                {"p4", "Diana"},
-                {"p5", "Eve"}
-            };
-            
-            // Track players
-            for (String[] p : players) {
-                leaderboard.trackPlayer(p[0]);
-            }
-            
             // Simulate game sessions
             System.out.println("=== Game Session 1 ===\n");
             leaderboard.recordScore("p1", "Alice", 1500);
@@ -189,6 +170,12 @@ public class LeaderboardExample {
             
             System.out.println("╚══════════════════════════════════════════════════════════════╝");
             
+            // Top of the board only, without touching the other players
+            System.out.println("\n=== Top 3 ===\n");
+            for (PlayerScore player : leaderboard.getTopPlayers(3)) {
+                System.out.println("  " + player);
+            }
+            
             // Individual player stats
             System.out.println("\n=== Individual Stats ===\n");
             
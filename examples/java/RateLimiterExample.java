@@ -1,7 +1,7 @@
 /**
  * FastCollection v1.0.0 - Rate Limiter Example
  * 
- * Implements a sliding window rate limiter using FastCollectionMap.
+ * Implements a fixed window rate limiter using FastCollectionMap counters.
  * 
  * Copyright © 2025-2030, Ashutosh Sinha (ajsinha@gmail.com)
  * Patent Pending
@@ -9,27 +9,17 @@
 package examples;
 
 import com.kuber.fastcollection.*;
-import java.io.Serializable;
 
 public class RateLimiterExample {
     
-    public static class RateLimitEntry implements Serializable {
-        private static final long serialVersionUID = 1L;
-        public int count;
-        public long windowStart;
-        
-        public RateLimitEntry() {
-            this.count = 1;
-            this.windowStart = System.currentTimeMillis();
-        }
-        
-        public void increment() {
-            this.count++;
-        }
-    }
-    
+    /**
+     * Fixed-window limiter: the first request of a window creates the
+     * client's counter with a TTL of one window, later requests only
+     * increment it. Each increment is a single atomic native call, so
+     * threads and processes sharing the file need no extra locking.
+     */
     public static class RateLimiter {
-        private final FastCollectionMap<String, RateLimitEntry> store;
+        private final FastCollectionMap<String, Long> store;
         private final int maxRequests;
         private final int windowSeconds;
         
@@ -39,29 +29,13 @@ public class RateLimiterExample {
             this.windowSeconds = windowSeconds;
         }
         
-        public synchronized boolean allowRequest(String clientId) {
-            RateLimitEntry entry = store.get(clientId);
-            
-            if (entry == null) {
-                store.put(clientId, new RateLimitEntry(), windowSeconds);
-                return true;
-            }
-            
-            if (entry.count >= maxRequests) {
-                return false;
-            }
-            
-            entry.increment();
-            store.put(clientId, entry, windowSeconds);
-            return true;
+        public boolean allowRequest(String clientId) {
+            return store.incrementBy(clientId, 1, windowSeconds) <= maxRequests;
         }
         
         public int getRemainingRequests(String clientId) {
-            RateLimitEntry entry = store.get(clientId);
-            if (entry == null) {
-                return maxRequests;
-            }
-            return Math.max(0, maxRequests - entry.count);
+            long count = store.getCounter(clientId);
+            return (int) Math.max(0, maxRequests - count);
         }
         
         public long getResetTime(String clientId) {
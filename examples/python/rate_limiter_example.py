@@ -2,7 +2,7 @@
 """
 FastCollection v1.0.0 - Rate Limiter Example (Python)
 
-Implements a sliding window rate limiter.
+Implements a fixed window rate limiter on FastMap counters.
 
 Usage: python rate_limiter_example.py
 
@@ -11,27 +11,15 @@ Patent Pending
 """
 
 from fastcollection import FastMap
-import json
-import time
-from dataclasses import dataclass, asdict
-
-
-@dataclass
-class RateLimitEntry:
-    count: int
-    window_start: float
-    
-    def to_json(self) -> bytes:
-        return json.dumps(asdict(self)).encode()
-    
-    @classmethod
-    def from_json(cls, data: bytes) -> 'RateLimitEntry':
-        return cls(**json.loads(data.decode()))
 
 
 class RateLimiter:
     """
-    Sliding window rate limiter with persistent storage.
+    Fixed window rate limiter with persistent storage.
+    
+    The first request of a window creates the client's counter with a TTL
+    of one window; later requests only increment it. Each increment is one
+    atomic native call, so processes sharing the file need no extra locking.
     
     Example: 100 requests per 60 seconds
     """
@@ -42,35 +30,18 @@ class RateLimiter:
         self.window_seconds = window_seconds
     
     def allow_request(self, client_id: str) -> bool:
-        """Check if request is allowed and update counter"""
-        key = client_id.encode()
-        data = self.store.get(key)
-        
-        if data is None:
-            # First request in window
-            entry = RateLimitEntry(count=1, window_start=time.time())
-            self.store.put(key, entry.to_json(), ttl=self.window_seconds)
-            return True
-        
-        entry = RateLimitEntry.from_json(data)
-        
-        if entry.count >= self.max_requests:
-            return False
-        
-        # Increment counter
-        entry.count += 1
-        self.store.put(key, entry.to_json(), ttl=self.window_seconds)
-        return True
+        """Count the request and check it against the limit"""
+        count = self.store.increment_by(client_id.encode(), 1, ttl=self.window_seconds)
+        return count <= self.max_requests
     
     def get_remaining(self, client_id: str) -> int:
         """Get remaining requests in current window"""
-        data = self.store.get(client_id.encode())
+        count = self.store.get_counter(client_id.encode())
         
-        if data is None:
+        if count is None:
             return self.max_requests
         
-        entry = RateLimitEntry.from_json(data)
-        return max(0, self.max_requests - entry.count)
+        return max(0, self.max_requests - count)
     
     def get_reset_time(self, client_id: str) -> int:
         """Get seconds until rate limit resets"""
@@ -38,7 +38,17 @@ ext_modules = [
             'src/main/cpp/src/fc_set.cpp',
             'src/main/cpp/src/fc_map.cpp',
             'src/main/cpp/src/fc_queue.cpp',
+            'src/main/cpp/src/fc_ring_queue.cpp',
             'src/main/cpp/src/fc_stack.cpp',
+            'src/main/cpp/src/fc_swiss.cpp',
+            'src/main/cpp/src/fc_epoch.cpp',
+            'src/main/cpp/src/fc_cache.cpp',
+            'src/main/cpp/src/fc_expiry.cpp',
+            'src/main/cpp/src/fc_position.cpp',
+            'src/main/cpp/src/fc_slab.cpp',
+            'src/main/cpp/src/fc_reaper.cpp',
+            'src/main/cpp/src/fc_sorted_map.cpp',
+            'src/main/cpp/src/fc_thread_pool.cpp',
         ],
         include_dirs=[
             get_pybind_include(),
@@ -42,8 +42,11 @@
 #include "fc_list.h"
 #include "fc_set.h"
 #include "fc_map.h"
+#include "fc_sorted_map.h"
 #include "fc_queue.h"
+#include "fc_ring_queue.h"
 #include "fc_stack.h"
+#include "fc_thread_pool.h"
 
 namespace fastcollection {
 
@@ -0,0 +1,162 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_cache.h
+ * @brief Memory-bounded cache mode for FastMap
+ *
+ * ============================================================================
+ * CACHE MODE
+ * ============================================================================
+ *
+ * A FastMap created with a CacheConfig keeps its entries within an entry
+ * and/or byte budget. Once a write pushes the map over budget, entries are
+ * evicted until it fits again. The policy state lives in the mapped file, so
+ * every process sharing the map evicts consistently.
+ *
+ * CLOCK (approximate LRU):
+ *   Every entry carries a reference bit (ShmEntry::referenced) that reads and
+ *   updates set. A hand sweeps the index; referenced entries get their bit
+ *   cleared and a second chance, the first unreferenced entry is evicted.
+ *   Expired entries are always evicted first.
+ *
+ * TINY_LFU (CLOCK plus frequency-based admission):
+ *   Accesses to every key, hits and misses alike, are counted in a count-min
+ *   sketch of 4-bit counters that is halved periodically so old popularity
+ *   fades. When a new key would evict the CLOCK victim, the key is only
+ *   admitted if it has been requested at least as often as the victim;
+ *   otherwise the new key itself is dropped. This keeps one-off scans from
+ *   flushing the hot set.
+ *
+ *   +--------------+      +-----------------------------------+
+ *   | CacheHeader  | ---> | sketch: DEPTH rows x width bytes  |
+ *   +--------------+      +-----------------------------------+
+ *
+ * The byte budget counts the entry nodes (ShmKeyValue::total_size of each
+ * entry); the hash index and headers come on top. A file whose initial size
+ * covers the budget plus the index therefore never needs to grow.
+ */
+
+#ifndef FASTCOLLECTION_CACHE_H
+#define FASTCOLLECTION_CACHE_H
+
+#include "fc_common.h"
+
+namespace fastcollection {
+
+/**
+ * @brief How a bounded FastMap chooses what to drop
+ */
+enum class EvictionPolicy : uint32_t {
+    CLOCK = 0,     // Second-chance approximation of LRU
+    TINY_LFU = 1   // CLOCK victims, frequency-based admission of new keys
+};
+
+/**
+ * @brief Budget and policy of a FastMap used as a cache
+ *
+ * A default-constructed config leaves the map unbounded.
+ */
+struct CacheConfig {
+    uint64_t max_entries = 0;  // 0 = no entry limit
+    uint64_t max_bytes = 0;    // 0 = no byte limit
+    EvictionPolicy policy = EvictionPolicy::CLOCK;
+
+    bool bounded() const { return max_entries != 0 || max_bytes != 0; }
+};
+
+/**
+ * @brief Shared-memory state of a cache-mode map
+ */
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t policy;                      // EvictionPolicy
+    uint64_t max_entries;
+    uint64_t max_bytes;
+    std::atomic<uint64_t> clock_hand;     // Scan cursor the sweep resumes at (next_scan_cursor order)
+    uint32_t sketch_width;                // Counters per sketch row (power of 2)
+    int64_t sketch_offset;                // Sketch counters (-1 = not allocated)
+    std::atomic<uint64_t> sketch_events;  // Increments since the sketch was last halved
+    IpcMutex evict_mutex;                 // One evicting writer at a time
+
+    static constexpr uint32_t MAGIC = 0xCAC4E5E7;
+
+    explicit CacheHeader(const CacheConfig& config)
+        : magic(MAGIC)
+        , policy(static_cast<uint32_t>(config.policy))
+        , max_entries(config.max_entries)
+        , max_bytes(config.max_bytes)
+        , clock_hand(0)
+        , sketch_width(0)
+        , sketch_offset(-1)
+        , sketch_events(0) {}
+
+    bool is_valid() const { return magic == MAGIC; }
+
+    EvictionPolicy eviction_policy() const { return static_cast<EvictionPolicy>(policy); }
+
+    CacheConfig config() const {
+        CacheConfig c;
+        c.max_entries = max_entries;
+        c.max_bytes = max_bytes;
+        c.policy = eviction_policy();
+        return c;
+    }
+};
+
+/**
+ * @brief Process-local view of the count-min sketch of a TINY_LFU cache
+ *
+ * Counters are updated with relaxed loads and stores, so concurrent
+ * increments of the same counter may occasionally be lost; the sketch only
+ * needs relative frequencies.
+ */
+class FrequencySketch {
+public:
+    static constexpr uint32_t DEPTH = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+    static constexpr uint32_t MIN_WIDTH = 1024;
+    static constexpr uint32_t MAX_WIDTH = 1u << 24;
+    // Increments per counter slot before every counter is halved
+    static constexpr uint64_t SAMPLE_FACTOR = 10;
+
+    FrequencySketch() = default;
+
+    /**
+     * @brief Attach to the sketch of a cache, allocating it on first use
+     */
+    FrequencySketch(MMapFileManager* file_manager, CacheHeader* header);
+
+    /**
+     * @brief Whether this cache keeps a sketch at all (TINY_LFU only)
+     */
+    explicit operator bool() const { return counters_ != nullptr; }
+
+    /**
+     * @brief Count one access to a key
+     */
+    void increment(uint32_t hash);
+
+    /**
+     * @brief Estimated recent access count of a key (0..MAX_COUNT)
+     */
+    uint32_t frequency(uint32_t hash) const;
+
+private:
+    uint32_t index(uint32_t hash, uint32_t row) const;
+    void halve();
+
+    CacheHeader* header_ = nullptr;
+    std::atomic<uint8_t>* counters_ = nullptr;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_CACHE_H
@@ -20,10 +20,12 @@
 #include <cstddef>
 #include <string>
 #include <memory>
+#include <vector>
 #include <atomic>
 #include <functional>
 #include <stdexcept>
 #include <chrono>
+#include <cstring>
 
 #include <boost/interprocess/managed_mapped_file.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
@@ -57,6 +59,16 @@ constexpr int64_t TTL_DEFAULT = TTL_INFINITE;              // Default: no expira
 constexpr uint64_t TTL_CLEANUP_INTERVAL_MS = 1000;         // Background cleanup interval
 constexpr size_t TTL_CLEANUP_BATCH_SIZE = 100;             // Max items to cleanup per pass
 
+// Cursor scans (FastMap::scan, FastSet::scan)
+constexpr size_t SCAN_DEFAULT_COUNT = 256;                 // Default batch size for bindings
+constexpr size_t SCAN_BUCKETS_PER_ENTRY = 10;              // Buckets visited per requested entry
+
+// Parallel bulk operations (see fc_thread_pool.h)
+constexpr uint32_t PARALLEL_CHUNK_BUCKETS = 1024;          // Main-array positions per task
+
+// Bucket locks of FastMap and FastSet (see fc_hashtable.h)
+constexpr uint32_t MAX_LOCK_STRIPES = 1024;                // Stripes per table, at most one per bucket
+
 namespace bip = boost::interprocess;
 
 // Forward declarations
@@ -154,6 +166,117 @@ using ScopedLock = bip::scoped_lock<IpcMutex>;
  */
 using ScopedSharedLock = bip::sharable_lock<IpcSharedMutex>;
 
+/**
+ * @brief One-word lock for shared memory: spins briefly, then sleeps
+ *
+ * A tenth the size of an IpcMutex, so many can sit side by side (see the
+ * bucket stripes in fc_hashtable.h). Uncontended lock and unlock are one
+ * atomic operation each. A contended waiter sleeps on a process-shared
+ * futex on Linux and yields elsewhere. Not recursive, and not released if
+ * its holder dies. Works with std::lock_guard and std::unique_lock.
+ */
+class ShmSpinLock {
+public:
+    ShmSpinLock() : state_(UNLOCKED) {}
+    
+    void lock() {
+        uint32_t expected = UNLOCKED;
+        if (!state_.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+            lock_slow();
+        }
+    }
+    
+    bool try_lock() {
+        uint32_t expected = UNLOCKED;
+        return state_.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire,
+                                              std::memory_order_relaxed);
+    }
+    
+    void unlock() {
+        if (state_.exchange(UNLOCKED, std::memory_order_release) == CONTENDED) {
+            wake_one();
+        }
+    }
+
+private:
+    static constexpr uint32_t UNLOCKED = 0;
+    static constexpr uint32_t LOCKED = 1;
+    static constexpr uint32_t CONTENDED = 2;  // Locked, and someone may be asleep
+    
+    void lock_slow();
+    void wake_one();
+    
+    std::atomic<uint32_t> state_;
+};
+
+/**
+ * @brief Wait/notify point for shared memory, usable across processes
+ *
+ * An event count: a sleeper reads the sequence with prepare_wait(),
+ * rechecks its condition, then calls wait(), which sleeps only while the
+ * sequence is unchanged. notify_one() and notify_all() bump the sequence
+ * after the caller has published its change, so a notification between the
+ * check and the sleep is never lost. Notifying is a fence and a load unless
+ * someone is waiting, so producers on a hot path do not contend on the word. Sleepers use a process-shared futex on Linux and a
+ * short sleep elsewhere; both may wake spuriously, so callers loop.
+ *
+ *   for (;;) {
+ *       uint32_t key = signal.prepare_wait();
+ *       if (try_take()) { signal.cancel_wait(); break; }
+ *       signal.wait(key);
+ *   }
+ *
+ * A process that dies while waiting leaves the waiter count high, which
+ * only costs notifiers a wake call.
+ */
+class ShmEventCount {
+public:
+    ShmEventCount() : sequence_(0), waiters_(0) {}
+    
+    /**
+     * @brief Register as a waiter; pass the result to wait()
+     */
+    uint32_t prepare_wait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        // Pairs with the fence in notify(): either the notifier sees this
+        // waiter, or the caller's recheck sees the notifier's change
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return sequence_.load(std::memory_order_seq_cst);
+    }
+    
+    /**
+     * @brief Deregister without waiting, once the condition held after all
+     */
+    void cancel_wait() {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Sleep until notified after prepare_wait(), or for timeout_ns
+     *
+     * Negative timeouts wait indefinitely. Deregisters either way.
+     */
+    void wait(uint32_t key, int64_t timeout_ns = -1);
+    
+    void notify_one() { notify(1); }
+    void notify_all() { notify(INT32_MAX); }
+
+private:
+    void notify(int32_t count) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) != 0) {
+            sequence_.fetch_add(1, std::memory_order_seq_cst);
+            wake(count);
+        }
+    }
+    
+    void wake(int32_t count);
+    
+    std::atomic<uint32_t> sequence_;
+    std::atomic<uint32_t> waiters_;
+};
+
 /**
  * @brief Statistics for a collection
  */
@@ -165,6 +288,8 @@ struct CollectionStats {
     std::atomic<uint64_t> write_count{0};
     std::atomic<uint64_t> hit_count{0};
     std::atomic<uint64_t> miss_count{0};
+    std::atomic<uint64_t> eviction_count{0};   // Entries dropped to stay within a cache budget
+    std::atomic<uint64_t> rejection_count{0};  // New keys refused by cache admission
     
     void reset() {
         size.store(0, std::memory_order_relaxed);
@@ -174,6 +299,8 @@ struct CollectionStats {
         write_count.store(0, std::memory_order_relaxed);
         hit_count.store(0, std::memory_order_relaxed);
         miss_count.store(0, std::memory_order_relaxed);
+        eviction_count.store(0, std::memory_order_relaxed);
+        rejection_count.store(0, std::memory_order_relaxed);
     }
 };
 
@@ -218,8 +345,14 @@ private:
     TimePoint end_;
 };
 
+class SlabAllocator;
+
 /**
  * @brief RAII wrapper for memory-mapped file management
+ *
+ * Blocks up to SlabHeap::MAX_BLOCK bytes come from the file's slab
+ * allocator (fc_slab.h); larger ones, and aligned or legacy blocks, from
+ * Boost. deallocate() tells them apart.
  */
 class MMapFileManager {
 public:
@@ -279,6 +412,22 @@ public:
      */
     void* allocate(size_t bytes);
     
+    /**
+     * @brief Allocate raw bytes at an address that is a multiple of alignment
+     */
+    void* allocate_aligned(size_t bytes, size_t alignment);
+    
+    /**
+     * @brief Allocate one block per entry of sizes in a single call
+     *
+     * Small blocks come from the slab classes; the rest are carved out of
+     * one free region when possible. Each is freed with deallocate().
+     *
+     * @param sizes Byte size of each block
+     * @param out Receives the blocks, in the order of sizes
+     */
+    void allocate_many(const std::vector<size_t>& sizes, std::vector<void*>& out);
+    
     /**
      * @brief Deallocate raw bytes
      */
@@ -291,6 +440,8 @@ public:
     
     /**
      * @brief Get free space in the mapped file
+     *
+     * Counts Boost's free space only, not free slab blocks.
      */
     size_t free_space() const;
     
@@ -312,14 +463,17 @@ public:
 private:
     std::string filename_;
     std::unique_ptr<bip::managed_mapped_file> file_;
+    std::unique_ptr<SlabAllocator> slabs_;
     size_t growth_size_;
 };
 
 /**
- * @brief Compute hash code for serialized data
+ * @brief Compute the 32-bit FNV-1a hash of serialized data
+ *
+ * Only used for files created before HashAlgorithm::WYHASH_64; see
+ * compute_hash64().
  */
 inline uint32_t compute_hash(const uint8_t* data, size_t size) {
-    // FNV-1a hash - fast and good distribution
     uint32_t hash = 2166136261u;
     for (size_t i = 0; i < size; ++i) {
         hash ^= data[i];
@@ -328,6 +482,104 @@ inline uint32_t compute_hash(const uint8_t* data, size_t size) {
     return hash;
 }
 
+namespace detail {
+
+inline uint64_t hash_read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t hash_read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 64x64 -> 128-bit multiply, low half into a and high half into b
+inline void hash_mul128(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    a = lo;
+#endif
+}
+
+inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    hash_mul128(a, b);
+    return a ^ b;
+}
+
+} // namespace detail
+
+/**
+ * @brief Compute the 64-bit hash of serialized data
+ *
+ * A wyhash-style hash: input is consumed 8 bytes at a time and long input
+ * 48 bytes per round in three independent multiply lanes, which keeps the
+ * multipliers busy instead of serializing on one dependency chain. Every
+ * bit of the result depends on every input bit, so masking the low bits for
+ * a bucket index does not cluster the way FNV-1a does.
+ */
+inline uint64_t compute_hash64(const uint8_t* data, size_t size) {
+    constexpr uint64_t P0 = 0xa0761d6478bd642full;
+    constexpr uint64_t P1 = 0xe7037ed1a0b428dbull;
+    constexpr uint64_t P2 = 0x8ebc6af09c88c6e3ull;
+    constexpr uint64_t P3 = 0x589965cc75374cc3ull;
+    
+    const uint8_t* p = data;
+    uint64_t seed = detail::hash_mix(P0, P1);
+    uint64_t a, b;
+    
+    if (size <= 16) {
+        if (size >= 4) {
+            size_t mid = (size >> 3) << 2;
+            a = (detail::hash_read32(p) << 32) | detail::hash_read32(p + mid);
+            b = (detail::hash_read32(p + size - 4) << 32) | detail::hash_read32(p + size - 4 - mid);
+        } else if (size > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) |
+                (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = size;
+        if (i > 48) {
+            uint64_t lane1 = seed, lane2 = seed;
+            do {
+                seed = detail::hash_mix(detail::hash_read64(p) ^ P1, detail::hash_read64(p + 8) ^ seed);
+                lane1 = detail::hash_mix(detail::hash_read64(p + 16) ^ P2, detail::hash_read64(p + 24) ^ lane1);
+                lane2 = detail::hash_mix(detail::hash_read64(p + 32) ^ P3, detail::hash_read64(p + 40) ^ lane2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (i > 16) {
+            seed = detail::hash_mix(detail::hash_read64(p) ^ P1, detail::hash_read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = detail::hash_read64(p + i - 16);
+        b = detail::hash_read64(p + i - 8);
+    }
+    
+    a ^= P1;
+    b ^= seed;
+    detail::hash_mul128(a, b);
+    return detail::hash_mix(a ^ P0 ^ size, b ^ P1);
+}
+
 /**
  * @brief Get current timestamp in nanoseconds
  */
@@ -361,6 +613,32 @@ inline void prefetch_write(void* addr) {
 #endif
 }
 
+/**
+ * @brief Advance a hash table scan cursor (SCAN-style reverse-binary order)
+ *
+ * Increments the bits of cursor selected by mask starting from the most
+ * significant one. A table of 2^k buckets is then visited in an order where
+ * every bucket visited so far, after the table doubles, corresponds to
+ * buckets that come before the cursor in the larger table too, so a scan
+ * resumed across a resize neither misses entries nor revisits buckets.
+ *
+ * @param cursor Current cursor; the bucket index is cursor & mask
+ * @param mask Bucket count - 1 (bucket count a power of 2)
+ * @return Next cursor, or 0 once every bucket was visited
+ */
+inline uint64_t next_scan_cursor(uint64_t cursor, uint64_t mask) {
+    auto reverse = [](uint64_t v) {
+        v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+        v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+        v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+        v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+        return (v >> 32) | (v << 32);
+    };
+    // Setting the unmasked bits makes the increment carry out of the top
+    return reverse(reverse(cursor | ~mask) + 1);
+}
+
 /**
  * @brief Statistics about a collection file
  */
@@ -0,0 +1,172 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_epoch.h
+ * @brief Cross-process epoch-based reclamation for lock-free readers
+ *
+ * ============================================================================
+ * EPOCH-BASED RECLAMATION
+ * ============================================================================
+ *
+ * Lock-free readers may still be walking a node after a writer has unlinked
+ * it. Instead of freeing such nodes immediately, writers retire them into
+ * one of three limbo lists kept in the mapped file, indexed by the global
+ * epoch at retirement time.
+ *
+ *   global epoch:   e-2        e-1         e
+ *   limbo lists:   [free]    [waiting]  [retiring]
+ *
+ * A reader claims one of MAX_READERS slots when it enters its outermost
+ * read section, announces there the epoch it entered with, and gives the
+ * slot back when it leaves. The global epoch only advances from e to e+1
+ * once every active slot has announced e, at which point nothing retired in
+ * e-2 can still be referenced and that list is freed.
+ *
+ * - Entering costs one CAS on the slot the thread used last, which is
+ *   normally still free, and leaving two stores.
+ * - Readers beyond MAX_READERS at the same moment count themselves in a
+ *   shared counter per epoch instead (one fetch_add each way), so any
+ *   number of threads can read; advancing waits for those counters too.
+ * - Slots held by processes that died are reclaimed when the collection is
+ *   next opened. A process that dies inside an overflow read section stops
+ *   reclamation in that file until it is recreated.
+ * - Retired nodes are linked through a caller-chosen int64 field that
+ *   readers never follow (prev_offset for chain nodes).
+ */
+
+#ifndef FASTCOLLECTION_EPOCH_H
+#define FASTCOLLECTION_EPOCH_H
+
+#include "fc_common.h"
+#include <vector>
+
+namespace fastcollection {
+
+/**
+ * @brief Reader slot: announced epoch and owning process
+ *
+ * Padded to a cache line rather than alignas(64): named objects in the
+ * segment are only guaranteed 16-byte alignment.
+ */
+struct EpochSlot {
+    std::atomic<uint64_t> epoch;   // 0 = quiescent
+    std::atomic<uint64_t> owner;   // pid + 1 of the owning process, 0 = free
+    uint8_t padding[64 - 2 * sizeof(uint64_t)];
+
+    EpochSlot() : epoch(0), owner(0) {}
+};
+
+/**
+ * @brief Shared-memory state of an epoch domain
+ */
+struct EpochHeader {
+    static constexpr uint32_t MAX_READERS = 128;  // Read sections with a slot at once
+    static constexpr uint32_t LIMBO_LISTS = 3;
+
+    std::atomic<uint64_t> global_epoch;
+    IpcMutex limbo_mutex;                 // Guards the limbo lists and epoch advance
+    int64_t limbo_head[LIMBO_LISTS];
+    uint64_t limbo_count[LIMBO_LISTS];
+    std::atomic<uint64_t> overflow[LIMBO_LISTS];  // Readers without a slot, by epoch % LIMBO_LISTS
+    EpochSlot slots[MAX_READERS];
+
+    EpochHeader() : global_epoch(1) {
+        for (uint32_t i = 0; i < LIMBO_LISTS; i++) {
+            limbo_head[i] = -1;
+            limbo_count[i] = 0;
+            overflow[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * @brief Process-local handle on an epoch domain stored in a mapped file
+ */
+class EpochDomain {
+    struct ThreadEntry;
+
+public:
+    // Retired nodes accumulated before an epoch advance is attempted
+    static constexpr uint64_t RECLAIM_THRESHOLD = 64;
+
+    /**
+     * @brief Attach to an epoch domain
+     *
+     * @param link_offset Byte offset, within each retired node, of the
+     *                    std::atomic<int64_t> used to chain limbo lists
+     */
+    EpochDomain(MMapFileManager* file_manager, EpochHeader* header, size_t link_offset);
+    ~EpochDomain();
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /**
+     * @brief RAII read section; nodes reachable inside it stay allocated
+     *
+     * Read sections nest: only the outermost one claims a slot and
+     * announces an epoch.
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const EpochDomain& domain);
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        const EpochDomain* domain_;
+        ThreadEntry* entry_;
+    };
+
+    /**
+     * @brief Enter a read section
+     */
+    ReadGuard read() const { return ReadGuard(*this); }
+
+    /**
+     * @brief Hand over an unlinked node to be freed once no reader can see it
+     */
+    void retire(void* node);
+
+    /**
+     * @brief Free everything that is safe to free right now
+     * @return Number of nodes freed
+     */
+    size_t reclaim();
+
+private:
+    static std::vector<std::unique_ptr<ThreadEntry>>& thread_entries();
+
+    ThreadEntry* thread_entry() const;
+    void enter(ThreadEntry& entry) const;  // Outermost read section starts
+    void leave(ThreadEntry& entry) const;  // ... and ends
+    void scavenge_dead_slots();
+    size_t try_advance();  // Requires limbo_mutex
+    size_t free_list(uint32_t list);
+
+    std::atomic<int64_t>* link_of(int64_t offset) const {
+        return reinterpret_cast<std::atomic<int64_t>*>(
+            reinterpret_cast<uint8_t*>(file_manager_->segment_manager()) + offset + link_offset_);
+    }
+
+    MMapFileManager* file_manager_;
+    EpochHeader* header_;
+    size_t link_offset_;
+    uint64_t id_;                          // Unique per domain instance in this process
+    uint64_t owner_;                       // Slot owner token of this process
+    std::shared_ptr<bool> alive_;          // Expires with the domain, so threads drop their entries
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_EPOCH_H
@@ -0,0 +1,233 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_expiry.h
+ * @brief Persistent expiration index for TTL collections
+ *
+ * ============================================================================
+ * EXPIRY INDEX
+ * ============================================================================
+ *
+ * Without an index, removeExpired() has to visit every element to find the
+ * few that are due. The index keeps one record per element with a TTL in
+ * binary min-heaps that live in the mapped file, ordered by expires_at, so a
+ * reap only visits the elements that are due.
+ *
+ *   +--------------+      +--------------------------------------------+
+ *   | ExpiryHeader | ---> | shard 0: heap (expires_at, node) | due     |
+ *   |  shards[16]  | ---> | shard 1: heap (expires_at, node) | due     |
+ *   |  due         |      +--------------------------------------------+
+ *   +--------------+
+ *
+ * Every record names its node, and every node remembers where its record
+ * is (ShmEntry::expiry_index). Changing a TTL repositions the record and
+ * unlinking a node removes it, so the index never holds a stale record and
+ * never two for one node. Hash collections (FastMap, FastSet) spread their
+ * nodes over the shards by hash, each shard with its own mutex, so writers
+ * to different buckets rarely contend; FastList and FastSortedMap use shard
+ * 0 only, under their global lock as well.
+ *
+ * Once a record comes due it moves off its heap into the shard's unordered
+ * due list, at most once, and ExpiryHeader::due counts the due lists. So
+ * size() subtracts an exact count of the elements that expired but were not
+ * reaped yet, at amortized constant cost, and the reaper takes its work from
+ * the due lists.
+ *
+ * Files created before this index existed open with an incomplete one;
+ * their first removeExpired() performs a full sweep that fills it. Indexes
+ * of the earlier layout (lazy records by hash for maps and sets) are left
+ * unused under their old names.
+ */
+
+#ifndef FASTCOLLECTION_EXPIRY_H
+#define FASTCOLLECTION_EXPIRY_H
+
+#include "fc_common.h"
+#include "fc_serialization.h"
+#include <vector>
+
+namespace fastcollection {
+
+/**
+ * @brief One record: when it is due and which node it is for
+ */
+struct ExpiryRecord {
+    uint64_t expires_at;
+    uint64_t ref;  // Segment offset of the node's ShmEntry
+};
+
+/**
+ * @brief One shard of the index: a heap and a due list
+ */
+struct ExpiryShard {
+    IpcMutex mutex;                  // Guards both arrays
+    uint32_t count;                  // Records on the heap
+    uint32_t capacity;
+    int64_t records_offset;          // Heap of ExpiryRecords (-1 = not allocated)
+    uint32_t due_count;              // Records taken off the heap once due
+    uint32_t due_capacity;
+    int64_t due_offset;              // Due list (-1 = not allocated)
+    std::atomic<uint64_t> next_due;  // Heap root's expires_at, read without the mutex
+
+    ExpiryShard()
+        : count(0), capacity(0), records_offset(-1)
+        , due_count(0), due_capacity(0), due_offset(-1)
+        , next_due(CollectionHeader::NO_EXPIRY) {}
+};
+
+/**
+ * @brief Shared-memory header of an expiry index
+ */
+struct ExpiryHeader {
+    static constexpr uint32_t SHARDS = 16;
+    static constexpr uint32_t MAGIC = 0xE4B1E5E8;
+
+    uint32_t magic;
+    std::atomic<uint32_t> complete;  // 0 = elements may be missing a record
+    std::atomic<uint64_t> records;   // Records across all heaps and due lists
+    std::atomic<uint64_t> due;       // Records across all due lists
+    ExpiryShard shards[SHARDS];
+
+    explicit ExpiryHeader(bool complete_index)
+        : magic(MAGIC)
+        , complete(complete_index ? 1 : 0)
+        , records(0)
+        , due(0) {}
+
+    bool is_valid() const { return magic == MAGIC; }
+};
+
+/**
+ * @brief Process-local view of an expiry index stored in a mapped file
+ */
+class ExpiryIndex {
+public:
+    static constexpr uint32_t MIN_CAPACITY = 64;
+
+    ExpiryIndex() = default;
+
+    /**
+     * @brief Attach to an index
+     *
+     * @param by_hash Spread nodes over the shards by hash (hash collections);
+     *                otherwise all records live in shard 0
+     */
+    ExpiryIndex(MMapFileManager* file_manager, ExpiryHeader* header, bool by_hash);
+
+    explicit operator bool() const { return header_ != nullptr; }
+
+    /**
+     * @brief Whether removeExpired() must fall back to a full sweep
+     *
+     * True while the index may miss elements.
+     */
+    bool needs_rebuild() const { return !header_->complete.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Mark the index as covering every element, after a full sweep
+     */
+    void mark_complete() { header_->complete.store(1, std::memory_order_release); }
+
+    /**
+     * @brief Drop every record (clear, or the start of a rebuilding sweep)
+     *
+     * Nodes keep stale positions, which fail validation.
+     */
+    void reset();
+
+    /**
+     * @brief Earliest due time in the index, or CollectionHeader::NO_EXPIRY
+     *
+     * While a due list is not empty, the due time of one of its records.
+     */
+    uint64_t next_expiry() const;
+
+    /**
+     * @brief Number of indexed elements due at now and not reaped yet
+     *
+     * Moves records that came due onto the due lists first; shards whose
+     * heap has nothing due are skipped without taking their mutex.
+     */
+    uint64_t count_due(uint64_t now) const;
+
+    /**
+     * @brief Insert, reposition or remove a node's record after its expires_at changed
+     *
+     * Call before CollectionHeader::note_expiry() so a concurrent reaper
+     * that rebuilds the bound from the index cannot miss the node.
+     */
+    void track(ShmEntry* entry);
+
+    /**
+     * @brief Remove a node's record, if it has one; call before the node is freed
+     */
+    void untrack(ShmEntry* entry);
+
+    /**
+     * @brief Take up to max_records due records, appending their nodes' hashes
+     *
+     * For hash collections: the reaper locks those buckets and removes what
+     * has expired there.
+     */
+    void pop_due(uint64_t now, std::vector<uint32_t>& hashes, size_t max_records = SIZE_MAX);
+
+    /**
+     * @brief Take one due record and return its node, or nullptr
+     */
+    ShmEntry* pop_due(uint64_t now);
+
+private:
+    static constexpr uint32_t DUE_BIT = 0x80000000u;
+
+    uint8_t* base() const {
+        return reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+    }
+
+    ExpiryRecord* records(const ExpiryShard& shard) const {
+        return reinterpret_cast<ExpiryRecord*>(base() + shard.records_offset);
+    }
+
+    ExpiryRecord* due_records(const ExpiryShard& shard) const {
+        return reinterpret_cast<ExpiryRecord*>(base() + shard.due_offset);
+    }
+
+    ShmEntry* entry_at(uint64_t offset) const {
+        return reinterpret_cast<ShmEntry*>(base() + offset);
+    }
+
+    ExpiryShard& shard_of(const ShmEntry* entry) const {
+        return header_->shards[by_hash_ ? (entry->hash_code >> 24) % ExpiryHeader::SHARDS : 0];
+    }
+
+    // Heap position, DUE_BIT | due list position, or NOT_INDEXED
+    uint32_t position_of(const ExpiryShard& shard, const ShmEntry* entry) const;
+
+    // Move the records due at now onto the due list (mutex held)
+    void settle(ExpiryShard& shard, uint64_t now) const;
+
+    void grow(int64_t& offset, uint32_t& capacity, uint32_t count) const;
+    void push(ExpiryShard& shard, const ExpiryRecord& record) const;
+    void erase(ExpiryShard& shard, uint32_t index) const;
+    void push_due(ExpiryShard& shard, const ExpiryRecord& record) const;
+    void erase_due(ExpiryShard& shard, uint32_t index) const;
+    void sift_up(ExpiryShard& shard, uint32_t index) const;
+    void sift_down(ExpiryShard& shard, uint32_t index) const;
+    void place(ExpiryShard& shard, uint32_t index, const ExpiryRecord& record) const;
+    void publish(ExpiryShard& shard) const;
+
+    MMapFileManager* file_manager_ = nullptr;
+    ExpiryHeader* header_ = nullptr;
+    bool by_hash_ = false;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_EXPIRY_H
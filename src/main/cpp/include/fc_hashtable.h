@@ -0,0 +1,806 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_hashtable.h
+ * @brief Resizable bucket table shared by FastMap and FastSet
+ *
+ * ============================================================================
+ * INCREMENTAL REHASHING
+ * ============================================================================
+ *
+ * The bucket array of a map or set doubles once the number of entries exceeds
+ * load_factor_percent of the bucket count. Instead of rehashing everything in
+ * one stop-the-world pass, the table keeps two arrays while a resize is in
+ * progress and moves a few chains per write operation:
+ *
+ *   main array (n)                 rehash array (2n)
+ *   +-----------+                  +-----------+
+ *   | MIGRATED  | ---------------> | bucket i  |   hash & (2n-1) == i
+ *   | MIGRATED  |         \------> | bucket i+n|   hash & (2n-1) == i+n
+ *   | chain ... |                  |    ...    |
+ *   +-----------+                  +-----------+
+ *
+ * - Writers lock the hash's stripe, then work on the main bucket or, if it
+ *   has been migrated, on the corresponding rehash bucket.
+ * - Lock-free readers follow the same routing and retry their lookup if the
+ *   chain they walked was migrated underneath them.
+ * - Migration is serialized by BucketDirectory::resize_mutex and only ever
+ *   attempted with try_lock, so a writer never waits on another's resize.
+ * - Sweeps that modify chains hold resize_mutex so the set of live buckets
+ *   is stable. Parallel ones hold it on the calling thread while pool
+ *   workers visit disjoint chunks of the main array.
+ * - Node sweeps, which run user callbacks, hold resize_mutex only while
+ *   they read the chains of a batch of main-array positions, and call back
+ *   after releasing it. A resize may complete between batches; tables only
+ *   grow, so a position of the table the sweep started on is then the set
+ *   of positions with the same low bits, and every node present throughout
+ *   is visited exactly once.
+ *   Resumable scans hold it for one step at a time and carry a cursor in
+ *   reverse-binary order (see next_scan_cursor()) across resizes.
+ * - Replaced main arrays are never freed. A thread that loaded the old main
+ *   array just before a resize finished may still be about to lock one of
+ *   its buckets; it must find MIGRATED there and retry, not reused memory.
+ *   Together the old arrays are smaller than the live one.
+ *
+ * ============================================================================
+ * BUCKETS AND LOCK STRIPES
+ * ============================================================================
+ *
+ * A bucket is a 16-byte head offset and tag word (see ShmBucket), so a
+ * lookup that misses usually reads one cache line and no chain node.
+ * Bucket locks live apart from the buckets, in an array of one-word
+ * ShmSpinLock stripes, one cache line each. The stripe of a hash is
+ * hash & (stripes - 1). There are never more stripes than buckets in the
+ * table the file was created with, and tables only grow, so all hashes of
+ * a bucket, and of both halves it migrates into, share one stripe.
+ *
+ * Callbacks that run under a stripe lock (the locked sweeps below) must not
+ * write to the same collection: stripe locks are not recursive.
+ *
+ * Files written before tagged buckets are converted when first opened,
+ * under resize_mutex: every chain is relinked into a new tagged array
+ * (finishing any resize in progress) and the stripes are created last.
+ * The owning collection stamps its header with
+ * CollectionHeader::CURRENT_VERSION on open, so builds that predate the
+ * conversion refuse the file.
+ *
+ * Node types must provide entry.hash_code, next_offset and prev_offset, which
+ * both ShmNode and ShmKeyValue do.
+ */
+
+#ifndef FASTCOLLECTION_HASHTABLE_H
+#define FASTCOLLECTION_HASHTABLE_H
+
+#include "fc_common.h"
+#include "fc_serialization.h"
+#include "fc_thread_pool.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fastcollection {
+
+/**
+ * @brief Stripe lock held on a bucket returned by BucketTable::lock_bucket()
+ *
+ * Movable, so batch writers can keep one bucket locked across keys.
+ */
+class BucketGuard {
+public:
+    BucketGuard() = default;
+    
+    BucketGuard(ShmLockStripe* stripe, ShmBucket* bucket)
+        : stripe_(stripe)
+        , bucket_(bucket) {}
+    
+    ~BucketGuard() { unlock(); }
+    
+    BucketGuard(const BucketGuard&) = delete;
+    BucketGuard& operator=(const BucketGuard&) = delete;
+    
+    BucketGuard(BucketGuard&& other) noexcept
+        : stripe_(other.stripe_)
+        , bucket_(other.bucket_) {
+        other.stripe_ = nullptr;
+        other.bucket_ = nullptr;
+    }
+    
+    BucketGuard& operator=(BucketGuard&& other) noexcept {
+        if (this != &other) {
+            unlock();
+            stripe_ = other.stripe_;
+            bucket_ = other.bucket_;
+            other.stripe_ = nullptr;
+            other.bucket_ = nullptr;
+        }
+        return *this;
+    }
+    
+    ShmBucket* bucket() const { return bucket_; }
+    
+    bool owns() const { return stripe_ != nullptr; }
+    
+    void unlock() {
+        if (stripe_) {
+            stripe_->lock.unlock();
+            stripe_ = nullptr;
+        }
+    }
+
+private:
+    ShmLockStripe* stripe_ = nullptr;
+    ShmBucket* bucket_ = nullptr;
+};
+
+template<typename Node>
+class BucketTable {
+public:
+    // Number of main buckets migrated per write operation
+    static constexpr uint32_t MIGRATE_BATCH = 4;
+
+    // Main-array positions whose chains a node sweep reads per resize_mutex hold
+    static constexpr uint32_t SWEEP_BATCH = 64;
+
+    BucketTable() = default;
+
+    /**
+     * @brief Attach to (or create) the bucket array, directory and stripes of a table
+     *
+     * Files created before incremental rehashing have only the named bucket
+     * array; the directory is created on first open and points at it. Files
+     * created before lock stripes are converted to tagged buckets first.
+     */
+    BucketTable(MMapFileManager* file_manager, HashTableHeader* header,
+                const char* buckets_name, const char* directory_name, const char* stripes_name)
+        : file_manager_(file_manager)
+        , header_(header) {
+        // New files get their stripes first, so stripes mean tagged buckets
+        bool tagged = file_manager_->find<ShmLockStripe>(stripes_name).first != nullptr;
+        directory_ = file_manager_->find<BucketDirectory>(directory_name).first;
+        
+        if (!tagged && !directory_) {
+            LegacyShmBucket* legacy = file_manager_->find<LegacyShmBucket>(buckets_name).first;
+            if (legacy) {
+                directory_ = file_manager_->find_or_construct<BucketDirectory>(
+                    directory_name, to_offset(legacy), header_->bucket_count);
+            } else {
+                file_manager_->construct_array<ShmLockStripe>(
+                    stripes_name, stripes_for(header_->bucket_count));
+                tagged = true;
+            }
+        }
+        
+        if (!tagged) {
+            convert_legacy(stripes_name);
+        } else if (!directory_) {
+            create_directory(directory_name);
+        }
+        
+        // Allocations above may have remapped the file
+        directory_ = file_manager_->find<BucketDirectory>(directory_name).first;
+        auto stripes = file_manager_->find<ShmLockStripe>(stripes_name);
+        stripes_ = stripes.first;
+        stripe_count_ = static_cast<uint32_t>(stripes.second);
+    }
+
+    /**
+     * @brief Lock the bucket that currently owns a hash
+     *
+     * The bucket is never in a migrated state while its guard is held.
+     */
+    BucketGuard lock_bucket(uint32_t hash) {
+        ShmLockStripe* stripe = &stripes_[hash & (stripe_count_ - 1)];
+        stripe->lock.lock();
+        
+        // Holding the stripe keeps the bucket found from migrating, and so
+        // its array from being replaced, until the guard is released
+        for (;;) {
+            uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+            ShmBucket* bucket = bucket_at(main, hash);
+            if (bucket->head_offset.load(std::memory_order_acquire) != ShmBucket::MIGRATED_OFFSET) {
+                return BucketGuard(stripe, bucket);
+            }
+
+            uint64_t target = rehash_target_of(main);
+            if (target == 0) continue;  // Resize finished, main table has moved
+
+            bucket = bucket_at(target, hash);
+            if (bucket->head_offset.load(std::memory_order_acquire) != ShmBucket::MIGRATED_OFFSET) {
+                return BucketGuard(stripe, bucket);
+            }
+        }
+    }
+
+    /**
+     * @brief Update a locked bucket's tags after a node was unlinked from it
+     */
+    void untag(ShmBucket* bucket, uint32_t hash) const {
+        if (!bucket->remove_entry(hash)) retag(bucket);
+    }
+
+    /**
+     * @brief Lock-free lookup of the first node in a hash's chain matching a predicate
+     *
+     * Only nodes of that hash can match: chains whose tags rule the hash
+     * out are not walked.
+     */
+    template<typename Match>
+    const Node* find(uint32_t hash, Match&& match) const {
+        const uint8_t* base = static_cast<const uint8_t*>(
+            static_cast<const void*>(file_manager_->segment_manager()));
+
+        for (;;) {
+            uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+            const ShmBucket* bucket = bucket_at(main, hash);
+            int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+
+            if (current == ShmBucket::MIGRATING_OFFSET) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (current == ShmBucket::MIGRATED_OFFSET) {
+                uint64_t target = rehash_target_of(main);
+                if (target == 0) continue;
+                bucket = bucket_at(target, hash);
+                current = bucket->head_offset.load(std::memory_order_acquire);
+                if (current < ShmBucket::NULL_OFFSET) continue;
+            }
+
+            if (bucket->may_contain(hash)) {
+                while (current >= 0) {
+                    const Node* node = reinterpret_cast<const Node*>(base + current);
+                    if (match(node)) return node;
+                    current = node->next_offset.load(std::memory_order_acquire);
+                }
+            }
+
+            // A miss only counts if the chain was not relinked while we walked it
+            if (bucket->head_offset.load(std::memory_order_seq_cst) >= ShmBucket::NULL_OFFSET &&
+                directory_->main_table.load(std::memory_order_acquire) == main) {
+                return nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief Prefetch the chain head of a hash's main-array bucket
+     */
+    void prefetch_bucket(uint32_t hash) const {
+        prefetch_read(&bucket_at(directory_->main_table.load(std::memory_order_acquire), hash)->head_offset);
+    }
+
+    /**
+     * @brief Prefetch the first node of a hash's chain
+     *
+     * Best effort: reads the head offset without validating it, so call it
+     * once the bucket itself is likely cached (after prefetch_bucket).
+     */
+    void prefetch_chain(uint32_t hash) const {
+        const ShmBucket* bucket = bucket_at(directory_->main_table.load(std::memory_order_acquire), hash);
+        int64_t head = bucket->head_offset.load(std::memory_order_acquire);
+        if (head < 0) return;
+
+        const Node* node = reinterpret_cast<const Node*>(
+            static_cast<const uint8_t*>(static_cast<const void*>(file_manager_->segment_manager())) + head);
+        prefetch_read(node);
+        prefetch_read(node->data);
+    }
+
+    /**
+     * @brief Whether a bucket returned by lock_bucket(), still locked, also owns a hash
+     *
+     * Lets batch writers keep one bucket locked across consecutive keys.
+     */
+    bool owns(const ShmBucket* locked, uint32_t hash) const {
+        if (bucket_at(directory_->main_table.load(std::memory_order_acquire), hash) == locked) {
+            return true;
+        }
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        return target != 0 && bucket_at(target, hash) == locked;
+    }
+
+    /**
+     * @brief Visit every node in the table
+     *
+     * The callback gets each node once and returns false to stop early. It
+     * runs without resize_mutex or any stripe lock, so it may read or write
+     * the collection, and nodes it is handed may have been removed since
+     * (check entry.is_alive()). Chains are walked without stripe locks too,
+     * so the caller must hold an epoch read section across the sweep: it
+     * keeps removed nodes from being freed, and their blocks from being
+     * handed out again, until the sweep is over.
+     */
+    template<typename Fn>
+    void for_each_node(Fn&& fn) const {
+        uint32_t count = BucketDirectory::table_size(directory_->main_table.load(std::memory_order_acquire));
+        std::vector<int64_t> nodes;
+
+        for (uint32_t first = 0; first < count; first += SWEEP_BATCH) {
+            nodes.clear();
+            collect_nodes(first, std::min(count, first + SWEEP_BATCH), count, nodes);
+            for (int64_t offset : nodes) {
+                if (!fn(node_at(offset))) return;
+            }
+        }
+    }
+
+    /**
+     * @brief Visit every node on the shared thread pool
+     *
+     * Like for_each_node(), but chunks of PARALLEL_CHUNK_BUCKETS main-array
+     * positions run concurrently on ThreadPool::instance(). The callback is
+     * called from several threads at once; returning false stops the sweep
+     * once the running chunks notice. Read sections belong to a thread, so
+     * each chunk holds the one returned by enter() while it runs.
+     */
+    template<typename Fn, typename Enter>
+    void for_each_node_parallel(Fn&& fn, Enter&& enter) const {
+        uint32_t count = BucketDirectory::table_size(directory_->main_table.load(std::memory_order_acquire));
+        size_t chunks = (count + PARALLEL_CHUNK_BUCKETS - 1) / PARALLEL_CHUNK_BUCKETS;
+        std::atomic<bool> stop{false};
+
+        ThreadPool::instance().parallel_for(chunks, [&](size_t chunk) {
+            uint32_t end = std::min(count, static_cast<uint32_t>((chunk + 1) * PARALLEL_CHUNK_BUCKETS));
+            std::vector<int64_t> nodes;
+            auto section = enter();
+
+            for (uint32_t first = static_cast<uint32_t>(chunk * PARALLEL_CHUNK_BUCKETS);
+                 first < end && !stop.load(std::memory_order_relaxed); first += SWEEP_BATCH) {
+                nodes.clear();
+                collect_nodes(first, std::min(end, first + SWEEP_BATCH), count, nodes);
+                for (int64_t offset : nodes) {
+                    if (!fn(node_at(offset))) {
+                        stop.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Visit every live bucket with its stripe locked
+     *
+     * Holds resize_mutex for the duration so no chain changes array while
+     * the sweep is running. The callback may modify the chain and returns
+     * false to stop early.
+     */
+    template<typename Fn>
+    void for_each_locked_bucket(Fn&& fn) const {
+        sweep(fn);
+    }
+
+    /**
+     * @brief Like for_each_locked_bucket(), resuming a lap at a scan cursor
+     *
+     * Visits main-array positions in next_scan_cursor() order from
+     * @p cursor, wrapping around once, and passes the cursor that follows
+     * the position being visited so the lap can be resumed later. Unlike an
+     * array index, a cursor keeps its place when the table doubles: the
+     * positions already passed are exactly those holding the entries
+     * already passed, so a resumed lap neither repeats nor skips them.
+     */
+    template<typename Fn>
+    void for_each_locked_bucket_from(uint64_t cursor, Fn&& fn) const {
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex);
+
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        ShmBucket* main_buckets = buckets_of(main);
+        uint32_t count = BucketDirectory::table_size(main);
+
+        for (uint32_t n = 0; n < count; n++) {
+            uint32_t i = static_cast<uint32_t>(cursor & (count - 1));
+            cursor = next_scan_cursor(cursor, count - 1);
+            StripeLock lock(stripe_at(i));
+
+            ShmBucket* bucket = &main_buckets[i];
+            if (bucket->head_offset.load(std::memory_order_acquire) == ShmBucket::MIGRATED_OFFSET) {
+                ShmBucket* target_buckets = buckets_of(target);
+                if (!fn(cursor, &target_buckets[i])) return;
+                if (!fn(cursor, &target_buckets[i + count])) return;
+            } else if (!fn(cursor, bucket)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Like for_each_locked_bucket(), on the shared thread pool
+     *
+     * Chunks of PARALLEL_CHUNK_BUCKETS main-array positions run concurrently
+     * on ThreadPool::instance(), each bucket with its stripe locked.
+     */
+    template<typename Fn>
+    void for_each_locked_bucket_parallel(Fn&& fn) const {
+        sweep_parallel(fn);
+    }
+
+    /**
+     * @brief Visit the buckets of one step of a resumable scan
+     *
+     * Visits main-array positions in next_scan_cursor() order from @p cursor,
+     * each with the one or two buckets its chain lives in, until the callback
+     * returns false or max_buckets positions were visited. Holds
+     * resize_mutex for the step only; cursors stay valid across resizes.
+     *
+     * @return Cursor for the next step, or 0 once every position was visited
+     */
+    template<typename Fn>
+    uint64_t scan_from(uint64_t cursor, size_t max_buckets, Fn&& fn) const {
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex);
+
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        ShmBucket* main_buckets = buckets_of(main);
+        uint32_t count = BucketDirectory::table_size(main);
+
+        for (size_t n = 0; n < max_buckets; n++) {
+            uint32_t i = static_cast<uint32_t>(cursor & (count - 1));
+            bool more;
+            ShmBucket* bucket = &main_buckets[i];
+            if (bucket->head_offset.load(std::memory_order_acquire) == ShmBucket::MIGRATED_OFFSET) {
+                ShmBucket* target_buckets = buckets_of(target);
+                more = fn(&target_buckets[i]);
+                more = fn(&target_buckets[i + count]) && more;
+            } else {
+                more = fn(bucket);
+            }
+
+            cursor = next_scan_cursor(cursor, count - 1);
+            if (cursor == 0 || !more) break;
+        }
+        return cursor;
+    }
+
+    /**
+     * @brief Advance an in-progress resize, or start one if the table is overloaded
+     *
+     * Called by write operations before they lock their bucket. Never blocks:
+     * if another thread or process is resizing, this is a no-op.
+     */
+    void advance() {
+        bool rehashing = directory_->rehash_table.load(std::memory_order_acquire) != 0;
+        if (!rehashing && !overloaded()) return;
+
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex, bip::try_to_lock);
+        if (!resize_lock.owns()) return;
+
+        if (directory_->rehash_table.load(std::memory_order_acquire) == 0) {
+            if (!overloaded() || !start_resize()) return;
+        }
+
+        for (uint32_t n = 0; n < MIGRATE_BATCH; n++) {
+            if (!migrate_next()) break;
+        }
+    }
+
+    /**
+     * @brief Number of buckets entries are currently spread across
+     */
+    uint32_t bucket_count() const {
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        return BucketDirectory::table_size(
+            target ? target : directory_->main_table.load(std::memory_order_acquire));
+    }
+
+private:
+    using IpcScopedLockGuard = bip::scoped_lock<IpcMutex>;
+    using StripeLock = std::unique_lock<ShmSpinLock>;
+
+    static constexpr uint32_t MAX_BUCKET_COUNT = 1u << 30;
+
+    // Stripes for a table created with the given bucket count
+    static uint32_t stripes_for(uint32_t bucket_count) {
+        return std::min(MAX_LOCK_STRIPES,
+                        BucketDirectory::table_size(BucketDirectory::pack(0, bucket_count)));
+    }
+
+    // Stripe of a main-array position; the same for any array size
+    ShmSpinLock& stripe_at(uint32_t index) const {
+        return stripes_[index & (stripe_count_ - 1)].lock;
+    }
+
+    const Node* node_at(int64_t offset) const {
+        return reinterpret_cast<const Node*>(
+            static_cast<const uint8_t*>(static_cast<const void*>(file_manager_->segment_manager())) + offset);
+    }
+
+    // Append the nodes of main-array positions [first, last) of a table of
+    // count buckets, wherever a resize has moved their chains since
+    void collect_nodes(uint32_t first, uint32_t last, uint32_t count, std::vector<int64_t>& nodes) const {
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex);
+
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        ShmBucket* main_buckets = buckets_of(main);
+        uint32_t now = BucketDirectory::table_size(main);
+
+        auto walk = [&](const ShmBucket* bucket) {
+            int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+            while (current >= 0) {
+                nodes.push_back(current);
+                current = node_at(current)->next_offset.load(std::memory_order_acquire);
+            }
+        };
+
+        // Migration runs under resize_mutex, so no chain is half moved here
+        for (uint32_t i = first; i < last; i++) {
+            for (uint32_t j = i; j < now; j += count) {
+                const ShmBucket* bucket = &main_buckets[j];
+                if (bucket->head_offset.load(std::memory_order_acquire) == ShmBucket::MIGRATED_OFFSET) {
+                    walk(&buckets_of(target)[j]);
+                    walk(&buckets_of(target)[j + now]);
+                } else {
+                    walk(bucket);
+                }
+            }
+        }
+    }
+
+    template<typename Fn>
+    void sweep(Fn&& fn) const {
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex);
+
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        ShmBucket* main_buckets = buckets_of(main);
+        uint32_t count = BucketDirectory::table_size(main);
+
+        for (uint32_t i = 0; i < count; i++) {
+            StripeLock lock(stripe_at(i));
+
+            ShmBucket* bucket = &main_buckets[i];
+            if (bucket->head_offset.load(std::memory_order_acquire) == ShmBucket::MIGRATED_OFFSET) {
+                ShmBucket* target_buckets = buckets_of(target);
+                if (!fn(&target_buckets[i])) return;
+                if (!fn(&target_buckets[i + count])) return;
+            } else if (!fn(bucket)) {
+                return;
+            }
+        }
+    }
+
+    template<typename Fn>
+    void sweep_parallel(Fn&& fn) const {
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex);
+
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        ShmBucket* main_buckets = buckets_of(main);
+        uint32_t count = BucketDirectory::table_size(main);
+        size_t chunks = (count + PARALLEL_CHUNK_BUCKETS - 1) / PARALLEL_CHUNK_BUCKETS;
+        std::atomic<bool> stop{false};
+
+        ThreadPool::instance().parallel_for(chunks, [&](size_t chunk) {
+            uint32_t first = static_cast<uint32_t>(chunk * PARALLEL_CHUNK_BUCKETS);
+            uint32_t last = std::min(count, first + PARALLEL_CHUNK_BUCKETS);
+
+            for (uint32_t i = first; i < last && !stop.load(std::memory_order_relaxed); i++) {
+                StripeLock lock(stripe_at(i));
+
+                ShmBucket* bucket = &main_buckets[i];
+                bool more;
+                if (bucket->head_offset.load(std::memory_order_acquire) == ShmBucket::MIGRATED_OFFSET) {
+                    ShmBucket* target_buckets = buckets_of(target);
+                    more = fn(&target_buckets[i]) && fn(&target_buckets[i + count]);
+                } else {
+                    more = fn(bucket);
+                }
+                if (!more) stop.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    int64_t to_offset(const void* ptr) const {
+        return static_cast<const uint8_t*>(ptr) -
+               static_cast<const uint8_t*>(static_cast<const void*>(file_manager_->segment_manager()));
+    }
+
+    ShmBucket* buckets_of(uint64_t packed) const {
+        return reinterpret_cast<ShmBucket*>(
+            reinterpret_cast<uint8_t*>(file_manager_->segment_manager()) +
+            BucketDirectory::table_offset(packed));
+    }
+
+    ShmBucket* bucket_at(uint64_t packed, uint32_t hash) const {
+        return &buckets_of(packed)[SerializationUtil::bucket_index(
+            hash, BucketDirectory::table_size(packed))];
+    }
+
+    // Rehash array of the resize that started from main, or 0 if that
+    // resize has finished. A thread that loaded main before a whole resize
+    // completed and the next one started must not follow the newer rehash
+    // array, whose buckets are only constructed as their chains migrate.
+    uint64_t rehash_target_of(uint64_t main) const {
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        if (directory_->main_table.load(std::memory_order_acquire) != main) return 0;
+        return target;
+    }
+
+    bool overloaded() const {
+        uint64_t main = directory_->main_table.load(std::memory_order_relaxed);
+        uint64_t count = BucketDirectory::table_size(main);
+        return count < MAX_BUCKET_COUNT &&
+               header_->size.load(std::memory_order_relaxed) * 100 >
+                   count * header_->load_factor_percent;
+    }
+
+    // Requires resize_mutex
+    bool start_resize() {
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint32_t new_count = BucketDirectory::table_size(main) * 2;
+
+        void* mem = nullptr;
+        try {
+            mem = allocate_buckets(new_count);
+        } catch (const FastCollectionException&) {
+            return false;  // Keep serving from the current table
+        }
+
+        // Buckets are constructed pairwise as their source chain migrates
+        directory_->rehash_next.store(0, std::memory_order_relaxed);
+        directory_->rehash_table.store(BucketDirectory::pack(to_offset(mem), new_count),
+                                       std::memory_order_release);
+        return true;
+    }
+
+    // Requires resize_mutex; returns false once the resize has completed
+    bool migrate_next() {
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        uint32_t count = BucketDirectory::table_size(main);
+        uint32_t i = directory_->rehash_next.load(std::memory_order_relaxed);
+
+        if (i >= count) {
+            directory_->main_table.store(target, std::memory_order_release);
+            directory_->rehash_table.store(0, std::memory_order_release);
+            directory_->retired_table.store(main, std::memory_order_release);
+            header_->bucket_count = BucketDirectory::table_size(target);
+            return false;
+        }
+
+        migrate(&buckets_of(main)[i], buckets_of(target), i, count);
+        directory_->rehash_next.store(i + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void migrate(ShmBucket* src, ShmBucket* target_buckets, uint32_t i, uint32_t count) {
+        uint8_t* base = reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+        ShmBucket* lo = new(&target_buckets[i]) ShmBucket();
+        ShmBucket* hi = new(&target_buckets[i + count]) ShmBucket();
+
+        std::lock_guard<ShmSpinLock> lock(stripe_at(i));
+        int64_t current = src->head_offset.load(std::memory_order_acquire);
+        src->head_offset.store(ShmBucket::MIGRATING_OFFSET, std::memory_order_seq_cst);
+
+        while (current >= 0) {
+            Node* node = reinterpret_cast<Node*>(base + current);
+            int64_t next = node->next_offset.load(std::memory_order_acquire);
+            push_front((node->entry.hash_code & count) ? hi : lo, node, current);
+            current = next;
+        }
+
+        src->tags.store(0, std::memory_order_release);
+        src->head_offset.store(ShmBucket::MIGRATED_OFFSET, std::memory_order_release);
+    }
+
+    // Link a node at the head of a locked or not yet published chain
+    void push_front(ShmBucket* dst, Node* node, int64_t offset) const {
+        uint8_t* base = reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+        int64_t old_head = dst->head_offset.load(std::memory_order_relaxed);
+        node->prev_offset.store(Node::NULL_OFFSET, std::memory_order_release);
+        node->next_offset.store(old_head, std::memory_order_release);
+        if (old_head >= 0) {
+            reinterpret_cast<Node*>(base + old_head)->prev_offset.store(
+                offset, std::memory_order_release);
+        }
+        dst->add_entry(node->entry.hash_code);
+        dst->head_offset.store(offset, std::memory_order_release);
+    }
+
+    // Recompute a locked bucket's tags from its chain
+    void retag(ShmBucket* bucket) const {
+        const uint8_t* base = static_cast<const uint8_t*>(
+            static_cast<const void*>(file_manager_->segment_manager()));
+        uint64_t tags = 0;
+        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+        while (current >= 0) {
+            const Node* node = reinterpret_cast<const Node*>(base + current);
+            tags = ShmBucket::with_entry(tags, node->entry.hash_code);
+            current = node->next_offset.load(std::memory_order_acquire);
+        }
+        bucket->tags.store(tags, std::memory_order_release);
+    }
+
+    // Constructed, cache-line aligned bucket array
+    ShmBucket* allocate_buckets(uint32_t count) {
+        void* mem = file_manager_->allocate_aligned(sizeof(ShmBucket) * count, 64);
+        ShmBucket* buckets = static_cast<ShmBucket*>(mem);
+        for (uint32_t i = 0; i < count; i++) new(&buckets[i]) ShmBucket();
+        return buckets;
+    }
+
+    void create_directory(const char* directory_name) {
+        uint32_t count = header_->bucket_count;
+        ShmBucket* buckets = allocate_buckets(count);
+        int64_t offset = to_offset(buckets);
+
+        // Another process creating the same file may have won the race
+        BucketDirectory* directory = file_manager_->find_or_construct<BucketDirectory>(
+            directory_name, offset, count);
+        if (BucketDirectory::table_offset(directory->main_table.load(std::memory_order_acquire)) != offset) {
+            file_manager_->deallocate(buckets);
+        }
+    }
+
+    // Relink every chain of a pre-stripe file into a tagged array, then
+    // create the stripes. Openers that find no stripes wait on resize_mutex.
+    void convert_legacy(const char* stripes_name) {
+        IpcScopedLockGuard resize_lock(directory_->resize_mutex);
+        if (file_manager_->find<ShmLockStripe>(stripes_name).first) return;
+
+        uint64_t main = directory_->main_table.load(std::memory_order_acquire);
+        uint64_t target = directory_->rehash_table.load(std::memory_order_acquire);
+        uint32_t count = BucketDirectory::table_size(main);
+        uint32_t new_count = target ? BucketDirectory::table_size(target) : count;
+
+        // Any remap happens here, before pointers into the file are taken
+        ShmBucket* buckets = allocate_buckets(new_count);
+
+        uint8_t* base = reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+        LegacyShmBucket* old_main = reinterpret_cast<LegacyShmBucket*>(
+            base + BucketDirectory::table_offset(main));
+        LegacyShmBucket* old_target = target ? reinterpret_cast<LegacyShmBucket*>(
+            base + BucketDirectory::table_offset(target)) : nullptr;
+
+        auto relink = [&](LegacyShmBucket* old) {
+            int64_t current = old->head_offset.load(std::memory_order_acquire);
+            while (current >= 0) {
+                Node* node = reinterpret_cast<Node*>(base + current);
+                int64_t next = node->next_offset.load(std::memory_order_acquire);
+                push_front(&buckets[SerializationUtil::bucket_index(node->entry.hash_code, new_count)],
+                           node, current);
+                current = next;
+            }
+        };
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (old_main[i].head_offset.load(std::memory_order_acquire) == ShmBucket::MIGRATED_OFFSET) {
+                relink(&old_target[i]);
+                relink(&old_target[i + count]);
+            } else {
+                relink(&old_main[i]);
+            }
+        }
+
+        // Old arrays are kept, like those retired by a resize
+        directory_->rehash_table.store(0, std::memory_order_release);
+        directory_->rehash_next.store(0, std::memory_order_relaxed);
+        directory_->main_table.store(BucketDirectory::pack(to_offset(buckets), new_count),
+                                     std::memory_order_release);
+        directory_->retired_table.store(main, std::memory_order_release);
+        header_->bucket_count = new_count;
+
+        file_manager_->construct_array<ShmLockStripe>(stripes_name, stripes_for(new_count));
+    }
+
+    MMapFileManager* file_manager_ = nullptr;
+    HashTableHeader* header_ = nullptr;
+    BucketDirectory* directory_ = nullptr;
+    ShmLockStripe* stripes_ = nullptr;
+    uint32_t stripe_count_ = 0;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_HASHTABLE_H
@@ -39,6 +39,8 @@
  * +------------------+
  * | ListHeader       |  <- Fixed-size header with metadata
  * +------------------+
+ * | PositionIndex    |  <- Order-statistic tree of node offsets (fc_position.h)
+ * +------------------+
  * | ShmNode[0]       |  <- Variable-size nodes containing data
  * +------------------+
  * | ShmNode[1]       |
@@ -70,7 +72,8 @@
  * CONCURRENCY MODEL:
  * ------------------
  * - Structural changes (add, remove): Protected by global mutex
- * - Reads: Can proceed concurrently with optimistic validation
+ * - Reads (get, indexOf, forEach, ...): Share the global mutex, so readers
+ *   only wait for writers, never for each other
  * - TTL checks: Lock-free using atomic operations
  * 
  * PERFORMANCE CHARACTERISTICS:
@@ -79,10 +82,9 @@
  * -------------------|--------------|----------------------------------
  * add (tail)         | < 500ns      | O(1) - direct tail pointer update
  * addFirst           | < 500ns      | O(1) - direct head pointer update
- * add (index)        | < 1µs + O(n) | O(n) - requires traversal to index
- * get (sequential)   | < 100ns      | O(1) - cached from previous access
- * get (random)       | < 1µs        | O(n) - requires traversal
- * remove             | < 500ns      | O(1) after locating node
+ * add (index)        | < 5µs        | O(log n) - position index descent
+ * get (index)        | < 1µs        | O(log n) - position index descent
+ * remove (index)     | < 5µs        | O(log n) - position index descent
  * contains           | < 1µs        | O(n) - full scan with hash shortcut
  * size               | < 50ns       | O(1) - atomic counter
  * 
@@ -121,6 +123,9 @@
 
 #include "fc_common.h"
 #include "fc_serialization.h"
+#include "fc_expiry.h"
+#include "fc_position.h"
+#include "fc_reaper.h"
 #include <optional>
 #include <functional>
 
@@ -130,8 +135,8 @@ namespace fastcollection {
  * @brief Ultra high-performance memory-mapped list with TTL support
  * 
  * Features:
- * - O(1) add/remove at head and tail
- * - O(n) random access (cached for sequential access patterns)
+ * - O(1) add/remove at head and tail, plus O(log n) position index upkeep
+ * - O(log n) random access through the position index
  * - TTL (Time-To-Live) support for automatic element expiration
  * - Fine-grained locking for concurrent operations
  * - Lock-free reads where possible
@@ -139,7 +144,6 @@ namespace fastcollection {
  * 
  * Performance targets:
  * - Add: < 500ns average
- * - Get (sequential): < 100ns average
  * - Get (random): < 1µs average
  * - Remove: < 500ns average
  */
@@ -212,7 +216,7 @@ public:
      * @param ttl_seconds Time-to-live in seconds (-1 for infinite)
      * @return true if successful, false if index out of bounds
      * 
-     * Time Complexity: O(n) - requires traversal to index
+     * Time Complexity: O(log n) through the position index
      * 
      * Example:
      *   // Insert at position 5 with 1-hour TTL
@@ -243,12 +247,44 @@ public:
      * @param out_data Output buffer for the data
      * @return true if element found and not expired, false otherwise
      * 
-     * Time Complexity: O(n) for random access, O(1) for sequential access
+     * Time Complexity: O(log n) through the position index. While expired
+     * elements wait for removal, positions are counted by walking the list
+     * in O(n); writers at an index remove them first.
      * 
      * Note: Expired elements are skipped during index calculation.
      */
     bool get(size_t index, std::vector<uint8_t>& out_data) const;
     
+    /**
+     * @brief Get element at index together with the version of its last write
+     * 
+     * Every write stamps the element with a new version from a file-wide
+     * clock, so the version also changes when a different element moves
+     * into this position. Pass it to setIfVersion() to update the element
+     * only if nothing changed it in between.
+     * 
+     * @param index Index of the element (0-based)
+     * @param out_data Output buffer for the data
+     * @param out_version Receives the version (always > 0 when found)
+     * @return true if element found and not expired
+     */
+    bool getWithVersion(size_t index, std::vector<uint8_t>& out_data,
+                        uint64_t& out_version) const;
+    
+    /**
+     * @brief Read the element at an index in place, without copying it
+     * 
+     * The callback receives a pointer into the mapped file. The list lock is
+     * held while it runs, so the element cannot be freed or rewritten. The
+     * callback must not keep the pointer or call back into this list.
+     * 
+     * @param index Index of the element (0-based)
+     * @param fn Called once with the element data if it is found and not expired
+     * @return true if the element was found and fn was called
+     */
+    bool getWith(size_t index,
+                 const std::function<void(const uint8_t* data, size_t size)>& fn) const;
+    
     /**
      * @brief Get the first element
      * 
@@ -290,10 +326,23 @@ public:
      * @param ttl_seconds New TTL in seconds (-1 to keep existing TTL)
      * @return true if successful
      * 
-     * Time Complexity: O(n) - requires traversal to index
+     * Time Complexity: O(log n) through the position index
      */
     bool set(size_t index, const uint8_t* data, size_t size, int32_t ttl_seconds = TTL_INFINITE);
     
+    /**
+     * @brief Set element at index only if it is still at the expected version
+     * 
+     * @param index Index of the element
+     * @param data New serialized data
+     * @param size Size of the data
+     * @param expected_version Version from getWithVersion()
+     * @param ttl_seconds New TTL in seconds (-1 for infinite)
+     * @return true if the element was updated, false on a version conflict
+     */
+    bool setIfVersion(size_t index, const uint8_t* data, size_t size,
+                      uint64_t expected_version, int32_t ttl_seconds = TTL_INFINITE);
+    
     /**
      * @brief Update TTL for element at index without changing data
      * 
@@ -314,7 +363,7 @@ public:
      * @param out_data Optional output buffer for removed data
      * @return true if element was removed
      * 
-     * Time Complexity: O(n) - requires traversal to index
+     * Time Complexity: O(log n) through the position index
      */
     bool remove(size_t index, std::vector<uint8_t>* out_data = nullptr);
     
@@ -356,9 +405,23 @@ public:
      * 
      * This is called automatically during other operations but can be
      * invoked manually for maintenance.
+     * 
+     * Time Complexity: O(k log n) for k expired elements, using the expiry
+     * index; O(n) once for files created before the index existed
      */
     size_t removeExpired();
     
+    /**
+     * @brief Remove expired elements in a bounded step
+     * 
+     * Stops once max_items elements were removed or nothing more is due,
+     * so the time the list lock is held stays bounded. The background
+     * reaper runs this.
+     * 
+     * @return Number of elements removed
+     */
+    size_t reapExpired(size_t max_items);
+    
     // =========================================================================
     // SEARCH OPERATIONS
     // =========================================================================
@@ -396,6 +459,28 @@ public:
      */
     int64_t lastIndexOf(const uint8_t* data, size_t size) const;
     
+    // =========================================================================
+    // BACKGROUND REAPER
+    // =========================================================================
+    
+    /**
+     * @brief Start removing expired elements on a background thread
+     * 
+     * Only one process per file reaps at a time; see fc_reaper.h. Restarts
+     * the reaper if one is already running. Moving the list stops it.
+     */
+    void startReaper(const ReaperConfig& config = ReaperConfig());
+    
+    /**
+     * @brief Stop this list's reaper, letting another process take over
+     */
+    void stopReaper();
+    
+    /**
+     * @brief Whether this list's reaper currently does the reaping for the file
+     */
+    bool isReaping() const { return reaper_ && reaper_->owns_lease(); }
+    
     // =========================================================================
     // UTILITY OPERATIONS
     // =========================================================================
@@ -410,10 +495,20 @@ public:
     /**
      * @brief Get the number of non-expired elements in the list
      * 
-     * Note: This may trigger lazy cleanup of expired elements.
+     * Amortized constant time: the live count kept in the shared header,
+     * less the nodes the expiry index counts as expired but not yet reaped;
+     * nothing is removed (see removeExpired()). In a file created before
+     * the index existed, elements may count until the first reap.
      */
     size_t size() const;
-    
+
+    /**
+     * @brief Count non-expired elements by walking the whole list
+     *
+     * Slow; does not modify the list.
+     */
+    size_t exactSize() const;
+
     /**
      * @brief Check if list is empty (no non-expired elements)
      */
@@ -460,36 +555,59 @@ public:
     void flush();
 
 private:
+    static constexpr size_t UNKNOWN_POSITION = SIZE_MAX;
+    
     // Get node at offset (with prefetching)
     ShmNode* node_at_offset(int64_t offset) const;
     
-    // Get node at index (caches recent lookups), skips expired
-    ShmNode* node_at_index(size_t index) const;
+    // Get node at index, skipping expired; position receives its place
+    // among all linked nodes
+    ShmNode* node_at_index(size_t index, size_t* position = nullptr) const;
+    
+    // Whether the position index can answer node_at_index() (lock held)
+    bool positions_ready() const;
+    
+    // Rebuild the position index if needed, first reaping due nodes if asked
+    // (exclusive lock held)
+    void refresh_positions(bool reap_due);
+    
+    // Make positions ready before a positional read (takes the lock)
+    void ensure_positions() const;
     
     // Allocate a new node
     ShmNode* allocate_node(size_t data_size);
     
-    // Free a node
+    // Free a node, dropping its expiry index record
     void free_node(ShmNode* node, size_t data_size);
     
-    // Link a node into the list
-    void link_node(ShmNode* node, ShmNode* prev, ShmNode* next);
+    // Record a node's expiration time in the expiry index and the header
+    void track_expiry(ShmNode* node);
+    
+    // Overwrite the node at a position, swapping in a new node if the size changes
+    void set_node(ShmNode* node, size_t position, const uint8_t* data, size_t size,
+                  int32_t ttl_seconds);
+    
+    // Link a node into the list at a position
+    void link_node(ShmNode* node, ShmNode* prev, ShmNode* next, size_t position);
+    
+    // Unlink a node from the list (UNKNOWN_POSITION if not known)
+    void unlink_node(ShmNode* node, size_t position);
     
-    // Unlink a node from the list
-    void unlink_node(ShmNode* node);
+    // Remove up to max_items due nodes (exclusive lock held)
+    size_t reap_expired_locked(size_t max_items);
     
     // Check and remove expired nodes lazily
     void lazy_cleanup_expired() const;
 
     std::unique_ptr<MMapFileManager> file_manager_;
     ListHeader* header_;
+    Hasher hasher_;  // Element hash function the file was created with
+    ExpiryIndex expiry_;  // Nodes with a TTL, ordered by due time
+    PositionIndex positions_;  // Linked nodes in list order, for positional access
+    VersionClock* versions_ = nullptr;  // Source of element versions
     CollectionStats stats_;
     
-    // Cache for sequential access optimization
-    mutable struct {
-        size_t last_index = SIZE_MAX;
-        int64_t last_offset = -1;
-    } access_cache_;
+    std::unique_ptr<TtlReaper> reaper_;  // Set while startReaper() is in effect
 };
 
 } // namespace fastcollection
@@ -27,7 +27,7 @@
  * 2. IPC: Multiple processes can share the same map
  * 3. TTL: Entries auto-expire after configurable duration
  * 4. CACHE-LIKE: Use as a persistent cache with automatic eviction
- * 5. ATOMIC OPS: putIfAbsent, replace, conditional remove
+ * 5. ATOMIC OPS: putIfAbsent, replace, conditional remove, counters
  * 
  * STORAGE ARCHITECTURE:
  * ---------------------
@@ -41,6 +41,19 @@
  * | ...              |
  * +------------------+
  * 
+ * Alternatively, a map can be created with MapEngine::SWISS, which indexes the
+ * same ShmKeyValue entries through an open-addressing table of 16-slot groups
+ * with one-byte fingerprints probed by SIMD (see fc_swiss.h). The engine is
+ * fixed when the file is created and detected automatically on reopen.
+ * 
+ * CACHE MODE:
+ * -----------
+ * A map created with a bounded CacheConfig never holds more than its entry
+ * and/or byte budget: writes that push it over budget evict entries chosen by
+ * CLOCK (approximate LRU), optionally with TinyLFU admission so that rarely
+ * requested keys cannot displace popular ones (see fc_cache.h). The budget
+ * and policy are stored in the file, like the engine.
+ * 
  * Each key-value pair is stored in a ShmKeyValue structure:
  * +------------------+
  * | ShmEntry header  |  <- hash, TTL, timestamps, state
@@ -81,10 +94,9 @@
  *    map.setTTL(sessionId, 1800);
  *    
  * 3. RATE LIMITING:
- *    // Track request counts with 1-minute window
- *    auto count = map.getOrDefault(clientId, 0);
- *    if (count >= MAX_REQUESTS) return TOO_MANY_REQUESTS;
- *    map.put(clientId, count + 1, 60);
+ *    // Count requests in a 1-minute window; the TTL starts with the window
+ *    int64_t count = map.incrementBy(clientId, 1, 60);
+ *    if (count > MAX_REQUESTS) return TOO_MANY_REQUESTS;
  *    
  * 4. FEATURE FLAGS:
  *    // Temporary feature flags with auto-expiry
@@ -155,12 +167,26 @@
 
 #include "fc_common.h"
 #include "fc_serialization.h"
+#include "fc_hashtable.h"
+#include "fc_swiss.h"
+#include "fc_epoch.h"
+#include "fc_cache.h"
+#include "fc_expiry.h"
+#include "fc_reaper.h"
 #include <functional>
 #include <vector>
 #include <optional>
 
 namespace fastcollection {
 
+/**
+ * @brief Index layout used by a FastMap file
+ */
+enum class MapEngine : uint32_t {
+    CHAINED = 0,  // Per-bucket chains, per-bucket locks, lock-free reads
+    SWISS = 1     // SIMD-probed open addressing under a shared/exclusive lock
+};
+
 /**
  * @brief Ultra high-performance memory-mapped hash map with TTL support
  * 
@@ -186,13 +212,20 @@ public:
      * @param initial_size Initial size of the memory-mapped region
      * @param create_new If true, create a new file (truncating any existing)
      * @param bucket_count Number of hash buckets (must be power of 2)
+     * @param engine Index layout for a newly created map; ignored when
+     *               opening an existing file, which keeps its engine
+     * @param cache Budget and eviction policy for a newly created map; the
+     *              default leaves the map unbounded. Ignored when opening an
+     *              existing file, which keeps its configuration
      * 
      * @throws FastCollectionException if file cannot be created/opened
      */
     FastMap(const std::string& mmap_file,
             size_t initial_size = DEFAULT_INITIAL_SIZE,
             bool create_new = false,
-            uint32_t bucket_count = HashTableHeader::DEFAULT_BUCKET_COUNT);
+            uint32_t bucket_count = HashTableHeader::DEFAULT_BUCKET_COUNT,
+            MapEngine engine = MapEngine::CHAINED,
+            const CacheConfig& cache = CacheConfig());
     
     ~FastMap();
     
@@ -216,9 +249,11 @@ public:
      * @param value Pointer to value data
      * @param value_size Size of value in bytes
      * @param ttl_seconds Time-to-live in seconds (-1 for infinite)
-     * @return true if entry was added/updated
+     * @return true if entry was added/updated; false if a cache-mode map
+     *         using EvictionPolicy::TINY_LFU declined to admit a new key
      * 
-     * If key exists, value and TTL are updated.
+     * If key exists, value and TTL are updated. In cache mode, entries are
+     * evicted afterwards until the map is within its budget again.
      */
     bool put(const uint8_t* key, size_t key_size,
              const uint8_t* value, size_t value_size,
@@ -255,6 +290,22 @@ public:
     bool get(const uint8_t* key, size_t key_size,
              std::vector<uint8_t>& out_value) const;
     
+    /**
+     * @brief Read a value in place, without copying it out of the mapped file
+     * 
+     * The callback receives a pointer into the mapped region. It stays valid
+     * and unchanged until the callback returns: the entry is pinned by an epoch
+     * read section (chained engine) or by the shared lock (swiss engine). The
+     * callback must not keep the pointer or modify this map.
+     * 
+     * @param key Pointer to key data
+     * @param key_size Size of key in bytes
+     * @param fn Called once with the value if the key is found and not expired
+     * @return true if the key was found and fn was called
+     */
+    bool getWith(const uint8_t* key, size_t key_size,
+                 const std::function<void(const uint8_t* value, size_t value_size)>& fn) const;
+    
     /**
      * @brief Get value or return default
      * 
@@ -305,10 +356,37 @@ public:
     /**
      * @brief Remove all expired entries
      * 
+     * Pops the due records of the expiry index and only visits the entries
+     * they name. A full sweep runs instead when the index is incomplete
+     * (a file created before the index existed), and rebuilds it.
+     * 
      * @return Number of entries removed
      */
     size_t removeExpired();
     
+    /**
+     * @brief Remove expired entries in a bounded step
+     * 
+     * Stops once about max_items entries were removed (all expired entries
+     * of a visited bucket go together) or nothing more is due, so the time
+     * a lock is held stays bounded. The background reaper runs this.
+     * 
+     * @return Number of entries removed
+     */
+    size_t reapExpired(size_t max_items);
+    
+    /**
+     * @brief Remove all expired entries with a full sweep on the thread pool
+     * 
+     * Visits every bucket, in chunks spread over ThreadPool::instance(),
+     * and rebuilds the expiry index. Each chunk locks only the buckets it
+     * visits. Worth it over removeExpired() for a large backlog or a stale
+     * index; a Swiss map sweeps on the calling thread.
+     * 
+     * @return Number of entries removed
+     */
+    size_t parallelRemoveExpired();
+    
     // =========================================================================
     // REPLACE OPERATIONS
     // =========================================================================
@@ -353,7 +431,105 @@ public:
      * @return true if key existed and TTL was updated
      */
     bool setTTL(const uint8_t* key, size_t key_size, int32_t ttl_seconds);
-    
+
+    // =========================================================================
+    // OPTIMISTIC CONCURRENCY
+    // =========================================================================
+    //
+    // Every write stamps its entry with a new version from a file-wide clock
+    // (TTL changes do not count as writes). A client reads a value with its
+    // version, computes the update without holding any lock, and stores it
+    // with putIfVersion(), which fails if anyone wrote the key in between;
+    // only then does it need to read again and retry. Version 0 stands for
+    // "no entry", so putIfVersion(..., 0) creates a key only if it is absent.
+
+    /**
+     * @brief Get a value together with the version of the write that stored it
+     *
+     * @param key Pointer to key data
+     * @param key_size Size of key in bytes
+     * @param out_value Output buffer for the value
+     * @param out_version Receives the version (always > 0 when found)
+     * @return true if key exists and is not expired
+     */
+    bool getWithVersion(const uint8_t* key, size_t key_size,
+                        std::vector<uint8_t>& out_value, uint64_t& out_version) const;
+
+    /**
+     * @brief Store a value only if the key is still at the expected version
+     *
+     * @param key Pointer to key data
+     * @param key_size Size of key in bytes
+     * @param value Value to store
+     * @param value_size Size of value
+     * @param expected_version Version from getWithVersion(), or 0 for "absent"
+     * @param ttl_seconds TTL of the stored value (-1 for infinite)
+     * @return true if the value was stored; false on a version conflict (or
+     *         if cache admission rejected a new key)
+     */
+    bool putIfVersion(const uint8_t* key, size_t key_size,
+                      const uint8_t* value, size_t value_size,
+                      uint64_t expected_version,
+                      int32_t ttl_seconds = TTL_INFINITE);
+
+    // =========================================================================
+    // ATOMIC COUNTERS
+    // =========================================================================
+    //
+    // A counter is an entry whose value is a 64-bit signed integer in native
+    // byte order. Each operation reads and writes it in one step under the
+    // key's bucket lock (swiss: the exclusive lock), so concurrent increments
+    // from any number of threads or processes are never lost. When the value
+    // slot is 8-byte aligned the chained engine stores the new value in place
+    // with a single atomic write; otherwise it swaps in an updated copy.
+    //
+    // The TTL given to a counter operation only applies when it creates the
+    // counter; updates keep the existing expiration time. Operations on an
+    // entry whose value is not 8 bytes throw INVALID_ARGUMENT.
+
+    /**
+     * @brief Add delta to a counter, creating it at delta if absent
+     *
+     * @param key Pointer to key data
+     * @param key_size Size of key in bytes
+     * @param delta Amount to add (may be negative; wraps on overflow)
+     * @param ttl_seconds TTL if the counter is created (-1 for infinite)
+     * @return Counter value after the addition
+     */
+    int64_t incrementBy(const uint8_t* key, size_t key_size, int64_t delta,
+                        int32_t ttl_seconds = TTL_INFINITE);
+
+    /**
+     * @brief Same as incrementBy(), named after Java's AtomicLong
+     */
+    int64_t addAndGet(const uint8_t* key, size_t key_size, int64_t delta,
+                      int32_t ttl_seconds = TTL_INFINITE) {
+        return incrementBy(key, key_size, delta, ttl_seconds);
+    }
+
+    /**
+     * @brief Set a counter, creating it if absent
+     *
+     * @return Previous value, or 0 if the counter did not exist
+     */
+    int64_t getAndSet(const uint8_t* key, size_t key_size, int64_t value,
+                      int32_t ttl_seconds = TTL_INFINITE);
+
+    /**
+     * @brief Set an existing counter to desired if it currently holds expected
+     *
+     * @return true if the counter existed, held expected and was updated
+     */
+    bool compareAndSet(const uint8_t* key, size_t key_size,
+                       int64_t expected, int64_t desired);
+
+    /**
+     * @brief Read a counter
+     *
+     * @return Current value, or empty if the key is absent or expired
+     */
+    std::optional<int64_t> getCounter(const uint8_t* key, size_t key_size) const;
+
     // =========================================================================
     // QUERY OPERATIONS
     // =========================================================================
@@ -378,6 +554,51 @@ public:
      */
     bool containsValue(const uint8_t* value, size_t value_size) const;
     
+    // =========================================================================
+    // BATCH OPERATIONS
+    // =========================================================================
+    
+    /**
+     * @brief Look up many keys in one call
+     * 
+     * All keys are hashed first, then their buckets and chain heads are
+     * prefetched a group at a time before any chain is walked, so the cache
+     * misses of different keys overlap instead of being paid one by one.
+     * 
+     * @param keys Keys to look up
+     * @return One entry per key: the value, or std::nullopt if the key is
+     *         missing or expired
+     */
+    std::vector<std::optional<std::vector<uint8_t>>> multiGet(
+        const std::vector<std::vector<uint8_t>>& keys) const;
+    
+    /**
+     * @brief Put many key-value pairs in one call
+     * 
+     * Keys are grouped by bucket so each bucket lock is taken once per batch
+     * (the swiss engine takes its exclusive lock once). Each pair behaves like
+     * put(); the batch as a whole is not atomic.
+     * 
+     * @param keys Keys to store
+     * @param values Values, parallel to keys
+     * @param ttl_seconds Time-to-live applied to every entry (-1 for infinite)
+     * @return Number of entries added or updated
+     * @throws FastCollectionException if keys and values differ in length
+     */
+    size_t multiPut(const std::vector<std::vector<uint8_t>>& keys,
+                    const std::vector<std::vector<uint8_t>>& values,
+                    int32_t ttl_seconds = TTL_INFINITE);
+    
+    /**
+     * @brief Remove many keys in one call
+     * 
+     * Locks each bucket once per batch, like multiPut().
+     * 
+     * @param keys Keys to remove
+     * @return Number of keys found and removed
+     */
+    size_t multiRemove(const std::vector<std::vector<uint8_t>>& keys);
+    
     // =========================================================================
     // ITERATION
     // =========================================================================
@@ -385,11 +606,26 @@ public:
     /**
      * @brief Iterate over all non-expired key-value pairs
      * 
+     * The callback runs without any lock held, so it may read or write the
+     * map. A Swiss map hands it copies taken a few groups at a time.
+     * 
      * @param callback Function receiving key data, key size, value data, value size
      */
     void forEach(std::function<bool(const uint8_t* key, size_t key_size,
                                     const uint8_t* value, size_t value_size)> callback) const;
     
+    /**
+     * @brief Iterate over all non-expired key-value pairs on the thread pool
+     * 
+     * Like forEach(), but chunks of buckets (groups on a Swiss map) are
+     * visited concurrently by ThreadPool::instance(), so the callback must
+     * be thread-safe and sees entries in no particular order. Returning
+     * false stops the sweep, though other threads may still deliver a few
+     * more entries.
+     */
+    void parallelForEach(std::function<bool(const uint8_t* key, size_t key_size,
+                                            const uint8_t* value, size_t value_size)> callback) const;
+    
     /**
      * @brief Iterate with TTL information
      */
@@ -417,6 +653,47 @@ public:
      */
     std::vector<std::vector<uint8_t>> values() const;
     
+    /**
+     * @brief Resumable iteration in bounded steps, like Redis SCAN
+     * 
+     * Start with cursor 0 and pass each returned cursor to the next call
+     * until it returns 0. No lock is held between calls. Every entry present
+     * for the whole scan is returned, even if the table resizes in between;
+     * entries added or removed meanwhile may or may not be. Buckets are
+     * visited in reverse-binary order (see next_scan_cursor()).
+     * 
+     * @param cursor 0 to start, or the cursor returned by the previous call
+     * @param count Approximate batch size. Whole buckets are returned, so a
+     *              batch may hold a few more; it may also hold fewer, or
+     *              none, when it runs into many empty buckets
+     * @param out_batch Receives copies of the (key, value) pairs; cleared first
+     * @return Cursor for the next call, or 0 once the scan is complete
+     */
+    uint64_t scan(uint64_t cursor, size_t count,
+                  std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>& out_batch) const;
+    
+    // =========================================================================
+    // BACKGROUND REAPER
+    // =========================================================================
+    
+    /**
+     * @brief Start removing expired entries on a background thread
+     * 
+     * Only one process per file reaps at a time; see fc_reaper.h. Restarts
+     * the reaper if one is already running. Moving the map stops it.
+     */
+    void startReaper(const ReaperConfig& config = ReaperConfig());
+    
+    /**
+     * @brief Stop this map's reaper, letting another process take over
+     */
+    void stopReaper();
+    
+    /**
+     * @brief Whether this map's reaper currently does the reaping for the file
+     */
+    bool isReaping() const { return reaper_ && reaper_->owns_lease(); }
+    
     // =========================================================================
     // UTILITY
     // =========================================================================
@@ -426,11 +703,28 @@ public:
      */
     void clear();
     
+    /**
+     * @brief Clear all entries, releasing them on the thread pool
+     */
+    void parallelClear();
+    
     /**
      * @brief Get the number of non-expired entries
+     *
+     * Amortized constant time: the live count kept in the shared header,
+     * less the entries the expiry index counts as expired but not yet
+     * reaped; nothing is removed (see removeExpired()). In a file created
+     * before the index existed, entries may count until the first reap.
      */
     size_t size() const;
     
+    /**
+     * @brief Count non-expired entries by walking the whole collection
+     *
+     * Slow; does not modify the collection.
+     */
+    size_t exactSize() const;
+    
     /**
      * @brief Check if map is empty
      */
@@ -446,28 +740,124 @@ public:
      */
     const std::string& filename() const { return file_manager_->filename(); }
     
+    /**
+     * @brief Get the index layout this map was created with
+     */
+    MapEngine engine() const { return swiss_ ? MapEngine::SWISS : MapEngine::CHAINED; }
+    
+    /**
+     * @brief Get the cache budget and policy; unbounded if not in cache mode
+     */
+    CacheConfig cacheConfig() const { return cache_ ? cache_->config() : CacheConfig(); }
+    
     /**
      * @brief Flush changes to disk
      */
     void flush();
 
 private:
-    // Get bucket for a key hash
-    ShmBucket* get_bucket(uint32_t hash);
-    const ShmBucket* get_bucket(uint32_t hash) const;
-    
     // Find key-value in bucket chain
     ShmKeyValue* find_in_bucket(ShmBucket* bucket, const uint8_t* key, size_t key_size,
-                                uint32_t hash, ShmKeyValue** prev_out = nullptr);
+                                uint64_t hash, ShmKeyValue** prev_out = nullptr);
     
     // Allocate and free key-value nodes
     ShmKeyValue* allocate_kv(size_t key_size, size_t value_size);
     void free_kv(ShmKeyValue* kv);
+    
+    // Chained engine: unlink a node from its locked bucket and retire it
+    void unlink_kv(ShmBucket* bucket, ShmKeyValue* kv);
+    
+    // Chained engine: defer freeing until lock-free readers are done, and
+    // replace a node with an updated copy. With keep_ttl the copy inherits
+    // the old expiration time and ttl_seconds is ignored
+    void retire_kv(ShmKeyValue* kv);
+    void swap_kv(ShmBucket* bucket, ShmKeyValue* existing,
+                 const uint8_t* key, size_t key_size,
+                 const uint8_t* value, size_t value_size,
+                 uint64_t hash, int32_t ttl_seconds, bool keep_ttl = false);
+    
+    // Swiss engine: overwrite the value of an existing slot, or unlink it
+    void swiss_assign(const SwissTable::Position& pos, const uint8_t* key, size_t key_size,
+                      const uint8_t* value, size_t value_size,
+                      uint64_t hash, int32_t ttl_seconds);
+    void swiss_erase(const SwissTable::Position& pos);
+    
+    // Write paths shared by the single-key and batch APIs; callers hold the
+    // bucket lock (chained) or the exclusive global lock (swiss). The put
+    // paths return true if the key was not present before
+    bool put_in_bucket(ShmBucket* bucket, const uint8_t* key, size_t key_size,
+                       const uint8_t* value, size_t value_size,
+                       uint64_t hash, int32_t ttl_seconds);
+    bool remove_from_bucket(ShmBucket* bucket, const uint8_t* key, size_t key_size,
+                            uint64_t hash, std::vector<uint8_t>* out_value);
+    bool swiss_put(const uint8_t* key, size_t key_size,
+                   const uint8_t* value, size_t value_size,
+                   uint64_t hash, int32_t ttl_seconds);
+    bool swiss_remove(const uint8_t* key, size_t key_size,
+                      uint64_t hash, std::vector<uint8_t>* out_value);
+    
+    // Lookup shared by the read APIs: calls fn with the live entry for key
+    // while it cannot be freed, and updates the read statistics
+    bool read_entry(const uint8_t* key, size_t key_size,
+                    const std::function<void(const ShmKeyValue* kv)>& fn) const;
+    
+    // Counter write path: fn maps the current value to the next one, or
+    // returns false to leave the counter alone. An absent key is passed as 0
+    // and only created (with ttl_seconds) if create is set. previous receives
+    // the value before the call; returns true if a value was stored
+    bool update_counter(const uint8_t* key, size_t key_size, int32_t ttl_seconds, bool create,
+                        const std::function<bool(int64_t current, int64_t& next)>& fn,
+                        int64_t& previous);
+
+    // Swiss engine sweeps: copy the live entries of a few groups at a time
+    // under the shared lock, then hand the copies to fn without it, so fn
+    // may write the map. With parallel, copies are handed out on the thread
+    // pool. Returns false if fn stopped the sweep
+    bool swiss_sweep(const std::function<bool(const uint8_t* key, size_t key_size,
+                                              const uint8_t* value, size_t value_size,
+                                              int64_t ttl_remaining)>& fn,
+                     bool parallel = false) const;
+    
+    // Record an entry's expiration time in the expiry index and the header
+    void track_expiry(ShmEntry& entry);
+    
+    // Chained engine: remove the expired entries of a locked bucket. With
+    // reindex, surviving entries with a TTL are tracked again in the expiry index
+    size_t reap_bucket(ShmBucket* bucket, uint64_t& next_expiry, bool reindex);
+    
+    // removeExpired() without the index; rebuilds it
+    size_t sweep_expired(bool parallel = false);
+    
+    // clear() and parallelClear()
+    void clear_entries(bool parallel);
+    
+    // Batch writes: order of key indices that visits each bucket once
+    std::vector<size_t> bucket_order(const std::vector<uint64_t>& hashes) const;
+    
+    // Cache mode: what the CLOCK hand does with the entry it points at
+    enum class ClockVerdict { SKIP, EVICT, REJECT };
+    ClockVerdict clock_visit(const ShmKeyValue* kv, const uint8_t* key, size_t key_size,
+                             uint64_t hash) const;
+    bool over_budget() const;
+    
+    // Cache mode: evict until the map is within budget. key, if not null, was
+    // just added and TINY_LFU may drop it instead of a more popular victim.
+    // The swiss engine requires the exclusive lock, the chained engine that
+    // no bucket lock is held. Returns false if key was dropped
+    bool enforce_budget(const uint8_t* key, size_t key_size, uint64_t hash);
 
     std::unique_ptr<MMapFileManager> file_manager_;
     HashTableHeader* header_;
-    ShmBucket* buckets_;
+    Hasher hasher_;                      // Key hash function the file was created with
+    BucketTable<ShmKeyValue> table_;
+    std::unique_ptr<SwissTable> swiss_;  // Set when the file uses MapEngine::SWISS
+    std::unique_ptr<EpochDomain> epoch_; // Reclamation for the chained engine's readers
+    CacheHeader* cache_ = nullptr;       // Set when the map was created in cache mode
+    FrequencySketch sketch_;             // Access counts for EvictionPolicy::TINY_LFU
+    ExpiryIndex expiry_;                 // Due times of entries with a TTL
+    VersionClock* versions_ = nullptr;   // Source of entry versions
     CollectionStats stats_;
+    std::unique_ptr<TtlReaper> reaper_;  // Set while startReaper() is in effect
 };
 
 } // namespace fastcollection
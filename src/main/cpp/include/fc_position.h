@@ -0,0 +1,192 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_position.h
+ * @brief Persistent positional index for FastList
+ *
+ * ============================================================================
+ * POSITION INDEX
+ * ============================================================================
+ *
+ * A linked list can only find its i-th node by walking to it. The position
+ * index is an order-statistic B-tree that lives in the mapped file next to
+ * the list: its leaves hold list node offsets in list order, and every inner
+ * node keeps the number of list nodes under each child, so a lookup descends
+ * by subtracting child counts and reaches position i in O(log n).
+ *
+ *                     +--------------------------+
+ *                     | inner: sizes = [64, 40]  |
+ *                     +--------------------------+
+ *                          /                \
+ *        +-----------------------+   +------------------------+
+ *        | leaf: positions 0..63 |   | leaf: positions 64..103 |
+ *        +-----------------------+   +------------------------+
+ *
+ * Positions count every linked node, expired or not; FastList only trusts
+ * them while no node can have expired (see CollectionHeader::
+ * may_have_expired()). Inserting and erasing at a position, including the
+ * ends, touches one root-to-leaf path, which is a handful of nodes for any
+ * realistic list. Appends and prepends split full nodes unevenly, so lists
+ * built from the ends pack their leaves full.
+ *
+ * Nodes do not know their own position, so removing a node found some other
+ * way (the expiry heap, for example) can only be indexed when it is at
+ * either end; otherwise the index is marked incomplete and rebuilt by one
+ * walk of the list the next time a position is needed. Files created before
+ * the index existed open incomplete too.
+ *
+ * The owning list's global lock covers all access: writers hold it
+ * exclusively, and readers that share it only call at() and size().
+ */
+
+#ifndef FASTCOLLECTION_POSITION_H
+#define FASTCOLLECTION_POSITION_H
+
+#include "fc_common.h"
+#include "fc_serialization.h"
+
+namespace fastcollection {
+
+/**
+ * @brief One node of the position tree
+ */
+struct PositionNode {
+    static constexpr uint32_t CAPACITY = 64;
+
+    uint32_t count;              // Slots in use
+    uint32_t leaf;               // 1 = slots hold list node offsets, 0 = children
+    uint64_t total;              // List nodes in this subtree
+    int64_t slots[CAPACITY];     // List node offsets, or child offsets
+    uint64_t sizes[CAPACITY];    // Inner nodes: total of each child
+
+    explicit PositionNode(bool is_leaf) : count(0), leaf(is_leaf ? 1 : 0), total(0) {}
+};
+
+/**
+ * @brief Shared-memory header of a position index
+ */
+struct PositionHeader {
+    static constexpr uint32_t MAGIC = 0x9051D0C5;
+
+    uint32_t magic;
+    std::atomic<uint32_t> complete;  // 0 = positions must be rebuilt before use
+    int64_t root_offset;             // -1 = empty
+    uint64_t nodes;                  // Tree nodes allocated
+
+    explicit PositionHeader(bool complete_index)
+        : magic(MAGIC)
+        , complete(complete_index ? 1 : 0)
+        , root_offset(-1)
+        , nodes(0) {}
+
+    bool is_valid() const { return magic == MAGIC; }
+};
+
+/**
+ * @brief Process-local view of a position index stored in a mapped file
+ */
+class PositionIndex {
+public:
+    PositionIndex() = default;
+    PositionIndex(MMapFileManager* file_manager, PositionHeader* header);
+
+    explicit operator bool() const { return header_ != nullptr; }
+
+    /**
+     * @brief Whether the index holds every linked node in order
+     */
+    bool complete() const {
+        return header_->complete.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * @brief Stop trusting the index until the next rebuild()
+     *
+     * Writers skip maintenance while the index is incomplete.
+     */
+    void mark_stale() { header_->complete.store(0, std::memory_order_release); }
+
+    /**
+     * @brief Drop every position and mark the index complete (empty list)
+     */
+    void reset();
+
+    /**
+     * @brief Refill the index from the list starting at head_offset
+     */
+    void rebuild(int64_t head_offset);
+
+    /**
+     * @brief Number of positions held
+     */
+    uint64_t size() const;
+
+    /**
+     * @brief List node offset at a position, or ShmNode::NULL_OFFSET past the end
+     */
+    int64_t at(uint64_t position) const;
+
+    /**
+     * @brief Insert a node offset before position (size() appends)
+     */
+    void insert(uint64_t position, int64_t offset);
+
+    /**
+     * @brief Remove the node offset at position
+     */
+    void erase(uint64_t position);
+
+    /**
+     * @brief Point a position at another node (a node reallocated in place)
+     */
+    void replace(uint64_t position, int64_t offset);
+
+    /**
+     * @brief Drop a node whose position is unknown, before it is unlinked
+     *
+     * Erases it when it is at either end, otherwise marks the index stale.
+     */
+    void forget(int64_t offset);
+
+private:
+    uint8_t* base() const {
+        return reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+    }
+
+    PositionNode* node(int64_t offset) const {
+        return reinterpret_cast<PositionNode*>(base() + offset);
+    }
+
+    int64_t offset_of(const PositionNode* n) const {
+        return reinterpret_cast<const uint8_t*>(n) - base();
+    }
+
+    PositionNode* allocate(bool leaf);
+    void release(PositionNode* n);
+    void release_subtree(int64_t offset);
+
+    // Child of an inner node holding position; position becomes child-relative
+    uint32_t child_for(const PositionNode* n, uint64_t& position) const;
+
+    // Returns the offset of a new right sibling if n had to split, else -1
+    int64_t insert_into(PositionNode* n, uint64_t position, int64_t value);
+    void erase_from(PositionNode* n, uint64_t position);
+
+    // Merge a nearly empty child with a neighbour when both fit in one node
+    void rebalance(PositionNode* parent, uint32_t index);
+
+    MMapFileManager* file_manager_ = nullptr;
+    PositionHeader* header_ = nullptr;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_POSITION_H
@@ -31,17 +31,32 @@
  * 
  * QUEUE ARCHITECTURE:
  * -------------------
- * The queue is implemented as a doubly-linked list with head and tail pointers:
+ * The queue is implemented as a doubly-linked list with head and tail pointers,
+ * headed by a dummy node (after Michael and Scott's two-lock queue):
  * 
  * +------------------+
  * | DequeHeader      |  <- front_offset, back_offset, size
  * +------------------+
  *        |
  *        v
- * [Front] <-> [Node] <-> [Node] <-> [Node] <-> [Back]
+ * [Dummy] <-> [Node] <-> [Node] <-> [Node] <-> [Back]
  *   ^                                            ^
  *   |                                            |
  * pollFirst()                               offerLast()
+ * head lock                                 tail lock
+ * 
+ * front_offset always points at the dummy, whose successor is the first
+ * element; poll() copies that element out and makes its node the new
+ * dummy. back_offset is the last element, or the dummy when the queue is
+ * empty. So the ends never share a pointer: offer() and offerAll() take only
+ * the tail lock ("queue_tail_lock", a ShmSpinLock on its own cache line),
+ * and poll(), pollBatch() and drainTo() only the head lock (the header's
+ * global mutex), and a producer never waits for a consumer.
+ * 
+ * Readers (peek, contains, forEach, ...) share the head lock. Operations
+ * that touch both ends - offerFirst, pollLast, removeElement, removeExpired,
+ * clear - take the head lock, then the tail lock. Files written before the
+ * dummy node existed get one the first time they are opened.
  * 
  * TTL (TIME-TO-LIVE) FEATURE:
  * ---------------------------
@@ -109,7 +124,23 @@
  * - offer(timeout): Wait up to timeout for space
  * 
  * Note: This is an unbounded queue, so put/offer with timeout behave like
- * regular offer (always succeed immediately).
+ * regular offer (always succeed immediately). FastRingQueue
+ * (fc_ring_queue.h) is the bounded alternative whose offer(timeout) waits.
+ * 
+ * Waiting consumers sleep on a ShmEventCount stored in the file
+ * ("queue_signal"), so an offer() from any process that maps the queue
+ * wakes one of them within microseconds, and idle consumers use no CPU.
+ * 
+ * BATCH OPERATIONS:
+ * -----------------
+ * offerAll() builds its nodes from one allocator call, before taking the
+ * tail lock, and links the whole run onto the tail in one splice. pollBatch()
+ * and drainTo() unlink a run from the head in one splice and copy or hand
+ * out its records after releasing the lock, so a batch of any size costs
+ * one lock round-trip:
+ * 
+ *   [Dummy] <-> [A] <-> [B] <-> ... <-> [Back] <-> ([X] <-> [Y] <-> [Z])
+ *                                                   offerAll run, linked at once
  * 
  * USAGE EXAMPLES:
  * ---------------
@@ -148,6 +179,7 @@
 #include "fc_serialization.h"
 #include <functional>
 #include <chrono>
+#include <mutex>
 #include <vector>
 
 namespace fastcollection {
@@ -242,6 +274,18 @@ public:
      */
     bool peek(std::vector<uint8_t>& out_data) const;
     
+    /**
+     * @brief Read the head element in place, without copying it
+     * 
+     * The callback receives a pointer into the mapped file. The head lock is
+     * held while it runs, so the element cannot be polled or freed. The
+     * callback must not keep the pointer or call back into this queue.
+     * 
+     * @param fn Called once with the head element if one exists
+     * @return true if an element was found and fn was called
+     */
+    bool peekWith(const std::function<void(const uint8_t* data, size_t size)>& fn) const;
+    
     /**
      * @brief Get element at head (throws if empty)
      * 
@@ -279,7 +323,8 @@ public:
     /**
      * @brief Take element, blocking until one is available
      * 
-     * Skips expired elements while waiting.
+     * Skips expired elements while waiting. Sleeps until an offer from this
+     * or another process wakes it.
      * 
      * @return Element data
      */
@@ -288,6 +333,8 @@ public:
     /**
      * @brief Poll with timeout
      * 
+     * Sleeps like take() until an offer wakes it or the timeout passes.
+     * 
      * @param out_data Output buffer for the data
      * @param timeout_ms Timeout in milliseconds
      * @return true if element was retrieved within timeout
@@ -335,6 +382,45 @@ public:
      */
     bool peekLast(std::vector<uint8_t>& out_data) const;
     
+    // =========================================================================
+    // BATCH OPERATIONS
+    // =========================================================================
+    
+    /**
+     * @brief Add many elements to the tail with one lock round-trip
+     * 
+     * The nodes come from a single allocator call and are linked in order
+     * with one splice, so consumers see the whole batch at once. Empty
+     * elements are skipped.
+     * 
+     * @param elements Serialized elements, head first
+     * @param ttl_seconds Time-to-live applied to every element (-1 for infinite)
+     * @return Number of elements added
+     */
+    size_t offerAll(const std::vector<std::vector<uint8_t>>& elements,
+                    int32_t ttl_seconds = TTL_INFINITE);
+    
+    /**
+     * @brief Remove up to max_elements elements from the head
+     * 
+     * Like drainTo(), unlinks them in one splice and copies them out after
+     * the lock is released. Expired elements on the way are dropped.
+     * 
+     * @param out Receives the elements, appended in queue order
+     * @param max_elements Maximum elements to remove (0 for all)
+     * @return Number of elements appended to out
+     */
+    size_t pollBatch(std::vector<std::vector<uint8_t>>& out, size_t max_elements);
+    
+    /**
+     * @brief Copy up to max_elements elements from the head without removing them
+     * 
+     * @param out Receives the elements, appended in queue order
+     * @param max_elements Maximum elements to copy (0 for all)
+     * @return Number of elements appended to out
+     */
+    size_t peekBatch(std::vector<std::vector<uint8_t>>& out, size_t max_elements) const;
+    
     // =========================================================================
     // TTL OPERATIONS
     // =========================================================================
@@ -415,6 +501,21 @@ public:
     size_t drainTo(std::function<void(std::vector<uint8_t>&&)> callback, 
                    size_t max_elements = 0);
     
+    /**
+     * @brief Drain queue elements to a callback without copying them
+     * 
+     * The elements are unlinked in one splice, then handed out in order
+     * after the queue lock is released, as pointers into their nodes; each
+     * node is freed when its callback returns. The callback must not keep
+     * the pointer, but may call back into this queue.
+     * 
+     * @param callback Receives each element's data and size
+     * @param max_elements Maximum elements to drain (0 for all)
+     * @return Number of elements drained (excludes expired)
+     */
+    size_t drainTo(const std::function<void(const uint8_t* data, size_t size)>& callback,
+                   size_t max_elements = 0);
+    
     /**
      * @brief Get collection statistics
      */
@@ -440,15 +541,45 @@ private:
     // Free a node
     void free_node(ShmNode* node, size_t data_size);
     
-    // Skip expired nodes at front
+    // Offset of a node in the segment
+    int64_t offset_of(const ShmNode* node) const;
+    
+    // Find the tail lock, giving a file without one its dummy node first
+    void open_tail();
+    
+    // Offset of the first element, behind the dummy
+    int64_t first_offset() const;
+    
+    // Make the dummy's successor the new dummy, freeing the old one
+    // (head lock must be held)
+    void advance_head(ShmNode* dummy, int64_t next);
+    
+    // Link the chain first..last after the back node (tail lock must be held)
+    void link_at_back(int64_t first, int64_t last);
+    
+    // Unlink and free an element (both locks must be held)
+    void unlink_node(ShmNode* node);
+    
+    // Stamp modified_at; producers and consumers hold different locks
+    void touch();
+    
+    // Skip expired nodes at front (head lock must be held)
     void skip_expired_front();
+    
+    // Unlink nodes from the front until max_live live ones are included,
+    // marking expired ones deleted; returns the run's first offset and sets
+    // count to the nodes unlinked (head lock must be held)
+    int64_t detach_front(size_t max_live, size_t& count);
+    
+    // Free count detached nodes starting at offset
+    void free_run(int64_t offset, size_t count);
 
     std::unique_ptr<MMapFileManager> file_manager_;
     DequeHeader* header_;
+    Hasher hasher_;  // Element hash function the file was created with
     CollectionStats stats_;
-    
-    // For blocking operations
-    mutable IpcMutex wait_mutex_;
+    ShmEventCount* signal_ = nullptr;  // Wakes take()/poll(timeout) waiters in any process
+    ShmLockStripe* tail_ = nullptr;    // Producers' lock; the global mutex guards the head
 };
 
 } // namespace fastcollection
@@ -0,0 +1,123 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_reaper.h
+ * @brief Opt-in background removal of expired elements
+ *
+ * ============================================================================
+ * BACKGROUND TTL REAPER
+ * ============================================================================
+ *
+ * Without a reaper, expired elements keep their memory until some caller runs
+ * removeExpired() and pays for the whole backlog at once. A collection's
+ * startReaper() starts a thread that instead wakes every interval_ms and
+ * removes expired elements in batches of at most batch_size, so no single
+ * step holds a collection lock for long.
+ *
+ * One process per file:
+ *   Every process may start a reaper, but only the holder of the file's
+ *   ReaperLease does any work. The holder renews the lease on each wake-up;
+ *   the others keep checking and take over once the lease has expired or
+ *   its owner process is gone.
+ *
+ * CPU budget:
+ *   After each batch the thread yields, then sleeps long enough that the
+ *   time spent reaping stays within cpu_budget_percent of one core. A
+ *   backlog is therefore worked off at a bounded rate instead of in a burst.
+ *
+ *   wake -> renew lease -> [batch -> yield -> sleep]* -> wait interval_ms
+ */
+
+#ifndef FASTCOLLECTION_REAPER_H
+#define FASTCOLLECTION_REAPER_H
+
+#include "fc_common.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace fastcollection {
+
+/**
+ * @brief Pacing of a background reaper
+ */
+struct ReaperConfig {
+    uint64_t interval_ms = TTL_CLEANUP_INTERVAL_MS;  // Pause between passes
+    size_t batch_size = TTL_CLEANUP_BATCH_SIZE;      // Elements removed per step
+    uint32_t cpu_budget_percent = 10;                // Share of one core (1-100)
+};
+
+/**
+ * @brief Shared-memory election record: which reaper works on a file
+ */
+struct ReaperLease {
+    std::atomic<uint64_t> owner;       // Token of the working reaper (0 = none)
+    std::atomic<uint64_t> expires_ns;  // Others may take over after this time
+
+    ReaperLease() : owner(0), expires_ns(0) {}
+};
+
+/**
+ * @brief Background thread that reaps one collection
+ *
+ * Owned by the collection; destroying it stops the thread and hands the
+ * lease back so another process can take over at once.
+ */
+class TtlReaper {
+public:
+    // Removes up to the given number of expired elements, returns how many
+    using ReapFn = std::function<size_t(size_t max_items)>;
+
+    // A lease stays valid for this many intervals without renewal
+    static constexpr uint64_t LEASE_INTERVALS = 3;
+
+    TtlReaper(ReaperLease* lease, ReapFn reap, const ReaperConfig& config);
+    ~TtlReaper();
+
+    TtlReaper(const TtlReaper&) = delete;
+    TtlReaper& operator=(const TtlReaper&) = delete;
+
+    const ReaperConfig& config() const { return config_; }
+
+    /**
+     * @brief Whether this reaper currently holds the file's lease
+     */
+    bool owns_lease() const;
+
+    /**
+     * @brief Elements removed by this reaper so far
+     */
+    uint64_t reaped() const { return reaped_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    bool acquire_lease();
+    void release_lease();
+
+    // Sleep up to ns; returns false if the reaper was stopped meanwhile
+    bool pause(uint64_t ns);
+
+    ReaperLease* lease_;
+    ReapFn reap_;
+    ReaperConfig config_;
+    uint64_t token_;
+    std::atomic<uint64_t> reaped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_REAPER_H
@@ -55,11 +55,14 @@ namespace fastcollection {
 struct alignas(64) ShmEntry {
     std::atomic<uint32_t> state;     // 0=empty, 1=writing, 2=valid, 3=deleted, 4=expired
     uint32_t data_size;              // Size of serialized data
-    uint32_t hash_code;              // Hash for quick equality check
+    uint32_t hash_code;              // Hash for quick equality check (low half)
     int32_t ttl_seconds;             // TTL in seconds (-1 = infinite, no expiry)
     uint64_t created_at;             // Creation timestamp in nanoseconds
     uint64_t expires_at;             // Expiration timestamp in nanoseconds (0 = never)
-    uint64_t version;                // Version number for optimistic locking
+    uint64_t version;                // Stamp of the last write (see VersionClock)
+    mutable std::atomic<uint32_t> referenced;  // CLOCK reference bit (cache-mode maps)
+    uint32_t expiry_index;           // Position of the entry's record in the owner's expiry index
+    uint32_t hash_high;              // High half of a 64-bit hash (see Hasher)
     
     // States
     static constexpr uint32_t STATE_EMPTY = 0;
@@ -68,8 +71,11 @@ struct alignas(64) ShmEntry {
     static constexpr uint32_t STATE_DELETED = 3;
     static constexpr uint32_t STATE_EXPIRED = 4;
     
+    static constexpr uint32_t NOT_INDEXED = UINT32_MAX;
+    
     ShmEntry() : state(STATE_EMPTY), data_size(0), hash_code(0), 
-                 ttl_seconds(TTL_INFINITE), created_at(0), expires_at(0), version(0) {}
+                 ttl_seconds(TTL_INFINITE), created_at(0), expires_at(0), version(0),
+                 referenced(0), expiry_index(NOT_INDEXED), hash_high(0) {}
     
     bool try_acquire_for_write() {
         uint32_t expected = STATE_EMPTY;
@@ -111,6 +117,43 @@ struct alignas(64) ShmEntry {
         return current_timestamp_ns() < expires_at;
     }
     
+    /**
+     * @brief Mark the entry as recently used for CLOCK eviction
+     *
+     * Checks first so repeated reads of a hot entry do not keep dirtying
+     * its cache line.
+     */
+    void touch() const {
+        if (!referenced.load(std::memory_order_relaxed)) {
+            referenced.store(1, std::memory_order_relaxed);
+        }
+    }
+    
+    /**
+     * @brief Version of the last write to this entry (see VersionClock)
+     *
+     * Readers that skip the owner's lock load it before the value, and
+     * writers that change a value in place store it after, so a reader that
+     * sees a version also sees the value written with it.
+     */
+    uint64_t current_version() const {
+        uint64_t v = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(version))
+                         .load(std::memory_order_acquire);
+        return v != 0 ? v : 1;  // Written before versions were stamped
+    }
+    
+    void stamp_version(uint64_t v) {
+        std::atomic_ref<uint64_t>(version).store(v, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Store the hash computed by the owner's Hasher
+     */
+    void set_hash(uint64_t hash) {
+        hash_code = static_cast<uint32_t>(hash);
+        hash_high = static_cast<uint32_t>(hash >> 32);
+    }
+    
     /**
      * @brief Set TTL for this entry
      * @param ttl TTL in seconds (-1 for infinite)
@@ -124,7 +167,16 @@ struct alignas(64) ShmEntry {
             expires_at = created_at + (static_cast<uint64_t>(ttl) * 1000000000ULL);
         }
     }
-    
+
+    /**
+     * @brief Take over another entry's TTL without restarting it
+     */
+    void copy_ttl(const ShmEntry& other) {
+        ttl_seconds = other.ttl_seconds;
+        created_at = other.created_at;
+        expires_at = other.expires_at;
+    }
+
     /**
      * @brief Get remaining TTL in seconds
      * @return Remaining seconds, 0 if expired, -1 if infinite
@@ -138,6 +190,9 @@ struct alignas(64) ShmEntry {
     }
 };
 
+// New fields must fit the cache line; older files were laid out the same way
+static_assert(sizeof(ShmEntry) == 64, "ShmEntry must stay one cache line");
+
 /**
  * @brief Node for linked structures (list, queue, stack) in shared memory
  */
@@ -187,16 +242,130 @@ struct ShmKeyValue {
 
 /**
  * @brief Bucket for hash-based collections (set, map)
+ *
+ * Sixteen bytes, four to a cache line: the chain head and a tag word. The
+ * low seven bytes of the tag word hold 8-bit fingerprints of the first
+ * seven entries in the chain (0 = unused), the top byte the chain length
+ * (saturating at 255). A lookup whose fingerprint is missing skips the
+ * chain without touching any node. Past seven entries every lookup walks.
+ *
+ * Buckets carry no lock; writers hold the hash's stripe lock in the
+ * owning BucketTable. Tags are stored before a new head is published and
+ * after an entry is unlinked, so they never miss a reachable entry.
  */
 struct ShmBucket {
-    IpcMutex mutex;                    // Use regular mutex for exclusive locking
     std::atomic<int64_t> head_offset;  // Offset to first entry in bucket
-    std::atomic<uint32_t> count;       // Number of entries in bucket
-    std::atomic<uint32_t> size;        // Alias for count (for compatibility)
+    std::atomic<uint64_t> tags;        // Fingerprints and chain length
     
     static constexpr int64_t NULL_OFFSET = -1;
+    static constexpr int64_t MIGRATED_OFFSET = -2;   // Chain moved to the rehash table
+    static constexpr int64_t MIGRATING_OFFSET = -3;  // Chain is being moved right now
+    
+    static constexpr uint32_t FINGERPRINTS = 7;
+    static constexpr uint32_t MAX_LENGTH = 255;
+    
+    ShmBucket() : head_offset(NULL_OFFSET), tags(0) {}
+    
+    static uint8_t fingerprint(uint32_t hash) {
+        // Multiply so the top byte depends on the bits that pick the bucket too
+        uint8_t fp = static_cast<uint8_t>((hash * 0x9E3779B1u) >> 24);
+        return fp ? fp : 1;
+    }
+    
+    static uint32_t length(uint64_t tags) {
+        return static_cast<uint32_t>(tags >> 56);
+    }
+    
+    /**
+     * @brief Tag word with one more entry of the given hash
+     */
+    static uint64_t with_entry(uint64_t tags, uint32_t hash) {
+        uint32_t n = length(tags);
+        if (n < FINGERPRINTS) tags |= static_cast<uint64_t>(fingerprint(hash)) << (8 * n);
+        if (n < MAX_LENGTH) tags += 1ull << 56;
+        return tags;
+    }
+    
+    /**
+     * @brief Whether an entry of the given hash may be in the chain
+     *
+     * False only if the chain is short enough to be fully tagged and no
+     * fingerprint matches.
+     */
+    bool may_contain(uint32_t hash) const {
+        uint64_t t = tags.load(std::memory_order_acquire);
+        uint32_t n = length(t);
+        if (n > FINGERPRINTS) return true;
+        
+        // Zero-byte test; a spurious hit can only sit above a real one
+        constexpr uint64_t ONES = 0x0101010101010101ull;
+        uint64_t x = t ^ (ONES * fingerprint(hash));
+        uint64_t zero = (x - ONES) & ~x & (ONES << 7);
+        return (zero & ((1ull << (8 * n)) - 1)) != 0;
+    }
+    
+    /**
+     * @brief Record an entry about to be linked in; requires the stripe lock
+     */
+    void add_entry(uint32_t hash) {
+        tags.store(with_entry(tags.load(std::memory_order_relaxed), hash), std::memory_order_release);
+    }
     
-    ShmBucket() : head_offset(NULL_OFFSET), count(0), size(0) {}
+    /**
+     * @brief Forget an entry that was unlinked; requires the stripe lock
+     *
+     * @return false if the tags must be rebuilt from the chain instead
+     */
+    bool remove_entry(uint32_t hash) {
+        uint64_t t = tags.load(std::memory_order_relaxed);
+        uint32_t n = length(t);
+        if (n > FINGERPRINTS) {
+            // Down to seven entries, or the exact length was lost: rebuild
+            if (n == FINGERPRINTS + 1 || n == MAX_LENGTH) return false;
+            tags.store(t - (1ull << 56), std::memory_order_release);
+            return true;
+        }
+        
+        uint8_t fp = fingerprint(hash);
+        for (uint32_t j = 0; j < n; j++) {
+            if (static_cast<uint8_t>(t >> (8 * j)) != fp) continue;
+            
+            // Move the last fingerprint into the freed byte
+            uint64_t last = (t >> (8 * (n - 1))) & 0xFF;
+            t = (t & ~(0xFFull << (8 * j))) | (last << (8 * j));
+            t &= ~(0xFFull << (8 * (n - 1)));
+            tags.store(t - (1ull << 56), std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
+};
+
+static_assert(sizeof(ShmBucket) == 16, "Four buckets must share a cache line");
+
+/**
+ * @brief Bucket layout of files written before tagged buckets
+ *
+ * Only read while such a file is converted on open (see fc_hashtable.h).
+ */
+struct LegacyShmBucket {
+    IpcMutex mutex;
+    std::atomic<int64_t> head_offset;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> size;
+    
+    LegacyShmBucket() : head_offset(ShmBucket::NULL_OFFSET), count(0), size(0) {}
+};
+
+/**
+ * @brief One stripe of a hash table's bucket locks
+ *
+ * Padded to a cache line rather than alignas(64), like EpochSlot, so
+ * neighbouring stripes never share a line.
+ */
+struct ShmLockStripe {
+    ShmSpinLock lock;
+    uint8_t padding[64 - sizeof(ShmSpinLock)];
 };
 
 /**
@@ -207,12 +376,17 @@ struct CollectionHeader {
     uint32_t version;            // Data structure version
     uint64_t created_at;         // Creation timestamp
     uint64_t modified_at;        // Last modification timestamp
-    std::atomic<uint64_t> size;  // Number of elements
-    std::atomic<uint64_t> capacity;
+    std::atomic<uint64_t> size;  // Number of elements, including expired ones not yet reaped
+    std::atomic<uint64_t> next_expiry_ns;  // No stored entry expires before this (0 = unknown)
     IpcSharedMutex global_mutex; // Global mutex for structural changes
     
     static constexpr uint32_t MAGIC = 0xFAC01EC0;
-    static constexpr uint32_t CURRENT_VERSION = 1;
+    // 1: untagged hash buckets; 2: tagged buckets with lock stripes;
+    // 3: small blocks from the slab heap (fc_slab.h); 4: an expiry record per
+    // node (fc_expiry.h)
+    static constexpr uint32_t CURRENT_VERSION = 4;
+    static constexpr uint32_t MIN_VERSION = 1;  // Oldest layout still opened (and converted)
+    static constexpr uint64_t NO_EXPIRY = UINT64_MAX;
     
     CollectionHeader() 
         : magic(MAGIC)
@@ -220,10 +394,54 @@ struct CollectionHeader {
         , created_at(current_timestamp_ns())
         , modified_at(created_at)
         , size(0)
-        , capacity(0) {}
+        , next_expiry_ns(NO_EXPIRY) {}
     
     bool is_valid() const {
-        return magic == MAGIC && version == CURRENT_VERSION;
+        return magic == MAGIC && version >= MIN_VERSION && version <= CURRENT_VERSION;
+    }
+    
+    /**
+     * @brief Stamp the file with the current layout
+     *
+     * Every collection does this when it opens an existing file, before
+     * anything is allocated from the slab heap or converted. Builds that
+     * only know an older version reject the file from then on.
+     */
+    void mark_current() {
+        std::atomic_ref<uint32_t>(version).store(CURRENT_VERSION, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Record the expiration time of a stored entry (0 = never expires)
+     */
+    void note_expiry(uint64_t expires_at) {
+        if (expires_at == 0) return;
+        uint64_t current = next_expiry_ns.load(std::memory_order_acquire);
+        while (expires_at < current &&
+               !next_expiry_ns.compare_exchange_weak(current, expires_at,
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+        }
+    }
+    
+    /**
+     * @brief Whether size may count entries that have already expired
+     *
+     * Files written before this field existed hold 0 here, so they count as
+     * possibly expired until their first reap establishes the bound.
+     */
+    bool may_have_expired() const {
+        return current_timestamp_ns() >= next_expiry_ns.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief Start a full expiry sweep
+     *
+     * The sweep reports every surviving entry through note_expiry(), as do
+     * writers running concurrently, so the bound is rebuilt from scratch.
+     */
+    void begin_expiry_sweep() {
+        next_expiry_ns.store(NO_EXPIRY, std::memory_order_release);
     }
 };
 
@@ -243,7 +461,7 @@ struct ListHeader : public CollectionHeader {
 struct HashTableHeader : public CollectionHeader {
     uint32_t bucket_count;
     uint32_t load_factor_percent;  // Default 75%
-    std::atomic<uint64_t> total_bytes;
+    std::atomic<uint64_t> total_bytes;  // Bytes of stored entry nodes (tracked in cache mode)
     
     static constexpr uint32_t DEFAULT_BUCKET_COUNT = 16384;
     static constexpr uint32_t DEFAULT_LOAD_FACTOR = 75;
@@ -259,6 +477,66 @@ struct HashTableHeader : public CollectionHeader {
         , total_bytes(0) {}
 };
 
+/**
+ * @brief File-wide source of entry versions
+ *
+ * Every write stamps its entry with a fresh value, so a version identifies
+ * one write even when a key is removed and added again, or another element
+ * moves into a list position. 0 is never handed out and means "no entry".
+ * Kept as a separate named object so older files open unchanged; their
+ * entries hold 0 and report version 1, which is why counting starts above it.
+ */
+struct VersionClock {
+    std::atomic<uint64_t> last;
+    
+    VersionClock() : last(1) {}
+    
+    uint64_t next() { return last.fetch_add(1, std::memory_order_relaxed) + 1; }
+};
+
+/**
+ * @brief Location of the bucket arrays of a hash table
+ *
+ * Kept as a separate named object next to the HashTableHeader so that files
+ * written before incremental rehashing open unchanged. Each table reference
+ * packs the array offset and log2 of its bucket count into one word, so a
+ * single atomic load always yields a consistent (array, size) pair.
+ *
+ * While a resize is in progress two arrays are live: the main array and a
+ * rehash array twice its size. Main buckets are migrated in order, a few per
+ * write operation, and a migrated bucket's head is set to MIGRATED_OFFSET so
+ * readers and writers know to look in the rehash array instead.
+ */
+struct BucketDirectory {
+    std::atomic<uint64_t> main_table;    // Packed reference to the main array
+    std::atomic<uint64_t> rehash_table;  // Packed reference to the target array (0 = idle)
+    std::atomic<uint32_t> rehash_next;   // Next main bucket to migrate
+    std::atomic<uint64_t> retired_table; // Previous main array (kept, see fc_hashtable.h)
+    IpcMutex resize_mutex;               // Serializes resize start, migration and sweeps
+
+    static constexpr uint32_t SHIFT_BITS = 6;
+
+    static uint64_t pack(int64_t offset, uint32_t bucket_count) {
+        uint32_t shift = 0;
+        while ((2ull << shift) <= bucket_count) ++shift;
+        return (static_cast<uint64_t>(offset) << SHIFT_BITS) | shift;
+    }
+
+    static int64_t table_offset(uint64_t packed) {
+        return static_cast<int64_t>(packed >> SHIFT_BITS);
+    }
+
+    static uint32_t table_size(uint64_t packed) {
+        return 1u << (packed & ((1u << SHIFT_BITS) - 1));
+    }
+
+    BucketDirectory(int64_t buckets_offset, uint32_t bucket_count)
+        : main_table(pack(buckets_offset, bucket_count))
+        , rehash_table(0)
+        , rehash_next(0)
+        , retired_table(0) {}
+};
+
 /**
  * @brief Queue/Stack header with specialized pointers
  */
@@ -269,6 +547,90 @@ struct DequeHeader : public CollectionHeader {
     DequeHeader() : front_offset(ShmNode::NULL_OFFSET), back_offset(ShmNode::NULL_OFFSET) {}
 };
 
+/**
+ * @brief Hash function a collection file was created with
+ */
+enum class HashAlgorithm : uint32_t {
+    FNV1A_32 = 0,   // compute_hash(); files created before HashHeader existed
+    WYHASH_64 = 1   // compute_hash64()
+};
+
+/**
+ * @brief Records which HashAlgorithm a file uses
+ *
+ * Kept as a separate named object next to the collection header so that
+ * files written before it existed open unchanged: they have none and keep
+ * hashing with FNV-1a.
+ */
+struct HashHeader {
+    static constexpr uint32_t MAGIC = 0x4A5B6C64;
+    
+    uint32_t magic;
+    uint32_t algorithm;  // HashAlgorithm
+    
+    explicit HashHeader(HashAlgorithm algo)
+        : magic(MAGIC), algorithm(static_cast<uint32_t>(algo)) {}
+    
+    bool is_valid() const {
+        return magic == MAGIC && algorithm <= static_cast<uint32_t>(HashAlgorithm::WYHASH_64);
+    }
+};
+
+/**
+ * @brief Hashes data with the algorithm of one collection file
+ *
+ * Collections hash each key once and pass the value down to lookups and
+ * SerializationUtil. Entries store the full 64 bits (hash_code holds the
+ * low half, which also routes buckets); FNV-1a files only have 32.
+ */
+class Hasher {
+public:
+    Hasher() = default;
+    explicit Hasher(HashAlgorithm algo) : algorithm_(algo) {}
+    
+    /**
+     * @brief Load the algorithm of a file, recording WYHASH_64 in new files
+     * @param name Named object holding the HashHeader
+     * @param existing Whether the collection header was already in the file
+     */
+    static Hasher open(MMapFileManager* file_manager, const char* name, bool existing) {
+        HashHeader* header = file_manager->find<HashHeader>(name).first;
+        if (!header) {
+            if (existing) return Hasher(HashAlgorithm::FNV1A_32);
+            header = file_manager->find_or_construct<HashHeader>(name, HashAlgorithm::WYHASH_64);
+        }
+        if (!header->is_valid()) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::INTERNAL_ERROR,
+                "Invalid hash header in file"
+            );
+        }
+        return Hasher(static_cast<HashAlgorithm>(header->algorithm));
+    }
+    
+    HashAlgorithm algorithm() const { return algorithm_; }
+    
+    uint64_t operator()(const uint8_t* data, size_t size) const {
+        return algorithm_ == HashAlgorithm::WYHASH_64 ? compute_hash64(data, size)
+                                                      : compute_hash(data, size);
+    }
+    
+    /**
+     * @brief Whether an entry may hold data with this hash
+     *
+     * FNV-1a files compare the low half only: entries written before
+     * hash_high existed hold arbitrary bytes there.
+     */
+    bool matches(const ShmEntry& entry, uint64_t hash) const {
+        return entry.hash_code == static_cast<uint32_t>(hash) &&
+               (algorithm_ == HashAlgorithm::FNV1A_32 ||
+                entry.hash_high == static_cast<uint32_t>(hash >> 32));
+    }
+
+private:
+    HashAlgorithm algorithm_ = HashAlgorithm::WYHASH_64;
+};
+
 /**
  * @brief Utility class for serialization operations
  */
@@ -277,14 +639,15 @@ public:
     /**
      * @brief Copy data into a shared memory node with TTL support
      * @param node Target node
+     * @param hash Hash of the data, from the collection's Hasher
      * @param data Source data
      * @param size Data size
      * @param ttl_seconds TTL in seconds (-1 for infinite, no expiry)
      */
-    static void copy_to_node(ShmNode* node, const uint8_t* data, size_t size, 
+    static void copy_to_node(ShmNode* node, uint64_t hash, const uint8_t* data, size_t size, 
                             int32_t ttl_seconds = TTL_INFINITE) {
         node->entry.data_size = static_cast<uint32_t>(size);
-        node->entry.hash_code = compute_hash(data, size);
+        node->entry.set_hash(hash);
         node->entry.set_ttl(ttl_seconds);
         std::memcpy(node->data, data, size);
         node->entry.mark_valid();
@@ -307,20 +670,21 @@ public:
     /**
      * @brief Copy key-value data into a shared memory structure with TTL
      * @param kv Target key-value structure
+     * @param hash Hash of the key, from the collection's Hasher
      * @param key Key data
      * @param key_size Key size
      * @param value Value data
      * @param value_size Value size
      * @param ttl_seconds TTL in seconds (-1 for infinite)
      */
-    static void copy_to_kv(ShmKeyValue* kv, 
+    static void copy_to_kv(ShmKeyValue* kv, uint64_t hash,
                           const uint8_t* key, size_t key_size,
                           const uint8_t* value, size_t value_size,
                           int32_t ttl_seconds = TTL_INFINITE) {
         kv->key_size = static_cast<uint32_t>(key_size);
         kv->value_size = static_cast<uint32_t>(value_size);
         kv->entry.data_size = static_cast<uint32_t>(key_size + value_size);
-        kv->entry.hash_code = compute_hash(key, key_size);
+        kv->entry.set_hash(hash);
         kv->entry.set_ttl(ttl_seconds);
         std::memcpy(kv->data, key, key_size);
         std::memcpy(kv->data + key_size, value, value_size);
@@ -339,8 +703,8 @@ public:
     /**
      * @brief Compute bucket index for a given hash
      */
-    static uint32_t bucket_index(uint32_t hash, uint32_t bucket_count) {
-        return hash & (bucket_count - 1);  // Assumes power-of-2 bucket count
+    static uint32_t bucket_index(uint64_t hash, uint32_t bucket_count) {
+        return static_cast<uint32_t>(hash) & (bucket_count - 1);  // Assumes power-of-2 bucket count
     }
 };
 
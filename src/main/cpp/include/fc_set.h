@@ -45,8 +45,10 @@
  * | Bucket[N-1]      |  -> Node
  * +------------------+
  * 
- * Each bucket has its own mutex, allowing concurrent operations on different
- * buckets. The default bucket count is 16384 (power of 2 for fast modulo).
+ * Buckets are locked through a stripe array of up to 1024 small locks, allowing
+ * concurrent operations on different buckets, and carry fingerprints of their
+ * first entries so most misses skip the chain. The default bucket count is
+ * 16384 (power of 2 for fast modulo).
  * 
  * TTL (TIME-TO-LIVE) FEATURE:
  * ---------------------------
@@ -118,6 +120,10 @@
 
 #include "fc_common.h"
 #include "fc_serialization.h"
+#include "fc_hashtable.h"
+#include "fc_expiry.h"
+#include "fc_epoch.h"
+#include "fc_reaper.h"
 #include <functional>
 #include <vector>
 
@@ -250,18 +256,57 @@ public:
     /**
      * @brief Retain only elements that satisfy a predicate
      * 
+     * The predicate runs with a bucket lock held and must not modify this set.
+     * 
      * @param predicate Function returning true for elements to keep
      * @return Number of elements removed
      */
     size_t retainIf(std::function<bool(const uint8_t* data, size_t size)> predicate);
     
+    /**
+     * @brief Retain only matching elements, sweeping on the thread pool
+     * 
+     * Like retainIf(), but chunks of buckets are filtered concurrently by
+     * ThreadPool::instance(), each locking only the buckets it visits. The
+     * predicate must be thread-safe.
+     * 
+     * @return Number of elements removed
+     */
+    size_t parallelRetainIf(std::function<bool(const uint8_t* data, size_t size)> predicate);
+    
     /**
      * @brief Remove all expired elements
      * 
+     * Only visits the buckets named by due records of the expiry index,
+     * falling back to a full sweep that rebuilds the index when it is
+     * incomplete.
+     * 
      * @return Number of elements removed
      */
     size_t removeExpired();
     
+    /**
+     * @brief Remove expired elements in a bounded step
+     * 
+     * Stops once about max_items elements were removed (all expired elements
+     * of a visited bucket go together) or nothing more is due, so the time
+     * a lock is held stays bounded. The background reaper runs this.
+     * 
+     * @return Number of elements removed
+     */
+    size_t reapExpired(size_t max_items);
+    
+    /**
+     * @brief Remove all expired elements with a full sweep on the thread pool
+     * 
+     * Visits every bucket, in chunks spread over ThreadPool::instance(),
+     * and rebuilds the expiry index. Worth it over removeExpired() for a
+     * large backlog.
+     * 
+     * @return Number of elements removed
+     */
+    size_t parallelRemoveExpired();
+    
     // =========================================================================
     // ITERATION
     // =========================================================================
@@ -273,6 +318,16 @@ public:
      */
     void forEach(std::function<bool(const uint8_t* data, size_t size)> callback) const;
     
+    /**
+     * @brief Iterate over all non-expired elements on the thread pool
+     * 
+     * Like forEach(), but chunks of buckets are visited concurrently by
+     * ThreadPool::instance(), so the callback must be thread-safe and sees
+     * elements in no particular order. Returning false stops the sweep,
+     * though other threads may still deliver a few more elements.
+     */
+    void parallelForEach(std::function<bool(const uint8_t* data, size_t size)> callback) const;
+    
     /**
      * @brief Iterate with TTL information
      * 
@@ -288,6 +343,42 @@ public:
      */
     std::vector<std::vector<uint8_t>> toArray() const;
     
+    /**
+     * @brief Resumable iteration in bounded steps, like Redis SCAN
+     * 
+     * Start with cursor 0 and pass each returned cursor to the next call
+     * until it returns 0. Every element present for the whole scan is
+     * returned, even across resizes; see FastMap::scan().
+     * 
+     * @param cursor 0 to start, or the cursor returned by the previous call
+     * @param count Approximate batch size (whole buckets are returned)
+     * @param out_batch Receives copies of the elements; cleared first
+     * @return Cursor for the next call, or 0 once the scan is complete
+     */
+    uint64_t scan(uint64_t cursor, size_t count, std::vector<std::vector<uint8_t>>& out_batch) const;
+    
+    // =========================================================================
+    // BACKGROUND REAPER
+    // =========================================================================
+    
+    /**
+     * @brief Start removing expired elements on a background thread
+     * 
+     * Only one process per file reaps at a time; see fc_reaper.h. Restarts
+     * the reaper if one is already running. Moving the set stops it.
+     */
+    void startReaper(const ReaperConfig& config = ReaperConfig());
+    
+    /**
+     * @brief Stop this set's reaper, letting another process take over
+     */
+    void stopReaper();
+    
+    /**
+     * @brief Whether this set's reaper currently does the reaping for the file
+     */
+    bool isReaping() const { return reaper_ && reaper_->owns_lease(); }
+    
     // =========================================================================
     // UTILITY
     // =========================================================================
@@ -297,11 +388,28 @@ public:
      */
     void clear();
     
+    /**
+     * @brief Clear all elements, releasing them on the thread pool
+     */
+    void parallelClear();
+    
     /**
      * @brief Get the number of non-expired elements
+     *
+     * Amortized constant time: the live count kept in the shared header,
+     * less the entries the expiry index counts as expired but not yet
+     * reaped; nothing is removed (see removeExpired()). In a file created
+     * before the index existed, entries may count until the first reap.
      */
     size_t size() const;
     
+    /**
+     * @brief Count non-expired elements by walking the whole collection
+     *
+     * Slow; does not modify the collection.
+     */
+    size_t exactSize() const;
+    
     /**
      * @brief Check if set is empty
      */
@@ -323,22 +431,40 @@ public:
     void flush();
 
 private:
-    // Get bucket for a hash value
-    ShmBucket* get_bucket(uint32_t hash);
-    const ShmBucket* get_bucket(uint32_t hash) const;
-    
     // Find element in bucket chain
     ShmNode* find_in_bucket(ShmBucket* bucket, const uint8_t* data, size_t size, 
-                           uint32_t hash, ShmNode** prev_out = nullptr);
+                           uint64_t hash, ShmNode** prev_out = nullptr);
     
-    // Allocate and free nodes
+    // Allocate nodes; unlinked nodes are retired and freed once no
+    // lock-free reader or sweep can still see them
     ShmNode* allocate_node(size_t data_size);
-    void free_node(ShmNode* node);
+    void retire_node(ShmNode* node);
+    
+    // Record an element's expiration time in the expiry index and the header
+    void track_expiry(ShmEntry& entry);
+    
+    // Remove the expired elements of a locked bucket. With reindex,
+    // surviving expiration times are re-added to the expiry index
+    size_t reap_bucket(ShmBucket* bucket, uint64_t& next_expiry, bool reindex);
+    
+    // removeExpired() without the index; rebuilds it
+    size_t sweep_expired(bool parallel = false);
+    
+    // retainIf() and parallelRetainIf()
+    size_t retain_matching(const std::function<bool(const uint8_t* data, size_t size)>& predicate,
+                           bool parallel);
+    
+    // clear() and parallelClear()
+    void clear_elements(bool parallel);
 
     std::unique_ptr<MMapFileManager> file_manager_;
     HashTableHeader* header_;
-    ShmBucket* buckets_;
+    Hasher hasher_;  // Element hash function the file was created with
+    BucketTable<ShmNode> table_;
+    ExpiryIndex expiry_;  // Due times of elements with a TTL
+    std::unique_ptr<EpochDomain> epoch_;  // Reclamation for lock-free readers and sweeps
     CollectionStats stats_;
+    std::unique_ptr<TtlReaper> reaper_;  // Set while startReaper() is in effect
 };
 
 } // namespace fastcollection
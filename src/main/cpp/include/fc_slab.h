@@ -0,0 +1,166 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_slab.h
+ * @brief Size-class slab allocator kept inside the mapped file
+ *
+ * ============================================================================
+ * SLAB ALLOCATOR
+ * ============================================================================
+ *
+ * Boost's best-fit allocator takes the segment mutex on every call, so every
+ * node allocation in every collection of a file serializes on it. Nodes are
+ * always 64-byte multiples (ShmNode::total_size, ShmKeyValue::total_size),
+ * so small blocks come from segregated free lists instead:
+ *
+ *   class:     0     1     2    ...   31
+ *   block:    64   128   192   ...  2048 bytes
+ *   free list: [tagged head] -> block -> block -> ...
+ *
+ * - Boost only hands out arenas: large regions, each as large as all the
+ *   arenas before it (256 KiB to 1 GiB), split into 16 KiB chunks.
+ * - A chunk is given to one class when that class's free list runs dry;
+ *   its blocks are linked up privately and spliced onto the list at once.
+ * - Allocation pops the list head and freeing pushes onto it, one CAS each.
+ *   The head packs a 40-bit offset and a 24-bit tag, like FastStack's top,
+ *   so a block freed and reused under a racing pop cannot be mistaken.
+ * - Each arena begins with a byte per chunk naming the chunk's class, which
+ *   is how deallocate() finds the list of a bare pointer. Pointers outside
+ *   every arena (large blocks, blocks from files written before the slabs)
+ *   go back to Boost.
+ *
+ * Chunks never return to Boost and a class never gives blocks to another,
+ * so the footprint follows the peak number of blocks per class rather than
+ * the history of sizes. Builds without slabs would hand slab blocks back
+ * to Boost, so collections stamp the files they open with
+ * CollectionHeader::CURRENT_VERSION 3, which those builds refuse.
+ */
+
+#ifndef FASTCOLLECTION_SLAB_H
+#define FASTCOLLECTION_SLAB_H
+
+#include "fc_common.h"
+
+namespace fastcollection {
+
+/**
+ * @brief Free list of one size class
+ *
+ * Padded to a cache line rather than alignas(64), like ShmLockStripe.
+ */
+struct SlabClass {
+    std::atomic<int64_t> free_head;  // Tagged offset of the first free block
+    ShmSpinLock refill_lock;         // One refill per class at a time
+    uint8_t padding[64 - sizeof(std::atomic<int64_t>) - sizeof(ShmSpinLock)];
+
+    SlabClass() : free_head(-1) {}
+};
+
+/**
+ * @brief An arena: a region from Boost carved into chunks
+ */
+struct SlabArena {
+    int64_t offset;        // Segment offset of the chunk class table
+    int64_t chunk_base;    // Segment offset of chunk 0
+    uint64_t chunks;       // Number of chunks
+};
+
+/**
+ * @brief Shared-memory state of the slab allocator ("slab_heap")
+ */
+struct SlabHeap {
+    static constexpr size_t BLOCK_UNIT = 64;
+    static constexpr uint32_t CLASSES = 32;
+    static constexpr size_t MAX_BLOCK = BLOCK_UNIT * CLASSES;
+    static constexpr size_t CHUNK_BYTES = 16 * 1024;
+    static constexpr size_t MIN_ARENA = 256 * 1024;
+    static constexpr size_t MAX_ARENA = size_t(1) << 30;
+    static constexpr uint32_t MAX_ARENAS = 64;
+    static constexpr uint8_t NO_CLASS = 0xff;
+
+    SlabClass classes[CLASSES];
+    ShmSpinLock arena_lock;                // Guards arena creation and next_chunk
+    std::atomic<uint32_t> arena_count;     // Published arenas
+    uint64_t next_chunk;                   // Next unused chunk of the newest arena
+    uint64_t arena_bytes;                  // Bytes taken from Boost so far
+    SlabArena arenas[MAX_ARENAS];
+
+    SlabHeap() : arena_count(0), next_chunk(0), arena_bytes(0) {}
+};
+
+/**
+ * @brief Allocates small blocks from a file's SlabHeap
+ *
+ * Owned by MMapFileManager, which falls back to Boost whenever allocate()
+ * returns nullptr and for every pointer deallocate() does not own.
+ */
+class SlabAllocator {
+public:
+    /**
+     * @brief Open or create the heap of a segment
+     *
+     * @throws bip::bad_alloc if the segment has no room for the heap
+     */
+    explicit SlabAllocator(SegmentManager* segment);
+
+    /**
+     * @brief Re-attach after the file was remapped
+     */
+    void remap(SegmentManager* segment);
+
+    /**
+     * @brief Whether a request of this size is served from a class
+     */
+    static bool handles(size_t bytes) { return bytes > 0 && bytes <= SlabHeap::MAX_BLOCK; }
+
+    /**
+     * @brief Allocate a block of at least bytes, 64-byte aligned
+     *
+     * @return The block, or nullptr if bytes is too large or no arena could
+     *         be taken from the segment without growing it
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * @brief Return a block to its class
+     *
+     * @return false if ptr was not allocated here
+     */
+    bool deallocate(void* ptr);
+
+private:
+    int64_t offset_of(const void* ptr) const {
+        return static_cast<const uint8_t*>(ptr) - base_;
+    }
+
+    // Class of the block at offset, or NO_CLASS if no arena holds it
+    uint8_t class_of(int64_t offset) const;
+
+    // Pop a block off a class list; -1 when empty
+    int64_t pop(SlabClass& cls);
+
+    // Put a privately linked run of blocks on a class list
+    void push(SlabClass& cls, int64_t first, int64_t last);
+
+    // Give the class a fresh chunk; false when none could be had
+    bool refill(uint32_t class_index);
+
+    // Start a new arena (arena lock held)
+    bool add_arena();
+
+    SegmentManager* segment_;
+    uint8_t* base_;
+    SlabHeap* heap_;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_SLAB_H
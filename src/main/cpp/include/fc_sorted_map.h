@@ -0,0 +1,550 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_sorted_map.h
+ * @brief Memory-mapped ordered map (B+tree) with range scans and TTL support
+ *
+ * ============================================================================
+ * FASTCOLLECTION SORTED MAP - MEMORY-MAPPED B+TREE WITH TTL
+ * ============================================================================
+ *
+ * OVERVIEW:
+ * ---------
+ * FastSortedMap keeps its keys in order, so leaderboards, time-keyed logs and
+ * other ordered workloads can ask for floor/ceiling, a key range, a key
+ * prefix or the last N entries without pulling everything out and sorting it.
+ * Keys are byte strings compared as unsigned bytes, shorter keys first on a
+ * common prefix (memcmp order). Encode numbers big-endian, with the sign bit
+ * flipped for signed values, to make their byte order match numeric order.
+ *
+ * STORAGE ARCHITECTURE:
+ * ---------------------
+ *                       +----------------------------+
+ *   SortedMapHeader --> | inner: prefixes, separators|
+ *                       |        children[65]        |
+ *                       +----------------------------+
+ *                         /            |           \
+ *               +-----------+   +-----------+   +-----------+
+ *   leaves:     | leaf      |<->| leaf      |<->| leaf      |  (sibling chain)
+ *               +-----------+   +-----------+   +-----------+
+ *                 |  |  |
+ *                 ShmKeyValue entries (key, value, TTL)
+ *
+ * - Nodes hold up to 64 keys. Each key slot keeps the first 8 key bytes as a
+ *   big-endian integer next to the others, so a node search is a binary
+ *   search over one contiguous array that only touches a key record on a tie.
+ * - Children, siblings and keys are offsets into the mapped file, so the
+ *   tree is valid in every process that maps it.
+ * - Entries are the ShmKeyValue records FastMap uses, with the same TTL and
+ *   state fields. Inner nodes route with separator records that hold the
+ *   shortest key prefix telling two leaves apart.
+ * - Leaves are linked both ways, so scans walk the leaf level in either
+ *   direction after one descent.
+ * - Inserting past the end of the last leaf splits it unevenly, leaving the
+ *   old leaf full, so append-mostly (time-keyed) workloads fill leaves.
+ * - Removing keys never merges nodes; an emptied leaf is refilled by later
+ *   inserts into its key range. clear() recycles every node.
+ *
+ * CONCURRENCY MODEL:
+ * ------------------
+ * Readers use optimistic lock coupling: every node carries a version that
+ * writers make odd while they change the node and bump again when done. A
+ * reader notes a node's version, reads what it needs, and re-checks the
+ * version before following a child, sibling or key offset. On the way down
+ * it re-checks the parent after reading the child's version, so it never
+ * acts on a node that changed underneath it; on a mismatch it starts over
+ * (scans resume after the last key they delivered). After a few failed
+ * attempts a reader takes the shared lock instead, so it always finishes.
+ *
+ * - Writers serialize on the collection's exclusive lock and never block
+ *   readers, except those that fell back to the shared lock.
+ * - Updates are copy-on-write: a new entry record replaces the old one in
+ *   its slot, and the old record is retired through an epoch domain (see
+ *   fc_epoch.h), so a key or value handed to a reader stays intact.
+ * - Nodes are never returned to the allocator, only recycled, so a stale
+ *   node offset always points at a node whose version exposes the change.
+ *
+ * TTL (TIME-TO-LIVE) FEATURE:
+ * ---------------------------
+ * Every entry has its own TTL, as in FastMap (-1 = never expires). Expired
+ * entries are skipped by lookups and scans and removed by removeExpired(),
+ * size() or the background reaper, using the expiry index (fc_expiry.h).
+ *
+ * PERFORMANCE CHARACTERISTICS:
+ * ----------------------------
+ * Operation          | Complexity        | Notes
+ * -------------------|-------------------|--------------------------------
+ * get / containsKey  | O(log n)          | Lock-free optimistic descent
+ * put / remove       | O(log n)          | Exclusive lock
+ * floor / ceiling    | O(log n)          | Same descent, then one step
+ * range / prefix     | O(log n + k)      | k = entries visited
+ * size               | O(1)              | Counter in the shared header
+ *
+ * USAGE EXAMPLES:
+ * ---------------
+ *
+ * C++:
+ *   FastSortedMap scores("/tmp/scores.fc", 64*1024*1024, true);
+ *   scores.put(key, key_size, value, value_size, 3600);  // 1-hour TTL
+ *
+ *   // Top 10, highest key first
+ *   size_t n = 0;
+ *   scores.forEach([&](const uint8_t* k, size_t ks, const uint8_t* v, size_t vs) {
+ *       return ++n < 10;
+ *   }, true);
+ *
+ * Java (via JNI):
+ *   FastCollectionSortedMap<String, Event> events = new FastCollectionSortedMap<>(
+ *       "/tmp/events.fc", FastCollectionSortedMap.KeyCodec.STRING);
+ *   events.put("2025-06-01T12:00:00Z", event, 86400);
+ *   List<Map.Entry<String, Event>> day = events.prefix("2025-06-01");
+ *
+ * Python (via pybind11):
+ *   m = FastSortedMap("/tmp/events.fc")
+ *   m.put(b"2025-06-01T12:00:00Z", data, ttl=86400)
+ *   for key, value in m.range(b"2025-06-01", b"2025-06-02"): ...
+ */
+
+#ifndef FASTCOLLECTION_SORTED_MAP_H
+#define FASTCOLLECTION_SORTED_MAP_H
+
+#include "fc_common.h"
+#include "fc_serialization.h"
+#include "fc_epoch.h"
+#include "fc_expiry.h"
+#include "fc_reaper.h"
+#include <functional>
+#include <vector>
+
+namespace fastcollection {
+
+/**
+ * @brief B+tree node stored in the mapped file
+ *
+ * Leaves (level 0) map keys[i] to ShmKeyValue entries. Inner nodes route a
+ * key k to children[i] where keys[i-1] <= k < keys[i], keys[] pointing at
+ * separator records (ShmKeyValue with an empty value).
+ */
+struct SortedNode {
+    static constexpr uint32_t FANOUT = 64;
+
+    std::atomic<uint64_t> version;   // Even = stable, odd = being changed
+    uint32_t count;                  // Keys in use
+    uint32_t level;                  // 0 = leaf
+    int64_t prev_offset;             // Leaf siblings (-1 = none)
+    int64_t next_offset;             // Leaf siblings; also links recycled nodes
+    uint64_t prefixes[FANOUT];       // First 8 key bytes, big-endian, zero padded
+    int64_t keys[FANOUT];            // Entry (leaf) or separator (inner) records
+    int64_t children[FANOUT + 1];    // Inner nodes only
+
+    static constexpr int64_t NULL_OFFSET = -1;
+
+    SortedNode() : version(0), count(0), level(0),
+                   prev_offset(NULL_OFFSET), next_offset(NULL_OFFSET) {}
+};
+
+/**
+ * @brief Sorted map header
+ */
+struct SortedMapHeader : public CollectionHeader {
+    std::atomic<int64_t> root_offset;   // -1 until the first open creates the root
+    std::atomic<uint32_t> height;       // Levels, 1 = the root is a leaf
+    int64_t spare_offset;               // Recycled nodes, linked by next_offset
+    uint64_t spare_count;
+    uint64_t node_count;                // Nodes allocated, in the tree or spare
+
+    SortedMapHeader()
+        : root_offset(SortedNode::NULL_OFFSET)
+        , height(0)
+        , spare_offset(SortedNode::NULL_OFFSET)
+        , spare_count(0)
+        , node_count(0) {}
+};
+
+/**
+ * @brief Memory-mapped ordered map with TTL support
+ *
+ * Features:
+ * - O(log n) put, get, remove, floor and ceiling
+ * - Range, prefix and full scans in either direction
+ * - TTL support for automatic entry expiration
+ * - Lock-free optimistic reads, writers serialized per file
+ * - Memory-mapped backing for persistence and IPC
+ */
+class FastSortedMap {
+public:
+    /**
+     * @brief Callback for scans: key, key size, value, value size
+     *
+     * The pointers point into the mapped file and are only valid during the
+     * call. Return false to stop the scan. The callback must not modify
+     * this map.
+     */
+    using EntryCallback = std::function<bool(const uint8_t* key, size_t key_size,
+                                             const uint8_t* value, size_t value_size)>;
+
+    /**
+     * @brief Construct a FastSortedMap with the given memory-mapped file
+     *
+     * @param mmap_file Path to the memory-mapped file
+     * @param initial_size Initial size of the memory-mapped region
+     * @param create_new If true, create a new file (truncating any existing)
+     *
+     * @throws FastCollectionException if file cannot be created/opened
+     */
+    FastSortedMap(const std::string& mmap_file,
+                  size_t initial_size = DEFAULT_INITIAL_SIZE,
+                  bool create_new = false);
+
+    ~FastSortedMap();
+
+    // Non-copyable
+    FastSortedMap(const FastSortedMap&) = delete;
+    FastSortedMap& operator=(const FastSortedMap&) = delete;
+
+    // Movable
+    FastSortedMap(FastSortedMap&&) noexcept;
+    FastSortedMap& operator=(FastSortedMap&&) noexcept;
+
+    // =========================================================================
+    // PUT OPERATIONS
+    // =========================================================================
+
+    /**
+     * @brief Put a key-value pair into the map
+     *
+     * @param key Pointer to key data
+     * @param key_size Size of key in bytes (must be > 0)
+     * @param value Pointer to value data
+     * @param value_size Size of value in bytes
+     * @param ttl_seconds Time-to-live in seconds (-1 for infinite)
+     * @return true if entry was added/updated, false for an empty key
+     *
+     * If key exists, value and TTL are replaced.
+     */
+    bool put(const uint8_t* key, size_t key_size,
+             const uint8_t* value, size_t value_size,
+             int32_t ttl_seconds = TTL_INFINITE);
+
+    /**
+     * @brief Put if key does not exist (atomic)
+     *
+     * @return true if entry was added, false if a live entry already exists
+     */
+    bool putIfAbsent(const uint8_t* key, size_t key_size,
+                     const uint8_t* value, size_t value_size,
+                     int32_t ttl_seconds = TTL_INFINITE);
+
+    // =========================================================================
+    // GET OPERATIONS
+    // =========================================================================
+
+    /**
+     * @brief Get value for a key
+     *
+     * @return true if key found and not expired
+     */
+    bool get(const uint8_t* key, size_t key_size,
+             std::vector<uint8_t>& out_value) const;
+
+    /**
+     * @brief Read a value in place, without copying it out of the mapped file
+     *
+     * The entry is pinned by an epoch read section until fn returns. The
+     * callback must not keep the pointer or modify this map.
+     *
+     * @return true if the key was found and fn was called
+     */
+    bool getWith(const uint8_t* key, size_t key_size,
+                 const std::function<void(const uint8_t* value, size_t value_size)>& fn) const;
+
+    /**
+     * @brief Get remaining TTL for a key
+     *
+     * @return Remaining seconds (-1 if infinite, 0 if expired/not found)
+     */
+    int64_t getTTL(const uint8_t* key, size_t key_size) const;
+
+    /**
+     * @brief Check if a live entry exists for key
+     */
+    bool containsKey(const uint8_t* key, size_t key_size) const;
+
+    // =========================================================================
+    // REMOVE OPERATIONS
+    // =========================================================================
+
+    /**
+     * @brief Remove a key
+     *
+     * @param out_value Optional output buffer for the removed value
+     * @return true if a live entry was removed
+     */
+    bool remove(const uint8_t* key, size_t key_size,
+                std::vector<uint8_t>* out_value = nullptr);
+
+    /**
+     * @brief Update TTL for a key without changing its value
+     *
+     * @return true if key exists and TTL was updated
+     */
+    bool setTTL(const uint8_t* key, size_t key_size, int32_t ttl_seconds);
+
+    /**
+     * @brief Remove all expired entries
+     *
+     * @return Number of entries removed
+     *
+     * Time Complexity: O(k log n) for k expired entries, using the expiry index
+     */
+    size_t removeExpired();
+
+    /**
+     * @brief Remove expired entries in a bounded step
+     *
+     * Stops once max_items entries were removed or nothing more is due.
+     * The background reaper runs this.
+     *
+     * @return Number of entries removed
+     */
+    size_t reapExpired(size_t max_items);
+
+    // =========================================================================
+    // ORDERED ACCESS
+    // =========================================================================
+
+    /**
+     * @brief Entry with the smallest key
+     *
+     * @return true if the map has a live entry
+     */
+    bool first(std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const;
+
+    /**
+     * @brief Entry with the largest key
+     */
+    bool last(std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const;
+
+    /**
+     * @brief Entry with the greatest key less than or equal to key
+     *
+     * @return true if there is one
+     */
+    bool floor(const uint8_t* key, size_t key_size,
+               std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const;
+
+    /**
+     * @brief Entry with the least key greater than or equal to key
+     */
+    bool ceiling(const uint8_t* key, size_t key_size,
+                 std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const;
+
+    /**
+     * @brief Visit entries with from <= key < to, in key order
+     *
+     * A bound of size 0 leaves that side open.
+     *
+     * @param reverse Visit from the largest key down
+     *
+     * Scans are weakly consistent: each entry is delivered at most once and
+     * in order, entries present for the whole scan are always delivered, and
+     * concurrent changes may or may not be seen.
+     */
+    void range(const uint8_t* from, size_t from_size,
+               const uint8_t* to, size_t to_size,
+               const EntryCallback& callback, bool reverse = false) const;
+
+    /**
+     * @brief Visit entries whose key starts with prefix, in key order
+     */
+    void prefix(const uint8_t* prefix, size_t prefix_size,
+                const EntryCallback& callback, bool reverse = false) const;
+
+    /**
+     * @brief Visit all live entries, in key order or reversed
+     */
+    void forEach(const EntryCallback& callback, bool reverse = false) const;
+
+    // =========================================================================
+    // BACKGROUND REAPER
+    // =========================================================================
+
+    /**
+     * @brief Start removing expired entries on a background thread
+     *
+     * Only one process per file reaps at a time; see fc_reaper.h. Restarts
+     * the reaper if one is already running. Moving the map stops it.
+     */
+    void startReaper(const ReaperConfig& config = ReaperConfig());
+
+    /**
+     * @brief Stop this map's reaper, letting another process take over
+     */
+    void stopReaper();
+
+    /**
+     * @brief Whether this map's reaper currently does the reaping for the file
+     */
+    bool isReaping() const { return reaper_ && reaper_->owns_lease(); }
+
+    // =========================================================================
+    // UTILITY
+    // =========================================================================
+
+    /**
+     * @brief Clear all entries from the map
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of non-expired entries
+     *
+     * Amortized constant time: the live count kept in the shared header,
+     * less the entries the expiry index counts as expired but not yet
+     * reaped; nothing is removed (see removeExpired()). In a file created
+     * before the index existed, entries may count until the first reap.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Count non-expired entries by walking the whole collection
+     *
+     * Slow; does not modify the collection.
+     */
+    size_t exactSize() const;
+
+    /**
+     * @brief Check if map is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Number of levels in the tree (1 = a single leaf)
+     */
+    uint32_t height() const { return header_->height.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get collection statistics
+     */
+    const CollectionStats& stats() const { return stats_; }
+
+    /**
+     * @brief Get the backing file path
+     */
+    const std::string& filename() const { return file_manager_->filename(); }
+
+    /**
+     * @brief Flush changes to disk
+     */
+    void flush();
+
+private:
+    // Deepest tree a writer can handle; 64-way nodes at least half full
+    // reach far beyond any file size first
+    static constexpr uint32_t MAX_HEIGHT = 16;
+
+    // Optimistic attempts before a reader falls back to the shared lock
+    static constexpr uint32_t OPTIMISTIC_ATTEMPTS = 8;
+
+    // Nodes on a writer's way down, with the child index taken in each
+    struct Path {
+        SortedNode* nodes[MAX_HEIGHT];
+        uint32_t indices[MAX_HEIGHT];
+        uint32_t depth = 0;
+    };
+
+    class WriteSet;
+
+    uint8_t* base() const {
+        return reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+    }
+
+    SortedNode* node_at(int64_t offset) const {
+        return reinterpret_cast<SortedNode*>(base() + offset);
+    }
+
+    ShmKeyValue* record_at(int64_t offset) const {
+        return reinterpret_cast<ShmKeyValue*>(base() + offset);
+    }
+
+    int64_t offset_of(const void* p) const {
+        return static_cast<const uint8_t*>(p) - base();
+    }
+
+    // Run a read attempt optimistically; after OPTIMISTIC_ATTEMPTS failures
+    // run it once more under the shared lock (locked = true), where it
+    // cannot fail. The caller holds an epoch read section.
+    void run_read(const std::function<bool(bool locked)>& attempt) const;
+
+    // Position in node of the first key >= key, or > key with upper set.
+    // Fails if the node changed while an optimistic reader searched it.
+    bool search(const SortedNode* node, uint64_t version, const uint8_t* key, size_t key_size,
+                bool upper, bool locked, uint32_t& out_index) const;
+
+    // Reader descent to the leaf covering key; without a key, to the first
+    // leaf or, with last set, the last one
+    bool find_leaf(const uint8_t* key, size_t key_size, bool last, bool locked,
+                   SortedNode*& out_leaf, uint64_t& out_version) const;
+
+    // Visit live entries from a bound (none = from the start or, reversed,
+    // the end); visit returns false to stop
+    void scan(const uint8_t* from, size_t from_size, bool inclusive, bool reverse,
+              const std::function<bool(const ShmKeyValue* kv)>& visit) const;
+
+    // Lookup shared by the read APIs: calls fn with the live entry for key
+    bool read_entry(const uint8_t* key, size_t key_size,
+                    const std::function<void(const ShmKeyValue* kv)>& fn) const;
+
+    // First live entry of a scan, copied out
+    bool first_entry(const uint8_t* from, size_t from_size, bool reverse,
+                     std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const;
+
+    // Writer descent to the leaf covering key (exclusive lock held)
+    SortedNode* descend(const uint8_t* key, size_t key_size, Path& path) const;
+
+    // Store a new entry; replace the existing one unless only_if_absent and
+    // it is still alive
+    bool insert(const uint8_t* key, size_t key_size,
+                const uint8_t* value, size_t value_size,
+                int32_t ttl_seconds, bool only_if_absent);
+
+    // Insert a new key at index of the path's leaf, splitting as needed
+    void insert_new(Path& path, uint32_t index, ShmKeyValue* kv);
+
+    // Remove the slot at index of a leaf and retire its entry
+    void erase_at(SortedNode* leaf, uint32_t index);
+
+    // Remove a specific entry record (reaper), if it is still in the tree
+    void erase_record(ShmKeyValue* kv);
+
+    // Node management: spare nodes are recycled before allocating new ones
+    void reserve_nodes(uint64_t count);
+    SortedNode* take_node(WriteSet& writes, uint32_t level);
+
+    // Entry and separator records
+    ShmKeyValue* allocate_kv(size_t key_size, size_t value_size);
+    ShmKeyValue* make_separator(const ShmKeyValue* left, const ShmKeyValue* right);
+    void retire_kv(ShmKeyValue* kv);
+
+    // Record an entry's expiration time in the expiry index and the header
+    void track_expiry(ShmKeyValue* kv);
+
+    std::unique_ptr<MMapFileManager> file_manager_;
+    SortedMapHeader* header_;
+    std::unique_ptr<EpochDomain> epoch_;  // Retired entry and separator records
+    ExpiryIndex expiry_;                  // Entries with a TTL, ordered by due time
+    CollectionStats stats_;
+    std::unique_ptr<TtlReaper> reaper_;   // Set while startReaper() is in effect
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_SORTED_MAP_H
@@ -28,6 +28,7 @@
  * 3. TTL: Elements auto-expire after configurable duration
  * 4. LOCK-FREE: CAS-based push/pop for high concurrency
  * 5. ABA PREVENTION: Tagged pointers prevent ABA problem
+ * 6. ELIMINATION: Colliding push/pop pairs hand over directly
  * 
  * STACK ARCHITECTURE:
  * -------------------
@@ -44,7 +45,7 @@
  *    push/pop
  * 
  * Lock-free operations use Compare-And-Swap (CAS) on the top pointer.
- * ABA problem is prevented using tagged pointers with version counters.
+ * ABA problem is prevented by packing a version tag into the top pointer.
  * 
  * TTL (TIME-TO-LIVE) FEATURE:
  * ---------------------------
@@ -106,16 +107,37 @@
  * 
  * Pop operation:
  *   1. Read current top
- *   2. If empty or expired, skip
+ *   2. If empty, return
  *   3. Read top->next
  *   4. CAS(top, current, next)
- *   5. Return node data
+ *   5. Return node data, or drop it and start over if it expired
  *   6. Retry if CAS fails
  * 
  * ABA Prevention:
- *   - Each node has a version tag
- *   - CAS compares both pointer and tag
- *   - Tag increments on each modification
+ *   - The top pointer is one 64-bit word: a 40-bit node offset and a
+ *     24-bit tag (files up to 1 TiB)
+ *   - Every change to the top bumps the tag, and CAS compares both
+ *   - So a pop whose top was popped, freed and reallocated at the same
+ *     offset meanwhile fails its CAS instead of installing a stale next
+ * 
+ * Elimination Backoff:
+ *   - A push or pop whose CAS fails goes to the elimination array, a few
+ *     cache-line slots in the file ("stack_elimination"), before retrying
+ *   - A push parks its node in a slot for a moment; a pop that finds it
+ *     there takes it with one CAS, and neither touches the top pointer
+ *   - The slots in use widen under contention and narrow when idle
+ * 
+ * Bulk Operations:
+ *   - pushAll() links its nodes privately, bottom to top, and publishes
+ *     the chain with one CAS, just like a single push
+ *   - popAll() walks up to max_count nodes down from the top, rechecking
+ *     the top word as it goes, and unlinks them all with one CAS
+ * 
+ * removeElement(), removeExpired() and clear() take the stack lock, lift
+ * the whole chain off the top with one CAS, edit it privately and put what
+ * is left back underneath anything pushed meanwhile, so LIFO order holds.
+ * A pop or peek that finds the top empty while the chain is lifted off
+ * waits for it to come back rather than reporting an empty stack.
  * 
  * USAGE EXAMPLES:
  * ---------------
@@ -161,6 +183,27 @@
 
 namespace fastcollection {
 
+/**
+ * @brief One elimination slot: a tagged node offset, NULL when free
+ *
+ * Padded to a cache line rather than alignas(64), like ShmLockStripe.
+ */
+struct EliminationSlot {
+    std::atomic<int64_t> word;
+    uint8_t padding[64 - sizeof(std::atomic<int64_t>)];
+
+    EliminationSlot() : word(-1) {}
+};
+
+/**
+ * @brief Elimination array of a FastStack, kept in the mapped file
+ */
+struct EliminationArray {
+    static constexpr uint32_t SLOTS = 8;
+
+    EliminationSlot slots[SLOTS];
+};
+
 /**
  * @brief Ultra high-performance memory-mapped concurrent stack with TTL
  * 
@@ -267,6 +310,9 @@ public:
      * @return Number of elements pushed
      * 
      * Elements are pushed in order, so last element ends up on top.
+     * The nodes are linked privately and published with one CAS on the
+     * top, so other threads see all of them or none. Empty elements are
+     * skipped; if an allocation fails, nothing is pushed.
      */
     size_t pushAll(const std::vector<std::tuple<const uint8_t*, size_t, int32_t>>& elements);
     
@@ -276,6 +322,10 @@ public:
      * @param out_data Output vector for elements
      * @param max_count Maximum number to pop
      * @return Number of elements popped
+     * 
+     * Elements are appended top first. Up to max_count nodes are unlinked
+     * with one CAS on the top (the whole stack when max_count covers it);
+     * expired ones among them are dropped and the shortfall retried.
      */
     size_t popAll(std::vector<std::vector<uint8_t>>& out_data, size_t max_count);
     
@@ -357,6 +407,9 @@ public:
     /**
      * @brief Iterate over all non-expired elements (top to bottom)
      * 
+     * Holds the stack lock shared, so other readers, push and pop keep going;
+     * the callback must not call clear(), removeElement() or removeExpired().
+     * 
      * @param callback Function called for each element. Return false to stop.
      */
     void forEach(std::function<bool(const uint8_t* data, size_t size)> callback) const;
@@ -386,30 +439,87 @@ private:
     /**
      * @brief Tagged pointer for ABA prevention
      * 
-     * Combines a node offset with a version tag to prevent the ABA problem
-     * in lock-free operations.
+     * Packs a node offset (low 40 bits, all ones for none) and a version tag
+     * (high 24 bits) into the header's front_offset word, so a single 64-bit
+     * CAS compares both. A file written before the tag reads as tag 0, and
+     * its empty stack (-1) as no offset.
      */
     struct TaggedPointer {
-        int64_t offset;   // Offset to node in memory-mapped file
-        uint64_t tag;     // Version counter for ABA prevention
+        static constexpr int OFFSET_BITS = 40;
+        static constexpr uint64_t OFFSET_MASK = (uint64_t(1) << OFFSET_BITS) - 1;
         
-        bool operator==(const TaggedPointer& other) const {
-            return offset == other.offset && tag == other.tag;
+        static int64_t offset(int64_t word) {
+            uint64_t bits = static_cast<uint64_t>(word) & OFFSET_MASK;
+            return bits == OFFSET_MASK ? ShmNode::NULL_OFFSET : static_cast<int64_t>(bits);
+        }
+        
+        // The word that replaces `word` to point at `offset`, with the next tag
+        static int64_t next(int64_t word, int64_t offset) {
+            uint64_t tag = (static_cast<uint64_t>(word) >> OFFSET_BITS) + 1;
+            return static_cast<int64_t>((tag << OFFSET_BITS) |
+                                        (static_cast<uint64_t>(offset) & OFFSET_MASK));
         }
     };
     
     // Get node at offset
     ShmNode* node_at_offset(int64_t offset) const;
     
+    // Offset of a node in the segment
+    int64_t offset_of(const ShmNode* node) const;
+    
     // Allocate a new node
     ShmNode* allocate_node(size_t data_size);
     
     // Free a node
     void free_node(ShmNode* node, size_t data_size);
+    
+    // Offset of the top node (for walks under the stack lock)
+    int64_t top_offset() const;
+    
+    // Link node above the top with one CAS attempt
+    bool try_push(ShmNode* node, int64_t node_offset);
+    
+    // Walk from the top to the first live node, restarting whenever the top
+    // word changes under the walk; sets top to the word the result is valid for
+    int64_t first_alive(int64_t& top) const;
+    
+    // Finish a node this thread unlinked: copy it out unless it expired,
+    // then free it. Returns whether it was live
+    bool consume_node(ShmNode* node, std::vector<uint8_t>* out_data);
+    
+    // Elimination: park a node for a pop / take a parked node
+    bool eliminate_push(int64_t node_offset);
+    int64_t eliminate_pop();
+    EliminationSlot& elimination_slot() const;
+    
+    // Unlink up to max_count nodes from the top with one CAS; returns the
+    // first offset and sets end to the offset the detached run stops at
+    int64_t detach_top(size_t max_count, int64_t& end);
+    
+    // Lift the whole chain off the top (stack lock held); returns its first
+    // offset. Must be followed by release_chain()
+    int64_t detach_all();
+    
+    // Put the edited chain (if any) back under whatever was pushed since
+    // detach_all(), and let waiting pops and peeks go on
+    void release_chain(int64_t first, ShmNode* last);
+    void reattach(int64_t first, ShmNode* last);
+    
+    // Whether the chain may have been lifted off since detach_seq_ read seq;
+    // if so waits for it to be back and the caller retries
+    bool chain_was_away(uint64_t seq) const;
+    
+    // Link a privately built chain above the top
+    void splice_on_top(int64_t first, ShmNode* last);
+    
+    // Stamp modified_at; lock-free pushes and pops write it concurrently
+    void touch();
 
     std::unique_ptr<MMapFileManager> file_manager_;
     DequeHeader* header_;
-    std::atomic<uint64_t>* aba_tag_;  // For ABA prevention
+    Hasher hasher_;  // Element hash function the file was created with
+    EliminationArray* elimination_ = nullptr;
+    std::atomic<uint64_t>* detach_seq_ = nullptr;  // Odd while the chain is lifted off
     CollectionStats stats_;
 };
 
@@ -0,0 +1,277 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_swiss.h
+ * @brief Open-addressing (Swiss table) index for FastMap
+ *
+ * ============================================================================
+ * SWISS TABLE ENGINE
+ * ============================================================================
+ *
+ * An alternative to the chained bucket layout. Slots are arranged in groups
+ * of 16, each group holding 16 one-byte control words followed by 16 entry
+ * offsets:
+ *
+ *   +------------------+------------------------------------+
+ *   | ctrl[16] (16 B)  | slots[16] (16 x int64 offsets)     |
+ *   +------------------+------------------------------------+
+ *
+ * A control byte is EMPTY (0x80), DELETED (0xFE) or, for a full slot, the low
+ * 7 bits of the key hash (H2). The remaining hash bits (H1) choose the first
+ * group to probe. A lookup compares all 16 control bytes against H2 in one
+ * SIMD instruction (SSE2 or NEON, with a portable fallback) and only
+ * dereferences entries whose fingerprint matches, so the common case touches
+ * one group and one ShmKeyValue.
+ *
+ * Probing moves between groups quadratically and stops at the first group
+ * that still has an EMPTY slot. The table rehashes when more than 7/8 of its
+ * slots are full or deleted.
+ *
+ * The table itself is not synchronized; FastMap guards it with the header's
+ * global shared mutex (shared for reads, exclusive for writes).
+ */
+
+#ifndef FASTCOLLECTION_SWISS_H
+#define FASTCOLLECTION_SWISS_H
+
+#include "fc_common.h"
+#include "fc_serialization.h"
+#include "fc_thread_pool.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace fastcollection {
+
+/**
+ * @brief One probe group: control bytes followed by entry offsets
+ */
+struct SwissGroup {
+    static constexpr uint32_t WIDTH = 16;
+
+    uint8_t ctrl[WIDTH];
+    int64_t slots[WIDTH];
+};
+
+/**
+ * @brief Shared-memory header of a Swiss table index
+ */
+struct SwissHeader {
+    uint32_t magic;
+    uint32_t group_count;     // Power of 2
+    int64_t groups_offset;    // Offset of the SwissGroup array
+    uint64_t full_slots;
+    uint64_t deleted_slots;
+
+    static constexpr uint32_t MAGIC = 0x5A155EED;
+
+    explicit SwissHeader(uint32_t groups)
+        : magic(MAGIC)
+        , group_count(groups)
+        , groups_offset(-1)
+        , full_slots(0)
+        , deleted_slots(0) {}
+
+    bool is_valid() const { return magic == MAGIC; }
+};
+
+/**
+ * @brief Process-local view of a Swiss table stored in a mapped file
+ */
+class SwissTable {
+public:
+    static constexpr uint8_t CTRL_EMPTY = 0x80;
+    static constexpr uint8_t CTRL_DELETED = 0xFE;
+
+    /**
+     * @brief Location of a full slot; group is null when a lookup misses
+     */
+    struct Position {
+        SwissGroup* group = nullptr;
+        uint32_t index = 0;
+
+        explicit operator bool() const { return group != nullptr; }
+    };
+
+    /**
+     * @brief Attach to a Swiss table, allocating its groups on first use
+     */
+    SwissTable(MMapFileManager* file_manager, SwissHeader* header);
+
+    /**
+     * @brief Number of groups needed for a requested slot count
+     */
+    static uint32_t groups_for(uint32_t slot_count);
+
+    /**
+     * @brief Find the slot holding a key (live or expired)
+     */
+    Position find(const uint8_t* key, size_t key_size, uint32_t hash) const;
+
+    /**
+     * @brief Append the slots of every entry whose key hashes to hash
+     */
+    void find_hash(uint32_t hash, std::vector<Position>& out) const;
+    
+    /**
+     * @brief Prefetch the first group a lookup of hash will probe
+     */
+    void prefetch(uint32_t hash) const {
+        prefetch_read(&groups()[h1(hash) & (header_->group_count - 1)]);
+    }
+
+    /**
+     * @brief Insert an entry whose key is known to be absent
+     *
+     * May rehash, which invalidates previously returned positions.
+     */
+    void insert(uint32_t hash, ShmKeyValue* kv);
+
+    /**
+     * @brief Point a full slot at a different entry for the same key
+     */
+    void set(const Position& pos, ShmKeyValue* kv);
+
+    /**
+     * @brief Remove a slot; the caller frees the entry
+     */
+    void erase(const Position& pos);
+
+    /**
+     * @brief Mark every slot empty; the caller frees the entries first
+     */
+    void reset();
+
+    /**
+     * @brief Entry referenced by a full slot
+     */
+    ShmKeyValue* at(const Position& pos) const {
+        return reinterpret_cast<ShmKeyValue*>(base() + pos.group->slots[pos.index]);
+    }
+
+    /**
+     * @brief Total number of slots, full or not
+     */
+    uint32_t slot_count() const { return header_->group_count * SwissGroup::WIDTH; }
+    
+    /**
+     * @brief Position of a slot by index, or an empty position if it is not full
+     */
+    Position slot(uint32_t index) const {
+        SwissGroup* group = &groups()[index / SwissGroup::WIDTH];
+        uint32_t i = index % SwissGroup::WIDTH;
+        if (group->ctrl[i] & CTRL_EMPTY) return Position{};  // EMPTY or DELETED
+        return Position{group, i};
+    }
+    
+    /**
+     * @brief Visit every full slot; the callback returns false to stop
+     *
+     * Erasing the visited slot from the callback is allowed.
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        SwissGroup* groups = this->groups();
+        for (uint32_t g = 0; g < header_->group_count; g++) {
+            for (uint32_t bits = match_full(groups[g].ctrl); bits; bits &= bits - 1) {
+                if (!fn(Position{&groups[g], lowest_bit(bits)})) return;
+            }
+        }
+    }
+
+    /**
+     * @brief Visit every full slot on the shared thread pool
+     *
+     * Groups are split into chunks that run concurrently on
+     * ThreadPool::instance(); the caller holds the table lock for all of
+     * them. The callback must not modify the table and returns false to
+     * stop the sweep once the running chunks notice.
+     */
+    template<typename Fn>
+    void for_each_parallel(Fn&& fn) const {
+        SwissGroup* groups = this->groups();
+        uint32_t count = header_->group_count;
+        uint32_t chunk_groups = PARALLEL_CHUNK_BUCKETS / SwissGroup::WIDTH;
+        size_t chunks = (count + chunk_groups - 1) / chunk_groups;
+        std::atomic<bool> stop{false};
+
+        ThreadPool::instance().parallel_for(chunks, [&](size_t chunk) {
+            uint32_t first = static_cast<uint32_t>(chunk * chunk_groups);
+            uint32_t last = std::min(count, first + chunk_groups);
+            for (uint32_t g = first; g < last && !stop.load(std::memory_order_relaxed); g++) {
+                for (uint32_t bits = match_full(groups[g].ctrl); bits; bits &= bits - 1) {
+                    if (!fn(Position{&groups[g], lowest_bit(bits)})) {
+                        stop.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Visit the full slots of one step of a resumable scan
+     *
+     * Visits home groups (the first group each key probes) in
+     * next_scan_cursor() order from @p cursor, calling fn with every full
+     * slot whose key's home is that group, until fn returns false after a
+     * group or max_groups groups were visited.
+     *
+     * @return Cursor for the next step, or 0 once every group was visited
+     */
+    template<typename Fn>
+    uint64_t scan_from(uint64_t cursor, size_t max_groups, Fn&& fn) const {
+        uint32_t mask = header_->group_count - 1;
+        for (size_t n = 0; n < max_groups; n++) {
+            bool more = true;
+            for_each_homed(static_cast<uint32_t>(cursor & mask), [&](const Position& pos) {
+                more = fn(pos) && more;
+            });
+            cursor = next_scan_cursor(cursor, mask);
+            if (cursor == 0 || !more) break;
+        }
+        return cursor;
+    }
+
+private:
+    uint8_t* base() const {
+        return reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+    }
+
+    SwissGroup* groups() const {
+        return reinterpret_cast<SwissGroup*>(base() + header_->groups_offset);
+    }
+
+    // Full slots of keys whose home is group home, found along its probe sequence
+    void for_each_homed(uint32_t home, const std::function<void(const Position&)>& fn) const;
+
+    SwissGroup* allocate_groups(uint32_t count);
+    void rehash(uint32_t new_group_count);
+    void place(SwissGroup* groups, uint32_t group_count, uint32_t hash, int64_t offset);
+
+    static uint32_t h1(uint32_t hash) { return hash >> 7; }
+    static uint8_t h2(uint32_t hash) { return static_cast<uint8_t>(hash & 0x7F); }
+    static uint32_t lowest_bit(uint32_t bits);
+
+    // 16-bit masks with one bit per matching control byte
+    static uint32_t match_byte(const uint8_t* ctrl, uint8_t value);
+    static uint32_t match_empty_or_deleted(const uint8_t* ctrl);
+    static uint32_t match_full(const uint8_t* ctrl) {
+        return ~match_empty_or_deleted(ctrl) & 0xFFFFu;
+    }
+
+    MMapFileManager* file_manager_;
+    SwissHeader* header_;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_SWISS_H
@@ -0,0 +1,137 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Legal Notice: This module and the associated software architecture are proprietary
+ * and confidential. Unauthorized copying, distribution, modification, or use is
+ * strictly prohibited without explicit written permission from the copyright holder.
+ *
+ * Patent Pending: Certain architectural patterns and implementations described in
+ * this module may be subject to patent applications.
+ *
+ * @file fc_thread_pool.h
+ * @brief Process-wide worker pool for parallel bulk operations
+ *
+ * ============================================================================
+ * PARALLEL SWEEPS
+ * ============================================================================
+ *
+ * Full-table operations such as FastMap::parallelForEach() split the bucket
+ * array into chunks of PARALLEL_CHUNK_BUCKETS positions and hand them to
+ * parallel_for(). The chunk indices are divided into one contiguous range per
+ * lane (the calling thread is lane 0, each worker one more):
+ *
+ *   lane 0          lane 1          lane 2          lane 3
+ *   [0 .. 15]       [16 .. 31]      [32 .. 47]      [48 .. 63]
+ *     ^ next          ^ next          ^ next          ^ next
+ *
+ * A lane claims chunks from its own range with one fetch_add each, then
+ * steals from the other ranges the same way, so a lane that hit long chains
+ * or contended bucket locks is helped by the others instead of holding up
+ * the whole sweep.
+ *
+ * - Workers are started on first use and sleep between jobs.
+ * - One job runs at a time; concurrent callers wait their turn. A
+ *   parallel_for() from inside a task runs inline on that thread.
+ * - The first exception thrown by a task cancels the chunks not yet
+ *   claimed and is rethrown to the caller once every lane has stopped.
+ */
+
+#ifndef FASTCOLLECTION_THREAD_POOL_H
+#define FASTCOLLECTION_THREAD_POOL_H
+
+#include "fc_common.h"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fastcollection {
+
+/**
+ * @brief Work-stealing pool that runs the chunks of one job at a time
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief The pool used by the collections' parallel operations
+     *
+     * Starts with one lane per hardware thread; see set_parallelism().
+     */
+    static ThreadPool& instance();
+    
+    /**
+     * @brief Create a pool
+     * 
+     * @param parallelism Number of lanes including the calling thread;
+     *                    0 uses std::thread::hardware_concurrency()
+     */
+    explicit ThreadPool(size_t parallelism = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /**
+     * @brief Number of lanes a job is split across, including the caller
+     */
+    size_t parallelism() const;
+    
+    /**
+     * @brief Change the number of lanes
+     * 
+     * Waits for a running job to finish. 1 runs every job on the calling
+     * thread; 0 uses std::thread::hardware_concurrency().
+     */
+    void set_parallelism(size_t parallelism);
+    
+    /**
+     * @brief Run fn(0) .. fn(count - 1) across the lanes and wait for them
+     * 
+     * Tasks run concurrently and in no particular order, so fn must be
+     * thread-safe. Rethrows the first exception a task threw.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    // Chunk indices of one lane; padded so lanes do not share a cache line
+    struct alignas(64) Range {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+    
+    struct Job {
+        const std::function<void(size_t)>* fn = nullptr;
+        std::unique_ptr<Range[]> ranges;
+        size_t lanes = 0;
+        std::atomic<bool> failed{false};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+    
+    static size_t resolve(size_t parallelism);
+    
+    void run_lane(Job& job, size_t lane);
+    void worker_loop(size_t lane, uint64_t seen);
+    void start_workers();  // Requires run_mutex_
+    void stop_workers();   // Requires run_mutex_
+    
+    mutable std::mutex run_mutex_;  // Serializes jobs and reconfiguration
+    size_t parallelism_;
+    
+    std::mutex mutex_;              // Guards the fields below
+    std::condition_variable wake_;  // Workers: a job was posted or stopping
+    std::condition_variable done_;  // Caller: the last worker left the job
+    Job* job_ = nullptr;
+    uint64_t generation_ = 0;
+    size_t active_ = 0;             // Workers inside the current job
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace fastcollection
+
+#endif // FASTCOLLECTION_THREAD_POOL_H
@@ -5,12 +5,13 @@
  * Patent Pending
  * 
  * @file jni_collections.cpp
- * @brief JNI bindings for FastMap, FastSet, FastQueue, and FastStack with TTL support
+ * @brief JNI bindings for FastMap, FastSortedMap, FastSet, FastQueue, and FastStack with TTL support
  */
 
 #include <jni.h>
 #include "jni_common.h"
 #include "fc_map.h"
+#include "fc_sorted_map.h"
 #include "fc_set.h"
 #include "fc_queue.h"
 #include "fc_stack.h"
@@ -18,6 +19,30 @@
 using namespace fastcollection;
 using namespace fastcollection::jni;
 
+namespace {
+
+// Sorted map scans come back to Java as one flat byte[][]: key, value, key, value, ...
+FastSortedMap::EntryCallback collectEntries(std::vector<std::vector<uint8_t>>& entries, jint limit) {
+    return [&entries, limit](const uint8_t* key, size_t key_size,
+                             const uint8_t* value, size_t value_size) {
+        entries.emplace_back(key, key + key_size);
+        entries.emplace_back(value, value + value_size);
+        return limit <= 0 || entries.size() < 2 * static_cast<size_t>(limit);
+    };
+}
+
+// A single entry as byte[2][] {key, value}, or null
+jobjectArray entryToJobjectArray(JNIEnv* env, bool found,
+                                 std::vector<uint8_t>& key, std::vector<uint8_t>& value) {
+    if (!found) return nullptr;
+    std::vector<std::vector<uint8_t>> entry;
+    entry.push_back(std::move(key));
+    entry.push_back(std::move(value));
+    return vectorsToJobjectArray(env, entry);
+}
+
+} // namespace
+
 extern "C" {
 
 // ============================================================================
@@ -94,6 +119,48 @@ JNIEXPORT jbyteArray JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nat
     }
 }
 
+JNIEXPORT jbyteArray JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeGetWithVersion
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jlongArray versionOut) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        std::vector<uint8_t> result;
+        uint64_t version = 0;
+        
+        if (!keyAccess.valid()) return nullptr;
+        
+        if (map->getWithVersion(keyAccess.data(), keyAccess.length(), result, version)) {
+            jlong jversion = static_cast<jlong>(version);
+            env->SetLongArrayRegion(versionOut, 0, 1, &jversion);
+            return vectorToJbyteArray(env, result);
+        }
+        return nullptr;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativePutIfVersion
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jbyteArray value,
+   jlong expectedVersion, jint ttlSeconds) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        JByteArrayAccess valueAccess(env, value);
+        
+        if (!keyAccess.valid() || !valueAccess.valid()) return JNI_FALSE;
+        
+        return map->putIfVersion(keyAccess.data(), keyAccess.length(),
+                                 valueAccess.data(), valueAccess.length(),
+                                 static_cast<uint64_t>(expectedVersion), ttlSeconds)
+            ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
 JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeRemove
   (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
     try {
@@ -154,6 +221,124 @@ JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativ
     }
 }
 
+JNIEXPORT jlong JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeIncrementBy
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jlong delta, jint ttlSeconds) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return 0;
+        
+        return map->incrementBy(keyAccess.data(), keyAccess.length(), delta, ttlSeconds);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeGetAndSet
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jlong value, jint ttlSeconds) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return 0;
+        
+        return map->getAndSet(keyAccess.data(), keyAccess.length(), value, ttlSeconds);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeCompareAndSet
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jlong expected, jlong desired) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return JNI_FALSE;
+        
+        return map->compareAndSet(keyAccess.data(), keyAccess.length(), expected, desired)
+            ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeGetCounter
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return 0;
+        
+        return map->getCounter(keyAccess.data(), keyAccess.length()).value_or(0);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeMultiGet
+  (JNIEnv* env, jobject obj, jlong handle, jobjectArray keys) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        return optionalVectorsToJobjectArray(env, map->multiGet(jobjectArrayToVectors(env, keys)));
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeMultiPut
+  (JNIEnv* env, jobject obj, jlong handle, jobjectArray keys, jobjectArray values, jint ttlSeconds) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        return static_cast<jint>(map->multiPut(jobjectArrayToVectors(env, keys),
+                                               jobjectArrayToVectors(env, values), ttlSeconds));
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeMultiRemove
+  (JNIEnv* env, jobject obj, jlong handle, jobjectArray keys) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        return static_cast<jint>(map->multiRemove(jobjectArrayToVectors(env, keys)));
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeScan
+  (JNIEnv* env, jobject obj, jlong handle, jlong cursor, jint count, jlongArray cursorOut) {
+    try {
+        FastMap* map = reinterpret_cast<FastMap*>(handle);
+        std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> batch;
+        jlong next = static_cast<jlong>(map->scan(static_cast<uint64_t>(cursor),
+                                                  static_cast<size_t>(count), batch));
+        env->SetLongArrayRegion(cursorOut, 0, 1, &next);
+        
+        // Flattened as key, value, key, value, ...
+        std::vector<std::vector<uint8_t>> flat;
+        flat.reserve(batch.size() * 2);
+        for (auto& entry : batch) {
+            flat.push_back(std::move(entry.first));
+            flat.push_back(std::move(entry.second));
+        }
+        return vectorsToJobjectArray(env, flat);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
 JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeRemoveExpired
   (JNIEnv* env, jobject obj, jlong handle) {
     try {
@@ -189,6 +374,270 @@ JNIEXPORT void JNICALL Java_com_kuber_fastcollection_FastCollectionMap_nativeFlu
     catch (const std::exception& e) { throwException(env, e.what()); }
 }
 
+// ============================================================================
+// FastCollectionSortedMap JNI Methods
+// ============================================================================
+
+JNIEXPORT jlong JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeCreate
+  (JNIEnv* env, jclass clazz, jstring filePath, jlong initialSize, jboolean createNew) {
+    try {
+        std::string path = jstringToString(env, filePath);
+        FastSortedMap* map = new FastSortedMap(path, static_cast<size_t>(initialSize), createNew);
+        return reinterpret_cast<jlong>(map);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeDestroy
+  (JNIEnv* env, jclass clazz, jlong handle) {
+    delete reinterpret_cast<FastSortedMap*>(handle);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativePut
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jbyteArray value, jint ttlSeconds) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        JByteArrayAccess valueAccess(env, value);
+        
+        if (!keyAccess.valid()) return JNI_FALSE;
+        
+        return map->put(keyAccess.data(), keyAccess.length(),
+                       valueAccess.data(), valueAccess.length(), ttlSeconds) ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativePutIfAbsent
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jbyteArray value, jint ttlSeconds) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        JByteArrayAccess valueAccess(env, value);
+        
+        if (!keyAccess.valid()) return JNI_FALSE;
+        
+        return map->putIfAbsent(keyAccess.data(), keyAccess.length(),
+                               valueAccess.data(), valueAccess.length(), ttlSeconds) ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeGet
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        std::vector<uint8_t> result;
+        
+        if (!keyAccess.valid()) return nullptr;
+        
+        if (map->get(keyAccess.data(), keyAccess.length(), result)) {
+            return vectorToJbyteArray(env, result);
+        }
+        return nullptr;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeRemove
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return JNI_FALSE;
+        
+        return map->remove(keyAccess.data(), keyAccess.length()) ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeContainsKey
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return JNI_FALSE;
+        
+        return map->containsKey(keyAccess.data(), keyAccess.length()) ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeGetTTL
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return 0;
+        
+        return static_cast<jlong>(map->getTTL(keyAccess.data(), keyAccess.length()));
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeSetTTL
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key, jint ttlSeconds) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        
+        if (!keyAccess.valid()) return JNI_FALSE;
+        
+        return map->setTTL(keyAccess.data(), keyAccess.length(), ttlSeconds) ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeFirst
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        std::vector<uint8_t> key, value;
+        bool found = map->first(key, value);
+        return entryToJobjectArray(env, found, key, value);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeLast
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        std::vector<uint8_t> key, value;
+        bool found = map->last(key, value);
+        return entryToJobjectArray(env, found, key, value);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeFloor
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        std::vector<uint8_t> outKey, outValue;
+        
+        if (!keyAccess.valid()) return nullptr;
+        
+        bool found = map->floor(keyAccess.data(), keyAccess.length(), outKey, outValue);
+        return entryToJobjectArray(env, found, outKey, outValue);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeCeiling
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray key) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess keyAccess(env, key);
+        std::vector<uint8_t> outKey, outValue;
+        
+        if (!keyAccess.valid()) return nullptr;
+        
+        bool found = map->ceiling(keyAccess.data(), keyAccess.length(), outKey, outValue);
+        return entryToJobjectArray(env, found, outKey, outValue);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeRange
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray from, jbyteArray to,
+   jboolean descending, jint limit) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        // A null bound leaves that end of the range open
+        JByteArrayAccess fromAccess(env, from);
+        JByteArrayAccess toAccess(env, to);
+        std::vector<std::vector<uint8_t>> entries;
+        
+        map->range(fromAccess.data(), fromAccess.length(), toAccess.data(), toAccess.length(),
+                   collectEntries(entries, limit), descending);
+        return vectorsToJobjectArray(env, entries);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativePrefix
+  (JNIEnv* env, jobject obj, jlong handle, jbyteArray prefix, jboolean descending, jint limit) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        JByteArrayAccess prefixAccess(env, prefix);
+        std::vector<std::vector<uint8_t>> entries;
+        
+        map->prefix(prefixAccess.data(), prefixAccess.length(),
+                    collectEntries(entries, limit), descending);
+        return vectorsToJobjectArray(env, entries);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeRemoveExpired
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try {
+        FastSortedMap* map = reinterpret_cast<FastSortedMap*>(handle);
+        return static_cast<jint>(map->removeExpired());
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeClear
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try { reinterpret_cast<FastSortedMap*>(handle)->clear(); }
+    catch (const std::exception& e) { throwException(env, e.what()); }
+}
+
+JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeSize
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try { return static_cast<jint>(reinterpret_cast<FastSortedMap*>(handle)->size()); }
+    catch (const std::exception& e) { throwException(env, e.what()); return 0; }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeIsEmpty
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try { return reinterpret_cast<FastSortedMap*>(handle)->isEmpty() ? JNI_TRUE : JNI_FALSE; }
+    catch (const std::exception& e) { throwException(env, e.what()); return JNI_TRUE; }
+}
+
+JNIEXPORT void JNICALL Java_com_kuber_fastcollection_FastCollectionSortedMap_nativeFlush
+  (JNIEnv* env, jobject obj, jlong handle) {
+    try { reinterpret_cast<FastSortedMap*>(handle)->flush(); }
+    catch (const std::exception& e) { throwException(env, e.what()); }
+}
+
 // ============================================================================
 // FastCollectionSet JNI Methods
 // ============================================================================
@@ -285,6 +734,21 @@ JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionSet_nativ
     }
 }
 
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionSet_nativeScan
+  (JNIEnv* env, jobject obj, jlong handle, jlong cursor, jint count, jlongArray cursorOut) {
+    try {
+        FastSet* set = reinterpret_cast<FastSet*>(handle);
+        std::vector<std::vector<uint8_t>> batch;
+        jlong next = static_cast<jlong>(set->scan(static_cast<uint64_t>(cursor),
+                                                  static_cast<size_t>(count), batch));
+        env->SetLongArrayRegion(cursorOut, 0, 1, &next);
+        return vectorsToJobjectArray(env, batch);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
 JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionSet_nativeRemoveExpired
   (JNIEnv* env, jobject obj, jlong handle) {
     try { return static_cast<jint>(reinterpret_cast<FastSet*>(handle)->removeExpired()); }
@@ -414,6 +878,43 @@ JNIEXPORT jbyteArray JNICALL Java_com_kuber_fastcollection_FastCollectionQueue_n
     }
 }
 
+JNIEXPORT jint JNICALL Java_com_kuber_fastcollection_FastCollectionQueue_nativeOfferAll
+  (JNIEnv* env, jobject obj, jlong handle, jobjectArray elements, jint ttlSeconds) {
+    try {
+        FastQueue* queue = reinterpret_cast<FastQueue*>(handle);
+        return static_cast<jint>(queue->offerAll(jobjectArrayToVectors(env, elements), ttlSeconds));
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionQueue_nativePollBatch
+  (JNIEnv* env, jobject obj, jlong handle, jint maxElements) {
+    try {
+        FastQueue* queue = reinterpret_cast<FastQueue*>(handle);
+        std::vector<std::vector<uint8_t>> batch;
+        queue->pollBatch(batch, static_cast<size_t>(maxElements));
+        return vectorsToJobjectArray(env, batch);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_kuber_fastcollection_FastCollectionQueue_nativePeekBatch
+  (JNIEnv* env, jobject obj, jlong handle, jint maxElements) {
+    try {
+        FastQueue* queue = reinterpret_cast<FastQueue*>(handle);
+        std::vector<std::vector<uint8_t>> batch;
+        queue->peekBatch(batch, static_cast<size_t>(maxElements));
+        return vectorsToJobjectArray(env, batch);
+    } catch (const std::exception& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
 JNIEXPORT jlong JNICALL Java_com_kuber_fastcollection_FastCollectionQueue_nativePeekTTL
   (JNIEnv* env, jobject obj, jlong handle) {
     try { return static_cast<jlong>(reinterpret_cast<FastQueue*>(handle)->peekTTL()); }
@@ -139,6 +139,30 @@ JNIEXPORT jbyteArray JNICALL Java_com_kuber_fastcollection_FastCollectionList_na
     }
 }
 
+/*
+ * Class:     com_kuber_fastcollection_FastCollectionList
+ * Method:    nativeGetWithVersion
+ * Signature: (JI[J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_kuber_fastcollection_FastCollectionList_nativeGetWithVersion
+  (JNIEnv* env, jobject obj, jlong handle, jint index, jlongArray versionOut) {
+    try {
+        FastList* list = reinterpret_cast<FastList*>(handle);
+        std::vector<uint8_t> result;
+        uint64_t version = 0;
+        
+        if (list->getWithVersion(static_cast<size_t>(index), result, version)) {
+            jlong jversion = static_cast<jlong>(version);
+            env->SetLongArrayRegion(versionOut, 0, 1, &jversion);
+            return vectorToJbyteArray(env, result);
+        }
+        return nullptr;
+    } catch (const FastCollectionException& e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+}
+
 /*
  * Class:     com_kuber_fastcollection_FastCollectionList
  * Method:    nativeGetFirst
@@ -205,6 +229,32 @@ JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionList_nati
     }
 }
 
+/*
+ * Class:     com_kuber_fastcollection_FastCollectionList
+ * Method:    nativeSetIfVersion
+ * Signature: (JI[BJI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_kuber_fastcollection_FastCollectionList_nativeSetIfVersion
+  (JNIEnv* env, jobject obj, jlong handle, jint index, jbyteArray data,
+   jlong expectedVersion, jint ttlSeconds) {
+    try {
+        FastList* list = reinterpret_cast<FastList*>(handle);
+        JByteArrayAccess dataAccess(env, data);
+        
+        if (!dataAccess.valid()) {
+            throwException(env, "Invalid data array");
+            return JNI_FALSE;
+        }
+        
+        return list->setIfVersion(static_cast<size_t>(index), dataAccess.data(), dataAccess.length(),
+                                  static_cast<uint64_t>(expectedVersion), ttlSeconds)
+               ? JNI_TRUE : JNI_FALSE;
+    } catch (const FastCollectionException& e) {
+        throwException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
 /*
  * Class:     com_kuber_fastcollection_FastCollectionList
  * Method:    nativeRemove
@@ -0,0 +1,103 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_cache.cpp
+ * @brief Implementation of the frequency sketch used by cache-mode maps
+ */
+
+#include "fc_cache.h"
+#include "fc_serialization.h"
+#include <algorithm>
+#include <bit>
+
+namespace fastcollection {
+
+namespace {
+
+// Odd multipliers giving each sketch row an independent index
+constexpr uint64_t ROW_SEEDS[FrequencySketch::DEPTH] = {
+    0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full,
+    0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+};
+
+} // namespace
+
+FrequencySketch::FrequencySketch(MMapFileManager* file_manager, CacheHeader* header)
+    : header_(header) {
+    if (header_->eviction_policy() != EvictionPolicy::TINY_LFU) return;
+
+    uint8_t* base = reinterpret_cast<uint8_t*>(file_manager->segment_manager());
+
+    if (header_->sketch_offset < 0) {
+        // One counter per expected entry; a byte budget is converted using the
+        // smallest possible entry node
+        uint64_t entries = header_->max_entries;
+        if (entries == 0) {
+            entries = header_->max_bytes / ShmKeyValue::total_size(0, 0);
+        }
+        uint64_t width = std::clamp<uint64_t>(entries, MIN_WIDTH, MAX_WIDTH);
+        width = std::bit_ceil(width);
+
+        void* mem = file_manager->allocate(DEPTH * width);
+        if (!mem) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+                "Failed to allocate cache frequency sketch"
+            );
+        }
+        auto* counters = static_cast<std::atomic<uint8_t>*>(mem);
+        for (uint64_t i = 0; i < DEPTH * width; i++) {
+            new(&counters[i]) std::atomic<uint8_t>(0);
+        }
+
+        header_->sketch_width = static_cast<uint32_t>(width);
+        header_->sketch_offset = static_cast<uint8_t*>(mem) - base;
+    }
+
+    counters_ = reinterpret_cast<std::atomic<uint8_t>*>(base + header_->sketch_offset);
+}
+
+uint32_t FrequencySketch::index(uint32_t hash, uint32_t row) const {
+    uint64_t mixed = (static_cast<uint64_t>(hash) + 1) * ROW_SEEDS[row];
+    return row * header_->sketch_width +
+           static_cast<uint32_t>((mixed >> 32) & (header_->sketch_width - 1));
+}
+
+void FrequencySketch::increment(uint32_t hash) {
+    for (uint32_t row = 0; row < DEPTH; row++) {
+        std::atomic<uint8_t>& counter = counters_[index(hash, row)];
+        uint8_t count = counter.load(std::memory_order_relaxed);
+        if (count < MAX_COUNT) {
+            counter.store(count + 1, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t sample = SAMPLE_FACTOR * header_->sketch_width;
+    if (header_->sketch_events.fetch_add(1, std::memory_order_relaxed) + 1 == sample) {
+        halve();
+        header_->sketch_events.fetch_sub(sample / 2, std::memory_order_relaxed);
+    }
+}
+
+uint32_t FrequencySketch::frequency(uint32_t hash) const {
+    uint32_t estimate = MAX_COUNT;
+    for (uint32_t row = 0; row < DEPTH; row++) {
+        estimate = std::min<uint32_t>(
+            estimate, counters_[index(hash, row)].load(std::memory_order_relaxed));
+    }
+    return estimate;
+}
+
+void FrequencySketch::halve() {
+    // Aging: recent accesses outweigh those from before the last sample
+    uint64_t total = static_cast<uint64_t>(DEPTH) * header_->sketch_width;
+    for (uint64_t i = 0; i < total; i++) {
+        counters_[i].store(counters_[i].load(std::memory_order_relaxed) >> 1,
+                           std::memory_order_relaxed);
+    }
+}
+
+} // namespace fastcollection
@@ -15,14 +15,106 @@
 
 #include "fc_common.h"
 #include "fc_serialization.h"
+#include "fc_slab.h"
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <filesystem>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace fastcollection {
 
+// ============================================================================
+// ShmSpinLock
+// ============================================================================
+
+namespace {
+
+// Rounds of spinning before a waiter goes to sleep
+constexpr int SPIN_LIMIT = 100;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // anonymous namespace
+
+void ShmSpinLock::lock_slow() {
+    // Spin while the holder is likely to release soon
+    for (int i = 0; i < SPIN_LIMIT; i++) {
+        cpu_relax();
+        uint32_t expected = UNLOCKED;
+        if (state_.load(std::memory_order_relaxed) == UNLOCKED &&
+            state_.compare_exchange_weak(expected, LOCKED, std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    
+    // Mark the lock contended so the holder wakes us, then sleep until free.
+    // The futex is not FUTEX_PRIVATE: waiters may be in other processes
+    while (state_.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED) {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_), FUTEX_WAIT,
+                CONTENDED, nullptr, nullptr, 0);
+#else
+        std::this_thread::yield();
+#endif
+    }
+}
+
+void ShmSpinLock::wake_one() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+// ============================================================================
+// ShmEventCount
+// ============================================================================
+
+void ShmEventCount::wait(uint32_t key, int64_t timeout_ns) {
+    if (sequence_.load(std::memory_order_acquire) == key) {
+#ifdef __linux__
+        // FUTEX_WAIT returns at once if the sequence moved past key
+        struct timespec timeout;
+        struct timespec* relative = nullptr;
+        if (timeout_ns >= 0) {
+            timeout.tv_sec = static_cast<time_t>(timeout_ns / 1000000000LL);
+            timeout.tv_nsec = static_cast<long>(timeout_ns % 1000000000LL);
+            relative = &timeout;
+        }
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence_), FUTEX_WAIT,
+                key, relative, nullptr, 0);
+#else
+        int64_t nap = timeout_ns >= 0 ? std::min<int64_t>(timeout_ns, 1000000) : 1000000;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(nap));
+#endif
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ShmEventCount::wake(int32_t count) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence_), FUTEX_WAKE, count,
+            nullptr, nullptr, 0);
+#else
+    (void)count;
+#endif
+}
+
 MMapFileManager::MMapFileManager(const std::string& filename, 
                                   size_t initial_size,
                                   bool create_new)
@@ -54,6 +146,19 @@ MMapFileManager::MMapFileManager(const std::string& filename,
             std::string("Failed to create/open memory-mapped file: ") + e.what()
         );
     }
+    
+    try {
+        slabs_ = std::make_unique<SlabAllocator>(file_->get_segment_manager());
+    } catch (const bip::bad_alloc&) {
+        // A full file from before the slabs: make room for the heap
+        if (!grow(sizeof(SlabHeap) + growth_size_)) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+                "No room for the slab heap in mapped file"
+            );
+        }
+        slabs_ = std::make_unique<SlabAllocator>(file_->get_segment_manager());
+    }
 }
 
 MMapFileManager::~MMapFileManager() {
@@ -69,6 +174,7 @@ MMapFileManager::~MMapFileManager() {
 MMapFileManager::MMapFileManager(MMapFileManager&& other) noexcept
     : filename_(std::move(other.filename_))
     , file_(std::move(other.file_))
+    , slabs_(std::move(other.slabs_))
     , growth_size_(other.growth_size_) {
 }
 
@@ -76,6 +182,7 @@ MMapFileManager& MMapFileManager::operator=(MMapFileManager&& other) noexcept {
     if (this != &other) {
         filename_ = std::move(other.filename_);
         file_ = std::move(other.file_);
+        slabs_ = std::move(other.slabs_);
         growth_size_ = other.growth_size_;
     }
     return *this;
@@ -86,6 +193,10 @@ SegmentManager* MMapFileManager::segment_manager() {
 }
 
 void* MMapFileManager::allocate(size_t bytes) {
+    if (void* block = slabs_->allocate(bytes)) {
+        return block;
+    }
+    
     try {
         return file_->allocate(bytes);
     } catch (const bip::bad_alloc&) {
@@ -100,8 +211,64 @@ void* MMapFileManager::allocate(size_t bytes) {
     }
 }
 
+void* MMapFileManager::allocate_aligned(size_t bytes, size_t alignment) {
+    try {
+        return file_->allocate_aligned(bytes, alignment);
+    } catch (const bip::bad_alloc&) {
+        if (grow(bytes + alignment + growth_size_)) {
+            return file_->allocate_aligned(bytes, alignment);
+        }
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+            "Failed to allocate memory in mapped file"
+        );
+    }
+}
+
+void MMapFileManager::allocate_many(const std::vector<size_t>& sizes, std::vector<void*>& out) {
+    out.assign(sizes.size(), nullptr);
+    if (sizes.empty()) return;
+    
+    // Small blocks from the slab classes, the rest from Boost in one call
+    std::vector<size_t> large;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        out[i] = slabs_->allocate(sizes[i]);
+        if (!out[i]) large.push_back(sizes[i]);
+    }
+    if (large.empty()) return;
+    
+    SegmentManager::multiallocation_chain chain;
+    try {
+        file_->get_segment_manager()->allocate_many(large.data(), large.size(), 1, chain);
+    } catch (const bip::bad_alloc&) {
+        // Room for the blocks plus the allocator's per-block header
+        size_t total = 0;
+        for (size_t bytes : large) total += bytes + 64;
+        
+        // Growing remaps the file; move the slab blocks along with it
+        uint8_t* old_base = reinterpret_cast<uint8_t*>(segment_manager());
+        bool grown = grow(total + growth_size_);
+        uint8_t* new_base = reinterpret_cast<uint8_t*>(segment_manager());
+        for (void*& block : out) {
+            if (block) block = new_base + (static_cast<uint8_t*>(block) - old_base);
+        }
+        if (!grown) {
+            for (void* block : out) deallocate(block);
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+                "Failed to allocate memory in mapped file"
+            );
+        }
+        file_->get_segment_manager()->allocate_many(large.data(), large.size(), 1, chain);
+    }
+    
+    for (void*& block : out) {
+        if (!block) block = bip::ipcdetail::to_raw_pointer(chain.pop_front());
+    }
+}
+
 void MMapFileManager::deallocate(void* ptr) {
-    if (ptr) {
+    if (ptr && !slabs_->deallocate(ptr)) {
         file_->deallocate(ptr);
     }
 }
@@ -119,6 +286,7 @@ bool MMapFileManager::grow(size_t additional_bytes) {
             bip::open_only,
             filename_.c_str()
         );
+        if (slabs_) slabs_->remap(file_->get_segment_manager());
         
         return true;
     } catch (const bip::interprocess_exception&) {
@@ -127,6 +295,7 @@ bool MMapFileManager::grow(size_t additional_bytes) {
             bip::open_only,
             filename_.c_str()
         );
+        if (slabs_) slabs_->remap(file_->get_segment_manager());
         return false;
     }
 }
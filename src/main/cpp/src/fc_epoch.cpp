@@ -0,0 +1,246 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_epoch.cpp
+ * @brief Implementation of cross-process epoch-based reclamation
+ */
+
+#include "fc_epoch.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace fastcollection {
+
+using IpcScopedLock = bip::scoped_lock<IpcMutex>;
+
+namespace {
+
+uint64_t current_owner_token() {
+#ifdef _WIN32
+    return static_cast<uint64_t>(_getpid()) + 1;
+#else
+    return static_cast<uint64_t>(getpid()) + 1;
+#endif
+}
+
+bool owner_alive(uint64_t owner) {
+#ifdef _WIN32
+    (void)owner;
+    return true;  // No cheap liveness probe; leave the slot alone
+#else
+    pid_t pid = static_cast<pid_t>(owner - 1);
+    return kill(pid, 0) == 0 || errno != ESRCH;
+#endif
+}
+
+std::atomic<uint64_t> next_domain_id{1};
+
+// Spreads the first slot each thread tries over the slots
+std::atomic<uint32_t> next_slot_hint{0};
+
+} // namespace
+
+/**
+ * @brief A thread's state in one domain: nesting depth and the slot it holds
+ */
+struct EpochDomain::ThreadEntry {
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    uint64_t domain_id;
+    std::weak_ptr<bool> domain_alive;
+    uint32_t depth = 0;
+    uint32_t slot = NO_SLOT;   // Held while depth > 0, unless counted in overflow
+    uint32_t hint = 0;         // Slot to try first on the next entry
+    uint64_t overflow_epoch = 0;
+};
+
+EpochDomain::EpochDomain(MMapFileManager* file_manager, EpochHeader* header, size_t link_offset)
+    : file_manager_(file_manager)
+    , header_(header)
+    , link_offset_(link_offset)
+    , id_(next_domain_id.fetch_add(1, std::memory_order_relaxed))
+    , owner_(current_owner_token())
+    , alive_(std::make_shared<bool>(true)) {
+    scavenge_dead_slots();
+}
+
+EpochDomain::~EpochDomain() {
+    reclaim();
+}
+
+std::vector<std::unique_ptr<EpochDomain::ThreadEntry>>& EpochDomain::thread_entries() {
+    thread_local std::vector<std::unique_ptr<ThreadEntry>> entries;
+    return entries;
+}
+
+EpochDomain::ThreadEntry* EpochDomain::thread_entry() const {
+    auto& entries = thread_entries();
+    for (auto& entry : entries) {
+        if (entry->domain_id == id_) return entry.get();
+    }
+
+    // First read on this domain from this thread: drop entries of closed domains
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const std::unique_ptr<ThreadEntry>& e) {
+                                     return e->domain_alive.expired();
+                                 }),
+                  entries.end());
+
+    auto entry = std::make_unique<ThreadEntry>();
+    entry->domain_id = id_;
+    entry->domain_alive = alive_;
+    entry->hint = next_slot_hint.fetch_add(1, std::memory_order_relaxed) % EpochHeader::MAX_READERS;
+    entries.push_back(std::move(entry));
+    return entries.back().get();
+}
+
+void EpochDomain::enter(ThreadEntry& entry) const {
+    // Claim a free slot, starting with the one this thread used last
+    for (uint32_t n = 0; n < EpochHeader::MAX_READERS; n++) {
+        uint32_t i = (entry.hint + n) % EpochHeader::MAX_READERS;
+        EpochSlot& slot = header_->slots[i];
+        uint64_t expected = 0;
+        if (slot.owner.load(std::memory_order_relaxed) != 0 ||
+            !slot.owner.compare_exchange_strong(expected, owner_, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            continue;
+        }
+        entry.slot = i;
+        entry.hint = i;
+
+        // Announce the current epoch, re-checking in case it advanced meanwhile
+        uint64_t epoch = header_->global_epoch.load(std::memory_order_seq_cst);
+        for (;;) {
+            slot.epoch.store(epoch, std::memory_order_seq_cst);
+            uint64_t now = header_->global_epoch.load(std::memory_order_seq_cst);
+            if (now == epoch) return;
+            epoch = now;
+        }
+    }
+
+    // Every slot is taken: count this reader under its epoch instead
+    entry.slot = ThreadEntry::NO_SLOT;
+    uint64_t epoch = header_->global_epoch.load(std::memory_order_seq_cst);
+    for (;;) {
+        std::atomic<uint64_t>& counter = header_->overflow[epoch % EpochHeader::LIMBO_LISTS];
+        counter.fetch_add(1, std::memory_order_seq_cst);
+        uint64_t now = header_->global_epoch.load(std::memory_order_seq_cst);
+        if (now == epoch) break;
+        counter.fetch_sub(1, std::memory_order_seq_cst);
+        epoch = now;
+    }
+    entry.overflow_epoch = epoch;
+}
+
+void EpochDomain::leave(ThreadEntry& entry) const {
+    if (entry.slot == ThreadEntry::NO_SLOT) {
+        header_->overflow[entry.overflow_epoch % EpochHeader::LIMBO_LISTS].fetch_sub(
+            1, std::memory_order_release);
+        return;
+    }
+
+    EpochSlot& slot = header_->slots[entry.slot];
+    slot.epoch.store(0, std::memory_order_release);
+    slot.owner.store(0, std::memory_order_release);
+    entry.slot = ThreadEntry::NO_SLOT;
+}
+
+void EpochDomain::scavenge_dead_slots() {
+    for (uint32_t i = 0; i < EpochHeader::MAX_READERS; i++) {
+        uint64_t owner = header_->slots[i].owner.load(std::memory_order_acquire);
+        if (owner == 0 || owner == owner_ || owner_alive(owner)) continue;
+
+        header_->slots[i].epoch.store(0, std::memory_order_release);
+        header_->slots[i].owner.compare_exchange_strong(
+            owner, 0, std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+}
+
+EpochDomain::ReadGuard::ReadGuard(const EpochDomain& domain)
+    : domain_(&domain)
+    , entry_(domain.thread_entry()) {
+    if (entry_->depth++ == 0) {
+        domain_->enter(*entry_);
+    }
+}
+
+EpochDomain::ReadGuard::~ReadGuard() {
+    if (--entry_->depth == 0) {
+        domain_->leave(*entry_);
+    }
+}
+
+void EpochDomain::retire(void* node) {
+    int64_t offset = static_cast<uint8_t*>(node) -
+                     reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+
+    IpcScopedLock lock(header_->limbo_mutex);
+    uint32_t list = header_->global_epoch.load(std::memory_order_acquire) % EpochHeader::LIMBO_LISTS;
+    link_of(offset)->store(header_->limbo_head[list], std::memory_order_relaxed);
+    header_->limbo_head[list] = offset;
+
+    if (++header_->limbo_count[list] >= RECLAIM_THRESHOLD) {
+        try_advance();
+    }
+}
+
+size_t EpochDomain::reclaim() {
+    IpcScopedLock lock(header_->limbo_mutex);
+
+    // Three quiescent advances drain every limbo list
+    size_t freed = 0;
+    for (uint32_t i = 0; i < EpochHeader::LIMBO_LISTS; i++) {
+        uint64_t before = header_->global_epoch.load(std::memory_order_acquire);
+        freed += try_advance();
+        if (header_->global_epoch.load(std::memory_order_acquire) == before) break;
+    }
+    return freed;
+}
+
+size_t EpochDomain::try_advance() {
+    uint64_t epoch = header_->global_epoch.load(std::memory_order_seq_cst);
+
+    for (uint32_t i = 0; i < EpochHeader::MAX_READERS; i++) {
+        uint64_t announced = header_->slots[i].epoch.load(std::memory_order_seq_cst);
+        if (announced != 0 && announced != epoch) return 0;
+    }
+    for (uint32_t i = 1; i < EpochHeader::LIMBO_LISTS; i++) {
+        if (header_->overflow[(epoch + i) % EpochHeader::LIMBO_LISTS].load(std::memory_order_seq_cst) != 0) {
+            return 0;
+        }
+    }
+
+    // Every active reader is in `epoch`, so nodes retired two epochs ago are unreachable
+    size_t freed = free_list((epoch + 1) % EpochHeader::LIMBO_LISTS);
+    header_->global_epoch.store(epoch + 1, std::memory_order_seq_cst);
+    return freed;
+}
+
+size_t EpochDomain::free_list(uint32_t list) {
+    uint8_t* base = reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+    size_t freed = 0;
+
+    int64_t current = header_->limbo_head[list];
+    while (current >= 0) {
+        int64_t next = link_of(current)->load(std::memory_order_relaxed);
+        file_manager_->deallocate(base + current);
+        current = next;
+        freed++;
+    }
+
+    header_->limbo_head[list] = -1;
+    header_->limbo_count[list] = 0;
+    return freed;
+}
+
+} // namespace fastcollection
@@ -0,0 +1,272 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_expiry.cpp
+ * @brief Implementation of the persistent expiration index
+ */
+
+#include "fc_expiry.h"
+#include <algorithm>
+#include <cstring>
+
+namespace fastcollection {
+
+using IpcScopedLock = bip::scoped_lock<IpcMutex>;
+
+ExpiryIndex::ExpiryIndex(MMapFileManager* file_manager, ExpiryHeader* header, bool by_hash)
+    : file_manager_(file_manager), header_(header), by_hash_(by_hash) {
+    if (!header_->is_valid()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INTERNAL_ERROR,
+            "Invalid expiry index header in file"
+        );
+    }
+}
+
+void ExpiryIndex::reset() {
+    for (ExpiryShard& shard : header_->shards) {
+        IpcScopedLock lock(shard.mutex);
+        header_->records.fetch_sub(shard.count + shard.due_count, std::memory_order_relaxed);
+        header_->due.fetch_sub(shard.due_count, std::memory_order_relaxed);
+        shard.count = 0;
+        shard.due_count = 0;
+        publish(shard);
+    }
+}
+
+uint64_t ExpiryIndex::next_expiry() const {
+    uint64_t next = CollectionHeader::NO_EXPIRY;
+    for (ExpiryShard& shard : header_->shards) {
+        IpcScopedLock lock(shard.mutex);
+        if (shard.due_count > 0) {
+            next = std::min(next, due_records(shard)[0].expires_at);
+        }
+        if (shard.count > 0) {
+            next = std::min(next, records(shard)[0].expires_at);
+        }
+    }
+    return next;
+}
+
+uint64_t ExpiryIndex::count_due(uint64_t now) const {
+    for (ExpiryShard& shard : header_->shards) {
+        if (shard.next_due.load(std::memory_order_acquire) > now) continue;
+        IpcScopedLock lock(shard.mutex);
+        settle(shard, now);
+    }
+    return header_->due.load(std::memory_order_acquire);
+}
+
+void ExpiryIndex::track(ShmEntry* entry) {
+    ExpiryShard& shard = shard_of(entry);
+    IpcScopedLock lock(shard.mutex);
+    uint32_t index = position_of(shard, entry);
+
+    if (index != ShmEntry::NOT_INDEXED && (index & DUE_BIT)) {
+        // A new due time takes the record back to the heap
+        erase_due(shard, index & ~DUE_BIT);
+        index = ShmEntry::NOT_INDEXED;
+    }
+
+    if (index == ShmEntry::NOT_INDEXED) {
+        entry->expiry_index = ShmEntry::NOT_INDEXED;
+        if (entry->expires_at != 0) {
+            uint64_t offset = reinterpret_cast<uint8_t*>(entry) - base();
+            push(shard, ExpiryRecord{entry->expires_at, offset});
+        }
+        return;
+    }
+
+    if (entry->expires_at == 0) {
+        erase(shard, index);
+        return;
+    }
+
+    records(shard)[index].expires_at = entry->expires_at;
+    sift_up(shard, index);
+    sift_down(shard, entry->expiry_index);
+    publish(shard);
+}
+
+void ExpiryIndex::untrack(ShmEntry* entry) {
+    ExpiryShard& shard = shard_of(entry);
+    IpcScopedLock lock(shard.mutex);
+    uint32_t index = position_of(shard, entry);
+
+    if (index == ShmEntry::NOT_INDEXED) return;
+    if (index & DUE_BIT) {
+        erase_due(shard, index & ~DUE_BIT);
+    } else {
+        erase(shard, index);
+    }
+}
+
+void ExpiryIndex::pop_due(uint64_t now, std::vector<uint32_t>& hashes, size_t max_records) {
+    size_t limit = hashes.size() + std::min(max_records, SIZE_MAX - hashes.size());
+    for (ExpiryShard& shard : header_->shards) {
+        if (hashes.size() >= limit) break;
+        if (shard.next_due.load(std::memory_order_acquire) > now &&
+            header_->due.load(std::memory_order_acquire) == 0) continue;
+
+        IpcScopedLock lock(shard.mutex);
+        settle(shard, now);
+        while (hashes.size() < limit && shard.due_count > 0) {
+            hashes.push_back(entry_at(due_records(shard)[shard.due_count - 1].ref)->hash_code);
+            erase_due(shard, shard.due_count - 1);
+        }
+    }
+}
+
+ShmEntry* ExpiryIndex::pop_due(uint64_t now) {
+    for (ExpiryShard& shard : header_->shards) {
+        if (shard.next_due.load(std::memory_order_acquire) > now &&
+            header_->due.load(std::memory_order_acquire) == 0) continue;
+
+        IpcScopedLock lock(shard.mutex);
+        settle(shard, now);
+        if (shard.due_count > 0) {
+            ShmEntry* entry = entry_at(due_records(shard)[shard.due_count - 1].ref);
+            erase_due(shard, shard.due_count - 1);
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t ExpiryIndex::position_of(const ExpiryShard& shard, const ShmEntry* entry) const {
+    uint32_t index = entry->expiry_index;
+    uint64_t offset = reinterpret_cast<const uint8_t*>(entry) - base();
+
+    // Positions survive reset() and may be garbage in nodes written before
+    // the field existed, so only trust one the arrays agree with
+    if (index == ShmEntry::NOT_INDEXED) return index;
+    if (index & DUE_BIT) {
+        uint32_t due = index & ~DUE_BIT;
+        if (due < shard.due_count && due_records(shard)[due].ref == offset) return index;
+    } else if (index < shard.count && records(shard)[index].ref == offset) {
+        return index;
+    }
+    return ShmEntry::NOT_INDEXED;
+}
+
+void ExpiryIndex::settle(ExpiryShard& shard, uint64_t now) const {
+    while (shard.count > 0 && records(shard)[0].expires_at <= now) {
+        ExpiryRecord record = records(shard)[0];
+        erase(shard, 0);
+        push_due(shard, record);
+    }
+}
+
+void ExpiryIndex::grow(int64_t& offset, uint32_t& capacity, uint32_t count) const {
+    if (count < capacity) return;
+
+    uint32_t grown = std::max(MIN_CAPACITY, capacity * 2);
+    void* mem = file_manager_->allocate(grown * sizeof(ExpiryRecord));
+    if (!mem) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+            "Failed to allocate expiry index"
+        );
+    }
+
+    if (offset >= 0) {
+        void* old = base() + offset;
+        std::memcpy(mem, old, count * sizeof(ExpiryRecord));
+        file_manager_->deallocate(old);
+    }
+
+    offset = static_cast<uint8_t*>(mem) - base();
+    capacity = grown;
+}
+
+void ExpiryIndex::push(ExpiryShard& shard, const ExpiryRecord& record) const {
+    grow(shard.records_offset, shard.capacity, shard.count);
+    place(shard, shard.count, record);
+    shard.count++;
+    header_->records.fetch_add(1, std::memory_order_relaxed);
+    sift_up(shard, shard.count - 1);
+    publish(shard);
+}
+
+void ExpiryIndex::erase(ExpiryShard& shard, uint32_t index) const {
+    ExpiryRecord* heap = records(shard);
+    entry_at(heap[index].ref)->expiry_index = ShmEntry::NOT_INDEXED;
+
+    shard.count--;
+    header_->records.fetch_sub(1, std::memory_order_relaxed);
+    if (index < shard.count) {
+        // Move the last record into the hole; it may belong above or below it
+        place(shard, index, heap[shard.count]);
+        sift_up(shard, index);
+        sift_down(shard, entry_at(heap[index].ref)->expiry_index);
+    }
+    publish(shard);
+}
+
+void ExpiryIndex::push_due(ExpiryShard& shard, const ExpiryRecord& record) const {
+    grow(shard.due_offset, shard.due_capacity, shard.due_count);
+    due_records(shard)[shard.due_count] = record;
+    entry_at(record.ref)->expiry_index = DUE_BIT | shard.due_count;
+    shard.due_count++;
+    header_->records.fetch_add(1, std::memory_order_relaxed);
+    header_->due.fetch_add(1, std::memory_order_release);
+}
+
+void ExpiryIndex::erase_due(ExpiryShard& shard, uint32_t index) const {
+    ExpiryRecord* due = due_records(shard);
+    entry_at(due[index].ref)->expiry_index = ShmEntry::NOT_INDEXED;
+
+    shard.due_count--;
+    header_->records.fetch_sub(1, std::memory_order_relaxed);
+    header_->due.fetch_sub(1, std::memory_order_release);
+    if (index < shard.due_count) {
+        due[index] = due[shard.due_count];
+        entry_at(due[index].ref)->expiry_index = DUE_BIT | index;
+    }
+}
+
+void ExpiryIndex::sift_up(ExpiryShard& shard, uint32_t index) const {
+    ExpiryRecord* heap = records(shard);
+    ExpiryRecord record = heap[index];
+
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (heap[parent].expires_at <= record.expires_at) break;
+        place(shard, index, heap[parent]);
+        index = parent;
+    }
+    place(shard, index, record);
+}
+
+void ExpiryIndex::sift_down(ExpiryShard& shard, uint32_t index) const {
+    ExpiryRecord* heap = records(shard);
+    ExpiryRecord record = heap[index];
+
+    for (;;) {
+        uint32_t child = 2 * index + 1;
+        if (child >= shard.count) break;
+        if (child + 1 < shard.count && heap[child + 1].expires_at < heap[child].expires_at) {
+            child++;
+        }
+        if (record.expires_at <= heap[child].expires_at) break;
+        place(shard, index, heap[child]);
+        index = child;
+    }
+    place(shard, index, record);
+}
+
+void ExpiryIndex::place(ExpiryShard& shard, uint32_t index, const ExpiryRecord& record) const {
+    records(shard)[index] = record;
+    entry_at(record.ref)->expiry_index = index;
+}
+
+void ExpiryIndex::publish(ExpiryShard& shard) const {
+    shard.next_due.store(shard.count > 0 ? records(shard)[0].expires_at
+                                         : CollectionHeader::NO_EXPIRY,
+                         std::memory_order_release);
+}
+
+} // namespace fastcollection
@@ -14,12 +14,15 @@
  */
 
 #include "fc_list.h"
+#include <algorithm>
 #include <cstring>
 
 namespace fastcollection {
 
-// Scoped lock type alias for cleaner code
+// Scoped lock type aliases for cleaner code: writers hold the list lock
+// exclusively, readers share it
 using IpcScopedLock = bip::scoped_lock<IpcSharedMutex>;
+using IpcSharableLock = bip::sharable_lock<IpcSharedMutex>;
 
 FastList::FastList(const std::string& mmap_file, 
                    size_t initial_size,
@@ -28,6 +31,7 @@ FastList::FastList(const std::string& mmap_file,
     
     // Find or create the list header
     auto result = file_manager_->find<ListHeader>("list_header");
+    bool existing = result.first != nullptr;
     
     if (result.first) {
         header_ = result.first;
@@ -37,33 +41,52 @@ FastList::FastList(const std::string& mmap_file,
                 "Invalid list header in file"
             );
         }
+        // Nodes now come from the slab heap, which older builds would corrupt
+        header_->mark_current();
     } else {
         // Create new header
         header_ = file_manager_->find_or_construct<ListHeader>("list_header");
     }
+    hasher_ = Hasher::open(file_manager_.get(), "list_hash", existing);
+    
+    // Files written before the index existed start with an incomplete one
+    expiry_ = ExpiryIndex(file_manager_.get(),
+                          file_manager_->find_or_construct<ExpiryHeader>("list_expiry_index", !existing),
+                          false);
+    versions_ = file_manager_->find_or_construct<VersionClock>("list_versions");
+    positions_ = PositionIndex(file_manager_.get(),
+                               file_manager_->find_or_construct<PositionHeader>("list_positions", !existing));
     
     stats_.size.store(header_->size.load(), std::memory_order_relaxed);
 }
 
 FastList::~FastList() {
+    // The reaper works on this list until it is joined
+    reaper_.reset();
     if (file_manager_) {
         flush();
     }
 }
 
 FastList::FastList(FastList&& other) noexcept
-    : file_manager_(std::move(other.file_manager_))
-    , header_(other.header_)
-    , access_cache_(other.access_cache_) {
-    other.header_ = nullptr;
+    : header_(nullptr) {
+    *this = std::move(other);
 }
 
 FastList& FastList::operator=(FastList&& other) noexcept {
     if (this != &other) {
+        // Reapers are bound to the object that started them
+        reaper_.reset();
+        other.reaper_.reset();
+        
         file_manager_ = std::move(other.file_manager_);
         header_ = other.header_;
-        access_cache_ = other.access_cache_;
+        hasher_ = other.hasher_;
+        expiry_ = other.expiry_;
+        positions_ = other.positions_;
+        versions_ = other.versions_;
         other.header_ = nullptr;
+        other.versions_ = nullptr;
     }
     return *this;
 }
@@ -85,50 +108,12 @@ ShmNode* FastList::node_at_offset(int64_t offset) const {
     return node;
 }
 
-ShmNode* FastList::node_at_index(size_t index) const {
-    void* base = file_manager_->segment_manager();
-    
-    // Check cache for sequential access optimization
-    if (access_cache_.last_index != SIZE_MAX && 
-        access_cache_.last_offset >= 0) {
-        
-        // Sequential forward access
-        if (index == access_cache_.last_index + 1) {
-            ShmNode* cached = node_at_offset(access_cache_.last_offset);
-            if (cached) {
-                int64_t next = cached->next_offset.load(std::memory_order_acquire);
-                ShmNode* node = node_at_offset(next);
-                // Skip expired nodes
-                while (node && node->entry.is_expired()) {
-                    next = node->next_offset.load(std::memory_order_acquire);
-                    node = node_at_offset(next);
-                }
-                if (node && node->entry.is_alive()) {
-                    access_cache_.last_index = index;
-                    access_cache_.last_offset = next;
-                    return node;
-                }
-            }
-        }
-        
-        // Sequential backward access
-        if (index == access_cache_.last_index - 1 && access_cache_.last_index > 0) {
-            ShmNode* cached = node_at_offset(access_cache_.last_offset);
-            if (cached) {
-                int64_t prev = cached->prev_offset.load(std::memory_order_acquire);
-                ShmNode* node = node_at_offset(prev);
-                // Skip expired nodes
-                while (node && node->entry.is_expired()) {
-                    prev = node->prev_offset.load(std::memory_order_acquire);
-                    node = node_at_offset(prev);
-                }
-                if (node && node->entry.is_alive()) {
-                    access_cache_.last_index = index;
-                    access_cache_.last_offset = prev;
-                    return node;
-                }
-            }
-        }
+ShmNode* FastList::node_at_index(size_t index, size_t* position) const {
+    if (positions_ready()) {
+        // No node can have expired, so list and linked positions agree
+        ShmNode* node = node_at_offset(positions_.at(index));
+        if (node && position) *position = index;
+        return node;
     }
     
     // Full traversal from optimal end, skipping expired nodes
@@ -138,6 +123,7 @@ ShmNode* FastList::node_at_index(size_t index) const {
         // Traverse from head
         int64_t current = header_->head_offset.load(std::memory_order_acquire);
         size_t live_index = 0;
+        size_t linked = 0;
         
         while (current >= 0) {
             ShmNode* node = node_at_offset(current);
@@ -145,18 +131,19 @@ ShmNode* FastList::node_at_index(size_t index) const {
             
             if (node->entry.is_alive()) {
                 if (live_index == index) {
-                    access_cache_.last_index = index;
-                    access_cache_.last_offset = current;
+                    if (position) *position = linked;
                     return node;
                 }
                 live_index++;
             }
+            linked++;
             current = node->next_offset.load(std::memory_order_acquire);
         }
     } else {
         // Traverse from tail
         int64_t current = header_->tail_offset.load(std::memory_order_acquire);
         size_t live_index = list_size - 1;
+        size_t linked = list_size - 1;
         
         while (current >= 0) {
             ShmNode* node = node_at_offset(current);
@@ -164,12 +151,12 @@ ShmNode* FastList::node_at_index(size_t index) const {
             
             if (node->entry.is_alive()) {
                 if (live_index == index) {
-                    access_cache_.last_index = index;
-                    access_cache_.last_offset = current;
+                    if (position) *position = linked;
                     return node;
                 }
                 live_index--;
             }
+            linked--;
             current = node->prev_offset.load(std::memory_order_acquire);
         }
     }
@@ -177,6 +164,30 @@ ShmNode* FastList::node_at_index(size_t index) const {
     return nullptr;
 }
 
+bool FastList::positions_ready() const {
+    return positions_.complete() && !header_->may_have_expired() &&
+           positions_.size() == header_->size.load(std::memory_order_acquire);
+}
+
+void FastList::refresh_positions(bool reap_due) {
+    if (reap_due && header_->may_have_expired()) {
+        reap_expired_locked(SIZE_MAX);
+    }
+    if (!positions_.complete() ||
+        positions_.size() != header_->size.load(std::memory_order_acquire)) {
+        positions_.rebuild(header_->head_offset.load(std::memory_order_acquire));
+    }
+}
+
+void FastList::ensure_positions() const {
+    // Readers leave expired nodes to writers and the reaper, walking past
+    // them meanwhile; they only fill in an incomplete index
+    if (positions_.complete()) return;
+    
+    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    const_cast<FastList*>(this)->refresh_positions(false);
+}
+
 ShmNode* FastList::allocate_node(size_t data_size) {
     size_t total = ShmNode::total_size(data_size);
     void* mem = file_manager_->allocate(total);
@@ -191,11 +202,17 @@ ShmNode* FastList::allocate_node(size_t data_size) {
 
 void FastList::free_node(ShmNode* node, size_t data_size) {
     if (node) {
+        expiry_.untrack(&node->entry);
         file_manager_->deallocate(node);
     }
 }
 
-void FastList::link_node(ShmNode* node, ShmNode* prev, ShmNode* next) {
+void FastList::track_expiry(ShmNode* node) {
+    expiry_.track(&node->entry);
+    header_->note_expiry(node->entry.expires_at);
+}
+
+void FastList::link_node(ShmNode* node, ShmNode* prev, ShmNode* next, size_t position) {
     void* base = file_manager_->segment_manager();
     int64_t node_offset = static_cast<uint8_t*>(static_cast<void*>(node)) - 
                           static_cast<uint8_t*>(base);
@@ -219,11 +236,22 @@ void FastList::link_node(ShmNode* node, ShmNode* prev, ShmNode* next) {
         node->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
         header_->tail_offset.store(node_offset, std::memory_order_release);
     }
+    
+    if (positions_.complete()) {
+        positions_.insert(position, node_offset);
+    }
 }
 
-void FastList::unlink_node(ShmNode* node) {
+void FastList::unlink_node(ShmNode* node, size_t position) {
     void* base = file_manager_->segment_manager();
     
+    if (position == UNKNOWN_POSITION) {
+        positions_.forget(static_cast<uint8_t*>(static_cast<void*>(node)) -
+                          static_cast<uint8_t*>(base));
+    } else if (positions_.complete()) {
+        positions_.erase(position);
+    }
+    
     int64_t prev = node->prev_offset.load(std::memory_order_acquire);
     int64_t next = node->next_offset.load(std::memory_order_acquire);
     
@@ -240,10 +268,6 @@ void FastList::unlink_node(ShmNode* node) {
     } else {
         header_->tail_offset.store(prev, std::memory_order_release);
     }
-    
-    // Invalidate cache
-    access_cache_.last_index = SIZE_MAX;
-    access_cache_.last_offset = -1;
 }
 
 bool FastList::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
@@ -257,12 +281,14 @@ bool FastList::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     ShmNode* node = allocate_node(size);
     
     // Copy data with TTL
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
+    SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl_seconds);
+    node->entry.stamp_version(versions_->next());
+    track_expiry(node);
     
     // Link at tail
     int64_t tail = header_->tail_offset.load(std::memory_order_acquire);
     ShmNode* tail_node = node_at_offset(tail);
-    link_node(node, tail_node, nullptr);
+    link_node(node, tail_node, nullptr, header_->size.load(std::memory_order_acquire));
     
     header_->size.fetch_add(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
@@ -276,6 +302,7 @@ bool FastList::add(size_t index, const uint8_t* data, size_t size, int32_t ttl_s
     if (!data || size == 0) return false;
     
     IpcScopedLock lock(header_->global_mutex);
+    refresh_positions(true);
     
     size_t current_size = header_->size.load(std::memory_order_acquire);
     
@@ -296,14 +323,17 @@ bool FastList::add(size_t index, const uint8_t* data, size_t size, int32_t ttl_s
     }
     
     // Insert in middle
-    ShmNode* next_node = node_at_index(index);
+    size_t position = 0;
+    ShmNode* next_node = node_at_index(index, &position);
     if (!next_node) return false;
     
     ShmNode* prev_node = node_at_offset(next_node->prev_offset.load(std::memory_order_acquire));
     
     ShmNode* node = allocate_node(size);
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
-    link_node(node, prev_node, next_node);
+    SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl_seconds);
+    node->entry.stamp_version(versions_->next());
+    track_expiry(node);
+    link_node(node, prev_node, next_node, position);
     
     header_->size.fetch_add(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
@@ -319,11 +349,13 @@ bool FastList::addFirst(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     IpcScopedLock lock(header_->global_mutex);
     
     ShmNode* node = allocate_node(size);
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
+    SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl_seconds);
+    node->entry.stamp_version(versions_->next());
+    track_expiry(node);
     
     int64_t head = header_->head_offset.load(std::memory_order_acquire);
     ShmNode* head_node = node_at_offset(head);
-    link_node(node, nullptr, head_node);
+    link_node(node, nullptr, head_node, 0);
     
     header_->size.fetch_add(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
@@ -334,7 +366,15 @@ bool FastList::addFirst(const uint8_t* data, size_t size, int32_t ttl_seconds) {
 }
 
 bool FastList::get(size_t index, std::vector<uint8_t>& out_data) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    return getWith(index, [&](const uint8_t* data, size_t size) {
+        out_data.assign(data, data + size);
+    });
+}
+
+bool FastList::getWith(size_t index,
+                       const std::function<void(const uint8_t* data, size_t size)>& fn) const {
+    ensure_positions();
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     ShmNode* node = node_at_index(index);
     if (!node || !node->entry.is_alive()) {
@@ -342,7 +382,26 @@ bool FastList::get(size_t index, std::vector<uint8_t>& out_data) const {
         return false;
     }
     
-    out_data = SerializationUtil::copy_from_node(node);
+    fn(node->data, node->entry.data_size);
+    const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
+    const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
+    
+    return true;
+}
+
+bool FastList::getWithVersion(size_t index, std::vector<uint8_t>& out_data,
+                              uint64_t& out_version) const {
+    ensure_positions();
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    
+    ShmNode* node = node_at_index(index);
+    if (!node || !node->entry.is_alive()) {
+        const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    out_data.assign(node->data, node->data + node->entry.data_size);
+    out_version = node->entry.current_version();
     const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
     const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
     
@@ -350,7 +409,7 @@ bool FastList::get(size_t index, std::vector<uint8_t>& out_data) const {
 }
 
 bool FastList::getFirst(std::vector<uint8_t>& out_data) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     int64_t head = header_->head_offset.load(std::memory_order_acquire);
     ShmNode* node = node_at_offset(head);
@@ -374,7 +433,7 @@ bool FastList::getFirst(std::vector<uint8_t>& out_data) const {
 }
 
 bool FastList::getLast(std::vector<uint8_t>& out_data) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     int64_t tail = header_->tail_offset.load(std::memory_order_acquire);
     ShmNode* node = node_at_offset(tail);
@@ -398,7 +457,8 @@ bool FastList::getLast(std::vector<uint8_t>& out_data) const {
 }
 
 int64_t FastList::getTTL(size_t index) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    ensure_positions();
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     ShmNode* node = node_at_index(index);
     if (!node) return 0;
@@ -410,16 +470,44 @@ bool FastList::set(size_t index, const uint8_t* data, size_t size, int32_t ttl_s
     if (!data || size == 0) return false;
     
     IpcScopedLock lock(header_->global_mutex);
+    refresh_positions(true);
     
-    ShmNode* node = node_at_index(index);
+    size_t position = 0;
+    ShmNode* node = node_at_index(index, &position);
     if (!node) return false;
     
+    set_node(node, position, data, size, ttl_seconds);
+    return true;
+}
+
+bool FastList::setIfVersion(size_t index, const uint8_t* data, size_t size,
+                            uint64_t expected_version, int32_t ttl_seconds) {
+    if (!data || size == 0) return false;
+    
+    IpcScopedLock lock(header_->global_mutex);
+    refresh_positions(true);
+    
+    size_t position = 0;
+    ShmNode* node = node_at_index(index, &position);
+    if (!node || !node->entry.is_alive() ||
+        node->entry.current_version() != expected_version) {
+        return false;
+    }
+    
+    set_node(node, position, data, size, ttl_seconds);
+    return true;
+}
+
+void FastList::set_node(ShmNode* node, size_t position, const uint8_t* data, size_t size,
+                        int32_t ttl_seconds) {
     // If size matches, update in place
     if (node->entry.data_size == size) {
         std::memcpy(node->data, data, size);
-        node->entry.hash_code = compute_hash(data, size);
+        node->entry.set_hash(hasher_(data, size));
         node->entry.set_ttl(ttl_seconds);
+        node->entry.stamp_version(versions_->next());
         node->entry.mark_valid();
+        track_expiry(node);
     } else {
         // Need to reallocate - remove and add
         void* base = file_manager_->segment_manager();
@@ -427,7 +515,9 @@ bool FastList::set(size_t index, const uint8_t* data, size_t size, int32_t ttl_s
         int64_t next = node->next_offset.load(std::memory_order_acquire);
         
         ShmNode* new_node = allocate_node(size);
-        SerializationUtil::copy_to_node(new_node, data, size, ttl_seconds);
+        SerializationUtil::copy_to_node(new_node, hasher_(data, size), data, size, ttl_seconds);
+        new_node->entry.stamp_version(versions_->next());
+        track_expiry(new_node);
         
         // Link new node
         new_node->prev_offset.store(prev, std::memory_order_release);
@@ -450,27 +540,27 @@ bool FastList::set(size_t index, const uint8_t* data, size_t size, int32_t ttl_s
             header_->tail_offset.store(new_offset, std::memory_order_release);
         }
         
+        if (positions_.complete()) {
+            positions_.replace(position, new_offset);
+        }
+        
         // Free old node
         free_node(node, node->entry.data_size);
     }
     
     header_->modified_at = current_timestamp_ns();
     stats_.write_count.fetch_add(1, std::memory_order_relaxed);
-    
-    // Invalidate cache
-    access_cache_.last_index = SIZE_MAX;
-    access_cache_.last_offset = -1;
-    
-    return true;
 }
 
 bool FastList::setTTL(size_t index, int32_t ttl_seconds) {
     IpcScopedLock lock(header_->global_mutex);
+    refresh_positions(true);
     
     ShmNode* node = node_at_index(index);
     if (!node || !node->entry.is_alive()) return false;
     
     node->entry.set_ttl(ttl_seconds);
+    track_expiry(node);
     header_->modified_at = current_timestamp_ns();
     
     return true;
@@ -478,8 +568,10 @@ bool FastList::setTTL(size_t index, int32_t ttl_seconds) {
 
 bool FastList::remove(size_t index, std::vector<uint8_t>* out_data) {
     IpcScopedLock lock(header_->global_mutex);
+    refresh_positions(true);
     
-    ShmNode* node = node_at_index(index);
+    size_t position = 0;
+    ShmNode* node = node_at_index(index, &position);
     if (!node) return false;
     
     if (out_data && node->entry.is_alive()) {
@@ -487,7 +579,7 @@ bool FastList::remove(size_t index, std::vector<uint8_t>* out_data) {
     }
     
     size_t data_size = node->entry.data_size;
-    unlink_node(node);
+    unlink_node(node, position);
     node->entry.mark_deleted();
     free_node(node, data_size);
     
@@ -511,7 +603,7 @@ bool FastList::removeFirst(std::vector<uint8_t>* out_data) {
     }
     
     size_t data_size = node->entry.data_size;
-    unlink_node(node);
+    unlink_node(node, 0);
     node->entry.mark_deleted();
     free_node(node, data_size);
     
@@ -535,7 +627,7 @@ bool FastList::removeLast(std::vector<uint8_t>* out_data) {
     }
     
     size_t data_size = node->entry.data_size;
-    unlink_node(node);
+    unlink_node(node, header_->size.load(std::memory_order_acquire) - 1);
     node->entry.mark_deleted();
     free_node(node, data_size);
     
@@ -549,23 +641,24 @@ bool FastList::removeLast(std::vector<uint8_t>* out_data) {
 bool FastList::removeElement(const uint8_t* data, size_t size) {
     if (!data || size == 0) return false;
     
-    uint32_t target_hash = compute_hash(data, size);
+    uint64_t target_hash = hasher_(data, size);
     
     IpcScopedLock lock(header_->global_mutex);
     
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
+    size_t position = 0;
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
         if (!node) break;
         
         if (node->entry.is_alive() &&
-            node->entry.hash_code == target_hash &&
+            hasher_.matches(node->entry, target_hash) &&
             node->entry.data_size == size &&
             std::memcmp(node->data, data, size) == 0) {
             
             size_t data_size = node->entry.data_size;
-            unlink_node(node);
+            unlink_node(node, position);
             node->entry.mark_deleted();
             free_node(node, data_size);
             
@@ -576,6 +669,7 @@ bool FastList::removeElement(const uint8_t* data, size_t size) {
             return true;
         }
         
+        position++;
         current = node->next_offset.load(std::memory_order_acquire);
     }
     
@@ -583,20 +677,29 @@ bool FastList::removeElement(const uint8_t* data, size_t size) {
 }
 
 size_t FastList::removeExpired() {
+    return reapExpired(SIZE_MAX);
+}
+
+size_t FastList::reapExpired(size_t max_items) {
     IpcScopedLock lock(header_->global_mutex);
+    return reap_expired_locked(max_items);
+}
+
+size_t FastList::reap_expired_locked(size_t max_items) {
+    header_->begin_expiry_sweep();
     
     size_t removed = 0;
-    int64_t current = header_->head_offset.load(std::memory_order_acquire);
     
-    while (current >= 0) {
-        ShmNode* node = node_at_offset(current);
-        if (!node) break;
-        
-        int64_t next = node->next_offset.load(std::memory_order_acquire);
-        
-        if (node->entry.is_expired()) {
+    if (!expiry_.needs_rebuild()) {
+        uint64_t now = current_timestamp_ns();
+        while (removed < max_items) {
+            ShmEntry* entry = expiry_.pop_due(now);
+            if (!entry) break;
+            
+            // The entry is the first member of its node
+            ShmNode* node = reinterpret_cast<ShmNode*>(entry);
             size_t data_size = node->entry.data_size;
-            unlink_node(node);
+            unlink_node(node, UNKNOWN_POSITION);
             node->entry.mark_deleted();
             free_node(node, data_size);
             
@@ -604,8 +707,41 @@ size_t FastList::removeExpired() {
             stats_.size.fetch_sub(1, std::memory_order_relaxed);
             removed++;
         }
+        header_->note_expiry(expiry_.next_expiry());
+    } else {
+        // Full sweep, indexing every survivor
+        uint64_t next_expiry = CollectionHeader::NO_EXPIRY;
+        int64_t current = header_->head_offset.load(std::memory_order_acquire);
+        size_t position = 0;
+        expiry_.reset();
         
-        current = next;
+        while (current >= 0) {
+            ShmNode* node = node_at_offset(current);
+            if (!node) break;
+            
+            int64_t next = node->next_offset.load(std::memory_order_acquire);
+            
+            if (node->entry.is_expired()) {
+                size_t data_size = node->entry.data_size;
+                unlink_node(node, position);
+                node->entry.mark_deleted();
+                free_node(node, data_size);
+                
+                header_->size.fetch_sub(1, std::memory_order_acq_rel);
+                stats_.size.fetch_sub(1, std::memory_order_relaxed);
+                removed++;
+            } else {
+                if (node->entry.expires_at != 0) {
+                    next_expiry = std::min(next_expiry, node->entry.expires_at);
+                    expiry_.track(&node->entry);
+                }
+                position++;
+            }
+            
+            current = next;
+        }
+        expiry_.mark_complete();
+        header_->note_expiry(next_expiry);
     }
     
     if (removed > 0) {
@@ -622,9 +758,9 @@ bool FastList::contains(const uint8_t* data, size_t size) const {
 int64_t FastList::indexOf(const uint8_t* data, size_t size) const {
     if (!data || size == 0) return -1;
     
-    uint32_t target_hash = compute_hash(data, size);
+    uint64_t target_hash = hasher_(data, size);
     
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
     int64_t index = 0;
@@ -634,7 +770,7 @@ int64_t FastList::indexOf(const uint8_t* data, size_t size) const {
         if (!node) break;
         
         if (node->entry.is_alive()) {
-            if (node->entry.hash_code == target_hash &&
+            if (hasher_.matches(node->entry, target_hash) &&
                 node->entry.data_size == size &&
                 std::memcmp(node->data, data, size) == 0) {
                 return index;
@@ -651,9 +787,9 @@ int64_t FastList::indexOf(const uint8_t* data, size_t size) const {
 int64_t FastList::lastIndexOf(const uint8_t* data, size_t size) const {
     if (!data || size == 0) return -1;
     
-    uint32_t target_hash = compute_hash(data, size);
+    uint64_t target_hash = hasher_(data, size);
     
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     // First, count total alive nodes
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
@@ -676,7 +812,7 @@ int64_t FastList::lastIndexOf(const uint8_t* data, size_t size) const {
         if (!node) break;
         
         if (node->entry.is_alive()) {
-            if (node->entry.hash_code == target_hash &&
+            if (hasher_.matches(node->entry, target_hash) &&
                 node->entry.data_size == size &&
                 std::memcmp(node->data, data, size) == 0) {
                 return live_index;
@@ -692,6 +828,8 @@ int64_t FastList::lastIndexOf(const uint8_t* data, size_t size) const {
 
 void FastList::clear() {
     IpcScopedLock lock(header_->global_mutex);
+    expiry_.reset();
+    positions_.reset();
     
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
     
@@ -713,13 +851,20 @@ void FastList::clear() {
     header_->modified_at = current_timestamp_ns();
     
     stats_.size.store(0, std::memory_order_relaxed);
-    access_cache_.last_index = SIZE_MAX;
-    access_cache_.last_offset = -1;
 }
 
 size_t FastList::size() const {
+    size_t size = header_->size.load(std::memory_order_acquire);
+    if (!header_->may_have_expired()) return size;
+    
+    // Leave the reaping to removeExpired(); just discount what is due
+    size_t due = static_cast<size_t>(expiry_.count_due(current_timestamp_ns()));
+    return size - std::min(due, size);
+}
+
+size_t FastList::exactSize() const {
     // Count only non-expired elements
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     size_t alive_count = 0;
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
@@ -739,7 +884,7 @@ bool FastList::isEmpty() const {
 }
 
 void FastList::forEach(std::function<bool(const uint8_t* data, size_t size, size_t index)> callback) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
     size_t index = 0;
@@ -761,7 +906,7 @@ void FastList::forEach(std::function<bool(const uint8_t* data, size_t size, size
 
 void FastList::forEachWithTTL(std::function<bool(const uint8_t* data, size_t size, 
                                                   size_t index, int64_t ttl_remaining)> callback) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     int64_t current = header_->head_offset.load(std::memory_order_acquire);
     size_t index = 0;
@@ -782,6 +927,18 @@ void FastList::forEachWithTTL(std::function<bool(const uint8_t* data, size_t siz
     }
 }
 
+void FastList::startReaper(const ReaperConfig& config) {
+    reaper_.reset();
+    reaper_ = std::make_unique<TtlReaper>(
+        file_manager_->find_or_construct<ReaperLease>("list_reaper"),
+        [this](size_t max_items) { return reapExpired(max_items); },
+        config);
+}
+
+void FastList::stopReaper() {
+    reaper_.reset();
+}
+
 void FastList::flush() {
     file_manager_->flush();
 }
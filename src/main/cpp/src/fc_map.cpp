@@ -9,19 +9,38 @@
  */
 
 #include "fc_map.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
+#include <numeric>
 
 namespace fastcollection {
 
 using IpcScopedLock = bip::scoped_lock<IpcMutex>;
+using IpcExclusiveLock = bip::scoped_lock<IpcSharedMutex>;
+using IpcSharableLock = bip::sharable_lock<IpcSharedMutex>;
+
+// Keys whose buckets multiGet prefetches before walking any of their chains
+static constexpr size_t PREFETCH_GROUP = 16;
+
+// Home groups a Swiss sweep copies out per hold of the global lock
+static constexpr size_t SWISS_SWEEP_GROUPS = PARALLEL_CHUNK_BUCKETS / SwissGroup::WIDTH;
+
+// A Swiss CLOCK hand keeps the scan cursor of its home group in the high
+// bits and how many of that group's entries it already passed in the low ones
+static constexpr unsigned SWISS_HAND_SHIFT = 16;
+static constexpr uint64_t SWISS_HAND_PASSED = (1ull << SWISS_HAND_SHIFT) - 1;
 
 FastMap::FastMap(const std::string& mmap_file,
                  size_t initial_size,
                  bool create_new,
-                 uint32_t bucket_count)
+                 uint32_t bucket_count,
+                 MapEngine engine,
+                 const CacheConfig& cache)
     : file_manager_(std::make_unique<MMapFileManager>(mmap_file, initial_size, create_new)) {
     
     auto result = file_manager_->find<HashTableHeader>("map_header");
+    bool existing = result.first != nullptr;
     
     if (result.first) {
         header_ = result.first;
@@ -31,57 +50,102 @@ FastMap::FastMap(const std::string& mmap_file,
                 "Invalid map header in file"
             );
         }
+        // Before the buckets are converted or anything comes from the slabs
+        header_->mark_current();
     } else {
         header_ = file_manager_->find_or_construct<HashTableHeader>("map_header", bucket_count);
     }
-    
-    auto buckets_result = file_manager_->find<ShmBucket>("map_buckets");
-    if (buckets_result.first) {
-        buckets_ = buckets_result.first;
+    hasher_ = Hasher::open(file_manager_.get(), "map_hash", existing);
+    
+    // The engine is chosen once, when the file is created
+    auto swiss_result = file_manager_->find<SwissHeader>("map_swiss");
+    if (swiss_result.first || (!existing && engine == MapEngine::SWISS)) {
+        SwissHeader* swiss_header = swiss_result.first;
+        if (!swiss_header) {
+            swiss_header = file_manager_->find_or_construct<SwissHeader>(
+                "map_swiss", SwissTable::groups_for(header_->bucket_count));
+        }
+        swiss_ = std::make_unique<SwissTable>(file_manager_.get(), swiss_header);
     } else {
-        buckets_ = file_manager_->construct_array<ShmBucket>("map_buckets", header_->bucket_count);
+        table_ = BucketTable<ShmKeyValue>(file_manager_.get(), header_, "map_buckets", "map_directory",
+                                          "map_stripes");
+        // Slots were held per thread under the earlier name "map_epoch",
+        // which is left unused
+        epoch_ = std::make_unique<EpochDomain>(
+            file_manager_.get(),
+            file_manager_->find_or_construct<EpochHeader>("map_epoch_domain"),
+            offsetof(ShmKeyValue, prev_offset));
+    }
+    
+    // Like the engine, cache mode is chosen when the file is created
+    auto cache_result = file_manager_->find<CacheHeader>("map_cache");
+    if (cache_result.first || (!existing && cache.bounded())) {
+        cache_ = cache_result.first;
+        if (!cache_) {
+            cache_ = file_manager_->find_or_construct<CacheHeader>("map_cache", cache);
+        }
+        if (!cache_->is_valid()) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::INTERNAL_ERROR,
+                "Invalid cache header in file"
+            );
+        }
+        sketch_ = FrequencySketch(file_manager_.get(), cache_);
     }
     
+    // Files written before the index existed start with an incomplete one
+    expiry_ = ExpiryIndex(file_manager_.get(),
+                          file_manager_->find_or_construct<ExpiryHeader>("map_expiry_index", !existing),
+                          true);
+    versions_ = file_manager_->find_or_construct<VersionClock>("map_versions");
+    
     stats_.size.store(header_->size.load(), std::memory_order_relaxed);
 }
 
 FastMap::~FastMap() {
+    // The reaper works on this map until it is joined
+    reaper_.reset();
     if (file_manager_) {
         flush();
     }
 }
 
 FastMap::FastMap(FastMap&& other) noexcept
-    : file_manager_(std::move(other.file_manager_))
-    , header_(other.header_)
-    , buckets_(other.buckets_) {
-    other.header_ = nullptr;
-    other.buckets_ = nullptr;
+    : header_(nullptr) {
+    *this = std::move(other);
 }
 
 FastMap& FastMap::operator=(FastMap&& other) noexcept {
     if (this != &other) {
+        // Reapers are bound to the object that started them
+        reaper_.reset();
+        other.reaper_.reset();
+        
+        // Release the epoch domain while its file is still mapped
+        epoch_ = std::move(other.epoch_);
         file_manager_ = std::move(other.file_manager_);
         header_ = other.header_;
-        buckets_ = other.buckets_;
+        hasher_ = other.hasher_;
+        table_ = other.table_;
+        swiss_ = std::move(other.swiss_);
+        cache_ = other.cache_;
+        sketch_ = other.sketch_;
+        expiry_ = other.expiry_;
+        versions_ = other.versions_;
         other.header_ = nullptr;
-        other.buckets_ = nullptr;
+        other.cache_ = nullptr;
+        other.versions_ = nullptr;
     }
     return *this;
 }
 
-ShmBucket* FastMap::get_bucket(uint32_t hash) {
-    uint32_t idx = hash & (header_->bucket_count - 1);
-    return &buckets_[idx];
-}
-
-const ShmBucket* FastMap::get_bucket(uint32_t hash) const {
-    uint32_t idx = hash & (header_->bucket_count - 1);
-    return &buckets_[idx];
-}
-
 ShmKeyValue* FastMap::find_in_bucket(ShmBucket* bucket, const uint8_t* key, size_t key_size,
-                                      uint32_t hash, ShmKeyValue** prev_out) {
+                                      uint64_t hash, ShmKeyValue** prev_out) {
+    if (!bucket->may_contain(hash)) {
+        if (prev_out) *prev_out = nullptr;
+        return nullptr;
+    }
+    
     void* base = file_manager_->segment_manager();
     
     int64_t current = bucket->head_offset.load(std::memory_order_acquire);
@@ -92,7 +156,7 @@ ShmKeyValue* FastMap::find_in_bucket(ShmBucket* bucket, const uint8_t* key, size
             static_cast<uint8_t*>(base) + current
         );
         
-        if (kv->entry.hash_code == hash &&
+        if (hasher_.matches(kv->entry, hash) &&
             kv->key_size == key_size &&
             std::memcmp(kv->data, key, key_size) == 0) {
             if (prev_out) *prev_out = prev;
@@ -116,77 +180,182 @@ ShmKeyValue* FastMap::allocate_kv(size_t key_size, size_t value_size) {
             "Failed to allocate key-value"
         );
     }
+    if (cache_) {
+        header_->total_bytes.fetch_add(total, std::memory_order_acq_rel);
+    }
     return new(mem) ShmKeyValue();
 }
 
 void FastMap::free_kv(ShmKeyValue* kv) {
     if (kv) {
+        expiry_.untrack(&kv->entry);
+        if (cache_) {
+            header_->total_bytes.fetch_sub(ShmKeyValue::total_size(kv->key_size, kv->value_size),
+                                           std::memory_order_acq_rel);
+        }
         file_manager_->deallocate(kv);
     }
 }
 
-bool FastMap::put(const uint8_t* key, size_t key_size,
-                  const uint8_t* value, size_t value_size,
-                  int32_t ttl_seconds) {
-    if (!key || key_size == 0) return false;
+void FastMap::retire_kv(ShmKeyValue* kv) {
+    expiry_.untrack(&kv->entry);
+    
+    // The node no longer counts against a cache budget, even though the
+    // memory is only released once no reader can see it
+    if (cache_) {
+        header_->total_bytes.fetch_sub(ShmKeyValue::total_size(kv->key_size, kv->value_size),
+                                       std::memory_order_acq_rel);
+    }
+    
+    // Lock-free readers may still hold kv; free it once they have all moved on
+    epoch_->retire(kv);
+}
+
+void FastMap::unlink_kv(ShmBucket* bucket, ShmKeyValue* kv) {
+    void* base = file_manager_->segment_manager();
+    int64_t prev = kv->prev_offset.load(std::memory_order_acquire);
+    int64_t next = kv->next_offset.load(std::memory_order_acquire);
     
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
+    if (prev >= 0) {
+        ShmKeyValue* prev_kv = reinterpret_cast<ShmKeyValue*>(
+            static_cast<uint8_t*>(base) + prev
+        );
+        prev_kv->next_offset.store(next, std::memory_order_release);
+    } else {
+        bucket->head_offset.store(next, std::memory_order_release);
+    }
+    
+    if (next >= 0) {
+        ShmKeyValue* next_kv = reinterpret_cast<ShmKeyValue*>(
+            static_cast<uint8_t*>(base) + next
+        );
+        next_kv->prev_offset.store(prev, std::memory_order_release);
+    }
     
-    IpcScopedLock lock(bucket->mutex);
+    table_.untag(bucket, kv->entry.hash_code);
+    kv->entry.mark_deleted();
+    retire_kv(kv);
     
+    header_->size.fetch_sub(1, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FastMap::swap_kv(ShmBucket* bucket, ShmKeyValue* existing,
+                      const uint8_t* key, size_t key_size,
+                      const uint8_t* value, size_t value_size,
+                      uint64_t hash, int32_t ttl_seconds, bool keep_ttl) {
     void* base = file_manager_->segment_manager();
+    int64_t prev_offset = existing->prev_offset.load(std::memory_order_acquire);
+    int64_t next_offset = existing->next_offset.load(std::memory_order_acquire);
+    
+    ShmKeyValue* new_kv = allocate_kv(key_size, value_size);
+    SerializationUtil::copy_to_kv(new_kv, hash, key, key_size, value, value_size, ttl_seconds);
+    new_kv->entry.stamp_version(versions_->next());
+    if (keep_ttl) new_kv->entry.copy_ttl(existing->entry);
+    track_expiry(new_kv->entry);
+    if (cache_) new_kv->entry.touch();  // An update counts as a use
+    
+    int64_t new_offset = static_cast<uint8_t*>(static_cast<void*>(new_kv)) - 
+                         static_cast<uint8_t*>(base);
+    
+    new_kv->prev_offset.store(prev_offset, std::memory_order_release);
+    new_kv->next_offset.store(next_offset, std::memory_order_release);
+    
+    if (prev_offset >= 0) {
+        ShmKeyValue* prev_kv = reinterpret_cast<ShmKeyValue*>(
+            static_cast<uint8_t*>(base) + prev_offset
+        );
+        prev_kv->next_offset.store(new_offset, std::memory_order_release);
+    } else {
+        bucket->head_offset.store(new_offset, std::memory_order_release);
+    }
+    
+    if (next_offset >= 0) {
+        ShmKeyValue* next_kv = reinterpret_cast<ShmKeyValue*>(
+            static_cast<uint8_t*>(base) + next_offset
+        );
+        next_kv->prev_offset.store(new_offset, std::memory_order_release);
+    }
+    
+    // The old node stays valid so a reader already on it returns the old value
+    retire_kv(existing);
+}
+
+void FastMap::swiss_assign(const SwissTable::Position& pos, const uint8_t* key, size_t key_size,
+                           const uint8_t* value, size_t value_size,
+                           uint64_t hash, int32_t ttl_seconds) {
+    ShmKeyValue* existing = swiss_->at(pos);
+    
+    if (existing->value_size == value_size) {
+        // Same size - update in place
+        std::memcpy(existing->data + key_size, value, value_size);
+        existing->entry.stamp_version(versions_->next());
+        existing->entry.set_ttl(ttl_seconds);
+        existing->entry.mark_valid();
+        track_expiry(existing->entry);
+        if (cache_) existing->entry.touch();
+        return;
+    }
+    
+    // Different size - swap in a new node
+    ShmKeyValue* new_kv = allocate_kv(key_size, value_size);
+    SerializationUtil::copy_to_kv(new_kv, hash, key, key_size, value, value_size, ttl_seconds);
+    new_kv->entry.stamp_version(versions_->next());
+    track_expiry(new_kv->entry);
+    if (cache_) new_kv->entry.touch();
+    swiss_->set(pos, new_kv);
+    
+    existing->entry.mark_deleted();
+    free_kv(existing);
+}
+
+void FastMap::swiss_erase(const SwissTable::Position& pos) {
+    ShmKeyValue* kv = swiss_->at(pos);
+    swiss_->erase(pos);
+    
+    kv->entry.mark_deleted();
+    free_kv(kv);
+    
+    header_->size.fetch_sub(1, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool FastMap::swiss_put(const uint8_t* key, size_t key_size,
+                        const uint8_t* value, size_t value_size,
+                        uint64_t hash, int32_t ttl_seconds) {
+    auto pos = swiss_->find(key, key_size, hash);
+    if (pos) {
+        swiss_assign(pos, key, key_size, value, value_size, hash, ttl_seconds);
+        return false;
+    }
+    
+    ShmKeyValue* kv = allocate_kv(key_size, value_size);
+    SerializationUtil::copy_to_kv(kv, hash, key, key_size, value, value_size, ttl_seconds);
+    kv->entry.stamp_version(versions_->next());
+    track_expiry(kv->entry);
+    swiss_->insert(hash, kv);
+    header_->size.fetch_add(1, std::memory_order_acq_rel);
+    stats_.size.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool FastMap::put_in_bucket(ShmBucket* bucket, const uint8_t* key, size_t key_size,
+                            const uint8_t* value, size_t value_size,
+                            uint64_t hash, int32_t ttl_seconds) {
     ShmKeyValue* existing = find_in_bucket(bucket, key, key_size, hash, nullptr);
     
     if (existing) {
-        // Update existing entry
-        if (existing->value_size == value_size) {
-            // Same size - update in place
-            std::memcpy(existing->data + key_size, value, value_size);
-            existing->entry.set_ttl(ttl_seconds);
-            existing->entry.mark_valid();
-        } else {
-            // Different size - need to reallocate
-            int64_t prev_offset = existing->prev_offset.load(std::memory_order_acquire);
-            int64_t next_offset = existing->next_offset.load(std::memory_order_acquire);
-            
-            ShmKeyValue* new_kv = allocate_kv(key_size, value_size);
-            SerializationUtil::copy_to_kv(new_kv, key, key_size, value, value_size, ttl_seconds);
-            
-            int64_t new_offset = static_cast<uint8_t*>(static_cast<void*>(new_kv)) - 
-                                 static_cast<uint8_t*>(base);
-            
-            new_kv->prev_offset.store(prev_offset, std::memory_order_release);
-            new_kv->next_offset.store(next_offset, std::memory_order_release);
-            
-            if (prev_offset >= 0) {
-                ShmKeyValue* prev_kv = reinterpret_cast<ShmKeyValue*>(
-                    static_cast<uint8_t*>(base) + prev_offset
-                );
-                prev_kv->next_offset.store(new_offset, std::memory_order_release);
-            } else {
-                bucket->head_offset.store(new_offset, std::memory_order_release);
-            }
-            
-            if (next_offset >= 0) {
-                ShmKeyValue* next_kv = reinterpret_cast<ShmKeyValue*>(
-                    static_cast<uint8_t*>(base) + next_offset
-                );
-                next_kv->prev_offset.store(new_offset, std::memory_order_release);
-            }
-            
-            existing->entry.mark_deleted();
-            free_kv(existing);
-        }
-        
-        header_->modified_at = current_timestamp_ns();
-        stats_.write_count.fetch_add(1, std::memory_order_relaxed);
-        return true;
+        // Copy-on-write so lock-free readers never see a half-written value
+        swap_kv(bucket, existing, key, key_size, value, value_size, hash, ttl_seconds);
+        return false;
     }
     
     // Add new entry
+    void* base = file_manager_->segment_manager();
     ShmKeyValue* kv = allocate_kv(key_size, value_size);
-    SerializationUtil::copy_to_kv(kv, key, key_size, value, value_size, ttl_seconds);
+    SerializationUtil::copy_to_kv(kv, hash, key, key_size, value, value_size, ttl_seconds);
+    kv->entry.stamp_version(versions_->next());
+    track_expiry(kv->entry);
     
     int64_t kv_offset = static_cast<uint8_t*>(static_cast<void*>(kv)) - 
                         static_cast<uint8_t*>(base);
@@ -202,26 +371,82 @@ bool FastMap::put(const uint8_t* key, size_t key_size,
         old_head_kv->prev_offset.store(kv_offset, std::memory_order_release);
     }
     
+    bucket->add_entry(hash);
     bucket->head_offset.store(kv_offset, std::memory_order_release);
-    bucket->size.fetch_add(1, std::memory_order_acq_rel);
     
     header_->size.fetch_add(1, std::memory_order_acq_rel);
-    header_->modified_at = current_timestamp_ns();
     stats_.size.fetch_add(1, std::memory_order_relaxed);
-    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
-    
     return true;
 }
 
+bool FastMap::put(const uint8_t* key, size_t key_size,
+                  const uint8_t* value, size_t value_size,
+                  int32_t ttl_seconds) {
+    if (!key || key_size == 0) return false;
+    
+    uint64_t hash = hasher_(key, key_size);
+    bool admitted = true;
+    if (sketch_) sketch_.increment(hash);
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        bool added = swiss_put(key, key_size, value, value_size, hash, ttl_seconds);
+        if (cache_) {
+            admitted = enforce_budget(added ? key : nullptr, key_size, hash);
+        }
+    } else {
+        table_.advance();
+        BucketGuard lock = table_.lock_bucket(hash);
+        ShmBucket* bucket = lock.bucket();
+        bool added = put_in_bucket(bucket, key, key_size, value, value_size, hash, ttl_seconds);
+        lock.unlock();
+        if (cache_) {
+            admitted = enforce_budget(added ? key : nullptr, key_size, hash);
+        }
+    }
+    
+    header_->modified_at = current_timestamp_ns();
+    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+    return admitted;
+}
+
 bool FastMap::putIfAbsent(const uint8_t* key, size_t key_size,
                           const uint8_t* value, size_t value_size,
                           int32_t ttl_seconds) {
     if (!key || key_size == 0) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(key, key_size);
+    if (sketch_) sketch_.increment(hash);
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        if (pos && swiss_->at(pos)->entry.is_alive()) {
+            return false;  // Key already exists
+        }
+        
+        if (pos) {
+            // Expired - reuse its slot
+            swiss_assign(pos, key, key_size, value, value_size, hash, ttl_seconds);
+        } else {
+            ShmKeyValue* kv = allocate_kv(key_size, value_size);
+            SerializationUtil::copy_to_kv(kv, hash, key, key_size, value, value_size, ttl_seconds);
+            kv->entry.stamp_version(versions_->next());
+            track_expiry(kv->entry);
+            swiss_->insert(hash, kv);
+            header_->size.fetch_add(1, std::memory_order_acq_rel);
+            stats_.size.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        header_->modified_at = current_timestamp_ns();
+        stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+        return !cache_ || enforce_budget(key, key_size, hash);
+    }
     
-    IpcScopedLock lock(bucket->mutex);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     ShmKeyValue* existing = find_in_bucket(bucket, key, key_size, hash, nullptr);
     if (existing && existing->entry.is_alive()) {
@@ -250,9 +475,9 @@ bool FastMap::putIfAbsent(const uint8_t* key, size_t key_size,
             next_kv->prev_offset.store(prev, std::memory_order_release);
         }
         
+        table_.untag(bucket, existing->entry.hash_code);
         existing->entry.mark_deleted();
-        free_kv(existing);
-        bucket->size.fetch_sub(1, std::memory_order_acq_rel);
+        retire_kv(existing);
         header_->size.fetch_sub(1, std::memory_order_acq_rel);
         stats_.size.fetch_sub(1, std::memory_order_relaxed);
     }
@@ -260,7 +485,9 @@ bool FastMap::putIfAbsent(const uint8_t* key, size_t key_size,
     // Add new entry
     void* base = file_manager_->segment_manager();
     ShmKeyValue* kv = allocate_kv(key_size, value_size);
-    SerializationUtil::copy_to_kv(kv, key, key_size, value, value_size, ttl_seconds);
+    SerializationUtil::copy_to_kv(kv, hash, key, key_size, value, value_size, ttl_seconds);
+    kv->entry.stamp_version(versions_->next());
+    track_expiry(kv->entry);
     
     int64_t kv_offset = static_cast<uint8_t*>(static_cast<void*>(kv)) - 
                         static_cast<uint8_t*>(base);
@@ -276,51 +503,80 @@ bool FastMap::putIfAbsent(const uint8_t* key, size_t key_size,
         old_head_kv->prev_offset.store(kv_offset, std::memory_order_release);
     }
     
+    bucket->add_entry(hash);
     bucket->head_offset.store(kv_offset, std::memory_order_release);
-    bucket->size.fetch_add(1, std::memory_order_acq_rel);
     
     header_->size.fetch_add(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
     stats_.size.fetch_add(1, std::memory_order_relaxed);
     stats_.write_count.fetch_add(1, std::memory_order_relaxed);
     
-    return true;
+    lock.unlock();
+    return !cache_ || enforce_budget(key, key_size, hash);
 }
 
 bool FastMap::get(const uint8_t* key, size_t key_size,
                   std::vector<uint8_t>& out_value) const {
+    return getWith(key, key_size, [&](const uint8_t* value, size_t value_size) {
+        out_value.assign(value, value + value_size);
+    });
+}
+
+bool FastMap::getWith(const uint8_t* key, size_t key_size,
+                      const std::function<void(const uint8_t* value, size_t value_size)>& fn) const {
+    return read_entry(key, key_size, [&](const ShmKeyValue* kv) {
+        fn(kv->value_data(), kv->value_size);
+    });
+}
+
+bool FastMap::getWithVersion(const uint8_t* key, size_t key_size,
+                             std::vector<uint8_t>& out_value, uint64_t& out_version) const {
+    return read_entry(key, key_size, [&](const ShmKeyValue* kv) {
+        // Version first: an in-place counter update stores it last
+        out_version = kv->entry.current_version();
+        out_value.assign(kv->value_data(), kv->value_data() + kv->value_size);
+    });
+}
+
+bool FastMap::read_entry(const uint8_t* key, size_t key_size,
+                         const std::function<void(const ShmKeyValue* kv)>& fn) const {
     if (!key || key_size == 0) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    const ShmBucket* bucket = get_bucket(hash);
-    
-    void* base = file_manager_->segment_manager();
-    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    uint64_t hash = hasher_(key, key_size);
+    const ShmKeyValue* kv = nullptr;
+    if (sketch_) const_cast<FrequencySketch&>(sketch_).increment(hash);
     
-    while (current >= 0) {
-        const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-            static_cast<const uint8_t*>(base) + current
-        );
+    if (swiss_) {
+        // Writers need the exclusive lock, so the entry cannot change under fn
+        IpcSharableLock lock(header_->global_mutex);
         
-        if (kv->entry.is_alive() &&
-            kv->entry.hash_code == hash &&
-            kv->key_size == key_size &&
-            std::memcmp(kv->data, key, key_size) == 0) {
-            
-            out_value.resize(kv->value_size);
-            std::memcpy(out_value.data(), kv->data + kv->key_size, kv->value_size);
-            
-            const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
-            const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
-            return true;
+        auto pos = swiss_->find(key, key_size, hash);
+        if (pos && swiss_->at(pos)->entry.is_alive()) {
+            kv = swiss_->at(pos);
+            if (cache_) kv->entry.touch();
+            fn(kv);
+        }
+    } else {
+        // Updates are copy-on-write (aligned counters: one atomic store) and
+        // unlinked nodes are only retired, so the node stays intact until the
+        // read section ends
+        auto guard = epoch_->read();
+        kv = table_.find(hash, [&](const ShmKeyValue* kv) {
+            return kv->entry.is_alive() &&
+                   hasher_.matches(kv->entry, hash) &&
+                   kv->key_size == key_size &&
+                   std::memcmp(kv->data, key, key_size) == 0;
+        });
+        if (kv) {
+            if (cache_) kv->entry.touch();
+            fn(kv);
         }
-        
-        current = kv->next_offset.load(std::memory_order_acquire);
     }
     
-    const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
-    const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
-    return false;
+    CollectionStats& stats = const_cast<CollectionStats&>(stats_);
+    (kv ? stats.hit_count : stats.miss_count).fetch_add(1, std::memory_order_relaxed);
+    stats.read_count.fetch_add(1, std::memory_order_relaxed);
+    return kv != nullptr;
 }
 
 std::vector<uint8_t> FastMap::getOrDefault(const uint8_t* key, size_t key_size,
@@ -335,39 +591,44 @@ std::vector<uint8_t> FastMap::getOrDefault(const uint8_t* key, size_t key_size,
 int64_t FastMap::getTTL(const uint8_t* key, size_t key_size) const {
     if (!key || key_size == 0) return 0;
     
-    uint32_t hash = compute_hash(key, key_size);
-    const ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(key, key_size);
     
-    void* base = file_manager_->segment_manager();
-    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
-    
-    while (current >= 0) {
-        const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-            static_cast<const uint8_t*>(base) + current
-        );
-        
-        if (kv->entry.is_alive() &&
-            kv->entry.hash_code == hash &&
-            kv->key_size == key_size &&
-            std::memcmp(kv->data, key, key_size) == 0) {
-            return kv->entry.remaining_ttl_seconds();
-        }
+    if (swiss_) {
+        IpcSharableLock lock(header_->global_mutex);
         
-        current = kv->next_offset.load(std::memory_order_acquire);
+        auto pos = swiss_->find(key, key_size, hash);
+        if (!pos || !swiss_->at(pos)->entry.is_alive()) return 0;
+        return swiss_->at(pos)->entry.remaining_ttl_seconds();
     }
     
-    return 0;
+    auto guard = epoch_->read();
+    const ShmKeyValue* kv = table_.find(hash, [&](const ShmKeyValue* kv) {
+        return kv->entry.is_alive() &&
+               hasher_.matches(kv->entry, hash) &&
+               kv->key_size == key_size &&
+               std::memcmp(kv->data, key, key_size) == 0;
+    });
+    
+    return kv ? kv->entry.remaining_ttl_seconds() : 0;
 }
 
-bool FastMap::remove(const uint8_t* key, size_t key_size,
-                     std::vector<uint8_t>* out_value) {
-    if (!key || key_size == 0) return false;
+bool FastMap::swiss_remove(const uint8_t* key, size_t key_size,
+                           uint64_t hash, std::vector<uint8_t>* out_value) {
+    auto pos = swiss_->find(key, key_size, hash);
+    if (!pos) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
-    
-    IpcScopedLock lock(bucket->mutex);
+    const ShmKeyValue* kv = swiss_->at(pos);
+    if (out_value && kv->entry.is_alive()) {
+        out_value->resize(kv->value_size);
+        std::memcpy(out_value->data(), kv->data + kv->key_size, kv->value_size);
+    }
     
+    swiss_erase(pos);
+    return true;
+}
+
+bool FastMap::remove_from_bucket(ShmBucket* bucket, const uint8_t* key, size_t key_size,
+                                 uint64_t hash, std::vector<uint8_t>* out_value) {
     void* base = file_manager_->segment_manager();
     ShmKeyValue* prev = nullptr;
     ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, &prev);
@@ -398,25 +659,66 @@ bool FastMap::remove(const uint8_t* key, size_t key_size,
         );
     }
     
+    table_.untag(bucket, kv->entry.hash_code);
     kv->entry.mark_deleted();
-    free_kv(kv);
+    retire_kv(kv);
     
-    bucket->size.fetch_sub(1, std::memory_order_acq_rel);
     header_->size.fetch_sub(1, std::memory_order_acq_rel);
-    header_->modified_at = current_timestamp_ns();
     stats_.size.fetch_sub(1, std::memory_order_relaxed);
     
     return true;
 }
 
+bool FastMap::remove(const uint8_t* key, size_t key_size,
+                     std::vector<uint8_t>* out_value) {
+    if (!key || key_size == 0) return false;
+    
+    uint64_t hash = hasher_(key, key_size);
+    bool removed;
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        removed = swiss_remove(key, key_size, hash, out_value);
+    } else {
+        table_.advance();
+        BucketGuard lock = table_.lock_bucket(hash);
+        ShmBucket* bucket = lock.bucket();
+        removed = remove_from_bucket(bucket, key, key_size, hash, out_value);
+    }
+    
+    if (removed) {
+        header_->modified_at = current_timestamp_ns();
+    }
+    return removed;
+}
+
 bool FastMap::remove(const uint8_t* key, size_t key_size,
                      const uint8_t* expected_value, size_t value_size) {
     if (!key || key_size == 0) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(key, key_size);
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        if (!pos) return false;
+        
+        const ShmKeyValue* kv = swiss_->at(pos);
+        if (!kv->entry.is_alive() ||
+            kv->value_size != value_size ||
+            std::memcmp(kv->data + kv->key_size, expected_value, value_size) != 0) {
+            return false;
+        }
+        
+        swiss_erase(pos);
+        header_->modified_at = current_timestamp_ns();
+        return true;
+    }
     
-    IpcScopedLock lock(bucket->mutex);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     void* base = file_manager_->segment_manager();
     ShmKeyValue* prev = nullptr;
@@ -449,10 +751,10 @@ bool FastMap::remove(const uint8_t* key, size_t key_size,
         );
     }
     
+    table_.untag(bucket, kv->entry.hash_code);
     kv->entry.mark_deleted();
-    free_kv(kv);
+    retire_kv(kv);
     
-    bucket->size.fetch_sub(1, std::memory_order_acq_rel);
     header_->size.fetch_sub(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
     stats_.size.fetch_sub(1, std::memory_order_relaxed);
@@ -460,119 +762,190 @@ bool FastMap::remove(const uint8_t* key, size_t key_size,
     return true;
 }
 
-size_t FastMap::removeExpired() {
+void FastMap::track_expiry(ShmEntry& entry) {
+    // Index first: a reaper that has already popped its due records then
+    // still sees this entry through the header bound
+    expiry_.track(&entry);
+    header_->note_expiry(entry.expires_at);
+}
+
+size_t FastMap::reap_bucket(ShmBucket* bucket, uint64_t& next_expiry, bool reindex) {
     size_t removed = 0;
     void* base = file_manager_->segment_manager();
+    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        ShmBucket* bucket = &buckets_[i];
-        IpcScopedLock lock(bucket->mutex);
-        
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    while (current >= 0) {
+        ShmKeyValue* kv = reinterpret_cast<ShmKeyValue*>(
+            static_cast<uint8_t*>(base) + current
+        );
+        int64_t next = kv->next_offset.load(std::memory_order_acquire);
         
-        while (current >= 0) {
-            ShmKeyValue* kv = reinterpret_cast<ShmKeyValue*>(
-                static_cast<uint8_t*>(base) + current
-            );
-            int64_t next = kv->next_offset.load(std::memory_order_acquire);
-            
-            if (kv->entry.is_expired()) {
-                int64_t prev = kv->prev_offset.load(std::memory_order_acquire);
-                
-                if (prev >= 0) {
-                    ShmKeyValue* prev_kv = reinterpret_cast<ShmKeyValue*>(
-                        static_cast<uint8_t*>(base) + prev
-                    );
-                    prev_kv->next_offset.store(next, std::memory_order_release);
-                } else {
-                    bucket->head_offset.store(next, std::memory_order_release);
-                }
-                
-                if (next >= 0) {
-                    ShmKeyValue* next_kv = reinterpret_cast<ShmKeyValue*>(
-                        static_cast<uint8_t*>(base) + next
-                    );
-                    next_kv->prev_offset.store(prev, std::memory_order_release);
-                }
-                
-                kv->entry.mark_deleted();
-                free_kv(kv);
-                
-                bucket->size.fetch_sub(1, std::memory_order_acq_rel);
-                header_->size.fetch_sub(1, std::memory_order_acq_rel);
-                stats_.size.fetch_sub(1, std::memory_order_relaxed);
-                removed++;
-            }
-            
-            current = next;
+        if (kv->entry.is_expired()) {
+            unlink_kv(bucket, kv);
+            removed++;
+        } else if (kv->entry.expires_at != 0) {
+            next_expiry = std::min(next_expiry, kv->entry.expires_at);
+            if (reindex) expiry_.track(&kv->entry);
         }
-    }
-    
-    if (removed > 0) {
-        header_->modified_at = current_timestamp_ns();
+        
+        current = next;
     }
     
     return removed;
 }
 
-bool FastMap::replace(const uint8_t* key, size_t key_size,
-                      const uint8_t* value, size_t value_size,
-                      int32_t ttl_seconds) {
-    if (!key || key_size == 0) return false;
-    
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
+size_t FastMap::removeExpired() {
+    return reapExpired(SIZE_MAX);
+}
+
+size_t FastMap::reapExpired(size_t max_items) {
+    if (expiry_.needs_rebuild()) {
+        return sweep_expired();
+    }
     
-    IpcScopedLock lock(bucket->mutex);
+    size_t removed = 0;
+    uint64_t now = current_timestamp_ns();
+    std::vector<uint32_t> hashes;
     
-    ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, nullptr);
-    if (!kv || !kv->entry.is_alive()) {
-        return false;
-    }
+    // Lock the swiss table before popping so no writer runs in between
+    std::optional<IpcExclusiveLock> swiss_lock;
+    if (swiss_) swiss_lock.emplace(header_->global_mutex);
     
-    void* base = file_manager_->segment_manager();
+    header_->begin_expiry_sweep();
     
-    if (kv->value_size == value_size) {
-        // Same size - update in place
-        std::memcpy(kv->data + key_size, value, value_size);
-        kv->entry.set_ttl(ttl_seconds);
-    } else {
-        // Different size - reallocate
-        int64_t prev_offset = kv->prev_offset.load(std::memory_order_acquire);
-        int64_t next_offset = kv->next_offset.load(std::memory_order_acquire);
-        
-        ShmKeyValue* new_kv = allocate_kv(key_size, value_size);
-        SerializationUtil::copy_to_kv(new_kv, key, key_size, value, value_size, ttl_seconds);
-        
-        int64_t new_offset = static_cast<uint8_t*>(static_cast<void*>(new_kv)) - 
-                             static_cast<uint8_t*>(base);
+    // Keep popping until enough was removed or nothing is due
+    while (removed < max_items) {
+        hashes.clear();
+        expiry_.pop_due(now, hashes, max_items - removed);
+        if (hashes.empty()) break;
         
-        new_kv->prev_offset.store(prev_offset, std::memory_order_release);
-        new_kv->next_offset.store(next_offset, std::memory_order_release);
+        // Several due entries may share a hash or a bucket
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
         
-        if (prev_offset >= 0) {
-            ShmKeyValue* prev_kv = reinterpret_cast<ShmKeyValue*>(
-                static_cast<uint8_t*>(base) + prev_offset
-            );
-            prev_kv->next_offset.store(new_offset, std::memory_order_release);
+        if (swiss_) {
+            std::vector<SwissTable::Position> positions;
+            for (uint32_t hash : hashes) {
+                positions.clear();
+                swiss_->find_hash(hash, positions);
+                for (const auto& pos : positions) {
+                    if (swiss_->at(pos)->entry.is_expired()) {
+                        swiss_erase(pos);
+                        removed++;
+                    }
+                }
+            }
         } else {
-            bucket->head_offset.store(new_offset, std::memory_order_release);
+            // Survivors of these buckets still have records of their own
+            uint64_t unused = CollectionHeader::NO_EXPIRY;
+            for (uint32_t hash : hashes) {
+                table_.advance();
+                BucketGuard lock = table_.lock_bucket(hash);
+                ShmBucket* bucket = lock.bucket();
+                removed += reap_bucket(bucket, unused, false);
+            }
         }
+    }
+    header_->note_expiry(expiry_.next_expiry());
+    
+    if (removed > 0) {
+        header_->modified_at = current_timestamp_ns();
+    }
+    return removed;
+}
+
+size_t FastMap::parallelRemoveExpired() {
+    return sweep_expired(true);
+}
+
+size_t FastMap::sweep_expired(bool parallel) {
+    std::atomic<size_t> removed{0};
+    uint64_t next_expiry = CollectionHeader::NO_EXPIRY;
+    
+    // Swiss erasure updates table-wide counters, so that engine always
+    // sweeps on this thread
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        header_->begin_expiry_sweep();
+        expiry_.reset();
         
-        if (next_offset >= 0) {
-            ShmKeyValue* next_kv = reinterpret_cast<ShmKeyValue*>(
-                static_cast<uint8_t*>(base) + next_offset
-            );
-            next_kv->prev_offset.store(new_offset, std::memory_order_release);
+        swiss_->for_each([&](const SwissTable::Position& pos) {
+            ShmEntry& entry = swiss_->at(pos)->entry;
+            if (entry.is_expired()) {
+                swiss_erase(pos);
+                removed++;
+            } else if (entry.expires_at != 0) {
+                next_expiry = std::min(next_expiry, entry.expires_at);
+                expiry_.track(&entry);
+            }
+            return true;
+        });
+    } else {
+        // Writers add their own records while the walk runs, so records
+        // dropped by reset() are either re-added here or by them
+        header_->begin_expiry_sweep();
+        expiry_.reset();
+        
+        auto reap = [&](ShmBucket* bucket) {
+            uint64_t bucket_expiry = CollectionHeader::NO_EXPIRY;
+            removed.fetch_add(reap_bucket(bucket, bucket_expiry, true), std::memory_order_relaxed);
+            header_->note_expiry(bucket_expiry);
+            return true;
+        };
+        if (parallel) {
+            table_.for_each_locked_bucket_parallel(reap);
+        } else {
+            table_.for_each_locked_bucket(reap);
+        }
+    }
+    expiry_.mark_complete();
+    header_->note_expiry(next_expiry);
+    
+    if (removed > 0) {
+        header_->modified_at = current_timestamp_ns();
+    }
+    return removed.load();
+}
+
+bool FastMap::replace(const uint8_t* key, size_t key_size,
+                      const uint8_t* value, size_t value_size,
+                      int32_t ttl_seconds) {
+    if (!key || key_size == 0) return false;
+    
+    uint64_t hash = hasher_(key, key_size);
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        if (!pos || !swiss_->at(pos)->entry.is_alive()) {
+            return false;
         }
         
-        kv->entry.mark_deleted();
-        free_kv(kv);
+        swiss_assign(pos, key, key_size, value, value_size, hash, ttl_seconds);
+        header_->modified_at = current_timestamp_ns();
+        stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+        if (cache_) enforce_budget(nullptr, 0, hash);
+        return true;
     }
     
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
+    
+    ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, nullptr);
+    if (!kv || !kv->entry.is_alive()) {
+        return false;
+    }
+    
+    swap_kv(bucket, kv, key, key_size, value, value_size, hash, ttl_seconds);
+    
     header_->modified_at = current_timestamp_ns();
     stats_.write_count.fetch_add(1, std::memory_order_relaxed);
     
+    // The new value may be larger than the old one
+    lock.unlock();
+    if (cache_) enforce_budget(nullptr, 0, hash);
     return true;
 }
 
@@ -582,10 +955,31 @@ bool FastMap::replace(const uint8_t* key, size_t key_size,
                       int32_t ttl_seconds) {
     if (!key || key_size == 0) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(key, key_size);
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        if (!pos) return false;
+        
+        const ShmKeyValue* kv = swiss_->at(pos);
+        if (!kv->entry.is_alive() ||
+            kv->value_size != old_value_size ||
+            std::memcmp(kv->data + kv->key_size, old_value, old_value_size) != 0) {
+            return false;
+        }
+        
+        swiss_assign(pos, key, key_size, new_value, new_value_size, hash, ttl_seconds);
+        header_->modified_at = current_timestamp_ns();
+        stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+        if (cache_) enforce_budget(nullptr, 0, hash);
+        return true;
+    }
     
-    IpcScopedLock lock(bucket->mutex);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, nullptr);
     if (!kv || !kv->entry.is_alive()) {
@@ -598,57 +992,39 @@ bool FastMap::replace(const uint8_t* key, size_t key_size,
         return false;
     }
     
-    void* base = file_manager_->segment_manager();
-    
-    if (kv->value_size == new_value_size) {
-        std::memcpy(kv->data + key_size, new_value, new_value_size);
-        kv->entry.set_ttl(ttl_seconds);
-    } else {
-        int64_t prev_offset = kv->prev_offset.load(std::memory_order_acquire);
-        int64_t next_offset = kv->next_offset.load(std::memory_order_acquire);
-        
-        ShmKeyValue* new_kv = allocate_kv(key_size, new_value_size);
-        SerializationUtil::copy_to_kv(new_kv, key, key_size, new_value, new_value_size, ttl_seconds);
-        
-        int64_t new_offset = static_cast<uint8_t*>(static_cast<void*>(new_kv)) - 
-                             static_cast<uint8_t*>(base);
-        
-        new_kv->prev_offset.store(prev_offset, std::memory_order_release);
-        new_kv->next_offset.store(next_offset, std::memory_order_release);
-        
-        if (prev_offset >= 0) {
-            ShmKeyValue* prev_kv = reinterpret_cast<ShmKeyValue*>(
-                static_cast<uint8_t*>(base) + prev_offset
-            );
-            prev_kv->next_offset.store(new_offset, std::memory_order_release);
-        } else {
-            bucket->head_offset.store(new_offset, std::memory_order_release);
-        }
-        
-        if (next_offset >= 0) {
-            ShmKeyValue* next_kv = reinterpret_cast<ShmKeyValue*>(
-                static_cast<uint8_t*>(base) + next_offset
-            );
-            next_kv->prev_offset.store(new_offset, std::memory_order_release);
-        }
-        
-        kv->entry.mark_deleted();
-        free_kv(kv);
-    }
+    swap_kv(bucket, kv, key, key_size, new_value, new_value_size, hash, ttl_seconds);
     
     header_->modified_at = current_timestamp_ns();
     stats_.write_count.fetch_add(1, std::memory_order_relaxed);
     
+    // The new value may be larger than the old one
+    lock.unlock();
+    if (cache_) enforce_budget(nullptr, 0, hash);
     return true;
 }
 
 bool FastMap::setTTL(const uint8_t* key, size_t key_size, int32_t ttl_seconds) {
     if (!key || key_size == 0) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(key, key_size);
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        if (!pos || !swiss_->at(pos)->entry.is_alive()) {
+            return false;
+        }
+        
+        swiss_->at(pos)->entry.set_ttl(ttl_seconds);
+        track_expiry(swiss_->at(pos)->entry);
+        header_->modified_at = current_timestamp_ns();
+        return true;
+    }
     
-    IpcScopedLock lock(bucket->mutex);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, nullptr);
     if (!kv || !kv->entry.is_alive()) {
@@ -656,113 +1032,689 @@ bool FastMap::setTTL(const uint8_t* key, size_t key_size, int32_t ttl_seconds) {
     }
     
     kv->entry.set_ttl(ttl_seconds);
+    track_expiry(kv->entry);
     header_->modified_at = current_timestamp_ns();
     
     return true;
 }
 
-bool FastMap::containsKey(const uint8_t* key, size_t key_size) const {
+bool FastMap::putIfVersion(const uint8_t* key, size_t key_size,
+                           const uint8_t* value, size_t value_size,
+                           uint64_t expected_version, int32_t ttl_seconds) {
     if (!key || key_size == 0) return false;
     
-    uint32_t hash = compute_hash(key, key_size);
-    const ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(key, key_size);
+    if (sketch_) sketch_.increment(hash);
+    bool added;
     
-    void* base = file_manager_->segment_manager();
-    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        const ShmKeyValue* kv = pos ? swiss_->at(pos) : nullptr;
+        uint64_t current = kv && kv->entry.is_alive() ? kv->entry.current_version() : 0;
+        if (current != expected_version) return false;
+        
+        added = swiss_put(key, key_size, value, value_size, hash, ttl_seconds);
+        header_->modified_at = current_timestamp_ns();
+        stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+        return !cache_ || enforce_budget(added ? key : nullptr, key_size, hash);
+    }
     
-    while (current >= 0) {
-        const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-            static_cast<const uint8_t*>(base) + current
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
+    
+    ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, nullptr);
+    uint64_t current = kv && kv->entry.is_alive() ? kv->entry.current_version() : 0;
+    if (current != expected_version) return false;
+    
+    added = put_in_bucket(bucket, key, key_size, value, value_size, hash, ttl_seconds);
+    header_->modified_at = current_timestamp_ns();
+    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+    
+    lock.unlock();
+    return !cache_ || enforce_budget(added ? key : nullptr, key_size, hash);
+}
+
+namespace {
+
+// Counter values are int64 in native byte order. When the value slot is
+// aligned, writers store it with one atomic write and readers load it the
+// same way, so a lock-free reader never sees half of an update
+bool counter_aligned(const uint8_t* slot) {
+    return reinterpret_cast<uintptr_t>(slot) % alignof(int64_t) == 0;
+}
+
+int64_t load_counter(const uint8_t* value, size_t value_size) {
+    if (value_size != sizeof(int64_t)) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INVALID_ARGUMENT,
+            "Value is not a 64-bit counter"
         );
+    }
+    uint8_t* slot = const_cast<uint8_t*>(value);
+    if (counter_aligned(slot)) {
+        return std::atomic_ref<int64_t>(*reinterpret_cast<int64_t*>(slot))
+            .load(std::memory_order_acquire);
+    }
+    int64_t counter;
+    std::memcpy(&counter, slot, sizeof(counter));
+    return counter;
+}
+
+} // namespace
+
+bool FastMap::update_counter(const uint8_t* key, size_t key_size, int32_t ttl_seconds,
+                             bool create,
+                             const std::function<bool(int64_t current, int64_t& next)>& fn,
+                             int64_t& previous) {
+    if (!key || key_size == 0) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INVALID_ARGUMENT,
+            "Counter key must not be empty"
+        );
+    }
+    
+    uint64_t hash = hasher_(key, key_size);
+    if (sketch_) sketch_.increment(hash);
+    previous = 0;
+    int64_t next = 0;
+    bool added = false;
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
         
-        if (kv->entry.is_alive() &&
-            kv->entry.hash_code == hash &&
-            kv->key_size == key_size &&
-            std::memcmp(kv->data, key, key_size) == 0) {
-            return true;
+        auto pos = swiss_->find(key, key_size, hash);
+        if (pos && swiss_->at(pos)->entry.is_alive()) {
+            // Readers hold the shared lock, so the slot can change in place
+            ShmKeyValue* kv = swiss_->at(pos);
+            previous = load_counter(kv->value_data(), kv->value_size);
+            if (!fn(previous, next)) return false;
+            std::memcpy(kv->value_data(), &next, sizeof(next));
+            kv->entry.stamp_version(versions_->next());
+            if (cache_) kv->entry.touch();
+        } else {
+            if (!create || !fn(previous, next)) return false;
+            added = swiss_put(key, key_size, reinterpret_cast<const uint8_t*>(&next),
+                              sizeof(next), hash, ttl_seconds);
         }
+        if (cache_ && added) enforce_budget(key, key_size, hash);
+    } else {
+        table_.advance();
+        BucketGuard lock = table_.lock_bucket(hash);
+        ShmBucket* bucket = lock.bucket();
         
-        current = kv->next_offset.load(std::memory_order_acquire);
+        ShmKeyValue* kv = find_in_bucket(bucket, key, key_size, hash, nullptr);
+        if (kv && kv->entry.is_alive()) {
+            previous = load_counter(kv->value_data(), kv->value_size);
+            if (!fn(previous, next)) return false;
+            
+            uint8_t* slot = kv->value_data();
+            if (counter_aligned(slot)) {
+                std::atomic_ref<int64_t>(*reinterpret_cast<int64_t*>(slot))
+                    .store(next, std::memory_order_release);
+                kv->entry.stamp_version(versions_->next());
+                if (cache_) kv->entry.touch();
+            } else {
+                swap_kv(bucket, kv, key, key_size, reinterpret_cast<const uint8_t*>(&next),
+                        sizeof(next), hash, TTL_INFINITE, true);
+            }
+        } else {
+            if (!create || !fn(previous, next)) return false;
+            added = put_in_bucket(bucket, key, key_size, reinterpret_cast<const uint8_t*>(&next),
+                                  sizeof(next), hash, ttl_seconds);
+        }
+        
+        // Updates keep the size of the entry; only a new counter can push the
+        // map over its budget
+        lock.unlock();
+        if (cache_ && added) enforce_budget(key, key_size, hash);
     }
     
-    return false;
+    header_->modified_at = current_timestamp_ns();
+    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+int64_t FastMap::incrementBy(const uint8_t* key, size_t key_size, int64_t delta,
+                             int32_t ttl_seconds) {
+    int64_t previous;
+    int64_t result = 0;
+    update_counter(key, key_size, ttl_seconds, true, [&](int64_t current, int64_t& next) {
+        // Wrap like Java's AtomicLong instead of overflowing
+        next = static_cast<int64_t>(static_cast<uint64_t>(current) + static_cast<uint64_t>(delta));
+        result = next;
+        return true;
+    }, previous);
+    return result;
+}
+
+int64_t FastMap::getAndSet(const uint8_t* key, size_t key_size, int64_t value,
+                           int32_t ttl_seconds) {
+    int64_t previous;
+    update_counter(key, key_size, ttl_seconds, true, [&](int64_t, int64_t& next) {
+        next = value;
+        return true;
+    }, previous);
+    return previous;
+}
+
+bool FastMap::compareAndSet(const uint8_t* key, size_t key_size,
+                            int64_t expected, int64_t desired) {
+    int64_t previous;
+    return update_counter(key, key_size, TTL_INFINITE, false, [&](int64_t current, int64_t& next) {
+        next = desired;
+        return current == expected;
+    }, previous);
+}
+
+std::optional<int64_t> FastMap::getCounter(const uint8_t* key, size_t key_size) const {
+    std::optional<int64_t> result;
+    getWith(key, key_size, [&](const uint8_t* value, size_t value_size) {
+        result = load_counter(value, value_size);
+    });
+    return result;
+}
+
+bool FastMap::containsKey(const uint8_t* key, size_t key_size) const {
+    if (!key || key_size == 0) return false;
+    
+    uint64_t hash = hasher_(key, key_size);
+    
+    if (swiss_) {
+        IpcSharableLock lock(header_->global_mutex);
+        
+        auto pos = swiss_->find(key, key_size, hash);
+        return pos && swiss_->at(pos)->entry.is_alive();
+    }
+    
+    auto guard = epoch_->read();
+    return table_.find(hash, [&](const ShmKeyValue* kv) {
+        return kv->entry.is_alive() &&
+               hasher_.matches(kv->entry, hash) &&
+               kv->key_size == key_size &&
+               std::memcmp(kv->data, key, key_size) == 0;
+    }) != nullptr;
 }
 
 bool FastMap::containsValue(const uint8_t* value, size_t value_size) const {
-    void* base = file_manager_->segment_manager();
+    if (swiss_) {
+        return !swiss_sweep([&](const uint8_t*, size_t, const uint8_t* data, size_t size, int64_t) {
+            return size != value_size || std::memcmp(data, value, value_size) != 0;
+        });
+    }
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    bool found = false;
+    
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmKeyValue* kv) {
+        if (kv->entry.is_alive() &&
+            kv->value_size == value_size &&
+            std::memcmp(kv->data + kv->key_size, value, value_size) == 0) {
+            found = true;
+            return false;
+        }
+        return true;
+    });
+    
+    return found;
+}
+
+std::vector<size_t> FastMap::bucket_order(const std::vector<uint64_t>& hashes) const {
+    // Stable, so repeated keys are still applied in the caller's order
+    uint32_t mask = table_.bucket_count() - 1;
+    std::vector<size_t> order(hashes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return (hashes[a] & mask) < (hashes[b] & mask);
+    });
+    return order;
+}
+
+std::vector<std::optional<std::vector<uint8_t>>> FastMap::multiGet(
+    const std::vector<std::vector<uint8_t>>& keys) const {
+    std::vector<std::optional<std::vector<uint8_t>>> results(keys.size());
+    
+    std::vector<uint64_t> hashes(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        hashes[i] = hasher_(keys[i].data(), keys[i].size());
+    }
+    
+    if (sketch_) {
+        for (uint64_t hash : hashes) const_cast<FrequencySketch&>(sketch_).increment(hash);
+    }
+    
+    size_t hits = 0;
+    auto take = [&](size_t i, const ShmKeyValue* kv) {
+        if (cache_) kv->entry.touch();
+        const uint8_t* value = kv->data + kv->key_size;
+        results[i].emplace(value, value + kv->value_size);
+        hits++;
+    };
+    
+    // Software pipeline over groups of PREFETCH_GROUP keys: while group g is
+    // resolved, the chain heads of group g+1 and the buckets of group g+2 are
+    // already on their way into the cache
+    auto group_end = [&](size_t start) { return std::min(keys.size(), start + PREFETCH_GROUP); };
+    
+    if (swiss_) {
+        IpcSharableLock lock(header_->global_mutex);
         
-        while (current >= 0) {
-            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-                static_cast<const uint8_t*>(base) + current
-            );
+        for (size_t i = 0; i < group_end(0); i++) {
+            swiss_->prefetch(hashes[i]);
+        }
+        for (size_t start = 0; start < keys.size(); start += PREFETCH_GROUP) {
+            for (size_t i = group_end(start); i < group_end(start + PREFETCH_GROUP); i++) {
+                swiss_->prefetch(hashes[i]);
+            }
+            for (size_t i = start; i < group_end(start); i++) {
+                if (keys[i].empty()) continue;
+                auto pos = swiss_->find(keys[i].data(), keys[i].size(), hashes[i]);
+                if (pos && swiss_->at(pos)->entry.is_alive()) {
+                    take(i, swiss_->at(pos));
+                }
+            }
+        }
+    } else {
+        auto guard = epoch_->read();
+        
+        for (size_t i = 0; i < group_end(PREFETCH_GROUP); i++) {
+            table_.prefetch_bucket(hashes[i]);
+        }
+        for (size_t i = 0; i < group_end(0); i++) {
+            table_.prefetch_chain(hashes[i]);
+        }
+        for (size_t start = 0; start < keys.size(); start += PREFETCH_GROUP) {
+            size_t next = start + PREFETCH_GROUP;
+            for (size_t i = group_end(next); i < group_end(next + PREFETCH_GROUP); i++) {
+                table_.prefetch_bucket(hashes[i]);
+            }
+            for (size_t i = std::min(keys.size(), next); i < group_end(next); i++) {
+                table_.prefetch_chain(hashes[i]);
+            }
             
-            if (kv->entry.is_alive() &&
-                kv->value_size == value_size &&
-                std::memcmp(kv->data + kv->key_size, value, value_size) == 0) {
-                return true;
+            for (size_t i = start; i < group_end(start); i++) {
+                if (keys[i].empty()) continue;
+                
+                const uint8_t* key = keys[i].data();
+                size_t key_size = keys[i].size();
+                uint64_t hash = hashes[i];
+                const ShmKeyValue* kv = table_.find(hash, [&](const ShmKeyValue* kv) {
+                    return kv->entry.is_alive() &&
+                           hasher_.matches(kv->entry, hash) &&
+                           kv->key_size == key_size &&
+                           std::memcmp(kv->data, key, key_size) == 0;
+                });
+                if (kv) take(i, kv);
             }
+        }
+    }
+    
+    CollectionStats& stats = const_cast<CollectionStats&>(stats_);
+    stats.hit_count.fetch_add(hits, std::memory_order_relaxed);
+    stats.miss_count.fetch_add(keys.size() - hits, std::memory_order_relaxed);
+    stats.read_count.fetch_add(keys.size(), std::memory_order_relaxed);
+    
+    return results;
+}
+
+size_t FastMap::multiPut(const std::vector<std::vector<uint8_t>>& keys,
+                         const std::vector<std::vector<uint8_t>>& values,
+                         int32_t ttl_seconds) {
+    if (keys.size() != values.size()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INVALID_ARGUMENT,
+            "multiPut: keys and values differ in length"
+        );
+    }
+    
+    std::vector<uint64_t> hashes(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        hashes[i] = hasher_(keys[i].data(), keys[i].size());
+    }
+    
+    if (sketch_) {
+        for (uint64_t hash : hashes) sketch_.increment(hash);
+    }
+    
+    size_t stored = 0;
+    
+    // In cache mode the batch is admitted as a whole and evicts once at the end
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i].empty()) continue;
+            swiss_put(keys[i].data(), keys[i].size(), values[i].data(), values[i].size(),
+                      hashes[i], ttl_seconds);
+            stored++;
+        }
+        if (cache_) enforce_budget(nullptr, 0, 0);
+    } else {
+        BucketGuard lock;
+        
+        for (size_t i : bucket_order(hashes)) {
+            if (keys[i].empty()) continue;
             
-            current = kv->next_offset.load(std::memory_order_acquire);
+            if (!lock.owns() || !table_.owns(lock.bucket(), hashes[i])) {
+                // advance() may migrate the held bucket, so release it first
+                lock.unlock();
+                table_.advance();
+                lock = table_.lock_bucket(hashes[i]);
+            }
+            
+            put_in_bucket(lock.bucket(), keys[i].data(), keys[i].size(),
+                          values[i].data(), values[i].size(), hashes[i], ttl_seconds);
+            stored++;
         }
+        
+        lock.unlock();
+        if (cache_) enforce_budget(nullptr, 0, 0);
     }
     
-    return false;
+    if (stored > 0) {
+        header_->modified_at = current_timestamp_ns();
+        stats_.write_count.fetch_add(stored, std::memory_order_relaxed);
+    }
+    return stored;
 }
 
-void FastMap::forEach(std::function<bool(const uint8_t* key, size_t key_size,
-                                          const uint8_t* value, size_t value_size)> callback) const {
-    void* base = file_manager_->segment_manager();
+size_t FastMap::multiRemove(const std::vector<std::vector<uint8_t>>& keys) {
+    std::vector<uint64_t> hashes(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        hashes[i] = hasher_(keys[i].data(), keys[i].size());
+    }
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    size_t removed = 0;
+    
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
         
-        while (current >= 0) {
-            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-                static_cast<const uint8_t*>(base) + current
-            );
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i].empty()) continue;
+            if (swiss_remove(keys[i].data(), keys[i].size(), hashes[i], nullptr)) removed++;
+        }
+    } else {
+        BucketGuard lock;
+        
+        for (size_t i : bucket_order(hashes)) {
+            if (keys[i].empty()) continue;
+            
+            if (!lock.owns() || !table_.owns(lock.bucket(), hashes[i])) {
+                lock.unlock();
+                table_.advance();
+                lock = table_.lock_bucket(hashes[i]);
+            }
             
-            if (kv->entry.is_alive()) {
-                if (!callback(kv->data, kv->key_size, 
-                             kv->data + kv->key_size, kv->value_size)) {
-                    return;
+            if (remove_from_bucket(lock.bucket(), keys[i].data(), keys[i].size(), hashes[i], nullptr)) {
+                removed++;
+            }
+        }
+    }
+    
+    if (removed > 0) {
+        header_->modified_at = current_timestamp_ns();
+    }
+    return removed;
+}
+
+bool FastMap::over_budget() const {
+    return (cache_->max_entries != 0 &&
+            header_->size.load(std::memory_order_acquire) > cache_->max_entries) ||
+           (cache_->max_bytes != 0 &&
+            header_->total_bytes.load(std::memory_order_acquire) > cache_->max_bytes);
+}
+
+FastMap::ClockVerdict FastMap::clock_visit(const ShmKeyValue* kv, const uint8_t* key,
+                                           size_t key_size, uint64_t hash) const {
+    if (kv->entry.is_expired()) return ClockVerdict::EVICT;
+    
+    // The key being admitted is never its own victim
+    if (key && hasher_.matches(kv->entry, hash) && kv->key_size == key_size &&
+        std::memcmp(kv->data, key, key_size) == 0) {
+        return ClockVerdict::SKIP;
+    }
+    
+    // Second chance for entries used since the hand last passed
+    if (kv->entry.referenced.load(std::memory_order_relaxed)) {
+        kv->entry.referenced.store(0, std::memory_order_relaxed);
+        return ClockVerdict::SKIP;
+    }
+    
+    // TinyLFU admission: a newcomer only displaces a victim it is at least as popular as
+    if (key && sketch_ && sketch_.frequency(hash) < sketch_.frequency(kv->entry.hash_code)) {
+        return ClockVerdict::REJECT;
+    }
+    return ClockVerdict::EVICT;
+}
+
+bool FastMap::enforce_budget(const uint8_t* key, size_t key_size, uint64_t hash) {
+    if (!over_budget()) return true;
+    
+    size_t evicted = 0;
+    bool rejected = false;
+    
+    if (swiss_) {
+        // The hand is a scan cursor over home groups, so a rehash between
+        // calls neither repeats nor skips groups of the current lap. Two
+        // full turns: the first may do nothing but clear reference bits
+        uint32_t groups = swiss_->slot_count() / SwissGroup::WIDTH;
+        uint64_t hand = cache_->clock_hand.load(std::memory_order_relaxed);
+        uint64_t cursor = hand >> SWISS_HAND_SHIFT;
+        size_t passed = hand & SWISS_HAND_PASSED;
+        std::vector<SwissTable::Position> homed;
+        for (uint64_t n = 0; n <= 2ull * groups && !rejected && over_budget(); n++) {
+            // Collect first: erasing would change the probes that find them
+            homed.clear();
+            uint64_t next = swiss_->scan_from(cursor, 1, [&](const SwissTable::Position& pos) {
+                homed.push_back(pos);
+                return true;
+            });
+            
+            // Entries evicted here drop out of the group, survivors keep their order
+            size_t i = std::min(passed, homed.size());
+            for (; i < homed.size() && !rejected && over_budget(); i++) {
+                switch (clock_visit(swiss_->at(homed[i]), key, key_size, hash)) {
+                case ClockVerdict::EVICT:
+                    swiss_erase(homed[i]);
+                    evicted++;
+                    break;
+                case ClockVerdict::REJECT:
+                    rejected = true;
+                    break;
+                case ClockVerdict::SKIP:
+                    passed++;
+                    break;
                 }
             }
             
-            current = kv->next_offset.load(std::memory_order_acquire);
+            if (i < homed.size()) break;
+            cursor = next;
+            passed = 0;
+        }
+        cache_->clock_hand.store((cursor << SWISS_HAND_SHIFT) | std::min<uint64_t>(passed, SWISS_HAND_PASSED),
+                                 std::memory_order_relaxed);
+        
+        // Also drop a newcomer that cannot fit even on its own
+        if (key && (rejected || over_budget())) {
+            rejected = swiss_remove(key, key_size, hash, nullptr);
         }
+    } else {
+        void* base = file_manager_->segment_manager();
+        
+        // Sweeps lock one bucket at a time; evict_mutex keeps concurrent
+        // writers from each evicting on behalf of the same overflow
+        IpcScopedLock evict_lock(cache_->evict_mutex);
+        
+        for (int turn = 0; turn < 2 && !rejected && over_budget(); turn++) {
+            uint64_t hand = cache_->clock_hand.load(std::memory_order_relaxed);
+            table_.for_each_locked_bucket_from(hand, [&](uint64_t resume, ShmBucket* bucket) {
+                int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+                while (current >= 0 && over_budget()) {
+                    ShmKeyValue* kv = reinterpret_cast<ShmKeyValue*>(
+                        static_cast<uint8_t*>(base) + current
+                    );
+                    int64_t next = kv->next_offset.load(std::memory_order_acquire);
+                    
+                    ClockVerdict verdict = clock_visit(kv, key, key_size, hash);
+                    if (verdict == ClockVerdict::REJECT) {
+                        rejected = true;
+                        break;
+                    }
+                    if (verdict == ClockVerdict::EVICT) {
+                        unlink_kv(bucket, kv);
+                        evicted++;
+                    }
+                    current = next;
+                }
+                
+                // Resume at the next bucket, so entries given a second chance
+                // here are not revisited straight away. The hand is a scan
+                // cursor, so it keeps its place across resizes
+                cache_->clock_hand.store(resume, std::memory_order_relaxed);
+                return !rejected && over_budget();
+            });
+        }
+        
+        if (key && (rejected || over_budget())) {
+            BucketGuard lock = table_.lock_bucket(hash);
+            ShmBucket* bucket = lock.bucket();
+            rejected = remove_from_bucket(bucket, key, key_size, hash, nullptr);
+        }
+        
+        // Hand evicted nodes back to the allocator now rather than after
+        // further retirements, so the file does not grow meanwhile
+        if (evicted > 0 || rejected) epoch_->reclaim();
     }
+    
+    if (evicted > 0) {
+        stats_.eviction_count.fetch_add(evicted, std::memory_order_relaxed);
+        header_->modified_at = current_timestamp_ns();
+    }
+    if (rejected) {
+        stats_.rejection_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return !rejected;
+}
+
+void FastMap::forEach(std::function<bool(const uint8_t* key, size_t key_size,
+                                          const uint8_t* value, size_t value_size)> callback) const {
+    if (swiss_) {
+        swiss_sweep([&](const uint8_t* key, size_t key_size,
+                        const uint8_t* value, size_t value_size, int64_t) {
+            return callback(key, key_size, value, value_size);
+        });
+        return;
+    }
+    
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmKeyValue* kv) {
+        if (kv->entry.is_alive()) {
+            if (!callback(kv->data, kv->key_size,
+                         kv->data + kv->key_size, kv->value_size)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+void FastMap::parallelForEach(std::function<bool(const uint8_t* key, size_t key_size,
+                                                  const uint8_t* value, size_t value_size)> callback) const {
+    if (swiss_) {
+        swiss_sweep([&](const uint8_t* key, size_t key_size,
+                        const uint8_t* value, size_t value_size, int64_t) {
+            return callback(key, key_size, value, value_size);
+        }, true);
+        return;
+    }
+    
+    table_.for_each_node_parallel([&](const ShmKeyValue* kv) {
+        if (kv->entry.is_alive()) {
+            if (!callback(kv->data, kv->key_size,
+                         kv->data + kv->key_size, kv->value_size)) {
+                return false;
+            }
+        }
+        return true;
+    }, [this] { return epoch_->read(); });
 }
 
 void FastMap::forEachWithTTL(std::function<bool(const uint8_t* key, size_t key_size,
                                                  const uint8_t* value, size_t value_size,
                                                  int64_t ttl_remaining)> callback) const {
-    void* base = file_manager_->segment_manager();
+    if (swiss_) {
+        swiss_sweep(callback);
+        return;
+    }
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmKeyValue* kv) {
+        if (kv->entry.is_alive()) {
+            int64_t ttl = kv->entry.remaining_ttl_seconds();
+            if (!callback(kv->data, kv->key_size,
+                         kv->data + kv->key_size, kv->value_size, ttl)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+bool FastMap::swiss_sweep(const std::function<bool(const uint8_t* key, size_t key_size,
+                                                   const uint8_t* value, size_t value_size,
+                                                   int64_t ttl_remaining)>& fn,
+                          bool parallel) const {
+    struct Copy {
+        size_t offset;  // Of the key in bytes; the value follows it
+        size_t key_size;
+        size_t value_size;
+        int64_t ttl_remaining;
+    };
+    std::vector<uint8_t> bytes;
+    std::vector<Copy> copies;
+    uint64_t cursor = 0;
+    
+    do {
+        bytes.clear();
+        copies.clear();
+        {
+            // Scan order visits every entry present throughout once, even
+            // if the table grows between steps
+            IpcSharableLock lock(header_->global_mutex);
+            cursor = swiss_->scan_from(cursor, SWISS_SWEEP_GROUPS, [&](const SwissTable::Position& pos) {
+                const ShmKeyValue* kv = swiss_->at(pos);
+                if (kv->entry.is_alive()) {
+                    copies.push_back(Copy{bytes.size(), kv->key_size, kv->value_size,
+                                          kv->entry.remaining_ttl_seconds()});
+                    bytes.insert(bytes.end(), kv->data, kv->data + kv->key_size + kv->value_size);
+                }
+                return true;
+            });
+        }
         
-        while (current >= 0) {
-            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-                static_cast<const uint8_t*>(base) + current
-            );
-            
-            if (kv->entry.is_alive()) {
-                int64_t ttl = kv->entry.remaining_ttl_seconds();
-                if (!callback(kv->data, kv->key_size,
-                             kv->data + kv->key_size, kv->value_size, ttl)) {
-                    return;
+        // The lock is released, so fn may write the map
+        auto deliver = [&](const Copy& copy) {
+            const uint8_t* key = bytes.data() + copy.offset;
+            return fn(key, copy.key_size, key + copy.key_size, copy.value_size, copy.ttl_remaining);
+        };
+        if (parallel) {
+            std::atomic<bool> stop{false};
+            ThreadPool::instance().parallel_for(copies.size(), [&](size_t i) {
+                if (!stop.load(std::memory_order_relaxed) && !deliver(copies[i])) {
+                    stop.store(true, std::memory_order_relaxed);
                 }
+            });
+            if (stop.load()) return false;
+        } else {
+            for (const Copy& copy : copies) {
+                if (!deliver(copy)) return false;
             }
-            
-            current = kv->next_offset.load(std::memory_order_acquire);
         }
-    }
+    } while (cursor != 0);
+    
+    return true;
 }
 
 void FastMap::forEachKey(std::function<bool(const uint8_t* key, size_t key_size)> callback) const {
@@ -803,13 +1755,87 @@ std::vector<std::vector<uint8_t>> FastMap::values() const {
     return vals;
 }
 
-void FastMap::clear() {
+uint64_t FastMap::scan(uint64_t cursor, size_t count,
+                       std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>& out_batch) const {
+    out_batch.clear();
+    count = std::max<size_t>(count, 1);
+    
+    // Bound the buckets one call may visit, so a sparse table cannot turn
+    // a step back into a full sweep
+    size_t max_buckets = count * SCAN_BUCKETS_PER_ENTRY;
+    
+    auto add = [&](const ShmKeyValue* kv) {
+        if (kv->entry.is_alive()) {
+            out_batch.emplace_back(std::vector<uint8_t>(kv->data, kv->data + kv->key_size),
+                                   std::vector<uint8_t>(kv->data + kv->key_size,
+                                                        kv->data + kv->key_size + kv->value_size));
+        }
+    };
+    
+    if (swiss_) {
+        IpcSharableLock lock(header_->global_mutex);
+        return swiss_->scan_from(cursor, max_buckets, [&](const SwissTable::Position& pos) {
+            add(swiss_->at(pos));
+            return out_batch.size() < count;
+        });
+    }
+    
     void* base = file_manager_->segment_manager();
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        ShmBucket* bucket = &buckets_[i];
-        IpcScopedLock lock(bucket->mutex);
+    auto guard = epoch_->read();
+    return table_.scan_from(cursor, max_buckets, [&](ShmBucket* bucket) {
+        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+        
+        while (current >= 0) {
+            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
+                static_cast<const uint8_t*>(base) + current
+            );
+            add(kv);
+            current = kv->next_offset.load(std::memory_order_acquire);
+        }
         
+        return out_batch.size() < count;
+    });
+}
+
+void FastMap::clear() {
+    clear_entries(false);
+}
+
+void FastMap::parallelClear() {
+    clear_entries(true);
+}
+
+void FastMap::clear_entries(bool parallel) {
+    if (swiss_) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        expiry_.reset();
+        
+        // Only the entries are released here; the table is reset afterwards
+        auto release = [&](const SwissTable::Position& pos) {
+            ShmKeyValue* kv = swiss_->at(pos);
+            kv->entry.mark_deleted();
+            free_kv(kv);
+            return true;
+        };
+        if (parallel) {
+            swiss_->for_each_parallel(release);
+        } else {
+            swiss_->for_each(release);
+        }
+        swiss_->reset();
+        
+        header_->size.store(0, std::memory_order_release);
+        header_->modified_at = current_timestamp_ns();
+        stats_.size.store(0, std::memory_order_relaxed);
+        return;
+    }
+    
+    void* base = file_manager_->segment_manager();
+    
+    // Entries added while the walk runs record themselves again
+    expiry_.reset();
+    auto drop = [&](ShmBucket* bucket) {
         int64_t current = bucket->head_offset.load(std::memory_order_acquire);
         
         while (current >= 0) {
@@ -819,13 +1845,20 @@ void FastMap::clear() {
             int64_t next = kv->next_offset.load(std::memory_order_acquire);
             
             kv->entry.mark_deleted();
-            free_kv(kv);
+            retire_kv(kv);
             
             current = next;
         }
         
         bucket->head_offset.store(ShmBucket::NULL_OFFSET, std::memory_order_release);
-        bucket->size.store(0, std::memory_order_release);
+        bucket->tags.store(0, std::memory_order_release);
+        
+        return true;
+    };
+    if (parallel) {
+        table_.for_each_locked_bucket_parallel(drop);
+    } else {
+        table_.for_each_locked_bucket(drop);
     }
     
     header_->size.store(0, std::memory_order_release);
@@ -834,22 +1867,34 @@ void FastMap::clear() {
 }
 
 size_t FastMap::size() const {
-    size_t alive = 0;
-    void* base = file_manager_->segment_manager();
+    size_t size = header_->size.load(std::memory_order_acquire);
+    if (!header_->may_have_expired()) return size;
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    // Leave the reaping to removeExpired(); just discount what is due
+    size_t due = static_cast<size_t>(expiry_.count_due(current_timestamp_ns()));
+    return size - std::min(due, size);
+}
+
+size_t FastMap::exactSize() const {
+    if (swiss_) {
+        IpcSharableLock lock(header_->global_mutex);
         
-        while (current >= 0) {
-            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(
-                static_cast<const uint8_t*>(base) + current
-            );
-            if (kv->entry.is_alive()) alive++;
-            current = kv->next_offset.load(std::memory_order_acquire);
-        }
+        size_t alive = 0;
+        swiss_->for_each([&](const SwissTable::Position& pos) {
+            if (swiss_->at(pos)->entry.is_alive()) alive++;
+            return true;
+        });
+        return alive;
     }
     
+    size_t alive = 0;
+    
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmKeyValue* kv) {
+        if (kv->entry.is_alive()) alive++;
+        return true;
+    });
+    
     return alive;
 }
 
@@ -857,6 +1902,18 @@ bool FastMap::isEmpty() const {
     return size() == 0;
 }
 
+void FastMap::startReaper(const ReaperConfig& config) {
+    reaper_.reset();
+    reaper_ = std::make_unique<TtlReaper>(
+        file_manager_->find_or_construct<ReaperLease>("map_reaper"),
+        [this](size_t max_items) { return reapExpired(max_items); },
+        config);
+}
+
+void FastMap::stopReaper() {
+    reaper_.reset();
+}
+
 void FastMap::flush() {
     file_manager_->flush();
 }
@@ -0,0 +1,317 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_position.cpp
+ * @brief Implementation of the persistent positional index
+ */
+
+#include "fc_position.h"
+#include <cstring>
+
+namespace fastcollection {
+
+namespace {
+
+// Recompute a node's total from its slots
+void refresh_total(PositionNode* n) {
+    if (n->leaf) {
+        n->total = n->count;
+        return;
+    }
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < n->count; i++) {
+        total += n->sizes[i];
+    }
+    n->total = total;
+}
+
+// Open a gap at slot index (caller checks capacity)
+void open_slot(PositionNode* n, uint32_t index) {
+    uint32_t tail = n->count - index;
+    std::memmove(&n->slots[index + 1], &n->slots[index], tail * sizeof(int64_t));
+    if (!n->leaf) {
+        std::memmove(&n->sizes[index + 1], &n->sizes[index], tail * sizeof(uint64_t));
+    }
+    n->count++;
+}
+
+void close_slot(PositionNode* n, uint32_t index) {
+    uint32_t tail = n->count - index - 1;
+    std::memmove(&n->slots[index], &n->slots[index + 1], tail * sizeof(int64_t));
+    if (!n->leaf) {
+        std::memmove(&n->sizes[index], &n->sizes[index + 1], tail * sizeof(uint64_t));
+    }
+    n->count--;
+}
+
+// Where a full node splits before inserting at slot: appends and prepends
+// leave the old node full, anything else halves it
+uint32_t split_point(const PositionNode* n, uint32_t slot) {
+    if (slot == n->count || slot == 0) return slot;
+    return n->count / 2;
+}
+
+} // anonymous namespace
+
+PositionIndex::PositionIndex(MMapFileManager* file_manager, PositionHeader* header)
+    : file_manager_(file_manager), header_(header) {
+    if (!header_->is_valid()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INTERNAL_ERROR,
+            "Invalid position index header in file"
+        );
+    }
+}
+
+void PositionIndex::reset() {
+    if (header_->root_offset >= 0) {
+        release_subtree(header_->root_offset);
+        header_->root_offset = -1;
+    }
+    header_->complete.store(1, std::memory_order_release);
+}
+
+void PositionIndex::rebuild(int64_t head_offset) {
+    header_->complete.store(0, std::memory_order_release);
+    if (header_->root_offset >= 0) {
+        release_subtree(header_->root_offset);
+        header_->root_offset = -1;
+    }
+
+    uint64_t position = 0;
+    int64_t current = head_offset;
+    while (current >= 0) {
+        insert(position++, current);
+        const ShmNode* list_node = reinterpret_cast<const ShmNode*>(base() + current);
+        current = list_node->next_offset.load(std::memory_order_acquire);
+    }
+    header_->complete.store(1, std::memory_order_release);
+}
+
+uint64_t PositionIndex::size() const {
+    if (header_->root_offset < 0) return 0;
+    return node(header_->root_offset)->total;
+}
+
+int64_t PositionIndex::at(uint64_t position) const {
+    if (position >= size()) return ShmNode::NULL_OFFSET;
+
+    const PositionNode* n = node(header_->root_offset);
+    while (!n->leaf) {
+        uint32_t i = child_for(n, position);
+        n = node(n->slots[i]);
+    }
+    return n->slots[position];
+}
+
+void PositionIndex::insert(uint64_t position, int64_t offset) {
+    if (position > size()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INDEX_OUT_OF_BOUNDS,
+            "Position index insert past the end"
+        );
+    }
+
+    if (header_->root_offset < 0) {
+        header_->root_offset = offset_of(allocate(true));
+    }
+
+    PositionNode* root = node(header_->root_offset);
+    int64_t sibling = insert_into(root, position, offset);
+    if (sibling < 0) return;
+
+    // The root split: grow the tree by one level
+    PositionNode* new_root = allocate(false);
+    new_root->slots[0] = header_->root_offset;
+    new_root->sizes[0] = root->total;
+    new_root->slots[1] = sibling;
+    new_root->sizes[1] = node(sibling)->total;
+    new_root->count = 2;
+    refresh_total(new_root);
+    header_->root_offset = offset_of(new_root);
+}
+
+void PositionIndex::erase(uint64_t position) {
+    if (position >= size()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INDEX_OUT_OF_BOUNDS,
+            "Position index erase past the end"
+        );
+    }
+
+    PositionNode* root = node(header_->root_offset);
+    erase_from(root, position);
+
+    // Drop roots left with a single child, then an empty leaf
+    while (!root->leaf && root->count == 1) {
+        header_->root_offset = root->slots[0];
+        release(root);
+        root = node(header_->root_offset);
+    }
+    if (root->count == 0) {
+        release(root);
+        header_->root_offset = -1;
+    }
+}
+
+void PositionIndex::replace(uint64_t position, int64_t offset) {
+    if (position >= size()) return;
+
+    PositionNode* n = node(header_->root_offset);
+    while (!n->leaf) {
+        uint32_t i = child_for(n, position);
+        n = node(n->slots[i]);
+    }
+    n->slots[position] = offset;
+}
+
+void PositionIndex::forget(int64_t offset) {
+    if (!complete()) return;
+
+    uint64_t count = size();
+    if (count > 0 && at(0) == offset) {
+        erase(0);
+    } else if (count > 0 && at(count - 1) == offset) {
+        erase(count - 1);
+    } else {
+        mark_stale();
+    }
+}
+
+PositionNode* PositionIndex::allocate(bool leaf) {
+    void* mem = file_manager_->allocate(sizeof(PositionNode));
+    if (!mem) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+            "Failed to allocate position index node"
+        );
+    }
+    header_->nodes++;
+    return new(mem) PositionNode(leaf);
+}
+
+void PositionIndex::release(PositionNode* n) {
+    header_->nodes--;
+    file_manager_->deallocate(n);
+}
+
+void PositionIndex::release_subtree(int64_t offset) {
+    PositionNode* n = node(offset);
+    if (!n->leaf) {
+        for (uint32_t i = 0; i < n->count; i++) {
+            release_subtree(n->slots[i]);
+        }
+    }
+    release(n);
+}
+
+uint32_t PositionIndex::child_for(const PositionNode* n, uint64_t& position) const {
+    uint32_t i = 0;
+    while (i + 1 < n->count && position >= n->sizes[i]) {
+        position -= n->sizes[i];
+        i++;
+    }
+    return i;
+}
+
+int64_t PositionIndex::insert_into(PositionNode* n, uint64_t position, int64_t value) {
+    uint32_t slot;
+    uint64_t child_total = 0;
+
+    if (n->leaf) {
+        slot = static_cast<uint32_t>(position);
+    } else {
+        uint32_t i = child_for(n, position);
+        PositionNode* child = node(n->slots[i]);
+        int64_t split = insert_into(child, position, value);
+        n->sizes[i] = child->total;
+        if (split < 0) {
+            n->total++;
+            return -1;
+        }
+        // The child split: its new sibling goes in the next slot
+        slot = i + 1;
+        value = split;
+        child_total = node(split)->total;
+    }
+
+    PositionNode* target = n;
+    int64_t sibling = -1;
+
+    if (n->count == PositionNode::CAPACITY) {
+        uint32_t old_count = n->count;
+        uint32_t at = split_point(n, slot);
+
+        PositionNode* right = allocate(n->leaf != 0);
+        right->count = old_count - at;
+        std::memcpy(right->slots, &n->slots[at], right->count * sizeof(int64_t));
+        if (!n->leaf) {
+            std::memcpy(right->sizes, &n->sizes[at], right->count * sizeof(uint64_t));
+        }
+        n->count = at;
+
+        if (slot > at || (slot == at && at == old_count)) {
+            target = right;
+            slot -= at;
+        }
+        sibling = offset_of(right);
+    }
+
+    open_slot(target, slot);
+    target->slots[slot] = value;
+    if (!target->leaf) {
+        target->sizes[slot] = child_total;
+    }
+
+    refresh_total(n);
+    if (sibling >= 0) {
+        refresh_total(node(sibling));
+    }
+    return sibling;
+}
+
+void PositionIndex::erase_from(PositionNode* n, uint64_t position) {
+    if (n->leaf) {
+        close_slot(n, static_cast<uint32_t>(position));
+        n->total--;
+        return;
+    }
+
+    uint32_t i = child_for(n, position);
+    PositionNode* child = node(n->slots[i]);
+    erase_from(child, position);
+    n->sizes[i] = child->total;
+    n->total--;
+
+    if (child->count == 0) {
+        release(child);
+        close_slot(n, i);
+    } else if (child->count < PositionNode::CAPACITY / 4) {
+        rebalance(n, i);
+    }
+}
+
+void PositionIndex::rebalance(PositionNode* parent, uint32_t index) {
+    if (parent->count < 2) return;
+
+    uint32_t left_index = index + 1 < parent->count ? index : index - 1;
+    PositionNode* left = node(parent->slots[left_index]);
+    PositionNode* right = node(parent->slots[left_index + 1]);
+    if (left->count + right->count > PositionNode::CAPACITY) return;
+
+    std::memcpy(&left->slots[left->count], right->slots, right->count * sizeof(int64_t));
+    if (!left->leaf) {
+        std::memcpy(&left->sizes[left->count], right->sizes, right->count * sizeof(uint64_t));
+    }
+    left->count += right->count;
+    refresh_total(left);
+    parent->sizes[left_index] = left->total;
+
+    release(right);
+    close_slot(parent, left_index + 1);
+}
+
+} // namespace fastcollection
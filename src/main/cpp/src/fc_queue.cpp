@@ -10,12 +10,13 @@
 
 #include "fc_queue.h"
 #include <cstring>
-#include <thread>
 #include <chrono>
 
 namespace fastcollection {
 
 using IpcScopedLock = bip::scoped_lock<IpcSharedMutex>;
+using IpcSharableLock = bip::sharable_lock<IpcSharedMutex>;
+using TailLock = std::unique_lock<ShmSpinLock>;
 
 FastQueue::FastQueue(const std::string& mmap_file,
                      size_t initial_size,
@@ -23,6 +24,7 @@ FastQueue::FastQueue(const std::string& mmap_file,
     : file_manager_(std::make_unique<MMapFileManager>(mmap_file, initial_size, create_new)) {
     
     auto result = file_manager_->find<DequeHeader>("queue_header");
+    bool existing = result.first != nullptr;
     
     if (result.first) {
         header_ = result.first;
@@ -32,9 +34,14 @@ FastQueue::FastQueue(const std::string& mmap_file,
                 "Invalid queue header in file"
             );
         }
+        // Nodes now come from the slab heap, which older builds would corrupt
+        header_->mark_current();
     } else {
         header_ = file_manager_->find_or_construct<DequeHeader>("queue_header");;
     }
+    hasher_ = Hasher::open(file_manager_.get(), "queue_hash", existing);
+    signal_ = file_manager_->find_or_construct<ShmEventCount>("queue_signal");
+    open_tail();
     
     stats_.size.store(header_->size.load(), std::memory_order_relaxed);
 }
@@ -47,15 +54,25 @@ FastQueue::~FastQueue() {
 
 FastQueue::FastQueue(FastQueue&& other) noexcept
     : file_manager_(std::move(other.file_manager_))
-    , header_(other.header_) {
+    , header_(other.header_)
+    , hasher_(other.hasher_)
+    , signal_(other.signal_)
+    , tail_(other.tail_) {
     other.header_ = nullptr;
+    other.signal_ = nullptr;
+    other.tail_ = nullptr;
 }
 
 FastQueue& FastQueue::operator=(FastQueue&& other) noexcept {
     if (this != &other) {
         file_manager_ = std::move(other.file_manager_);
         header_ = other.header_;
+        hasher_ = other.hasher_;
+        signal_ = other.signal_;
+        tail_ = other.tail_;
         other.header_ = nullptr;
+        other.signal_ = nullptr;
+        other.tail_ = nullptr;
     }
     return *this;
 }
@@ -67,6 +84,11 @@ ShmNode* FastQueue::node_at_offset(int64_t offset) const {
     return reinterpret_cast<ShmNode*>(static_cast<uint8_t*>(base) + offset);
 }
 
+int64_t FastQueue::offset_of(const ShmNode* node) const {
+    return reinterpret_cast<const uint8_t*>(node) - 
+           reinterpret_cast<const uint8_t*>(file_manager_->segment_manager());
+}
+
 ShmNode* FastQueue::allocate_node(size_t data_size) {
     size_t total = ShmNode::total_size(data_size);
     void* mem = file_manager_->allocate(total);
@@ -85,72 +107,172 @@ void FastQueue::free_node(ShmNode* node, size_t data_size) {
     }
 }
 
-void FastQueue::skip_expired_front() {
-    // Skip expired nodes at front (must be called with lock held)
-    void* base = file_manager_->segment_manager();
+void FastQueue::open_tail() {
+    // The tail lock marks a file whose list starts with a dummy node. Older
+    // files get theirs here, once, while the head lock keeps other users out
+    IpcScopedLock lock(header_->global_mutex);
+    
+    tail_ = file_manager_->find<ShmLockStripe>("queue_tail_lock").first;
+    if (tail_) return;
+    
+    ShmNode* dummy = allocate_node(0);
+    dummy->entry.mark_deleted();
+    int64_t dummy_offset = offset_of(dummy);
+    
+    int64_t front = header_->front_offset.load(std::memory_order_acquire);
+    dummy->next_offset.store(front, std::memory_order_relaxed);
+    if (front >= 0) {
+        node_at_offset(front)->prev_offset.store(dummy_offset, std::memory_order_relaxed);
+    } else {
+        header_->back_offset.store(dummy_offset, std::memory_order_release);
+    }
+    header_->front_offset.store(dummy_offset, std::memory_order_release);
+    
+    tail_ = file_manager_->find_or_construct<ShmLockStripe>("queue_tail_lock");
+}
+
+int64_t FastQueue::first_offset() const {
+    ShmNode* dummy = node_at_offset(header_->front_offset.load(std::memory_order_acquire));
+    return dummy->next_offset.load(std::memory_order_acquire);
+}
+
+void FastQueue::advance_head(ShmNode* dummy, int64_t next) {
+    // The successor's record leaves the queue and its node stays as the
+    // dummy; producers never touch the old dummy once it has a successor
+    ShmNode* node = node_at_offset(next);
+    node->entry.mark_deleted();
+    node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_relaxed);
+    header_->front_offset.store(next, std::memory_order_release);
+    
+    free_node(dummy, dummy->entry.data_size);
+    
+    header_->size.fetch_sub(1, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FastQueue::link_at_back(int64_t first, int64_t last) {
+    int64_t back = header_->back_offset.load(std::memory_order_acquire);
+    node_at_offset(first)->prev_offset.store(back, std::memory_order_relaxed);
     
+    // A consumer may take the run as soon as the link is visible
+    node_at_offset(back)->next_offset.store(first, std::memory_order_release);
+    header_->back_offset.store(last, std::memory_order_release);
+}
+
+void FastQueue::unlink_node(ShmNode* node) {
+    // Every element has a predecessor: the dummy, at worst
+    int64_t prev = node->prev_offset.load(std::memory_order_acquire);
+    int64_t next = node->next_offset.load(std::memory_order_acquire);
+    
+    node_at_offset(prev)->next_offset.store(next, std::memory_order_release);
+    if (next >= 0) {
+        node_at_offset(next)->prev_offset.store(prev, std::memory_order_release);
+    } else {
+        header_->back_offset.store(prev, std::memory_order_release);
+    }
+    
+    size_t data_size = node->entry.data_size;
+    node->entry.mark_deleted();
+    free_node(node, data_size);
+    
+    header_->size.fetch_sub(1, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FastQueue::touch() {
+    std::atomic_ref<uint64_t>(header_->modified_at).store(current_timestamp_ns(),
+                                                          std::memory_order_relaxed);
+}
+
+void FastQueue::skip_expired_front() {
     while (true) {
-        int64_t front = header_->front_offset.load(std::memory_order_acquire);
-        if (front < 0) break;
+        ShmNode* dummy = node_at_offset(header_->front_offset.load(std::memory_order_acquire));
+        int64_t first = dummy->next_offset.load(std::memory_order_acquire);
+        if (first < 0) break;
         
-        ShmNode* node = node_at_offset(front);
-        if (!node) break;
+        if (!node_at_offset(first)->entry.is_expired()) break;
         
-        if (!node->entry.is_expired()) break;
-        
-        // Remove expired node
-        int64_t next = node->next_offset.load(std::memory_order_acquire);
-        header_->front_offset.store(next, std::memory_order_release);
-        
-        if (next >= 0) {
-            ShmNode* next_node = node_at_offset(next);
-            next_node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+        advance_head(dummy, first);
+    }
+}
+
+int64_t FastQueue::detach_front(size_t max_live, size_t& count) {
+    int64_t dummy_offset = header_->front_offset.load(std::memory_order_acquire);
+    ShmNode* dummy = node_at_offset(dummy_offset);
+    int64_t first = dummy->next_offset.load(std::memory_order_acquire);
+    int64_t current = first;
+    ShmNode* last = nullptr;
+    size_t live = 0;
+    count = 0;
+    
+    while (current >= 0 && live < max_live) {
+        ShmNode* node = node_at_offset(current);
+        if (node->entry.is_alive()) {
+            live++;
         } else {
-            header_->back_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+            node->entry.mark_deleted();  // Dropped with the run, not handed out
         }
-        
-        size_t data_size = node->entry.data_size;
+        last = node;
+        count++;
+        current = node->next_offset.load(std::memory_order_acquire);
+    }
+    if (count == 0) return ShmNode::NULL_OFFSET;
+    
+    // A run ending at the back races with producers linking after it, so
+    // the cut is made under the tail lock, keeping whatever they added
+    TailLock tail;
+    if (current < 0) {
+        tail = TailLock(tail_->lock);
+        current = last->next_offset.load(std::memory_order_acquire);
+        if (current < 0) {
+            header_->back_offset.store(dummy_offset, std::memory_order_release);
+        }
+    }
+    
+    // current is the first node left in the queue
+    if (current >= 0) {
+        node_at_offset(current)->prev_offset.store(dummy_offset, std::memory_order_release);
+    }
+    dummy->next_offset.store(current, std::memory_order_release);
+    last->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_relaxed);
+    
+    header_->size.fetch_sub(count, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(count, std::memory_order_relaxed);
+    touch();
+    
+    return first;
+}
+
+void FastQueue::free_run(int64_t offset, size_t count) {
+    while (count-- > 0 && offset >= 0) {
+        ShmNode* node = node_at_offset(offset);
+        offset = node->next_offset.load(std::memory_order_relaxed);
         node->entry.mark_deleted();
-        free_node(node, data_size);
-        
-        header_->size.fetch_sub(1, std::memory_order_acq_rel);
-        stats_.size.fetch_sub(1, std::memory_order_relaxed);
+        free_node(node, node->entry.data_size);
     }
 }
 
 bool FastQueue::offer(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     if (!data || size == 0) return false;
     
-    IpcScopedLock lock(header_->global_mutex);
-    
-    void* base = file_manager_->segment_manager();
-    
     ShmNode* node = allocate_node(size);
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
-    
-    int64_t node_offset = static_cast<uint8_t*>(static_cast<void*>(node)) - 
-                          static_cast<uint8_t*>(base);
-    
-    // Add to back
-    int64_t back = header_->back_offset.load(std::memory_order_acquire);
-    
-    node->prev_offset.store(back, std::memory_order_release);
-    node->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+    SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl_seconds);
+    int64_t node_offset = offset_of(node);
     
-    if (back >= 0) {
-        ShmNode* back_node = node_at_offset(back);
-        back_node->next_offset.store(node_offset, std::memory_order_release);
-    } else {
-        header_->front_offset.store(node_offset, std::memory_order_release);
+    {
+        // Counted before it is linked, so a consumer never counts it out first
+        TailLock tail(tail_->lock);
+        header_->size.fetch_add(1, std::memory_order_acq_rel);
+        stats_.size.fetch_add(1, std::memory_order_relaxed);
+        link_at_back(node_offset, node_offset);
     }
+    touch();
     
-    header_->back_offset.store(node_offset, std::memory_order_release);
-    header_->size.fetch_add(1, std::memory_order_acq_rel);
-    header_->modified_at = current_timestamp_ns();
-    
-    stats_.size.fetch_add(1, std::memory_order_relaxed);
     stats_.write_count.fetch_add(1, std::memory_order_relaxed);
     
+    // Wake a consumer once the element is visible
+    signal_->notify_one();
+    
     return true;
 }
 
@@ -160,14 +282,15 @@ bool FastQueue::poll(std::vector<uint8_t>& out_data) {
     // Skip expired nodes
     skip_expired_front();
     
-    int64_t front = header_->front_offset.load(std::memory_order_acquire);
-    if (front < 0) {
+    ShmNode* dummy = node_at_offset(header_->front_offset.load(std::memory_order_acquire));
+    int64_t first = dummy->next_offset.load(std::memory_order_acquire);
+    if (first < 0) {
         stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
     
-    ShmNode* node = node_at_offset(front);
-    if (!node || !node->entry.is_alive()) {
+    ShmNode* node = node_at_offset(first);
+    if (!node->entry.is_alive()) {
         stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
@@ -175,24 +298,9 @@ bool FastQueue::poll(std::vector<uint8_t>& out_data) {
     out_data = SerializationUtil::copy_from_node(node);
     
     // Remove from front
-    int64_t next = node->next_offset.load(std::memory_order_acquire);
-    header_->front_offset.store(next, std::memory_order_release);
-    
-    if (next >= 0) {
-        ShmNode* next_node = node_at_offset(next);
-        next_node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-    } else {
-        header_->back_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-    }
+    advance_head(dummy, first);
+    touch();
     
-    size_t data_size = node->entry.data_size;
-    node->entry.mark_deleted();
-    free_node(node, data_size);
-    
-    header_->size.fetch_sub(1, std::memory_order_acq_rel);
-    header_->modified_at = current_timestamp_ns();
-    
-    stats_.size.fetch_sub(1, std::memory_order_relaxed);
     stats_.read_count.fetch_add(1, std::memory_order_relaxed);
     stats_.hit_count.fetch_add(1, std::memory_order_relaxed);
     
@@ -211,12 +319,22 @@ std::vector<uint8_t> FastQueue::remove() {
 }
 
 bool FastQueue::peek(std::vector<uint8_t>& out_data) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
-    
-    // Skip expired at front
-    const_cast<FastQueue*>(this)->skip_expired_front();
+    return peekWith([&](const uint8_t* data, size_t size) {
+        out_data.assign(data, data + size);
+    });
+}
+
+bool FastQueue::peekWith(const std::function<void(const uint8_t* data, size_t size)>& fn) const {
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
-    int64_t front = header_->front_offset.load(std::memory_order_acquire);
+    // Step over expired nodes at the front; other readers share the lock,
+    // so unlinking them is left to poll() and the reaper
+    int64_t front = first_offset();
+    while (front >= 0) {
+        ShmNode* node = node_at_offset(front);
+        if (!node || !node->entry.is_expired()) break;
+        front = node->next_offset.load(std::memory_order_acquire);
+    }
     if (front < 0) {
         const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
         return false;
@@ -228,7 +346,7 @@ bool FastQueue::peek(std::vector<uint8_t>& out_data) const {
         return false;
     }
     
-    out_data = SerializationUtil::copy_from_node(node);
+    fn(node->data, node->entry.data_size);
     
     const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
     const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
@@ -262,11 +380,13 @@ std::vector<uint8_t> FastQueue::take() {
     std::vector<uint8_t> result;
     
     while (true) {
+        // Register before checking, so an offer in between still wakes us
+        uint32_t key = signal_->prepare_wait();
         if (poll(result)) {
+            signal_->cancel_wait();
             return result;
         }
-        // Wait and retry
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        signal_->wait(key);
     }
 }
 
@@ -274,117 +394,93 @@ bool FastQueue::poll(std::vector<uint8_t>& out_data, uint32_t timeout_ms) {
     auto deadline = std::chrono::steady_clock::now() + 
                     std::chrono::milliseconds(timeout_ms);
     
-    while (std::chrono::steady_clock::now() < deadline) {
+    while (true) {
+        uint32_t key = signal_->prepare_wait();
         if (poll(out_data)) {
+            signal_->cancel_wait();
             return true;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        
+        // Check the deadline only after polling: a consumer woken late
+        // still takes the element it was woken for
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            signal_->cancel_wait();
+            return false;
+        }
+        signal_->wait(key, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count());
     }
-    
-    return false;
 }
 
 bool FastQueue::offerFirst(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     if (!data || size == 0) return false;
     
-    IpcScopedLock lock(header_->global_mutex);
-    
-    void* base = file_manager_->segment_manager();
-    
     ShmNode* node = allocate_node(size);
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
+    SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl_seconds);
+    int64_t node_offset = offset_of(node);
     
-    int64_t node_offset = static_cast<uint8_t*>(static_cast<void*>(node)) - 
-                          static_cast<uint8_t*>(base);
+    // Into an empty queue the element is also the new back, so both ends
+    // are locked
+    IpcScopedLock lock(header_->global_mutex);
+    TailLock tail(tail_->lock);
     
-    // Add to front
-    int64_t front = header_->front_offset.load(std::memory_order_acquire);
+    // Add behind the dummy
+    int64_t dummy_offset = header_->front_offset.load(std::memory_order_acquire);
+    ShmNode* dummy = node_at_offset(dummy_offset);
+    int64_t first = dummy->next_offset.load(std::memory_order_acquire);
     
-    node->next_offset.store(front, std::memory_order_release);
-    node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+    node->next_offset.store(first, std::memory_order_release);
+    node->prev_offset.store(dummy_offset, std::memory_order_release);
     
-    if (front >= 0) {
-        ShmNode* front_node = node_at_offset(front);
-        front_node->prev_offset.store(node_offset, std::memory_order_release);
+    if (first >= 0) {
+        node_at_offset(first)->prev_offset.store(node_offset, std::memory_order_release);
     } else {
         header_->back_offset.store(node_offset, std::memory_order_release);
     }
     
-    header_->front_offset.store(node_offset, std::memory_order_release);
+    dummy->next_offset.store(node_offset, std::memory_order_release);
     header_->size.fetch_add(1, std::memory_order_acq_rel);
-    header_->modified_at = current_timestamp_ns();
+    touch();
     
     stats_.size.fetch_add(1, std::memory_order_relaxed);
     stats_.write_count.fetch_add(1, std::memory_order_relaxed);
     
+    // Wake a consumer once the element is visible
+    tail.unlock();
+    lock.unlock();
+    signal_->notify_one();
+    
     return true;
 }
 
 bool FastQueue::pollLast(std::vector<uint8_t>& out_data) {
     IpcScopedLock lock(header_->global_mutex);
+    TailLock tail(tail_->lock);
     
+    int64_t dummy_offset = header_->front_offset.load(std::memory_order_acquire);
     int64_t back = header_->back_offset.load(std::memory_order_acquire);
     
     // Skip expired from back
-    while (back >= 0) {
+    while (back != dummy_offset) {
         ShmNode* node = node_at_offset(back);
-        if (!node) break;
-        
         if (node->entry.is_alive()) break;
         
-        // Remove expired node
-        int64_t prev = node->prev_offset.load(std::memory_order_acquire);
-        header_->back_offset.store(prev, std::memory_order_release);
-        
-        if (prev >= 0) {
-            ShmNode* prev_node = node_at_offset(prev);
-            prev_node->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-        } else {
-            header_->front_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-        }
-        
-        size_t data_size = node->entry.data_size;
-        node->entry.mark_deleted();
-        free_node(node, data_size);
-        
-        header_->size.fetch_sub(1, std::memory_order_acq_rel);
-        stats_.size.fetch_sub(1, std::memory_order_relaxed);
-        
-        back = prev;
+        unlink_node(node);
+        back = header_->back_offset.load(std::memory_order_acquire);
     }
     
-    if (back < 0) {
+    if (back == dummy_offset) {
         stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
     
     ShmNode* node = node_at_offset(back);
-    if (!node || !node->entry.is_alive()) {
-        stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
-        return false;
-    }
-    
     out_data = SerializationUtil::copy_from_node(node);
     
     // Remove from back
-    int64_t prev = node->prev_offset.load(std::memory_order_acquire);
-    header_->back_offset.store(prev, std::memory_order_release);
-    
-    if (prev >= 0) {
-        ShmNode* prev_node = node_at_offset(prev);
-        prev_node->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-    } else {
-        header_->front_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-    }
-    
-    size_t data_size = node->entry.data_size;
-    node->entry.mark_deleted();
-    free_node(node, data_size);
+    unlink_node(node);
+    touch();
     
-    header_->size.fetch_sub(1, std::memory_order_acq_rel);
-    header_->modified_at = current_timestamp_ns();
-    
-    stats_.size.fetch_sub(1, std::memory_order_relaxed);
     stats_.read_count.fetch_add(1, std::memory_order_relaxed);
     stats_.hit_count.fetch_add(1, std::memory_order_relaxed);
     
@@ -392,29 +488,26 @@ bool FastQueue::pollLast(std::vector<uint8_t>& out_data) {
 }
 
 bool FastQueue::peekLast(std::vector<uint8_t>& out_data) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
+    // Producers may move the back meanwhile, but only a holder of the
+    // exclusive head lock frees nodes, so the walk back to the dummy is safe
+    int64_t dummy_offset = header_->front_offset.load(std::memory_order_acquire);
     int64_t back = header_->back_offset.load(std::memory_order_acquire);
     
     // Skip expired from back
-    while (back >= 0) {
+    while (back != dummy_offset) {
         ShmNode* node = node_at_offset(back);
-        if (!node) break;
         if (node->entry.is_alive()) break;
         back = node->prev_offset.load(std::memory_order_acquire);
     }
     
-    if (back < 0) {
+    if (back == dummy_offset) {
         const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
     
     ShmNode* node = node_at_offset(back);
-    if (!node || !node->entry.is_alive()) {
-        const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
-        return false;
-    }
-    
     out_data = SerializationUtil::copy_from_node(node);
     
     const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
@@ -424,9 +517,9 @@ bool FastQueue::peekLast(std::vector<uint8_t>& out_data) const {
 }
 
 int64_t FastQueue::peekTTL() const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
-    int64_t front = header_->front_offset.load(std::memory_order_acquire);
+    int64_t front = first_offset();
     
     while (front >= 0) {
         ShmNode* node = node_at_offset(front);
@@ -442,11 +535,10 @@ int64_t FastQueue::peekTTL() const {
 
 size_t FastQueue::removeExpired() {
     IpcScopedLock lock(header_->global_mutex);
+    TailLock tail(tail_->lock);
     
     size_t removed = 0;
-    void* base = file_manager_->segment_manager();
-    
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = first_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -455,28 +547,7 @@ size_t FastQueue::removeExpired() {
         int64_t next = node->next_offset.load(std::memory_order_acquire);
         
         if (node->entry.is_expired()) {
-            int64_t prev = node->prev_offset.load(std::memory_order_acquire);
-            
-            if (prev >= 0) {
-                ShmNode* prev_node = node_at_offset(prev);
-                prev_node->next_offset.store(next, std::memory_order_release);
-            } else {
-                header_->front_offset.store(next, std::memory_order_release);
-            }
-            
-            if (next >= 0) {
-                ShmNode* next_node = node_at_offset(next);
-                next_node->prev_offset.store(prev, std::memory_order_release);
-            } else {
-                header_->back_offset.store(prev, std::memory_order_release);
-            }
-            
-            size_t data_size = node->entry.data_size;
-            node->entry.mark_deleted();
-            free_node(node, data_size);
-            
-            header_->size.fetch_sub(1, std::memory_order_acq_rel);
-            stats_.size.fetch_sub(1, std::memory_order_relaxed);
+            unlink_node(node);
             removed++;
         }
         
@@ -484,7 +555,7 @@ size_t FastQueue::removeExpired() {
     }
     
     if (removed > 0) {
-        header_->modified_at = current_timestamp_ns();
+        touch();
     }
     
     return removed;
@@ -493,18 +564,18 @@ size_t FastQueue::removeExpired() {
 bool FastQueue::contains(const uint8_t* data, size_t size) const {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
+    uint64_t hash = hasher_(data, size);
     
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = first_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
         if (!node) break;
         
         if (node->entry.is_alive() &&
-            node->entry.hash_code == hash &&
+            hasher_.matches(node->entry, hash) &&
             node->entry.data_size == size &&
             std::memcmp(node->data, data, size) == 0) {
             return true;
@@ -519,46 +590,24 @@ bool FastQueue::contains(const uint8_t* data, size_t size) const {
 bool FastQueue::removeElement(const uint8_t* data, size_t size) {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
+    uint64_t hash = hasher_(data, size);
     
     IpcScopedLock lock(header_->global_mutex);
+    TailLock tail(tail_->lock);
     
-    void* base = file_manager_->segment_manager();
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = first_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
         if (!node) break;
         
         if (node->entry.is_alive() &&
-            node->entry.hash_code == hash &&
+            hasher_.matches(node->entry, hash) &&
             node->entry.data_size == size &&
             std::memcmp(node->data, data, size) == 0) {
             
-            int64_t prev = node->prev_offset.load(std::memory_order_acquire);
-            int64_t next = node->next_offset.load(std::memory_order_acquire);
-            
-            if (prev >= 0) {
-                ShmNode* prev_node = node_at_offset(prev);
-                prev_node->next_offset.store(next, std::memory_order_release);
-            } else {
-                header_->front_offset.store(next, std::memory_order_release);
-            }
-            
-            if (next >= 0) {
-                ShmNode* next_node = node_at_offset(next);
-                next_node->prev_offset.store(prev, std::memory_order_release);
-            } else {
-                header_->back_offset.store(prev, std::memory_order_release);
-            }
-            
-            size_t data_size = node->entry.data_size;
-            node->entry.mark_deleted();
-            free_node(node, data_size);
-            
-            header_->size.fetch_sub(1, std::memory_order_acq_rel);
-            header_->modified_at = current_timestamp_ns();
-            stats_.size.fetch_sub(1, std::memory_order_relaxed);
+            unlink_node(node);
+            touch();
             
             return true;
         }
@@ -571,8 +620,11 @@ bool FastQueue::removeElement(const uint8_t* data, size_t size) {
 
 void FastQueue::clear() {
     IpcScopedLock lock(header_->global_mutex);
+    TailLock tail(tail_->lock);
     
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t dummy_offset = header_->front_offset.load(std::memory_order_acquire);
+    ShmNode* dummy = node_at_offset(dummy_offset);
+    int64_t current = dummy->next_offset.load(std::memory_order_acquire);
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -587,19 +639,20 @@ void FastQueue::clear() {
         current = next;
     }
     
-    header_->front_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-    header_->back_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+    // Only the dummy is left
+    dummy->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+    header_->back_offset.store(dummy_offset, std::memory_order_release);
     header_->size.store(0, std::memory_order_release);
-    header_->modified_at = current_timestamp_ns();
+    touch();
     
     stats_.size.store(0, std::memory_order_relaxed);
 }
 
 size_t FastQueue::size() const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
     size_t alive = 0;
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = first_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -616,9 +669,9 @@ bool FastQueue::isEmpty() const {
 }
 
 void FastQueue::forEach(std::function<bool(const uint8_t* data, size_t size)> callback) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = first_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -636,9 +689,9 @@ void FastQueue::forEach(std::function<bool(const uint8_t* data, size_t size)> ca
 
 void FastQueue::forEachWithTTL(std::function<bool(const uint8_t* data, size_t size,
                                                    int64_t ttl_remaining)> callback) const {
-    IpcScopedLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
     
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = first_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -657,50 +710,125 @@ void FastQueue::forEachWithTTL(std::function<bool(const uint8_t* data, size_t si
 
 size_t FastQueue::drainTo(std::function<void(std::vector<uint8_t>&&)> callback, 
                           size_t max_elements) {
-    IpcScopedLock lock(header_->global_mutex);
+    return drainTo([&](const uint8_t* data, size_t size) {
+        callback(std::vector<uint8_t>(data, data + size));
+    }, max_elements);
+}
+
+size_t FastQueue::drainTo(const std::function<void(const uint8_t* data, size_t size)>& callback,
+                          size_t max_elements) {
+    size_t limit = (max_elements == 0) ? SIZE_MAX : max_elements;
+    size_t count = 0;
+    int64_t current;
+    {
+        IpcScopedLock lock(header_->global_mutex);
+        current = detach_front(limit, count);
+    }
     
+    // The run is unreachable from the queue now, so no lock is needed
     size_t drained = 0;
+    while (count > 0) {
+        ShmNode* node = node_at_offset(current);
+        current = node->next_offset.load(std::memory_order_relaxed);
+        count--;
+        
+        if (node->entry.is_valid()) {
+            try {
+                callback(node->data, node->entry.data_size);
+            } catch (...) {
+                free_node(node, node->entry.data_size);
+                free_run(current, count);
+                throw;
+            }
+            drained++;
+        }
+        node->entry.mark_deleted();
+        free_node(node, node->entry.data_size);
+    }
+    
+    stats_.read_count.fetch_add(drained, std::memory_order_relaxed);
+    return drained;
+}
+
+size_t FastQueue::offerAll(const std::vector<std::vector<uint8_t>>& elements,
+                           int32_t ttl_seconds) {
+    std::vector<size_t> sizes;
+    sizes.reserve(elements.size());
+    for (const auto& element : elements) {
+        if (!element.empty()) sizes.push_back(ShmNode::total_size(element.size()));
+    }
+    if (sizes.empty()) return 0;
+    
+    // Build and chain the whole run before taking the lock
+    std::vector<void*> blocks;
+    file_manager_->allocate_many(sizes, blocks);
+    
+    std::vector<int64_t> offsets;
+    offsets.reserve(blocks.size());
+    size_t next_block = 0;
+    for (const auto& element : elements) {
+        if (element.empty()) continue;
+        ShmNode* node = new(blocks[next_block++]) ShmNode();
+        SerializationUtil::copy_to_node(node, hasher_(element.data(), element.size()),
+                                        element.data(), element.size(), ttl_seconds);
+        offsets.push_back(offset_of(node));
+    }
+    for (size_t i = 0; i < offsets.size(); i++) {
+        ShmNode* node = node_at_offset(offsets[i]);
+        node->prev_offset.store(i > 0 ? offsets[i - 1] : ShmNode::NULL_OFFSET,
+                                std::memory_order_relaxed);
+        node->next_offset.store(i + 1 < offsets.size() ? offsets[i + 1] : ShmNode::NULL_OFFSET,
+                                std::memory_order_relaxed);
+    }
+    
+    size_t added = offsets.size();
+    {
+        // Splice the run onto the back
+        TailLock tail(tail_->lock);
+        header_->size.fetch_add(added, std::memory_order_acq_rel);
+        stats_.size.fetch_add(added, std::memory_order_relaxed);
+        link_at_back(offsets.front(), offsets.back());
+    }
+    touch();
+    
+    stats_.write_count.fetch_add(added, std::memory_order_relaxed);
+    
+    if (added == 1) {
+        signal_->notify_one();
+    } else {
+        signal_->notify_all();
+    }
+    
+    return added;
+}
+
+size_t FastQueue::pollBatch(std::vector<std::vector<uint8_t>>& out, size_t max_elements) {
+    return drainTo([&](const uint8_t* data, size_t size) {
+        out.emplace_back(data, data + size);
+    }, max_elements);
+}
+
+size_t FastQueue::peekBatch(std::vector<std::vector<uint8_t>>& out, size_t max_elements) const {
     size_t limit = (max_elements == 0) ? SIZE_MAX : max_elements;
+    size_t copied = 0;
     
-    while (drained < limit) {
-        skip_expired_front();
-        
-        int64_t front = header_->front_offset.load(std::memory_order_acquire);
-        if (front < 0) break;
-        
-        ShmNode* node = node_at_offset(front);
-        if (!node || !node->entry.is_alive()) break;
-        
-        std::vector<uint8_t> data = SerializationUtil::copy_from_node(node);
-        
-        // Remove
-        int64_t next = node->next_offset.load(std::memory_order_acquire);
-        header_->front_offset.store(next, std::memory_order_release);
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    
+    int64_t current = first_offset();
+    while (current >= 0 && copied < limit) {
+        ShmNode* node = node_at_offset(current);
+        if (!node) break;
         
-        if (next >= 0) {
-            ShmNode* next_node = node_at_offset(next);
-            next_node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-        } else {
-            header_->back_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+        if (node->entry.is_alive()) {
+            out.emplace_back(node->data, node->data + node->entry.data_size);
+            copied++;
         }
         
-        size_t data_size = node->entry.data_size;
-        node->entry.mark_deleted();
-        free_node(node, data_size);
-        
-        header_->size.fetch_sub(1, std::memory_order_acq_rel);
-        stats_.size.fetch_sub(1, std::memory_order_relaxed);
-        
-        callback(std::move(data));
-        drained++;
-    }
-    
-    if (drained > 0) {
-        header_->modified_at = current_timestamp_ns();
-        stats_.read_count.fetch_add(drained, std::memory_order_relaxed);
+        current = node->next_offset.load(std::memory_order_acquire);
     }
     
-    return drained;
+    const_cast<CollectionStats&>(stats_).read_count.fetch_add(copied, std::memory_order_relaxed);
+    return copied;
 }
 
 void FastQueue::flush() {
@@ -0,0 +1,136 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_reaper.cpp
+ * @brief Implementation of the background TTL reaper
+ */
+
+#include "fc_reaper.h"
+#include <chrono>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace fastcollection {
+
+namespace {
+
+std::atomic<uint32_t> next_reaper_id{1};
+
+// Process id in the high half, so a token also identifies its process
+uint64_t new_token() {
+#ifdef _WIN32
+    uint64_t pid = static_cast<uint64_t>(_getpid());
+#else
+    uint64_t pid = static_cast<uint64_t>(getpid());
+#endif
+    return ((pid + 1) << 32) | next_reaper_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool owner_alive(uint64_t token) {
+#ifdef _WIN32
+    (void)token;
+    return true;  // No cheap liveness probe; wait for the lease to expire
+#else
+    pid_t pid = static_cast<pid_t>((token >> 32) - 1);
+    return kill(pid, 0) == 0 || errno != ESRCH;
+#endif
+}
+
+} // namespace
+
+TtlReaper::TtlReaper(ReaperLease* lease, ReapFn reap, const ReaperConfig& config)
+    : lease_(lease)
+    , reap_(std::move(reap))
+    , config_(config)
+    , token_(new_token()) {
+    if (config_.interval_ms == 0 || config_.batch_size == 0 ||
+        config_.cpu_budget_percent == 0 || config_.cpu_budget_percent > 100) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INVALID_ARGUMENT,
+            "Reaper needs a positive interval and batch size and a CPU budget of 1-100%"
+        );
+    }
+    thread_ = std::thread(&TtlReaper::run, this);
+}
+
+TtlReaper::~TtlReaper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    release_lease();
+}
+
+bool TtlReaper::owns_lease() const {
+    return lease_->owner.load(std::memory_order_acquire) == token_;
+}
+
+bool TtlReaper::acquire_lease() {
+    uint64_t now = current_timestamp_ns();
+    uint64_t owner = lease_->owner.load(std::memory_order_acquire);
+
+    if (owner != token_) {
+        bool vacant = owner == 0 ||
+                      now > lease_->expires_ns.load(std::memory_order_acquire) ||
+                      !owner_alive(owner);
+        if (!vacant || !lease_->owner.compare_exchange_strong(owner, token_,
+                                                              std::memory_order_acq_rel)) {
+            return false;
+        }
+    }
+
+    lease_->expires_ns.store(now + LEASE_INTERVALS * config_.interval_ms * 1000000ull,
+                             std::memory_order_release);
+    return true;
+}
+
+void TtlReaper::release_lease() {
+    uint64_t expected = token_;
+    lease_->owner.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+}
+
+bool TtlReaper::pause(uint64_t ns) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !wake_.wait_for(lock, std::chrono::nanoseconds(ns), [this] { return stop_; });
+}
+
+void TtlReaper::run() {
+    const uint64_t interval_ns = config_.interval_ms * 1000000ull;
+    const uint64_t budget = config_.cpu_budget_percent;
+
+    do {
+        if (!acquire_lease()) continue;
+
+        // Batches until the backlog is gone, each followed by enough idle
+        // time to keep the reaper within its CPU share
+        for (;;) {
+            uint64_t start = current_timestamp_ns();
+            size_t removed = 0;
+            try {
+                removed = reap_(config_.batch_size);
+            } catch (const std::exception&) {
+                break;  // E.g. the file could not grow; retry next interval
+            }
+            reaped_.fetch_add(removed, std::memory_order_relaxed);
+            if (removed < config_.batch_size) break;
+
+            uint64_t busy = current_timestamp_ns() - start;
+            std::this_thread::yield();
+            if (!pause(busy * (100 - budget) / budget)) return;
+            if (!acquire_lease()) break;
+        }
+    } while (pause(interval_ns));
+}
+
+} // namespace fastcollection
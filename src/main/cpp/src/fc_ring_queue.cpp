@@ -0,0 +1,401 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_ring_queue.cpp
+ * @brief Implementation of the bounded lock-free ring queue
+ */
+
+#include "fc_ring_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace fastcollection {
+
+using IpcScopedLock = bip::scoped_lock<IpcSharedMutex>;
+
+namespace {
+
+// Room for the header, named-object index and allocator bookkeeping
+constexpr size_t RING_FILE_SLACK = 1024 * 1024;
+
+uint64_t round_up_pow2(uint64_t n) {
+    uint64_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+uint64_t expiry_for(int32_t ttl_seconds) {
+    if (ttl_seconds < 0) return 0;
+    return current_timestamp_ns() + static_cast<uint64_t>(ttl_seconds) * 1000000000ULL;
+}
+
+} // anonymous namespace
+
+FastRingQueue::FastRingQueue(const std::string& mmap_file,
+                             size_t capacity,
+                             size_t slot_bytes,
+                             bool create_new) {
+    if (capacity == 0 || slot_bytes == 0) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INVALID_ARGUMENT,
+            "Ring queue capacity and slot size must be positive"
+        );
+    }
+    uint64_t slots = round_up_pow2(capacity);
+    uint64_t bytes = (slot_bytes + 7) & ~uint64_t(7);
+
+    // The whole ring is laid out up front, so size the file for it
+    size_t file_size = slots * (sizeof(RingSlot) + bytes) + RING_FILE_SLACK;
+    file_manager_ = std::make_unique<MMapFileManager>(mmap_file, file_size, create_new);
+
+    auto result = file_manager_->find<RingQueueHeader>("ring_header");
+    if (result.first) {
+        header_ = result.first;
+        if (!header_->is_valid()) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::INTERNAL_ERROR,
+                "Invalid ring queue header in file"
+            );
+        }
+        // The file now holds a slab heap, which older builds would not know of
+        header_->mark_current();
+    } else {
+        header_ = file_manager_->find_or_construct<RingQueueHeader>("ring_header", slots, bytes);
+    }
+
+    // Two processes may open a new file at once; the first one lays out the ring
+    if (header_->slots_offset < 0) {
+        IpcScopedLock lock(header_->global_mutex);
+        if (header_->slots_offset < 0) {
+            create_ring();
+        }
+    }
+
+    uint8_t* base = reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+    slots_ = reinterpret_cast<RingSlot*>(base + header_->slots_offset);
+    arena_ = base + header_->arena_offset;
+    mask_ = header_->capacity - 1;
+}
+
+FastRingQueue::~FastRingQueue() {
+    if (file_manager_) {
+        flush();
+    }
+}
+
+FastRingQueue::FastRingQueue(FastRingQueue&& other) noexcept {
+    *this = std::move(other);
+}
+
+FastRingQueue& FastRingQueue::operator=(FastRingQueue&& other) noexcept {
+    if (this != &other) {
+        file_manager_ = std::move(other.file_manager_);
+        header_ = other.header_;
+        slots_ = other.slots_;
+        arena_ = other.arena_;
+        mask_ = other.mask_;
+        other.header_ = nullptr;
+        other.slots_ = nullptr;
+        other.arena_ = nullptr;
+    }
+    return *this;
+}
+
+void FastRingQueue::create_ring() {
+    uint64_t slots = header_->capacity;
+    uint8_t* base = reinterpret_cast<uint8_t*>(file_manager_->segment_manager());
+
+    void* slot_mem = file_manager_->allocate_aligned(slots * sizeof(RingSlot), 64);
+    void* arena_mem = file_manager_->allocate_aligned(slots * header_->slot_bytes, 64);
+    if (!slot_mem || !arena_mem) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+            "Failed to allocate ring queue"
+        );
+    }
+
+    // Every slot starts free for its first-lap position
+    RingSlot* ring = static_cast<RingSlot*>(slot_mem);
+    for (uint64_t i = 0; i < slots; i++) {
+        new(&ring[i]) RingSlot();
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    header_->arena_offset = static_cast<uint8_t*>(arena_mem) - base;
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->slots_offset = static_cast<uint8_t*>(slot_mem) - base;
+}
+
+void FastRingQueue::copy_in(uint64_t position, const uint8_t* data, size_t size) {
+    size_t arena_bytes = header_->capacity * header_->slot_bytes;
+    size_t start = (position & mask_) * header_->slot_bytes;
+    size_t first = std::min(size, arena_bytes - start);
+    std::memcpy(arena_ + start, data, first);
+    if (size > first) {
+        std::memcpy(arena_, data + first, size - first);
+    }
+}
+
+void FastRingQueue::copy_out(uint64_t position, uint8_t* out, size_t size) const {
+    size_t arena_bytes = header_->capacity * header_->slot_bytes;
+    size_t start = (position & mask_) * header_->slot_bytes;
+    size_t first = std::min(size, arena_bytes - start);
+    std::memcpy(out, arena_ + start, first);
+    if (size > first) {
+        std::memcpy(out + first, arena_, size - first);
+    }
+}
+
+bool FastRingQueue::try_offer(const uint8_t* data, size_t size, int32_t ttl_seconds) {
+    uint64_t span = span_for(size);
+    uint64_t pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+        // Every slot of the record must be free for this lap
+        bool stale = false;
+        for (uint64_t j = 0; j < span; j++) {
+            uint64_t seq = slot_at(pos + j).sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - (pos + j));
+            if (diff < 0) {
+                return false;  // Still holds last lap's record: full
+            }
+            if (diff > 0) {
+                stale = true;  // Another producer got here first
+                break;
+            }
+        }
+        if (stale) {
+            pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (header_->enqueue_pos.compare_exchange_weak(pos, pos + span,
+                                                       std::memory_order_relaxed,
+                                                       std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    RingSlot& head = slot_at(pos);
+    head.size = static_cast<uint32_t>(size);
+    head.span = static_cast<uint32_t>(span);
+    head.expires_at = expiry_for(ttl_seconds);
+    copy_in(pos, data, size);
+
+    // Counted before it is visible, so a consumer never counts it out first
+    header_->size.fetch_add(1, std::memory_order_relaxed);
+
+    // Publish the head last: consumers and peek() look only at the head
+    for (uint64_t j = span - 1; j > 0; j--) {
+        slot_at(pos + j).sequence.store(pos + j + 1, std::memory_order_release);
+    }
+    head.sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+FastRingQueue::Take FastRingQueue::try_poll(std::vector<uint8_t>* out_data) {
+    uint64_t pos = header_->dequeue_pos.load(std::memory_order_relaxed);
+    uint64_t span;
+
+    while (true) {
+        RingSlot& head = slot_at(pos);
+        uint64_t seq = head.sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+        if (diff == 0) {
+            // The CAS succeeds only if nobody consumed pos, so span is this record's
+            span = head.span;
+            if (header_->dequeue_pos.compare_exchange_weak(pos, pos + span,
+                                                           std::memory_order_relaxed,
+                                                           std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return Take::EMPTY;  // Nothing published here yet
+        } else {
+            pos = header_->dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    RingSlot& head = slot_at(pos);
+    uint64_t expires_at = head.expires_at;
+    bool live = expires_at == 0 || current_timestamp_ns() < expires_at;
+    if (live && out_data) {
+        out_data->resize(head.size);
+        copy_out(pos, out_data->data(), head.size);
+    }
+
+    // Free the head last, so a slot peek() validated cannot be rewritten
+    uint64_t capacity = header_->capacity;
+    for (uint64_t j = span - 1; j > 0; j--) {
+        slot_at(pos + j).sequence.store(pos + j + capacity, std::memory_order_release);
+    }
+    head.sequence.store(pos + capacity, std::memory_order_release);
+    header_->size.fetch_sub(1, std::memory_order_relaxed);
+    return live ? Take::LIVE : Take::EXPIRED;
+}
+
+bool FastRingQueue::offer(const uint8_t* data, size_t size, int32_t ttl_seconds) {
+    if (!data || size == 0) return false;
+    if (size > maxRecordSize()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INVALID_ARGUMENT,
+            "Record larger than the ring queue"
+        );
+    }
+
+    if (!try_offer(data, size, ttl_seconds)) return false;
+    header_->not_empty.notify_one();
+    return true;
+}
+
+bool FastRingQueue::offer(const uint8_t* data, size_t size, uint32_t timeout_ms,
+                          int32_t ttl_seconds) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        // Register before trying, so a poll in between still wakes us
+        uint32_t key = header_->not_full.prepare_wait();
+        if (offer(data, size, ttl_seconds)) {
+            header_->not_full.cancel_wait();
+            return true;
+        }
+        if (!data || size == 0) {
+            header_->not_full.cancel_wait();
+            return false;
+        }
+
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            header_->not_full.cancel_wait();
+            return false;
+        }
+        header_->not_full.wait(key, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count());
+    }
+}
+
+void FastRingQueue::put(const uint8_t* data, size_t size, int32_t ttl_seconds) {
+    if (!data || size == 0) return;
+
+    while (true) {
+        uint32_t key = header_->not_full.prepare_wait();
+        if (offer(data, size, ttl_seconds)) {
+            header_->not_full.cancel_wait();
+            return;
+        }
+        header_->not_full.wait(key);
+    }
+}
+
+bool FastRingQueue::poll(std::vector<uint8_t>& out_data) {
+    while (true) {
+        Take taken = try_poll(&out_data);
+        if (taken == Take::EMPTY) return false;
+
+        // Records can differ in size, so any waiting producer may now fit
+        header_->not_full.notify_all();
+        if (taken == Take::LIVE) return true;
+    }
+}
+
+bool FastRingQueue::poll(std::vector<uint8_t>& out_data, uint32_t timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        uint32_t key = header_->not_empty.prepare_wait();
+        if (poll(out_data)) {
+            header_->not_empty.cancel_wait();
+            return true;
+        }
+
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            header_->not_empty.cancel_wait();
+            return false;
+        }
+        header_->not_empty.wait(key, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count());
+    }
+}
+
+std::vector<uint8_t> FastRingQueue::take() {
+    std::vector<uint8_t> result;
+
+    while (true) {
+        uint32_t key = header_->not_empty.prepare_wait();
+        if (poll(result)) {
+            header_->not_empty.cancel_wait();
+            return result;
+        }
+        header_->not_empty.wait(key);
+    }
+}
+
+bool FastRingQueue::peek(std::vector<uint8_t>& out_data) const {
+    while (true) {
+        uint64_t head_pos = header_->dequeue_pos.load(std::memory_order_acquire);
+        uint64_t pos = head_pos;
+        bool retry = false;
+
+        // Walk past expired records without consuming them
+        while (pos - head_pos < header_->capacity) {
+            RingSlot& slot = slot_at(pos);
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                // Empty here, unless consumers moved the head meanwhile
+                retry = header_->dequeue_pos.load(std::memory_order_acquire) != head_pos;
+                break;
+            }
+
+            uint32_t size = slot.size;
+            uint32_t span = slot.span;
+            uint64_t expires_at = slot.expires_at;
+            bool live = expires_at == 0 || current_timestamp_ns() < expires_at;
+            if (live) {
+                out_data.resize(size);
+                copy_out(pos, out_data.data(), size);
+            }
+
+            // The head slot is freed last, so if it still holds this record
+            // nothing read above was overwritten
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != pos + 1) {
+                retry = true;
+                break;
+            }
+            if (live) return true;
+            pos += span;
+        }
+
+        if (!retry) return false;
+    }
+}
+
+size_t FastRingQueue::size() const {
+    return header_->size.load(std::memory_order_relaxed);
+}
+
+size_t FastRingQueue::remainingSlots() const {
+    uint64_t dequeued = header_->dequeue_pos.load(std::memory_order_acquire);
+    uint64_t enqueued = header_->enqueue_pos.load(std::memory_order_acquire);
+    uint64_t used = enqueued > dequeued ? enqueued - dequeued : 0;
+    return used >= header_->capacity ? 0 : header_->capacity - used;
+}
+
+void FastRingQueue::clear() {
+    size_t dropped = 0;
+    while (try_poll(nullptr) != Take::EMPTY) {
+        dropped++;
+    }
+    if (dropped > 0) {
+        header_->not_full.notify_all();
+    }
+}
+
+void FastRingQueue::flush() {
+    file_manager_->flush();
+}
+
+} // namespace fastcollection
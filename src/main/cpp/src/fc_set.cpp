@@ -9,12 +9,12 @@
  */
 
 #include "fc_set.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 
 namespace fastcollection {
 
-using IpcScopedLock = bip::scoped_lock<IpcMutex>;
-
 FastSet::FastSet(const std::string& mmap_file,
                  size_t initial_size,
                  bool create_new,
@@ -22,6 +22,7 @@ FastSet::FastSet(const std::string& mmap_file,
     : file_manager_(std::make_unique<MMapFileManager>(mmap_file, initial_size, create_new)) {
     
     auto result = file_manager_->find<HashTableHeader>("set_header");
+    bool existing = result.first != nullptr;
     
     if (result.first) {
         header_ = result.first;
@@ -31,58 +32,67 @@ FastSet::FastSet(const std::string& mmap_file,
                 "Invalid set header in file"
             );
         }
+        // Before the buckets are converted or anything comes from the slabs
+        header_->mark_current();
     } else {
         header_ = file_manager_->find_or_construct<HashTableHeader>("set_header", bucket_count);
     }
+    hasher_ = Hasher::open(file_manager_.get(), "set_hash", existing);
     
     // Find or create buckets
-    auto buckets_result = file_manager_->find<ShmBucket>("set_buckets");
-    if (buckets_result.first) {
-        buckets_ = buckets_result.first;
-    } else {
-        buckets_ = file_manager_->construct_array<ShmBucket>("set_buckets", header_->bucket_count);
-    }
+    table_ = BucketTable<ShmNode>(file_manager_.get(), header_, "set_buckets", "set_directory",
+                                  "set_stripes");
+    epoch_ = std::make_unique<EpochDomain>(
+        file_manager_.get(),
+        file_manager_->find_or_construct<EpochHeader>("set_epoch_domain"),
+        offsetof(ShmNode, prev_offset));
+    
+    // Files written before the index existed start with an incomplete one
+    expiry_ = ExpiryIndex(file_manager_.get(),
+                          file_manager_->find_or_construct<ExpiryHeader>("set_expiry_index", !existing),
+                          true);
     
     stats_.size.store(header_->size.load(), std::memory_order_relaxed);
 }
 
 FastSet::~FastSet() {
+    // The reaper works on this set until it is joined
+    reaper_.reset();
     if (file_manager_) {
         flush();
     }
 }
 
 FastSet::FastSet(FastSet&& other) noexcept
-    : file_manager_(std::move(other.file_manager_))
-    , header_(other.header_)
-    , buckets_(other.buckets_) {
-    other.header_ = nullptr;
-    other.buckets_ = nullptr;
+    : header_(nullptr) {
+    *this = std::move(other);
 }
 
 FastSet& FastSet::operator=(FastSet&& other) noexcept {
     if (this != &other) {
+        // Reapers are bound to the object that started them
+        reaper_.reset();
+        other.reaper_.reset();
+        
+        // Release the epoch domain while its file is still mapped
+        epoch_ = std::move(other.epoch_);
         file_manager_ = std::move(other.file_manager_);
         header_ = other.header_;
-        buckets_ = other.buckets_;
+        hasher_ = other.hasher_;
+        table_ = other.table_;
+        expiry_ = other.expiry_;
         other.header_ = nullptr;
-        other.buckets_ = nullptr;
     }
     return *this;
 }
 
-ShmBucket* FastSet::get_bucket(uint32_t hash) {
-    uint32_t idx = hash & (header_->bucket_count - 1);
-    return &buckets_[idx];
-}
-
-const ShmBucket* FastSet::get_bucket(uint32_t hash) const {
-    uint32_t idx = hash & (header_->bucket_count - 1);
-    return &buckets_[idx];
-}
-
 ShmNode* FastSet::find_in_bucket(ShmBucket* bucket, const uint8_t* data, size_t size,
-                                  uint32_t hash, ShmNode** prev_out) {
+                                  uint64_t hash, ShmNode** prev_out) {
+    if (!bucket->may_contain(hash)) {
+        if (prev_out) *prev_out = nullptr;
+        return nullptr;
+    }
+    
     void* base = file_manager_->segment_manager();
     
     int64_t current = bucket->head_offset.load(std::memory_order_acquire);
@@ -94,7 +104,7 @@ ShmNode* FastSet::find_in_bucket(ShmBucket* bucket, const uint8_t* data, size_t
         );
         
         if (node->entry.is_alive() &&
-            node->entry.hash_code == hash &&
+            hasher_.matches(node->entry, hash) &&
             node->entry.data_size == size &&
             std::memcmp(node->data, data, size) == 0) {
             if (prev_out) *prev_out = prev;
@@ -121,19 +131,21 @@ ShmNode* FastSet::allocate_node(size_t data_size) {
     return new(mem) ShmNode();
 }
 
-void FastSet::free_node(ShmNode* node) {
-    if (node) {
-        file_manager_->deallocate(node);
-    }
+void FastSet::retire_node(ShmNode* node) {
+    expiry_.untrack(&node->entry);
+    
+    // Lock-free readers and sweeps may still hold node; free it once they
+    // have all moved on
+    epoch_->retire(node);
 }
 
 bool FastSet::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
-    ShmBucket* bucket = get_bucket(hash);
-    
-    IpcScopedLock lock(bucket->mutex);
+    uint64_t hash = hasher_(data, size);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     // Check if already exists
     ShmNode* existing = find_in_bucket(bucket, data, size, hash, nullptr);
@@ -145,6 +157,7 @@ bool FastSet::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
         // Expired - update in place
         existing->entry.set_ttl(ttl_seconds);
         existing->entry.mark_valid();
+        track_expiry(existing->entry);
         stats_.write_count.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
@@ -152,7 +165,8 @@ bool FastSet::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     // Allocate and add new node
     void* base = file_manager_->segment_manager();
     ShmNode* node = allocate_node(size);
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
+    SerializationUtil::copy_to_node(node, hash, data, size, ttl_seconds);
+    track_expiry(node->entry);
     
     int64_t node_offset = static_cast<uint8_t*>(static_cast<void*>(node)) - 
                           static_cast<uint8_t*>(base);
@@ -169,8 +183,8 @@ bool FastSet::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
         old_head_node->prev_offset.store(node_offset, std::memory_order_release);
     }
     
+    bucket->add_entry(hash);
     bucket->head_offset.store(node_offset, std::memory_order_release);
-    bucket->size.fetch_add(1, std::memory_order_acq_rel);
     
     header_->size.fetch_add(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
@@ -183,10 +197,10 @@ bool FastSet::add(const uint8_t* data, size_t size, int32_t ttl_seconds) {
 bool FastSet::remove(const uint8_t* data, size_t size) {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
-    ShmBucket* bucket = get_bucket(hash);
-    
-    IpcScopedLock lock(bucket->mutex);
+    uint64_t hash = hasher_(data, size);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     void* base = file_manager_->segment_manager();
     ShmNode* prev = nullptr;
@@ -218,10 +232,10 @@ bool FastSet::remove(const uint8_t* data, size_t size) {
         );
     }
     
+    table_.untag(bucket, node->entry.hash_code);
     node->entry.mark_deleted();
-    free_node(node);
+    retire_node(node);
     
-    bucket->size.fetch_sub(1, std::memory_order_acq_rel);
     header_->size.fetch_sub(1, std::memory_order_acq_rel);
     header_->modified_at = current_timestamp_ns();
     stats_.size.fetch_sub(1, std::memory_order_relaxed);
@@ -232,28 +246,21 @@ bool FastSet::remove(const uint8_t* data, size_t size) {
 bool FastSet::contains(const uint8_t* data, size_t size) const {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
-    const ShmBucket* bucket = get_bucket(hash);
+    uint64_t hash = hasher_(data, size);
     
     // Lock-free optimistic read
-    void* base = file_manager_->segment_manager();
-    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    auto guard = epoch_->read();
+    const ShmNode* node = table_.find(hash, [&](const ShmNode* node) {
+        return node->entry.is_alive() &&
+               hasher_.matches(node->entry, hash) &&
+               node->entry.data_size == size &&
+               std::memcmp(node->data, data, size) == 0;
+    });
     
-    while (current >= 0) {
-        const ShmNode* node = reinterpret_cast<const ShmNode*>(
-            static_cast<const uint8_t*>(base) + current
-        );
-        
-        if (node->entry.is_alive() &&
-            node->entry.hash_code == hash &&
-            node->entry.data_size == size &&
-            std::memcmp(node->data, data, size) == 0) {
-            const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
-            const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
-            return true;
-        }
-        
-        current = node->next_offset.load(std::memory_order_acquire);
+    if (node) {
+        const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
+        const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
     }
     
     const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
@@ -264,37 +271,25 @@ bool FastSet::contains(const uint8_t* data, size_t size) const {
 int64_t FastSet::getTTL(const uint8_t* data, size_t size) const {
     if (!data || size == 0) return 0;
     
-    uint32_t hash = compute_hash(data, size);
-    const ShmBucket* bucket = get_bucket(hash);
-    
-    void* base = file_manager_->segment_manager();
-    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
-    
-    while (current >= 0) {
-        const ShmNode* node = reinterpret_cast<const ShmNode*>(
-            static_cast<const uint8_t*>(base) + current
-        );
-        
-        if (node->entry.is_alive() &&
-            node->entry.hash_code == hash &&
-            node->entry.data_size == size &&
-            std::memcmp(node->data, data, size) == 0) {
-            return node->entry.remaining_ttl_seconds();
-        }
-        
-        current = node->next_offset.load(std::memory_order_acquire);
-    }
+    uint64_t hash = hasher_(data, size);
+    auto guard = epoch_->read();
+    const ShmNode* node = table_.find(hash, [&](const ShmNode* node) {
+        return node->entry.is_alive() &&
+               hasher_.matches(node->entry, hash) &&
+               node->entry.data_size == size &&
+               std::memcmp(node->data, data, size) == 0;
+    });
     
-    return 0;
+    return node ? node->entry.remaining_ttl_seconds() : 0;
 }
 
 bool FastSet::setTTL(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
-    ShmBucket* bucket = get_bucket(hash);
-    
-    IpcScopedLock lock(bucket->mutex);
+    uint64_t hash = hasher_(data, size);
+    table_.advance();
+    BucketGuard lock = table_.lock_bucket(hash);
+    ShmBucket* bucket = lock.bucket();
     
     ShmNode* node = find_in_bucket(bucket, data, size, hash, nullptr);
     if (!node || !node->entry.is_alive()) {
@@ -302,6 +297,7 @@ bool FastSet::setTTL(const uint8_t* data, size_t size, int32_t ttl_seconds) {
     }
     
     node->entry.set_ttl(ttl_seconds);
+    track_expiry(node->entry);
     header_->modified_at = current_timestamp_ns();
     
     return true;
@@ -328,13 +324,19 @@ size_t FastSet::removeAll(const std::vector<std::pair<const uint8_t*, size_t>>&
 }
 
 size_t FastSet::retainIf(std::function<bool(const uint8_t* data, size_t size)> predicate) {
-    size_t removed = 0;
+    return retain_matching(predicate, false);
+}
+
+size_t FastSet::parallelRetainIf(std::function<bool(const uint8_t* data, size_t size)> predicate) {
+    return retain_matching(predicate, true);
+}
+
+size_t FastSet::retain_matching(const std::function<bool(const uint8_t* data, size_t size)>& predicate,
+                                bool parallel) {
+    std::atomic<size_t> removed{0};
     void* base = file_manager_->segment_manager();
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        ShmBucket* bucket = &buckets_[i];
-        IpcScopedLock lock(bucket->mutex);
-        
+    auto filter = [&](ShmBucket* bucket) {
         int64_t current = bucket->head_offset.load(std::memory_order_acquire);
         
         while (current >= 0) {
@@ -363,127 +365,198 @@ size_t FastSet::retainIf(std::function<bool(const uint8_t* data, size_t size)> p
                     next_node->prev_offset.store(prev, std::memory_order_release);
                 }
                 
+                table_.untag(bucket, node->entry.hash_code);
                 node->entry.mark_deleted();
-                free_node(node);
+                retire_node(node);
                 
-                bucket->size.fetch_sub(1, std::memory_order_acq_rel);
                 header_->size.fetch_sub(1, std::memory_order_acq_rel);
                 stats_.size.fetch_sub(1, std::memory_order_relaxed);
-                removed++;
+                removed.fetch_add(1, std::memory_order_relaxed);
             }
             
             current = next;
         }
+        
+        return true;
+    };
+    if (parallel) {
+        table_.for_each_locked_bucket_parallel(filter);
+    } else {
+        table_.for_each_locked_bucket(filter);
     }
     
     if (removed > 0) {
         header_->modified_at = current_timestamp_ns();
     }
     
-    return removed;
+    return removed.load();
 }
 
-size_t FastSet::removeExpired() {
+void FastSet::track_expiry(ShmEntry& entry) {
+    // Index first: a reaper that has already popped its due records then
+    // still sees this element through the header bound
+    expiry_.track(&entry);
+    header_->note_expiry(entry.expires_at);
+}
+
+size_t FastSet::reap_bucket(ShmBucket* bucket, uint64_t& next_expiry, bool reindex) {
     size_t removed = 0;
     void* base = file_manager_->segment_manager();
+    int64_t current = bucket->head_offset.load(std::memory_order_acquire);
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        ShmBucket* bucket = &buckets_[i];
-        IpcScopedLock lock(bucket->mutex);
-        
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+    while (current >= 0) {
+        ShmNode* node = reinterpret_cast<ShmNode*>(
+            static_cast<uint8_t*>(base) + current
+        );
+        int64_t next = node->next_offset.load(std::memory_order_acquire);
         
-        while (current >= 0) {
-            ShmNode* node = reinterpret_cast<ShmNode*>(
-                static_cast<uint8_t*>(base) + current
-            );
-            int64_t next = node->next_offset.load(std::memory_order_acquire);
+        if (!node->entry.is_expired()) {
+            if (node->entry.expires_at != 0) {
+                next_expiry = std::min(next_expiry, node->entry.expires_at);
+                if (reindex) expiry_.track(&node->entry);
+            }
+        } else {
+            int64_t prev = node->prev_offset.load(std::memory_order_acquire);
             
-            if (node->entry.is_expired()) {
-                int64_t prev = node->prev_offset.load(std::memory_order_acquire);
-                
-                if (prev >= 0) {
-                    ShmNode* prev_node = reinterpret_cast<ShmNode*>(
-                        static_cast<uint8_t*>(base) + prev
-                    );
-                    prev_node->next_offset.store(next, std::memory_order_release);
-                } else {
-                    bucket->head_offset.store(next, std::memory_order_release);
-                }
-                
-                if (next >= 0) {
-                    ShmNode* next_node = reinterpret_cast<ShmNode*>(
-                        static_cast<uint8_t*>(base) + next
-                    );
-                    next_node->prev_offset.store(prev, std::memory_order_release);
-                }
-                
-                node->entry.mark_deleted();
-                free_node(node);
-                
-                bucket->size.fetch_sub(1, std::memory_order_acq_rel);
-                header_->size.fetch_sub(1, std::memory_order_acq_rel);
-                stats_.size.fetch_sub(1, std::memory_order_relaxed);
-                removed++;
+            if (prev >= 0) {
+                ShmNode* prev_node = reinterpret_cast<ShmNode*>(
+                    static_cast<uint8_t*>(base) + prev
+                );
+                prev_node->next_offset.store(next, std::memory_order_release);
+            } else {
+                bucket->head_offset.store(next, std::memory_order_release);
             }
             
-            current = next;
+            if (next >= 0) {
+                ShmNode* next_node = reinterpret_cast<ShmNode*>(
+                    static_cast<uint8_t*>(base) + next
+                );
+                next_node->prev_offset.store(prev, std::memory_order_release);
+            }
+            
+            table_.untag(bucket, node->entry.hash_code);
+            node->entry.mark_deleted();
+            retire_node(node);
+            
+            header_->size.fetch_sub(1, std::memory_order_acq_rel);
+            stats_.size.fetch_sub(1, std::memory_order_relaxed);
+            removed++;
+        }
+        
+        current = next;
+    }
+    
+    return removed;
+}
+
+size_t FastSet::removeExpired() {
+    return reapExpired(SIZE_MAX);
+}
+
+size_t FastSet::reapExpired(size_t max_items) {
+    if (expiry_.needs_rebuild()) {
+        return sweep_expired();
+    }
+    
+    size_t removed = 0;
+    uint64_t now = current_timestamp_ns();
+    std::vector<uint32_t> hashes;
+    
+    header_->begin_expiry_sweep();
+    
+    // Keep popping until enough was removed or nothing is due
+    while (removed < max_items) {
+        hashes.clear();
+        expiry_.pop_due(now, hashes, max_items - removed);
+        if (hashes.empty()) break;
+        
+        // Several due elements may share a hash or a bucket
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+        
+        // Survivors of these buckets still have records of their own
+        uint64_t unused = CollectionHeader::NO_EXPIRY;
+        for (uint32_t hash : hashes) {
+            table_.advance();
+            BucketGuard lock = table_.lock_bucket(hash);
+            ShmBucket* bucket = lock.bucket();
+            removed += reap_bucket(bucket, unused, false);
         }
     }
+    header_->note_expiry(expiry_.next_expiry());
     
     if (removed > 0) {
         header_->modified_at = current_timestamp_ns();
     }
-    
     return removed;
 }
 
-void FastSet::forEach(std::function<bool(const uint8_t* data, size_t size)> callback) const {
-    void* base = file_manager_->segment_manager();
+size_t FastSet::parallelRemoveExpired() {
+    return sweep_expired(true);
+}
+
+size_t FastSet::sweep_expired(bool parallel) {
+    std::atomic<size_t> removed{0};
+    
+    // Writers add their own records while the walk runs, so records dropped
+    // by reset() are either re-added here or by them
+    header_->begin_expiry_sweep();
+    expiry_.reset();
+    
+    auto reap = [&](ShmBucket* bucket) {
+        uint64_t bucket_expiry = CollectionHeader::NO_EXPIRY;
+        removed.fetch_add(reap_bucket(bucket, bucket_expiry, true), std::memory_order_relaxed);
+        header_->note_expiry(bucket_expiry);
+        return true;
+    };
+    if (parallel) {
+        table_.for_each_locked_bucket_parallel(reap);
+    } else {
+        table_.for_each_locked_bucket(reap);
+    }
+    expiry_.mark_complete();
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
-        
-        while (current >= 0) {
-            const ShmNode* node = reinterpret_cast<const ShmNode*>(
-                static_cast<const uint8_t*>(base) + current
-            );
-            
-            if (node->entry.is_alive()) {
-                if (!callback(node->data, node->entry.data_size)) {
-                    return;
-                }
+    if (removed > 0) {
+        header_->modified_at = current_timestamp_ns();
+    }
+    return removed.load();
+}
+
+void FastSet::forEach(std::function<bool(const uint8_t* data, size_t size)> callback) const {
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmNode* node) {
+        if (node->entry.is_alive()) {
+            if (!callback(node->data, node->entry.data_size)) {
+                return false;
             }
-            
-            current = node->next_offset.load(std::memory_order_acquire);
         }
-    }
+        return true;
+    });
+}
+
+void FastSet::parallelForEach(std::function<bool(const uint8_t* data, size_t size)> callback) const {
+    table_.for_each_node_parallel([&](const ShmNode* node) {
+        if (node->entry.is_alive()) {
+            if (!callback(node->data, node->entry.data_size)) {
+                return false;
+            }
+        }
+        return true;
+    }, [this] { return epoch_->read(); });
 }
 
 void FastSet::forEachWithTTL(std::function<bool(const uint8_t* data, size_t size,
                                                  int64_t ttl_remaining)> callback) const {
-    void* base = file_manager_->segment_manager();
-    
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
-        
-        while (current >= 0) {
-            const ShmNode* node = reinterpret_cast<const ShmNode*>(
-                static_cast<const uint8_t*>(base) + current
-            );
-            
-            if (node->entry.is_alive()) {
-                int64_t ttl = node->entry.remaining_ttl_seconds();
-                if (!callback(node->data, node->entry.data_size, ttl)) {
-                    return;
-                }
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmNode* node) {
+        if (node->entry.is_alive()) {
+            int64_t ttl = node->entry.remaining_ttl_seconds();
+            if (!callback(node->data, node->entry.data_size, ttl)) {
+                return false;
             }
-            
-            current = node->next_offset.load(std::memory_order_acquire);
         }
-    }
+        return true;
+    });
 }
 
 std::vector<std::vector<uint8_t>> FastSet::toArray() const {
@@ -498,13 +571,44 @@ std::vector<std::vector<uint8_t>> FastSet::toArray() const {
     return result;
 }
 
-void FastSet::clear() {
+uint64_t FastSet::scan(uint64_t cursor, size_t count,
+                       std::vector<std::vector<uint8_t>>& out_batch) const {
+    out_batch.clear();
+    count = std::max<size_t>(count, 1);
     void* base = file_manager_->segment_manager();
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        ShmBucket* bucket = &buckets_[i];
-        IpcScopedLock lock(bucket->mutex);
+    auto guard = epoch_->read();
+    return table_.scan_from(cursor, count * SCAN_BUCKETS_PER_ENTRY, [&](ShmBucket* bucket) {
+        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
+        
+        while (current >= 0) {
+            const ShmNode* node = reinterpret_cast<const ShmNode*>(
+                static_cast<const uint8_t*>(base) + current
+            );
+            if (node->entry.is_alive()) {
+                out_batch.emplace_back(node->data, node->data + node->entry.data_size);
+            }
+            current = node->next_offset.load(std::memory_order_acquire);
+        }
         
+        return out_batch.size() < count;
+    });
+}
+
+void FastSet::clear() {
+    clear_elements(false);
+}
+
+void FastSet::parallelClear() {
+    clear_elements(true);
+}
+
+void FastSet::clear_elements(bool parallel) {
+    void* base = file_manager_->segment_manager();
+    
+    // Elements added while the walk runs record themselves again
+    expiry_.reset();
+    auto drop = [&](ShmBucket* bucket) {
         int64_t current = bucket->head_offset.load(std::memory_order_acquire);
         
         while (current >= 0) {
@@ -514,13 +618,20 @@ void FastSet::clear() {
             int64_t next = node->next_offset.load(std::memory_order_acquire);
             
             node->entry.mark_deleted();
-            free_node(node);
+            retire_node(node);
             
             current = next;
         }
         
         bucket->head_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-        bucket->size.store(0, std::memory_order_release);
+        bucket->tags.store(0, std::memory_order_release);
+        
+        return true;
+    };
+    if (parallel) {
+        table_.for_each_locked_bucket_parallel(drop);
+    } else {
+        table_.for_each_locked_bucket(drop);
     }
     
     header_->size.store(0, std::memory_order_release);
@@ -529,22 +640,23 @@ void FastSet::clear() {
 }
 
 size_t FastSet::size() const {
+    size_t size = header_->size.load(std::memory_order_acquire);
+    if (!header_->may_have_expired()) return size;
+    
+    // Leave the reaping to removeExpired(); just discount what is due
+    size_t due = static_cast<size_t>(expiry_.count_due(current_timestamp_ns()));
+    return size - std::min(due, size);
+}
+
+size_t FastSet::exactSize() const {
     // Count only alive elements
     size_t alive = 0;
-    void* base = file_manager_->segment_manager();
     
-    for (uint32_t i = 0; i < header_->bucket_count; i++) {
-        const ShmBucket* bucket = &buckets_[i];
-        int64_t current = bucket->head_offset.load(std::memory_order_acquire);
-        
-        while (current >= 0) {
-            const ShmNode* node = reinterpret_cast<const ShmNode*>(
-                static_cast<const uint8_t*>(base) + current
-            );
-            if (node->entry.is_alive()) alive++;
-            current = node->next_offset.load(std::memory_order_acquire);
-        }
-    }
+    auto guard = epoch_->read();
+    table_.for_each_node([&](const ShmNode* node) {
+        if (node->entry.is_alive()) alive++;
+        return true;
+    });
     
     return alive;
 }
@@ -553,6 +665,18 @@ bool FastSet::isEmpty() const {
     return size() == 0;
 }
 
+void FastSet::startReaper(const ReaperConfig& config) {
+    reaper_.reset();
+    reaper_ = std::make_unique<TtlReaper>(
+        file_manager_->find_or_construct<ReaperLease>("set_reaper"),
+        [this](size_t max_items) { return reapExpired(max_items); },
+        config);
+}
+
+void FastSet::stopReaper() {
+    reaper_.reset();
+}
+
 void FastSet::flush() {
     file_manager_->flush();
 }
@@ -0,0 +1,190 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_slab.cpp
+ * @brief Implementation of the size-class slab allocator
+ */
+
+#include "fc_slab.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace fastcollection {
+
+namespace {
+
+// List heads pack a block offset (low 40 bits, all ones for none) and a tag
+// bumped on every change (high 24 bits)
+constexpr int OFFSET_BITS = 40;
+constexpr uint64_t OFFSET_MASK = (uint64_t(1) << OFFSET_BITS) - 1;
+
+inline int64_t head_offset(int64_t word) {
+    uint64_t bits = static_cast<uint64_t>(word) & OFFSET_MASK;
+    return bits == OFFSET_MASK ? -1 : static_cast<int64_t>(bits);
+}
+
+inline int64_t next_head(int64_t word, int64_t offset) {
+    uint64_t tag = (static_cast<uint64_t>(word) >> OFFSET_BITS) + 1;
+    return static_cast<int64_t>((tag << OFFSET_BITS) |
+                                (static_cast<uint64_t>(offset) & OFFSET_MASK));
+}
+
+inline size_t round_up(size_t bytes) {
+    return (bytes + SlabHeap::BLOCK_UNIT - 1) & ~(SlabHeap::BLOCK_UNIT - 1);
+}
+
+// A free block's first word links it to the next free block of its class
+inline std::atomic_ref<int64_t> link_of(uint8_t* block) {
+    return std::atomic_ref<int64_t>(*reinterpret_cast<int64_t*>(block));
+}
+
+} // anonymous namespace
+
+SlabAllocator::SlabAllocator(SegmentManager* segment) {
+    remap(segment);
+}
+
+void SlabAllocator::remap(SegmentManager* segment) {
+    segment_ = segment;
+    base_ = reinterpret_cast<uint8_t*>(segment);
+    heap_ = segment->find_or_construct<SlabHeap>("slab_heap")();
+}
+
+void* SlabAllocator::allocate(size_t bytes) {
+    if (!handles(bytes)) return nullptr;
+
+    uint32_t class_index = static_cast<uint32_t>(round_up(bytes) / SlabHeap::BLOCK_UNIT) - 1;
+    SlabClass& cls = heap_->classes[class_index];
+
+    while (true) {
+        int64_t offset = pop(cls);
+        if (offset >= 0) return base_ + offset;
+        if (!refill(class_index)) return nullptr;
+    }
+}
+
+bool SlabAllocator::deallocate(void* ptr) {
+    int64_t offset = offset_of(ptr);
+    uint8_t class_index = class_of(offset);
+    if (class_index == SlabHeap::NO_CLASS) return false;
+
+    push(heap_->classes[class_index], offset, offset);
+    return true;
+}
+
+uint8_t SlabAllocator::class_of(int64_t offset) const {
+    // Arenas are published after they are filled in and never change
+    uint32_t count = heap_->arena_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        const SlabArena& arena = heap_->arenas[i];
+        if (offset < arena.chunk_base) continue;
+
+        uint64_t chunk = static_cast<uint64_t>(offset - arena.chunk_base) / SlabHeap::CHUNK_BYTES;
+        if (chunk >= arena.chunks) continue;
+
+        return std::atomic_ref<uint8_t>(base_[arena.offset + chunk]).load(std::memory_order_relaxed);
+    }
+    return SlabHeap::NO_CLASS;
+}
+
+int64_t SlabAllocator::pop(SlabClass& cls) {
+    int64_t head = cls.free_head.load(std::memory_order_acquire);
+    while (true) {
+        int64_t offset = head_offset(head);
+        if (offset < 0) return -1;
+
+        // If another pop takes this block first, its link may be user data
+        // by now, but the head's tag has moved on and the CAS fails
+        int64_t next = link_of(base_ + offset).load(std::memory_order_relaxed);
+        if (cls.free_head.compare_exchange_weak(head, next_head(head, next),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+            return offset;
+        }
+    }
+}
+
+void SlabAllocator::push(SlabClass& cls, int64_t first, int64_t last) {
+    int64_t head = cls.free_head.load(std::memory_order_relaxed);
+    do {
+        link_of(base_ + last).store(head_offset(head), std::memory_order_relaxed);
+    } while (!cls.free_head.compare_exchange_weak(head, next_head(head, first),
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+}
+
+bool SlabAllocator::refill(uint32_t class_index) {
+    SlabClass& cls = heap_->classes[class_index];
+    std::lock_guard<ShmSpinLock> refill(cls.refill_lock);
+
+    // Another thread may have refilled, or blocks been freed, meanwhile
+    if (head_offset(cls.free_head.load(std::memory_order_acquire)) >= 0) return true;
+
+    int64_t chunk_offset;
+    {
+        std::lock_guard<ShmSpinLock> lock(heap_->arena_lock);
+        uint32_t count = heap_->arena_count.load(std::memory_order_relaxed);
+        if (count == 0 || heap_->next_chunk == heap_->arenas[count - 1].chunks) {
+            if (!add_arena()) return false;
+            count++;
+        }
+
+        const SlabArena& arena = heap_->arenas[count - 1];
+        uint64_t chunk = heap_->next_chunk++;
+        std::atomic_ref<uint8_t>(base_[arena.offset + chunk]).store(
+            static_cast<uint8_t>(class_index), std::memory_order_relaxed);
+        chunk_offset = arena.chunk_base + static_cast<int64_t>(chunk * SlabHeap::CHUNK_BYTES);
+    }
+
+    // Link the chunk's blocks in address order and hand them over at once
+    int64_t block_size = static_cast<int64_t>((class_index + 1) * SlabHeap::BLOCK_UNIT);
+    int64_t blocks = static_cast<int64_t>(SlabHeap::CHUNK_BYTES) / block_size;
+    int64_t last = chunk_offset + (blocks - 1) * block_size;
+    for (int64_t offset = chunk_offset; offset < last; offset += block_size) {
+        link_of(base_ + offset).store(offset + block_size, std::memory_order_relaxed);
+    }
+    push(cls, chunk_offset, last);
+    return true;
+}
+
+bool SlabAllocator::add_arena() {
+    uint32_t count = heap_->arena_count.load(std::memory_order_relaxed);
+    if (count == SlabHeap::MAX_ARENAS) return false;
+
+    // Double the slab footprint each time, settling for less when the
+    // segment is short of room; growing the file is left to the caller
+    size_t size = std::clamp<size_t>(heap_->arena_bytes, SlabHeap::MIN_ARENA, SlabHeap::MAX_ARENA);
+    void* mem = nullptr;
+    for (; size >= SlabHeap::MIN_ARENA; size /= 2) {
+        mem = segment_->allocate_aligned(size, SlabHeap::BLOCK_UNIT, std::nothrow);
+        if (mem) break;
+    }
+    if (!mem) return false;
+    if (static_cast<uint64_t>(offset_of(mem)) + size >= OFFSET_MASK) {
+        // Beyond what a tagged list head can address
+        segment_->deallocate(mem);
+        return false;
+    }
+
+    // A class byte per chunk, then the chunks on a block boundary
+    uint64_t chunks = size / SlabHeap::CHUNK_BYTES;
+    while (round_up(chunks) + chunks * SlabHeap::CHUNK_BYTES > size) chunks--;
+
+    SlabArena& arena = heap_->arenas[count];
+    arena.offset = offset_of(mem);
+    arena.chunk_base = arena.offset + static_cast<int64_t>(round_up(chunks));
+    arena.chunks = chunks;
+    std::memset(mem, SlabHeap::NO_CLASS, round_up(chunks));
+
+    heap_->next_chunk = 0;
+    heap_->arena_bytes += size;
+    heap_->arena_count.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+} // namespace fastcollection
@@ -0,0 +1,982 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_sorted_map.cpp
+ * @brief Implementation of the memory-mapped B+tree sorted map
+ */
+
+#include "fc_sorted_map.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace fastcollection {
+
+using IpcExclusiveLock = bip::scoped_lock<IpcSharedMutex>;
+using IpcSharableLock = bip::sharable_lock<IpcSharedMutex>;
+
+namespace {
+
+constexpr uint32_t FANOUT = SortedNode::FANOUT;
+
+// First 8 key bytes as a big-endian integer, zero padded: comparing two
+// prefixes orders the keys unless they are equal
+uint64_t key_prefix(const uint8_t* key, size_t size) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; i++) {
+        prefix = (prefix << 8) | (i < size ? key[i] : 0);
+    }
+    return prefix;
+}
+
+int compare_keys(const uint8_t* a, size_t a_size, const uint8_t* b, size_t b_size) {
+    int c = std::memcmp(a, b, std::min(a_size, b_size));
+    if (c != 0) return c;
+    return a_size < b_size ? -1 : (a_size > b_size ? 1 : 0);
+}
+
+bool key_equals(const ShmKeyValue* kv, const uint8_t* key, size_t key_size) {
+    return kv->key_size == key_size && std::memcmp(kv->key_data(), key, key_size) == 0;
+}
+
+// Optimistic readers load node fields that a writer may be changing; the
+// loads must not tear or be repeated, and the node version tells whether
+// what they returned can be used
+template <typename T>
+T peek(const T& field) {
+    return std::atomic_ref<T>(const_cast<T&>(field)).load(std::memory_order_relaxed);
+}
+
+uint32_t count_of(const SortedNode* node) {
+    return std::min(peek(node->count), FANOUT);
+}
+
+// A node's version, unless a writer is changing the node right now
+bool stable(const SortedNode* node, bool locked, uint64_t& version) {
+    version = node->version.load(std::memory_order_acquire);
+    return locked || (version & 1) == 0;
+}
+
+// Whether nothing changed the node since its version was taken
+bool unchanged(const SortedNode* node, uint64_t version, bool locked) {
+    if (locked) return true;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return node->version.load(std::memory_order_relaxed) == version;
+}
+
+// Smallest key greater than every key starting with prefix; empty if there
+// is none (the prefix is all 0xFF)
+std::vector<uint8_t> prefix_successor(const uint8_t* prefix, size_t size) {
+    std::vector<uint8_t> next(prefix, prefix + size);
+    while (!next.empty() && next.back() == 0xFF) next.pop_back();
+    if (!next.empty()) next.back()++;
+    return next;
+}
+
+} // namespace
+
+/**
+ * @brief Nodes a writer has marked as changing
+ *
+ * Locking a node makes its version odd; the destructor makes every version
+ * even again, once the whole change is in place.
+ */
+class FastSortedMap::WriteSet {
+public:
+    WriteSet() = default;
+    WriteSet(const WriteSet&) = delete;
+    WriteSet& operator=(const WriteSet&) = delete;
+
+    ~WriteSet() {
+        for (uint32_t i = 0; i < count_; i++) {
+            nodes_[i]->version.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void lock(SortedNode* node) {
+        for (uint32_t i = 0; i < count_; i++) {
+            if (nodes_[i] == node) return;
+        }
+        // Acquire keeps the changes that follow behind the odd version
+        node->version.fetch_add(1, std::memory_order_acquire);
+        nodes_[count_++] = node;
+    }
+
+private:
+    // Per level at most the node, its new sibling and the next leaf, plus a new root
+    SortedNode* nodes_[3 * MAX_HEIGHT + 1];
+    uint32_t count_ = 0;
+};
+
+FastSortedMap::FastSortedMap(const std::string& mmap_file,
+                             size_t initial_size,
+                             bool create_new)
+    : file_manager_(std::make_unique<MMapFileManager>(mmap_file, initial_size, create_new)) {
+
+    auto result = file_manager_->find<SortedMapHeader>("sorted_header");
+    bool existing = result.first != nullptr;
+
+    if (result.first) {
+        header_ = result.first;
+        if (!header_->is_valid()) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::INTERNAL_ERROR,
+                "Invalid sorted map header in file"
+            );
+        }
+        // Nodes now come from the slab heap, which older builds would corrupt
+        header_->mark_current();
+    } else {
+        header_ = file_manager_->find_or_construct<SortedMapHeader>("sorted_header");
+    }
+
+    epoch_ = std::make_unique<EpochDomain>(
+        file_manager_.get(),
+        file_manager_->find_or_construct<EpochHeader>("sorted_epoch"),
+        offsetof(ShmKeyValue, prev_offset));
+    expiry_ = ExpiryIndex(file_manager_.get(),
+                          file_manager_->find_or_construct<ExpiryHeader>("sorted_expiry_index", !existing),
+                          false);
+
+    // Two processes may open a new file at once; the first one plants the root
+    if (header_->root_offset.load(std::memory_order_acquire) < 0) {
+        IpcExclusiveLock lock(header_->global_mutex);
+        if (header_->root_offset.load(std::memory_order_acquire) < 0) {
+            WriteSet writes;
+            SortedNode* root = take_node(writes, 0);
+            header_->height.store(1, std::memory_order_release);
+            header_->root_offset.store(offset_of(root), std::memory_order_release);
+        }
+    }
+
+    stats_.size.store(header_->size.load(), std::memory_order_relaxed);
+}
+
+FastSortedMap::~FastSortedMap() {
+    // The reaper works on this map until it is joined
+    reaper_.reset();
+    if (file_manager_) {
+        flush();
+    }
+}
+
+FastSortedMap::FastSortedMap(FastSortedMap&& other) noexcept
+    : header_(nullptr) {
+    *this = std::move(other);
+}
+
+FastSortedMap& FastSortedMap::operator=(FastSortedMap&& other) noexcept {
+    if (this != &other) {
+        // Reapers are bound to the object that started them
+        reaper_.reset();
+        other.reaper_.reset();
+
+        // Release the epoch domain while its file is still mapped
+        epoch_ = std::move(other.epoch_);
+        file_manager_ = std::move(other.file_manager_);
+        header_ = other.header_;
+        expiry_ = other.expiry_;
+        other.header_ = nullptr;
+    }
+    return *this;
+}
+
+// ============================================================================
+// Node and record management
+// ============================================================================
+
+void FastSortedMap::reserve_nodes(uint64_t count) {
+    while (header_->spare_count < count) {
+        void* mem = file_manager_->allocate(sizeof(SortedNode));
+        if (!mem) {
+            throw FastCollectionException(
+                FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+                "Failed to allocate tree node"
+            );
+        }
+        SortedNode* node = new(mem) SortedNode();
+        node->next_offset = header_->spare_offset;
+        header_->spare_offset = offset_of(node);
+        header_->spare_count++;
+        header_->node_count++;
+    }
+}
+
+SortedNode* FastSortedMap::take_node(WriteSet& writes, uint32_t level) {
+    reserve_nodes(1);
+
+    // A recycled node may still be in use by a reader that has not yet
+    // noticed it left the tree, so it is reinitialized under its version
+    SortedNode* node = node_at(header_->spare_offset);
+    writes.lock(node);
+    header_->spare_offset = node->next_offset;
+    header_->spare_count--;
+
+    node->count = 0;
+    node->level = level;
+    node->prev_offset = SortedNode::NULL_OFFSET;
+    node->next_offset = SortedNode::NULL_OFFSET;
+    return node;
+}
+
+ShmKeyValue* FastSortedMap::allocate_kv(size_t key_size, size_t value_size) {
+    void* mem = file_manager_->allocate(ShmKeyValue::total_size(key_size, value_size));
+    if (!mem) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+            "Failed to allocate key-value"
+        );
+    }
+    return new(mem) ShmKeyValue();
+}
+
+ShmKeyValue* FastSortedMap::make_separator(const ShmKeyValue* left, const ShmKeyValue* right) {
+    // The shortest prefix of right's key that is still greater than left's
+    size_t common = 0;
+    size_t limit = std::min(left->key_size, right->key_size);
+    while (common < limit && left->key_data()[common] == right->key_data()[common]) common++;
+    size_t size = std::min<size_t>(common + 1, right->key_size);
+
+    ShmKeyValue* separator = allocate_kv(size, 0);
+    separator->key_size = static_cast<uint32_t>(size);
+    separator->entry.data_size = static_cast<uint32_t>(size);
+    std::memcpy(separator->data, right->key_data(), size);
+    separator->entry.mark_valid();
+    return separator;
+}
+
+void FastSortedMap::retire_kv(ShmKeyValue* kv) {
+    expiry_.untrack(&kv->entry);
+    // Optimistic readers may still hold kv; free it once they have all moved on
+    epoch_->retire(kv);
+}
+
+void FastSortedMap::track_expiry(ShmKeyValue* kv) {
+    expiry_.track(&kv->entry);
+    header_->note_expiry(kv->entry.expires_at);
+}
+
+// ============================================================================
+// Optimistic reads
+// ============================================================================
+
+void FastSortedMap::run_read(const std::function<bool(bool locked)>& attempt) const {
+    for (uint32_t i = 0; i < OPTIMISTIC_ATTEMPTS; i++) {
+        if (attempt(false)) return;
+        std::this_thread::yield();  // Give the writer time to finish
+    }
+
+    // Writers need the exclusive lock, so nothing changes under this attempt
+    IpcSharableLock lock(header_->global_mutex);
+    attempt(true);
+}
+
+bool FastSortedMap::search(const SortedNode* node, uint64_t version,
+                           const uint8_t* key, size_t key_size,
+                           bool upper, bool locked, uint32_t& out_index) const {
+    uint64_t prefix = key_prefix(key, key_size);
+    uint32_t lo = 0;
+    uint32_t hi = count_of(node);
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint64_t mid_prefix = peek(node->prefixes[mid]);
+        int cmp;
+        if (mid_prefix != prefix) {
+            cmp = mid_prefix < prefix ? -1 : 1;
+        } else {
+            // Equal prefixes: compare the whole key, once the offset is known good
+            int64_t offset = peek(node->keys[mid]);
+            if (!unchanged(node, version, locked)) return false;
+            const ShmKeyValue* kv = record_at(offset);
+            cmp = compare_keys(kv->key_data(), kv->key_size, key, key_size);
+        }
+
+        if (cmp < 0 || (upper && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    out_index = lo;
+    return true;
+}
+
+bool FastSortedMap::find_leaf(const uint8_t* key, size_t key_size, bool last, bool locked,
+                              SortedNode*& out_leaf, uint64_t& out_version) const {
+    int64_t root_offset = header_->root_offset.load(std::memory_order_acquire);
+    SortedNode* node = node_at(root_offset);
+    uint64_t version;
+    if (!stable(node, locked, version)) return false;
+    if (header_->root_offset.load(std::memory_order_acquire) != root_offset) return false;
+
+    while (peek(node->level) > 0) {
+        uint32_t index;
+        if (key) {
+            if (!search(node, version, key, key_size, true, locked, index)) return false;
+        } else {
+            index = last ? count_of(node) : 0;
+        }
+
+        int64_t child_offset = peek(node->children[index]);
+        if (!unchanged(node, version, locked)) return false;
+
+        // Lock coupling: the child's version only counts if the parent
+        // still pointed at it after it was taken
+        SortedNode* child = node_at(child_offset);
+        uint64_t child_version;
+        if (!stable(child, locked, child_version)) return false;
+        if (!unchanged(node, version, locked)) return false;
+
+        node = child;
+        version = child_version;
+    }
+
+    out_leaf = node;
+    out_version = version;
+    return true;
+}
+
+void FastSortedMap::scan(const uint8_t* from, size_t from_size, bool inclusive, bool reverse,
+                         const std::function<bool(const ShmKeyValue* kv)>& visit) const {
+    // The read section keeps every record seen during the scan allocated,
+    // including the last one, from which a failed attempt resumes
+    auto guard = epoch_->read();
+    const ShmKeyValue* last = nullptr;
+
+    run_read([&](bool locked) {
+        const uint8_t* key = from;
+        size_t key_size = from_size;
+        bool include = inclusive;
+        if (last) {
+            key = last->key_data();
+            key_size = last->key_size;
+            include = false;
+        }
+
+        SortedNode* leaf;
+        uint64_t version;
+        if (!find_leaf(key, key_size, reverse, locked, leaf, version)) return false;
+
+        // Forward scans start at the first key >= (or >) the bound,
+        // reverse scans just before the first key > (or >=) it
+        int64_t pos;
+        if (key) {
+            uint32_t index;
+            if (!search(leaf, version, key, key_size, reverse == include, locked, index)) {
+                return false;
+            }
+            pos = reverse ? static_cast<int64_t>(index) - 1 : index;
+        } else {
+            pos = reverse ? INT64_MAX : 0;
+        }
+
+        for (;;) {
+            // Copy this leaf's part of the scan, then check it was consistent
+            int64_t batch[FANOUT];
+            uint32_t n = 0;
+            int64_t count = count_of(leaf);
+            if (reverse) {
+                for (int64_t i = std::min(pos, count - 1); i >= 0; i--) {
+                    batch[n++] = peek(leaf->keys[i]);
+                }
+            } else {
+                for (int64_t i = pos; i < count; i++) {
+                    batch[n++] = peek(leaf->keys[i]);
+                }
+            }
+            int64_t sibling = peek(reverse ? leaf->prev_offset : leaf->next_offset);
+            if (!unchanged(leaf, version, locked)) return false;
+
+            // Records never change once published, so the visits need no checks
+            for (uint32_t i = 0; i < n; i++) {
+                const ShmKeyValue* kv = record_at(batch[i]);
+                if (kv->entry.is_alive() && !visit(kv)) return true;
+                last = kv;
+            }
+
+            if (sibling < 0) return true;
+            SortedNode* next = node_at(sibling);
+            uint64_t next_version;
+            if (!stable(next, locked, next_version)) return false;
+            if (!unchanged(leaf, version, locked)) return false;
+
+            leaf = next;
+            version = next_version;
+            pos = reverse ? INT64_MAX : 0;
+        }
+    });
+}
+
+bool FastSortedMap::read_entry(const uint8_t* key, size_t key_size,
+                               const std::function<void(const ShmKeyValue* kv)>& fn) const {
+    if (!key || key_size == 0) return false;
+
+    auto guard = epoch_->read();
+    const ShmKeyValue* found = nullptr;
+
+    run_read([&](bool locked) {
+        SortedNode* leaf;
+        uint64_t version;
+        uint32_t index;
+        if (!find_leaf(key, key_size, false, locked, leaf, version)) return false;
+        if (!search(leaf, version, key, key_size, false, locked, index)) return false;
+
+        int64_t offset = index < count_of(leaf) ? peek(leaf->keys[index]) : SortedNode::NULL_OFFSET;
+        if (!unchanged(leaf, version, locked)) return false;
+
+        found = nullptr;
+        if (offset >= 0) {
+            const ShmKeyValue* kv = record_at(offset);
+            if (key_equals(kv, key, key_size) && kv->entry.is_alive()) found = kv;
+        }
+        return true;
+    });
+
+    if (found) fn(found);
+
+    CollectionStats& stats = const_cast<CollectionStats&>(stats_);
+    (found ? stats.hit_count : stats.miss_count).fetch_add(1, std::memory_order_relaxed);
+    stats.read_count.fetch_add(1, std::memory_order_relaxed);
+    return found != nullptr;
+}
+
+bool FastSortedMap::first_entry(const uint8_t* from, size_t from_size, bool reverse,
+                                std::vector<uint8_t>& out_key,
+                                std::vector<uint8_t>& out_value) const {
+    bool found = false;
+    scan(from, from_size, true, reverse, [&](const ShmKeyValue* kv) {
+        out_key.assign(kv->key_data(), kv->key_data() + kv->key_size);
+        out_value.assign(kv->value_data(), kv->value_data() + kv->value_size);
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+// ============================================================================
+// Writes (exclusive lock held)
+// ============================================================================
+
+SortedNode* FastSortedMap::descend(const uint8_t* key, size_t key_size, Path& path) const {
+    SortedNode* node = node_at(header_->root_offset.load(std::memory_order_relaxed));
+    path.depth = 0;
+
+    for (;;) {
+        uint32_t index = 0;
+        if (node->level > 0) {
+            search(node, 0, key, key_size, true, true, index);
+        }
+        path.nodes[path.depth] = node;
+        path.indices[path.depth] = index;
+        path.depth++;
+
+        if (node->level == 0) return node;
+        node = node_at(node->children[index]);
+    }
+}
+
+bool FastSortedMap::insert(const uint8_t* key, size_t key_size,
+                           const uint8_t* value, size_t value_size,
+                           int32_t ttl_seconds, bool only_if_absent) {
+    if (!key || key_size == 0) return false;
+
+    // Prepare the record before taking the lock
+    ShmKeyValue* kv = allocate_kv(key_size, value_size);
+    SerializationUtil::copy_to_kv(kv, 0, key, key_size, value, value_size, ttl_seconds);
+
+    bool stored = true;
+    try {
+        IpcExclusiveLock lock(header_->global_mutex);
+
+        Path path;
+        SortedNode* leaf = descend(key, key_size, path);
+        uint32_t index;
+        search(leaf, 0, key, key_size, false, true, index);
+
+        ShmKeyValue* existing = index < leaf->count ? record_at(leaf->keys[index]) : nullptr;
+        if (existing && key_equals(existing, key, key_size)) {
+            if (only_if_absent && existing->entry.is_alive()) {
+                stored = false;
+            } else {
+                {
+                    WriteSet writes;
+                    writes.lock(leaf);
+                    leaf->keys[index] = offset_of(kv);
+                }
+                retire_kv(existing);
+            }
+        } else {
+            insert_new(path, index, kv);
+            header_->size.fetch_add(1, std::memory_order_acq_rel);
+            stats_.size.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (stored) {
+            track_expiry(kv);
+            header_->modified_at = current_timestamp_ns();
+        }
+    } catch (...) {
+        file_manager_->deallocate(kv);
+        throw;
+    }
+
+    if (!stored) {
+        file_manager_->deallocate(kv);
+        return false;
+    }
+    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void FastSortedMap::insert_new(Path& path, uint32_t index, ShmKeyValue* kv) {
+    const uint32_t depth = path.depth;
+    SortedNode* leaf = path.nodes[depth - 1];
+    uint64_t kv_prefix = key_prefix(kv->key_data(), kv->key_size);
+    int64_t kv_offset = offset_of(kv);
+
+    if (leaf->count < FANOUT) {
+        WriteSet writes;
+        writes.lock(leaf);
+        uint32_t tail = leaf->count - index;
+        std::memmove(&leaf->prefixes[index + 1], &leaf->prefixes[index], tail * sizeof(uint64_t));
+        std::memmove(&leaf->keys[index + 1], &leaf->keys[index], tail * sizeof(int64_t));
+        leaf->prefixes[index] = kv_prefix;
+        leaf->keys[index] = kv_offset;
+        leaf->count++;
+        return;
+    }
+
+    // Every full node from the leaf up splits; if the root does, the tree grows
+    uint32_t splits = 0;
+    while (splits < depth && path.nodes[depth - 1 - splits]->count == FANOUT) splits++;
+    bool grow = splits == depth;
+    if (grow && depth == MAX_HEIGHT) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::COLLECTION_FULL,
+            "Sorted map reached its maximum height"
+        );
+    }
+
+    // The full leaf plus the new entry, in order
+    constexpr uint32_t TOTAL = FANOUT + 1;
+    uint64_t prefixes[TOTAL];
+    int64_t keys[TOTAL];
+    std::copy(leaf->prefixes, leaf->prefixes + index, prefixes);
+    std::copy(leaf->keys, leaf->keys + index, keys);
+    prefixes[index] = kv_prefix;
+    keys[index] = kv_offset;
+    std::copy(leaf->prefixes + index, leaf->prefixes + FANOUT, prefixes + index + 1);
+    std::copy(leaf->keys + index, leaf->keys + FANOUT, keys + index + 1);
+
+    // Appending past the last leaf leaves it full: keys that arrive in
+    // order would otherwise leave every leaf half empty
+    uint32_t keep = (index == FANOUT && leaf->next_offset < 0) ? FANOUT : (TOTAL + 1) / 2;
+
+    // Allocate everything before the first change, so a full file leaves
+    // the tree as it was
+    ShmKeyValue* separator = make_separator(record_at(keys[keep - 1]), record_at(keys[keep]));
+    try {
+        reserve_nodes(splits + (grow ? 1 : 0));
+    } catch (...) {
+        file_manager_->deallocate(separator);
+        throw;
+    }
+
+    WriteSet writes;
+    writes.lock(leaf);
+    SortedNode* right = take_node(writes, 0);
+
+    leaf->count = keep;
+    std::copy(prefixes, prefixes + keep, leaf->prefixes);
+    std::copy(keys, keys + keep, leaf->keys);
+    right->count = TOTAL - keep;
+    std::copy(prefixes + keep, prefixes + TOTAL, right->prefixes);
+    std::copy(keys + keep, keys + TOTAL, right->keys);
+
+    right->prev_offset = offset_of(leaf);
+    right->next_offset = leaf->next_offset;
+    if (leaf->next_offset >= 0) {
+        SortedNode* next = node_at(leaf->next_offset);
+        writes.lock(next);
+        next->prev_offset = offset_of(right);
+    }
+    leaf->next_offset = offset_of(right);
+
+    // Hand a separator and the new right node up until a parent has room
+    uint64_t up_prefix = key_prefix(separator->key_data(), separator->key_size);
+    int64_t up_key = offset_of(separator);
+    int64_t up_child = offset_of(right);
+
+    for (int32_t level = static_cast<int32_t>(depth) - 2; level >= 0; level--) {
+        SortedNode* node = path.nodes[level];
+        uint32_t at = path.indices[level];
+        writes.lock(node);
+
+        if (node->count < FANOUT) {
+            uint32_t tail = node->count - at;
+            std::memmove(&node->prefixes[at + 1], &node->prefixes[at], tail * sizeof(uint64_t));
+            std::memmove(&node->keys[at + 1], &node->keys[at], tail * sizeof(int64_t));
+            std::memmove(&node->children[at + 2], &node->children[at + 1], tail * sizeof(int64_t));
+            node->prefixes[at] = up_prefix;
+            node->keys[at] = up_key;
+            node->children[at + 1] = up_child;
+            node->count++;
+            return;
+        }
+
+        // Split the inner node; its middle separator moves up
+        int64_t children[TOTAL + 1];
+        std::copy(node->prefixes, node->prefixes + at, prefixes);
+        std::copy(node->keys, node->keys + at, keys);
+        prefixes[at] = up_prefix;
+        keys[at] = up_key;
+        std::copy(node->prefixes + at, node->prefixes + FANOUT, prefixes + at + 1);
+        std::copy(node->keys + at, node->keys + FANOUT, keys + at + 1);
+        std::copy(node->children, node->children + at + 1, children);
+        children[at + 1] = up_child;
+        std::copy(node->children + at + 1, node->children + FANOUT + 1, children + at + 2);
+
+        constexpr uint32_t MID = TOTAL / 2;
+        SortedNode* sibling = take_node(writes, node->level);
+
+        node->count = MID;
+        std::copy(prefixes, prefixes + MID, node->prefixes);
+        std::copy(keys, keys + MID, node->keys);
+        std::copy(children, children + MID + 1, node->children);
+        sibling->count = TOTAL - MID - 1;
+        std::copy(prefixes + MID + 1, prefixes + TOTAL, sibling->prefixes);
+        std::copy(keys + MID + 1, keys + TOTAL, sibling->keys);
+        std::copy(children + MID + 1, children + TOTAL + 1, sibling->children);
+
+        up_prefix = prefixes[MID];
+        up_key = keys[MID];
+        up_child = offset_of(sibling);
+    }
+
+    // The root split: a new root above it and its new sibling
+    SortedNode* old_root = path.nodes[0];
+    SortedNode* root = take_node(writes, old_root->level + 1);
+    root->count = 1;
+    root->prefixes[0] = up_prefix;
+    root->keys[0] = up_key;
+    root->children[0] = offset_of(old_root);
+    root->children[1] = up_child;
+    header_->root_offset.store(offset_of(root), std::memory_order_release);
+    header_->height.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void FastSortedMap::erase_at(SortedNode* leaf, uint32_t index) {
+    ShmKeyValue* kv = record_at(leaf->keys[index]);
+    {
+        WriteSet writes;
+        writes.lock(leaf);
+        uint32_t tail = leaf->count - index - 1;
+        std::memmove(&leaf->prefixes[index], &leaf->prefixes[index + 1], tail * sizeof(uint64_t));
+        std::memmove(&leaf->keys[index], &leaf->keys[index + 1], tail * sizeof(int64_t));
+        leaf->count--;
+    }
+    retire_kv(kv);
+
+    header_->size.fetch_sub(1, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FastSortedMap::erase_record(ShmKeyValue* kv) {
+    Path path;
+    SortedNode* leaf = descend(kv->key_data(), kv->key_size, path);
+    uint32_t index;
+    search(leaf, 0, kv->key_data(), kv->key_size, false, true, index);
+    if (index < leaf->count && leaf->keys[index] == offset_of(kv)) {
+        erase_at(leaf, index);
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool FastSortedMap::put(const uint8_t* key, size_t key_size,
+                        const uint8_t* value, size_t value_size,
+                        int32_t ttl_seconds) {
+    return insert(key, key_size, value, value_size, ttl_seconds, false);
+}
+
+bool FastSortedMap::putIfAbsent(const uint8_t* key, size_t key_size,
+                                const uint8_t* value, size_t value_size,
+                                int32_t ttl_seconds) {
+    return insert(key, key_size, value, value_size, ttl_seconds, true);
+}
+
+bool FastSortedMap::get(const uint8_t* key, size_t key_size,
+                        std::vector<uint8_t>& out_value) const {
+    return read_entry(key, key_size, [&](const ShmKeyValue* kv) {
+        out_value.assign(kv->value_data(), kv->value_data() + kv->value_size);
+    });
+}
+
+bool FastSortedMap::getWith(const uint8_t* key, size_t key_size,
+                            const std::function<void(const uint8_t* value, size_t value_size)>& fn) const {
+    return read_entry(key, key_size, [&](const ShmKeyValue* kv) {
+        fn(kv->value_data(), kv->value_size);
+    });
+}
+
+int64_t FastSortedMap::getTTL(const uint8_t* key, size_t key_size) const {
+    int64_t ttl = 0;
+    read_entry(key, key_size, [&](const ShmKeyValue* kv) {
+        ttl = kv->entry.remaining_ttl_seconds();
+    });
+    return ttl;
+}
+
+bool FastSortedMap::containsKey(const uint8_t* key, size_t key_size) const {
+    return read_entry(key, key_size, [](const ShmKeyValue*) {});
+}
+
+bool FastSortedMap::remove(const uint8_t* key, size_t key_size,
+                           std::vector<uint8_t>* out_value) {
+    if (!key || key_size == 0) return false;
+
+    IpcExclusiveLock lock(header_->global_mutex);
+
+    Path path;
+    SortedNode* leaf = descend(key, key_size, path);
+    uint32_t index;
+    search(leaf, 0, key, key_size, false, true, index);
+    if (index >= leaf->count || !key_equals(record_at(leaf->keys[index]), key, key_size)) {
+        return false;
+    }
+
+    // An expired entry is removed all the same, but reported as absent
+    const ShmKeyValue* kv = record_at(leaf->keys[index]);
+    bool alive = kv->entry.is_alive();
+    if (alive && out_value) {
+        out_value->assign(kv->value_data(), kv->value_data() + kv->value_size);
+    }
+
+    erase_at(leaf, index);
+    header_->modified_at = current_timestamp_ns();
+    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+    return alive;
+}
+
+bool FastSortedMap::setTTL(const uint8_t* key, size_t key_size, int32_t ttl_seconds) {
+    if (!key || key_size == 0) return false;
+
+    IpcExclusiveLock lock(header_->global_mutex);
+
+    Path path;
+    SortedNode* leaf = descend(key, key_size, path);
+    uint32_t index;
+    search(leaf, 0, key, key_size, false, true, index);
+    if (index >= leaf->count) return false;
+
+    ShmKeyValue* existing = record_at(leaf->keys[index]);
+    if (!key_equals(existing, key, key_size) || !existing->entry.is_alive()) return false;
+
+    // Copy-on-write like any update, so readers never see the TTL change mid-read
+    ShmKeyValue* kv = allocate_kv(existing->key_size, existing->value_size);
+    SerializationUtil::copy_to_kv(kv, 0, existing->key_data(), existing->key_size,
+                                  existing->value_data(), existing->value_size, ttl_seconds);
+    {
+        WriteSet writes;
+        writes.lock(leaf);
+        leaf->keys[index] = offset_of(kv);
+    }
+    retire_kv(existing);
+    track_expiry(kv);
+
+    header_->modified_at = current_timestamp_ns();
+    return true;
+}
+
+size_t FastSortedMap::removeExpired() {
+    return reapExpired(SIZE_MAX);
+}
+
+size_t FastSortedMap::reapExpired(size_t max_items) {
+    IpcExclusiveLock lock(header_->global_mutex);
+    header_->begin_expiry_sweep();
+
+    size_t removed = 0;
+
+    if (!expiry_.needs_rebuild()) {
+        uint64_t now = current_timestamp_ns();
+        while (removed < max_items) {
+            ShmEntry* entry = expiry_.pop_due(now);
+            if (!entry) break;
+
+            // The entry is the first member of its record
+            erase_record(reinterpret_cast<ShmKeyValue*>(entry));
+            removed++;
+        }
+        header_->note_expiry(expiry_.next_expiry());
+    } else {
+        // Full sweep along the leaves, indexing every survivor
+        uint64_t next_expiry = CollectionHeader::NO_EXPIRY;
+        expiry_.reset();
+
+        SortedNode* leaf = node_at(header_->root_offset.load(std::memory_order_relaxed));
+        while (leaf->level > 0) leaf = node_at(leaf->children[0]);
+
+        for (;;) {
+            uint32_t index = 0;
+            while (index < leaf->count) {
+                ShmKeyValue* kv = record_at(leaf->keys[index]);
+                if (kv->entry.is_expired()) {
+                    erase_at(leaf, index);
+                    removed++;
+                    continue;
+                }
+                if (kv->entry.expires_at != 0) {
+                    next_expiry = std::min(next_expiry, kv->entry.expires_at);
+                    expiry_.track(&kv->entry);
+                }
+                index++;
+            }
+            if (leaf->next_offset < 0) break;
+            leaf = node_at(leaf->next_offset);
+        }
+        expiry_.mark_complete();
+        header_->note_expiry(next_expiry);
+    }
+
+    if (removed > 0) {
+        header_->modified_at = current_timestamp_ns();
+    }
+
+    return removed;
+}
+
+bool FastSortedMap::first(std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const {
+    return first_entry(nullptr, 0, false, out_key, out_value);
+}
+
+bool FastSortedMap::last(std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const {
+    return first_entry(nullptr, 0, true, out_key, out_value);
+}
+
+bool FastSortedMap::floor(const uint8_t* key, size_t key_size,
+                          std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const {
+    if (!key || key_size == 0) return false;
+    return first_entry(key, key_size, true, out_key, out_value);
+}
+
+bool FastSortedMap::ceiling(const uint8_t* key, size_t key_size,
+                            std::vector<uint8_t>& out_key, std::vector<uint8_t>& out_value) const {
+    if (!key || key_size == 0) return false;
+    return first_entry(key, key_size, false, out_key, out_value);
+}
+
+void FastSortedMap::range(const uint8_t* from, size_t from_size,
+                          const uint8_t* to, size_t to_size,
+                          const EntryCallback& callback, bool reverse) const {
+    if (from_size == 0) from = nullptr;
+    if (to_size == 0) to = nullptr;
+
+    // Start at one bound and stop on passing the other
+    const uint8_t* start = reverse ? to : from;
+    size_t start_size = reverse ? to_size : from_size;
+
+    scan(start, start_size, !reverse, reverse, [&](const ShmKeyValue* kv) {
+        if (reverse) {
+            if (from && compare_keys(kv->key_data(), kv->key_size, from, from_size) < 0) return false;
+        } else {
+            if (to && compare_keys(kv->key_data(), kv->key_size, to, to_size) >= 0) return false;
+        }
+        return callback(kv->key_data(), kv->key_size, kv->value_data(), kv->value_size);
+    });
+}
+
+void FastSortedMap::prefix(const uint8_t* prefix, size_t prefix_size,
+                           const EntryCallback& callback, bool reverse) const {
+    std::vector<uint8_t> end = prefix_size > 0 ? prefix_successor(prefix, prefix_size)
+                                               : std::vector<uint8_t>();
+    range(prefix, prefix_size, end.data(), end.size(), callback, reverse);
+}
+
+void FastSortedMap::forEach(const EntryCallback& callback, bool reverse) const {
+    range(nullptr, 0, nullptr, 0, callback, reverse);
+}
+
+void FastSortedMap::startReaper(const ReaperConfig& config) {
+    reaper_.reset();
+    reaper_ = std::make_unique<TtlReaper>(
+        file_manager_->find_or_construct<ReaperLease>("sorted_reaper"),
+        [this](size_t max_items) { return reapExpired(max_items); },
+        config);
+}
+
+void FastSortedMap::stopReaper() {
+    reaper_.reset();
+}
+
+void FastSortedMap::clear() {
+    IpcExclusiveLock lock(header_->global_mutex);
+    expiry_.reset();
+
+    // Retire every record and recycle every node, one level at a time
+    std::vector<int64_t> level{header_->root_offset.load(std::memory_order_relaxed)};
+    while (!level.empty()) {
+        std::vector<int64_t> below;
+        for (int64_t offset : level) {
+            SortedNode* node = node_at(offset);
+            for (uint32_t i = 0; i < node->count; i++) {
+                retire_kv(record_at(node->keys[i]));
+            }
+            if (node->level > 0) {
+                below.insert(below.end(), node->children, node->children + node->count + 1);
+            }
+
+            WriteSet writes;
+            writes.lock(node);
+            node->count = 0;
+            node->next_offset = header_->spare_offset;
+            header_->spare_offset = offset;
+            header_->spare_count++;
+        }
+        level.swap(below);
+    }
+
+    WriteSet writes;
+    SortedNode* root = take_node(writes, 0);
+    header_->height.store(1, std::memory_order_release);
+    header_->root_offset.store(offset_of(root), std::memory_order_release);
+    header_->size.store(0, std::memory_order_release);
+    header_->modified_at = current_timestamp_ns();
+
+    stats_.size.store(0, std::memory_order_relaxed);
+}
+
+size_t FastSortedMap::size() const {
+    size_t size = header_->size.load(std::memory_order_acquire);
+    if (!header_->may_have_expired()) return size;
+
+    // Leave the reaping to removeExpired(); just discount what is due
+    size_t due = static_cast<size_t>(expiry_.count_due(current_timestamp_ns()));
+    return size - std::min(due, size);
+}
+
+size_t FastSortedMap::exactSize() const {
+    size_t count = 0;
+    scan(nullptr, 0, true, false, [&](const ShmKeyValue*) {
+        count++;
+        return true;
+    });
+    return count;
+}
+
+bool FastSortedMap::isEmpty() const {
+    return size() == 0;
+}
+
+void FastSortedMap::flush() {
+    file_manager_->flush();
+}
+
+} // namespace fastcollection
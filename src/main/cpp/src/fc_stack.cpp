@@ -10,10 +10,43 @@
 
 #include "fc_stack.h"
 #include <cstring>
+#include <functional>
+#include <thread>
 
 namespace fastcollection {
 
 using IpcScopedLock = bip::scoped_lock<IpcSharedMutex>;
+using IpcSharableLock = bip::sharable_lock<IpcSharedMutex>;
+
+namespace {
+
+// Pauses a push waits in an elimination slot for a pop
+constexpr int ELIMINATION_SPINS = 64;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Per-thread elimination state: slots in use and a random source
+struct EliminationState {
+    uint32_t width = 1;
+    uint32_t seed = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1;
+    
+    uint32_t pick() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed % width;
+    }
+};
+
+thread_local EliminationState elimination_state;
+
+} // anonymous namespace
 
 FastStack::FastStack(const std::string& mmap_file,
                      size_t initial_size,
@@ -21,6 +54,7 @@ FastStack::FastStack(const std::string& mmap_file,
     : file_manager_(std::make_unique<MMapFileManager>(mmap_file, initial_size, create_new)) {
     
     auto result = file_manager_->find<DequeHeader>("stack_header");
+    bool existing = result.first != nullptr;
     
     if (result.first) {
         header_ = result.first;
@@ -30,16 +64,20 @@ FastStack::FastStack(const std::string& mmap_file,
                 "Invalid stack header in file"
             );
         }
+        // Nodes now come from the slab heap, which older builds would corrupt
+        header_->mark_current();
     } else {
         header_ = file_manager_->find_or_construct<DequeHeader>("stack_header");;
     }
-    
-    // Find or create ABA counter
-    auto aba_result = file_manager_->find<std::atomic<uint64_t>>("stack_aba_tag");
-    if (aba_result.first) {
-        aba_tag_ = aba_result.first;
-    } else {
-        aba_tag_ = file_manager_->find_or_construct<std::atomic<uint64_t>>("stack_aba_tag", 0);
+    hasher_ = Hasher::open(file_manager_.get(), "stack_hash", existing);
+    
+    // The tag lives in the top word itself now; files written before keep
+    // their unused "stack_aba_tag" counter
+    elimination_ = file_manager_->find_or_construct<EliminationArray>("stack_elimination");
+    detach_seq_ = file_manager_->find_or_construct<std::atomic<uint64_t>>("stack_detach_seq", 0);
+    if (detach_seq_->load(std::memory_order_relaxed) & 1) {
+        // A process died with the chain lifted off; nothing can be recovered
+        detach_seq_->fetch_add(1, std::memory_order_relaxed);
     }
     
     stats_.size.store(header_->size.load(), std::memory_order_relaxed);
@@ -54,18 +92,24 @@ FastStack::~FastStack() {
 FastStack::FastStack(FastStack&& other) noexcept
     : file_manager_(std::move(other.file_manager_))
     , header_(other.header_)
-    , aba_tag_(other.aba_tag_) {
+    , hasher_(other.hasher_)
+    , elimination_(other.elimination_)
+    , detach_seq_(other.detach_seq_) {
     other.header_ = nullptr;
-    other.aba_tag_ = nullptr;
+    other.elimination_ = nullptr;
+    other.detach_seq_ = nullptr;
 }
 
 FastStack& FastStack::operator=(FastStack&& other) noexcept {
     if (this != &other) {
         file_manager_ = std::move(other.file_manager_);
         header_ = other.header_;
-        aba_tag_ = other.aba_tag_;
+        hasher_ = other.hasher_;
+        elimination_ = other.elimination_;
+        detach_seq_ = other.detach_seq_;
         other.header_ = nullptr;
-        other.aba_tag_ = nullptr;
+        other.elimination_ = nullptr;
+        other.detach_seq_ = nullptr;
     }
     return *this;
 }
@@ -77,6 +121,11 @@ ShmNode* FastStack::node_at_offset(int64_t offset) const {
     return reinterpret_cast<ShmNode*>(static_cast<uint8_t*>(base) + offset);
 }
 
+int64_t FastStack::offset_of(const ShmNode* node) const {
+    return reinterpret_cast<const uint8_t*>(node) - 
+           reinterpret_cast<const uint8_t*>(file_manager_->segment_manager());
+}
+
 ShmNode* FastStack::allocate_node(size_t data_size) {
     size_t total = ShmNode::total_size(data_size);
     void* mem = file_manager_->allocate(total);
@@ -86,7 +135,15 @@ ShmNode* FastStack::allocate_node(size_t data_size) {
             "Failed to allocate node"
         );
     }
-    return new(mem) ShmNode();
+    ShmNode* node = new(mem) ShmNode();
+    if (static_cast<uint64_t>(offset_of(node)) >= TaggedPointer::OFFSET_MASK) {
+        file_manager_->deallocate(node);
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::MEMORY_ALLOCATION_FAILED,
+            "Stack node beyond the 1 TiB a tagged top pointer can address"
+        );
+    }
+    return node;
 }
 
 void FastStack::free_node(ShmNode* node, size_t data_size) {
@@ -95,144 +152,309 @@ void FastStack::free_node(ShmNode* node, size_t data_size) {
     }
 }
 
-bool FastStack::push(const uint8_t* data, size_t size, int32_t ttl_seconds) {
-    if (!data || size == 0) return false;
-    
-    void* base = file_manager_->segment_manager();
-    
-    ShmNode* node = allocate_node(size);
-    SerializationUtil::copy_to_node(node, data, size, ttl_seconds);
-    
-    int64_t node_offset = static_cast<uint8_t*>(static_cast<void*>(node)) - 
-                          static_cast<uint8_t*>(base);
+int64_t FastStack::top_offset() const {
+    return TaggedPointer::offset(header_->front_offset.load(std::memory_order_acquire));
+}
+
+void FastStack::touch() {
+    std::atomic_ref<uint64_t>(header_->modified_at).store(current_timestamp_ns(),
+                                                          std::memory_order_relaxed);
+}
+
+bool FastStack::try_push(ShmNode* node, int64_t node_offset) {
+    int64_t top = header_->front_offset.load(std::memory_order_acquire);
+    node->next_offset.store(TaggedPointer::offset(top), std::memory_order_relaxed);
     
-    // CAS loop for lock-free push
+    return header_->front_offset.compare_exchange_strong(
+        top, TaggedPointer::next(top, node_offset),
+        std::memory_order_acq_rel,
+        std::memory_order_relaxed);
+}
+
+int64_t FastStack::first_alive(int64_t& top) const {
+    // A node can only be freed after it was the top or was lifted off with
+    // the whole chain, both of which change the top word; so while the word
+    // is unchanged, every node read since loading it was still allocated
     while (true) {
-        int64_t old_top = header_->front_offset.load(std::memory_order_acquire);
-        node->next_offset.store(old_top, std::memory_order_release);
-        node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
+        top = header_->front_offset.load(std::memory_order_acquire);
+        int64_t offset = TaggedPointer::offset(top);
+        bool raced = false;
         
-        if (header_->front_offset.compare_exchange_weak(
-                old_top, node_offset,
-                std::memory_order_acq_rel,
-                std::memory_order_relaxed)) {
+        while (offset >= 0) {
+            ShmNode* node = node_at_offset(offset);
+            bool alive = node->entry.is_alive();
+            int64_t next = node->next_offset.load(std::memory_order_acquire);
             
-            // Update previous top's prev pointer (for iteration)
-            if (old_top >= 0) {
-                ShmNode* old_top_node = node_at_offset(old_top);
-                old_top_node->prev_offset.store(node_offset, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->front_offset.load(std::memory_order_relaxed) != top) {
+                raced = true;
+                break;
             }
-            
-            // Increment ABA tag
-            aba_tag_->fetch_add(1, std::memory_order_relaxed);
-            header_->size.fetch_add(1, std::memory_order_acq_rel);
-            header_->modified_at = current_timestamp_ns();
-            
-            stats_.size.fetch_add(1, std::memory_order_relaxed);
-            stats_.write_count.fetch_add(1, std::memory_order_relaxed);
-            
-            return true;
+            if (alive) break;
+            offset = next;
         }
-        // CAS failed, retry
+        if (!raced) return offset;
     }
 }
 
-bool FastStack::pop(std::vector<uint8_t>& out_data) {
+bool FastStack::consume_node(ShmNode* node, std::vector<uint8_t>* out_data) {
+    bool alive = node->entry.is_alive();
+    if (alive && out_data) {
+        *out_data = SerializationUtil::copy_from_node(node);
+    }
+    
+    size_t data_size = node->entry.data_size;
+    node->entry.mark_deleted();
+    free_node(node, data_size);
+    
+    header_->size.fetch_sub(1, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(1, std::memory_order_relaxed);
+    if (alive) {
+        touch();
+        stats_.read_count.fetch_add(1, std::memory_order_relaxed);
+        stats_.hit_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return alive;
+}
+
+EliminationSlot& FastStack::elimination_slot() const {
+    return elimination_->slots[elimination_state.pick()];
+}
+
+bool FastStack::eliminate_push(int64_t node_offset) {
+    EliminationSlot& slot = elimination_slot();
+    EliminationState& state = elimination_state;
+    
+    int64_t word = slot.word.load(std::memory_order_acquire);
+    int64_t offered = TaggedPointer::next(word, node_offset);
+    if (TaggedPointer::offset(word) >= 0 ||
+        !slot.word.compare_exchange_strong(word, offered, std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+        // Another push is parked here: spread out
+        state.width = std::min(state.width * 2, EliminationArray::SLOTS);
+        return false;
+    }
+    
+    for (int i = 0; i < ELIMINATION_SPINS; i++) {
+        cpu_relax();
+        if (slot.word.load(std::memory_order_acquire) != offered) return true;
+    }
+    
+    // Nobody came: withdraw, unless a pop takes the node first. The tag
+    // tells our offer apart from a later one of the same offset
+    if (slot.word.compare_exchange_strong(offered, TaggedPointer::next(offered, ShmNode::NULL_OFFSET),
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+        state.width = std::max(state.width / 2, 1u);
+        return false;
+    }
+    return true;
+}
+
+int64_t FastStack::eliminate_pop() {
+    EliminationSlot& slot = elimination_slot();
+    
+    int64_t word = slot.word.load(std::memory_order_acquire);
+    int64_t offset = TaggedPointer::offset(word);
+    if (offset < 0) return ShmNode::NULL_OFFSET;
+    
+    if (!slot.word.compare_exchange_strong(word, TaggedPointer::next(word, ShmNode::NULL_OFFSET),
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+        return ShmNode::NULL_OFFSET;
+    }
+    return offset;
+}
+
+int64_t FastStack::detach_top(size_t max_count, int64_t& end) {
     while (true) {
         int64_t top = header_->front_offset.load(std::memory_order_acquire);
+        int64_t first = TaggedPointer::offset(top);
+        end = ShmNode::NULL_OFFSET;
         
-        if (top < 0) {
-            stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
-            return false;
+        // Every node on the stack was counted before it was published, so
+        // when max_count covers the size the whole chain goes without a walk
+        if (max_count < header_->size.load(std::memory_order_acquire)) {
+            // Walk the run like first_alive(): while the top word holds, the
+            // nodes read are still on the stack and their links current
+            end = first;
+            bool raced = false;
+            for (size_t taken = 0; end >= 0 && taken < max_count; taken++) {
+                int64_t next = node_at_offset(end)->next_offset.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (header_->front_offset.load(std::memory_order_relaxed) != top) {
+                    raced = true;
+                    break;
+                }
+                end = next;
+            }
+            if (raced) continue;
         }
         
-        ShmNode* node = node_at_offset(top);
-        if (!node) {
-            stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
-            return false;
+        if (first < 0) return ShmNode::NULL_OFFSET;
+        if (header_->front_offset.compare_exchange_strong(
+                top, TaggedPointer::next(top, end),
+                std::memory_order_acq_rel,
+                std::memory_order_relaxed)) {
+            return first;
         }
+    }
+}
+
+int64_t FastStack::detach_all() {
+    // Odd until release_chain(): pops and peeks that find the stack empty
+    // meanwhile wait instead of reporting it
+    detach_seq_->fetch_add(1, std::memory_order_acq_rel);
+    
+    int64_t top = header_->front_offset.load(std::memory_order_acquire);
+    while (!header_->front_offset.compare_exchange_weak(
+               top, TaggedPointer::next(top, ShmNode::NULL_OFFSET),
+               std::memory_order_acq_rel,
+               std::memory_order_acquire)) {
+    }
+    return TaggedPointer::offset(top);
+}
+
+void FastStack::reattach(int64_t first, ShmNode* last) {
+    while (true) {
+        int64_t top = header_->front_offset.load(std::memory_order_acquire);
+        int64_t pushed = TaggedPointer::offset(top);
         
-        // Skip expired nodes
-        if (node->entry.is_expired()) {
-            // Try to remove expired node
-            int64_t next = node->next_offset.load(std::memory_order_acquire);
-            
-            if (header_->front_offset.compare_exchange_weak(
-                    top, next,
+        if (pushed < 0) {
+            last->next_offset.store(ShmNode::NULL_OFFSET, std::memory_order_relaxed);
+            if (header_->front_offset.compare_exchange_strong(
+                    top, TaggedPointer::next(top, first),
                     std::memory_order_acq_rel,
                     std::memory_order_relaxed)) {
-                
-                // Successfully removed expired node
-                if (next >= 0) {
-                    ShmNode* next_node = node_at_offset(next);
-                    next_node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-                }
-                
-                size_t data_size = node->entry.data_size;
-                node->entry.mark_deleted();
-                free_node(node, data_size);
-                
-                aba_tag_->fetch_add(1, std::memory_order_relaxed);
-                header_->size.fetch_sub(1, std::memory_order_acq_rel);
-                stats_.size.fetch_sub(1, std::memory_order_relaxed);
+                return;
             }
-            // Retry from the beginning
             continue;
         }
         
-        // Found valid non-expired node
-        int64_t next = node->next_offset.load(std::memory_order_acquire);
-        
-        // Copy data before CAS (in case another thread pops it)
-        std::vector<uint8_t> temp_data = SerializationUtil::copy_from_node(node);
-        
-        if (header_->front_offset.compare_exchange_weak(
-                top, next,
+        // Nodes pushed meanwhile are newer: lift them off too and put the
+        // chain under them
+        if (!header_->front_offset.compare_exchange_strong(
+                top, TaggedPointer::next(top, ShmNode::NULL_OFFSET),
                 std::memory_order_acq_rel,
                 std::memory_order_relaxed)) {
-            
-            // Successfully popped
-            if (next >= 0) {
-                ShmNode* next_node = node_at_offset(next);
-                next_node->prev_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-            }
-            
-            out_data = std::move(temp_data);
-            
-            size_t data_size = node->entry.data_size;
-            node->entry.mark_deleted();
-            free_node(node, data_size);
-            
-            aba_tag_->fetch_add(1, std::memory_order_relaxed);
-            header_->size.fetch_sub(1, std::memory_order_acq_rel);
-            header_->modified_at = current_timestamp_ns();
-            
-            stats_.size.fetch_sub(1, std::memory_order_relaxed);
-            stats_.read_count.fetch_add(1, std::memory_order_relaxed);
-            stats_.hit_count.fetch_add(1, std::memory_order_relaxed);
-            
-            return true;
+            continue;
         }
-        // CAS failed, retry
+        ShmNode* bottom = node_at_offset(pushed);
+        int64_t next;
+        while ((next = bottom->next_offset.load(std::memory_order_relaxed)) >= 0) {
+            bottom = node_at_offset(next);
+        }
+        bottom->next_offset.store(first, std::memory_order_relaxed);
+        first = pushed;
     }
 }
 
-bool FastStack::peek(std::vector<uint8_t>& out_data) const {
+void FastStack::release_chain(int64_t first, ShmNode* last) {
+    if (last) {
+        reattach(first, last);
+    }
+    detach_seq_->fetch_add(1, std::memory_order_release);
+}
+
+bool FastStack::chain_was_away(uint64_t seq) const {
+    if ((seq & 1) == 0 && detach_seq_->load(std::memory_order_acquire) == seq) return false;
+    
+    while (detach_seq_->load(std::memory_order_acquire) & 1) {
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void FastStack::splice_on_top(int64_t first, ShmNode* last) {
     int64_t top = header_->front_offset.load(std::memory_order_acquire);
+    do {
+        last->next_offset.store(TaggedPointer::offset(top), std::memory_order_relaxed);
+    } while (!header_->front_offset.compare_exchange_weak(
+                 top, TaggedPointer::next(top, first),
+                 std::memory_order_acq_rel,
+                 std::memory_order_acquire));
+}
+
+bool FastStack::push(const uint8_t* data, size_t size, int32_t ttl_seconds) {
+    if (!data || size == 0) return false;
     
-    while (top >= 0) {
-        ShmNode* node = node_at_offset(top);
-        if (!node) break;
+    ShmNode* node = allocate_node(size);
+    SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl_seconds);
+    int64_t node_offset = offset_of(node);
+    
+    // Counted before it is visible, so a pop never counts it out first
+    header_->size.fetch_add(1, std::memory_order_acq_rel);
+    stats_.size.fetch_add(1, std::memory_order_relaxed);
+    
+    // CAS loop for lock-free push, backing off into the elimination array
+    while (!try_push(node, node_offset) && !eliminate_push(node_offset)) {
+    }
+    
+    touch();
+    stats_.write_count.fetch_add(1, std::memory_order_relaxed);
+    
+    return true;
+}
+
+bool FastStack::pop(std::vector<uint8_t>& out_data) {
+    while (true) {
+        uint64_t seq = detach_seq_->load(std::memory_order_acquire);
+        int64_t top = header_->front_offset.load(std::memory_order_acquire);
+        int64_t offset = TaggedPointer::offset(top);
         
-        if (node->entry.is_alive()) {
-            out_data = SerializationUtil::copy_from_node(node);
-            const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
-            const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
+        if (offset < 0) {
+            // Empty only for now if a locked operation holds the chain
+            if (chain_was_away(seq)) continue;
+            stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        // If another pop frees this node first, next is garbage, but the
+        // top's tag has moved on and the CAS fails
+        ShmNode* node = node_at_offset(offset);
+        int64_t next = node->next_offset.load(std::memory_order_acquire);
+        
+        if (header_->front_offset.compare_exchange_strong(
+                top, TaggedPointer::next(top, next),
+                std::memory_order_acq_rel,
+                std::memory_order_relaxed)) {
+            // The node is ours; an expired one is dropped and we go on
+            if (consume_node(node, &out_data)) return true;
+            continue;
+        }
+        
+        // CAS failed: meet a concurrent push instead of retrying at once
+        int64_t handed = eliminate_pop();
+        if (handed >= 0 && consume_node(node_at_offset(handed), &out_data)) {
             return true;
         }
+    }
+}
+
+bool FastStack::peek(std::vector<uint8_t>& out_data) const {
+    while (true) {
+        uint64_t seq = detach_seq_->load(std::memory_order_acquire);
+        int64_t top;
+        int64_t offset = first_alive(top);
+        if (offset < 0) {
+            if (chain_was_away(seq)) continue;
+            break;
+        }
         
-        // Skip expired
-        top = node->next_offset.load(std::memory_order_acquire);
+        // Validated copy: read the size, check the node was still ours to
+        // read, copy, and check again
+        ShmNode* node = node_at_offset(offset);
+        uint32_t size = node->entry.data_size;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->front_offset.load(std::memory_order_relaxed) != top) continue;
+        
+        out_data.assign(node->data, node->data + size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->front_offset.load(std::memory_order_relaxed) != top) continue;
+        
+        const_cast<CollectionStats&>(stats_).read_count.fetch_add(1, std::memory_order_relaxed);
+        const_cast<CollectionStats&>(stats_).hit_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
     }
     
     const_cast<CollectionStats&>(stats_).miss_count.fetch_add(1, std::memory_order_relaxed);
@@ -262,91 +484,145 @@ std::vector<uint8_t> FastStack::peekOrThrow() const {
 }
 
 size_t FastStack::pushAll(const std::vector<std::tuple<const uint8_t*, size_t, int32_t>>& elements) {
+    // Link the nodes privately, each above the one before it
+    ShmNode* bottom = nullptr;
+    int64_t first = ShmNode::NULL_OFFSET;
     size_t pushed = 0;
-    for (const auto& [data, size, ttl] : elements) {
-        if (push(data, size, ttl)) {
+    
+    try {
+        for (const auto& [data, size, ttl] : elements) {
+            if (!data || size == 0) continue;
+            
+            ShmNode* node = allocate_node(size);
+            SerializationUtil::copy_to_node(node, hasher_(data, size), data, size, ttl);
+            node->next_offset.store(first, std::memory_order_relaxed);
+            if (!bottom) bottom = node;
+            first = offset_of(node);
             pushed++;
         }
+    } catch (...) {
+        while (first >= 0) {
+            ShmNode* node = node_at_offset(first);
+            first = node->next_offset.load(std::memory_order_relaxed);
+            free_node(node, node->entry.data_size);
+        }
+        throw;
     }
+    if (pushed == 0) return 0;
+    
+    // Counted before it is visible, then published with one CAS
+    header_->size.fetch_add(pushed, std::memory_order_acq_rel);
+    stats_.size.fetch_add(pushed, std::memory_order_relaxed);
+    splice_on_top(first, bottom);
+    
+    touch();
+    stats_.write_count.fetch_add(pushed, std::memory_order_relaxed);
+    
     return pushed;
 }
 
 size_t FastStack::popAll(std::vector<std::vector<uint8_t>>& out_data, size_t max_count) {
     size_t popped = 0;
-    std::vector<uint8_t> item;
     
-    while (popped < max_count && pop(item)) {
-        out_data.push_back(std::move(item));
-        popped++;
+    while (popped < max_count) {
+        uint64_t seq = detach_seq_->load(std::memory_order_acquire);
+        int64_t end;
+        int64_t current = detach_top(max_count - popped, end);
+        if (current < 0) {
+            if (chain_was_away(seq)) continue;
+            break;
+        }
+        
+        // The run is ours: copy out the live nodes, drop the expired ones
+        size_t taken = 0;
+        size_t live = 0;
+        while (current != end) {
+            ShmNode* node = node_at_offset(current);
+            current = node->next_offset.load(std::memory_order_relaxed);
+            
+            if (node->entry.is_alive()) {
+                out_data.push_back(SerializationUtil::copy_from_node(node));
+                live++;
+            }
+            size_t data_size = node->entry.data_size;
+            node->entry.mark_deleted();
+            free_node(node, data_size);
+            taken++;
+        }
+        
+        header_->size.fetch_sub(taken, std::memory_order_acq_rel);
+        stats_.size.fetch_sub(taken, std::memory_order_relaxed);
+        popped += live;
+        if (live > 0) {
+            touch();
+            stats_.read_count.fetch_add(live, std::memory_order_relaxed);
+            stats_.hit_count.fetch_add(live, std::memory_order_relaxed);
+        }
+        
+        // The stack ran out; pushes since are left for the next call
+        if (end < 0) break;
     }
     
+    if (popped == 0) {
+        stats_.miss_count.fetch_add(1, std::memory_order_relaxed);
+    }
     return popped;
 }
 
 int64_t FastStack::peekTTL() const {
-    int64_t top = header_->front_offset.load(std::memory_order_acquire);
-    
-    while (top >= 0) {
-        ShmNode* node = node_at_offset(top);
-        if (!node) break;
-        
-        if (node->entry.is_alive()) {
-            return node->entry.remaining_ttl_seconds();
+    while (true) {
+        uint64_t seq = detach_seq_->load(std::memory_order_acquire);
+        int64_t top;
+        int64_t offset = first_alive(top);
+        if (offset < 0) {
+            if (chain_was_away(seq)) continue;
+            return 0;
         }
         
-        top = node->next_offset.load(std::memory_order_acquire);
+        int64_t ttl = node_at_offset(offset)->entry.remaining_ttl_seconds();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->front_offset.load(std::memory_order_relaxed) == top) return ttl;
     }
-    
-    return 0;
 }
 
 size_t FastStack::removeExpired() {
     // Use locking for bulk removal
     IpcScopedLock lock(header_->global_mutex);
     
+    // Work on the chain privately; pushes meanwhile land above it
+    int64_t current = detach_all();
+    int64_t first = ShmNode::NULL_OFFSET;
+    ShmNode* last = nullptr;
     size_t removed = 0;
-    void* base = file_manager_->segment_manager();
-    
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
-    int64_t prev_offset = ShmNode::NULL_OFFSET;
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
-        if (!node) break;
-        
-        int64_t next = node->next_offset.load(std::memory_order_acquire);
+        int64_t next = node->next_offset.load(std::memory_order_relaxed);
         
         if (node->entry.is_expired()) {
-            // Unlink node
-            if (prev_offset < 0) {
-                header_->front_offset.store(next, std::memory_order_release);
-            } else {
-                ShmNode* prev_node = node_at_offset(prev_offset);
-                prev_node->next_offset.store(next, std::memory_order_release);
-            }
-            
-            if (next >= 0) {
-                ShmNode* next_node = node_at_offset(next);
-                next_node->prev_offset.store(prev_offset, std::memory_order_release);
-            }
-            
             size_t data_size = node->entry.data_size;
             node->entry.mark_deleted();
             free_node(node, data_size);
-            
-            header_->size.fetch_sub(1, std::memory_order_acq_rel);
-            stats_.size.fetch_sub(1, std::memory_order_relaxed);
             removed++;
         } else {
-            prev_offset = current;
+            // Keep it, linked behind the last node kept
+            if (last) {
+                last->next_offset.store(current, std::memory_order_relaxed);
+            } else {
+                first = current;
+            }
+            last = node;
         }
         
         current = next;
     }
     
+    release_chain(first, last);
+    
     if (removed > 0) {
-        aba_tag_->fetch_add(1, std::memory_order_relaxed);
-        header_->modified_at = current_timestamp_ns();
+        header_->size.fetch_sub(removed, std::memory_order_acq_rel);
+        stats_.size.fetch_sub(removed, std::memory_order_relaxed);
+        touch();
     }
     
     return removed;
@@ -355,8 +631,13 @@ size_t FastStack::removeExpired() {
 int64_t FastStack::search(const uint8_t* data, size_t size) const {
     if (!data || size == 0) return -1;
     
-    uint32_t hash = compute_hash(data, size);
-    int64_t top = header_->front_offset.load(std::memory_order_acquire);
+    uint64_t hash = hasher_(data, size);
+    
+    // Full walks share the lock so removeElement() and clear() cannot free
+    // nodes under them; push and pop stay lock-free
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    
+    int64_t top = top_offset();
     int64_t distance = 1;  // 1-based distance
     
     while (top >= 0) {
@@ -364,7 +645,7 @@ int64_t FastStack::search(const uint8_t* data, size_t size) const {
         if (!node) break;
         
         if (node->entry.is_alive()) {
-            if (node->entry.hash_code == hash &&
+            if (hasher_.matches(node->entry, hash) &&
                 node->entry.data_size == size &&
                 std::memcmp(node->data, data, size) == 0) {
                 return distance;
@@ -381,61 +662,69 @@ int64_t FastStack::search(const uint8_t* data, size_t size) const {
 bool FastStack::removeElement(const uint8_t* data, size_t size) {
     if (!data || size == 0) return false;
     
-    uint32_t hash = compute_hash(data, size);
+    uint64_t hash = hasher_(data, size);
     
     // Use locking for removal from middle
     IpcScopedLock lock(header_->global_mutex);
     
-    void* base = file_manager_->segment_manager();
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
-    int64_t prev_offset = ShmNode::NULL_OFFSET;
+    // Work on the chain privately; pushes meanwhile land above it
+    int64_t first = detach_all();
+    if (first < 0) {
+        release_chain(ShmNode::NULL_OFFSET, nullptr);
+        return false;
+    }
+    
+    int64_t current = first;
+    ShmNode* prev = nullptr;
+    ShmNode* last = nullptr;
+    bool removed = false;
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
-        if (!node) break;
+        int64_t next = node->next_offset.load(std::memory_order_relaxed);
         
-        if (node->entry.is_alive() &&
-            node->entry.hash_code == hash &&
+        if (!removed &&
+            node->entry.is_alive() &&
+            hasher_.matches(node->entry, hash) &&
             node->entry.data_size == size &&
             std::memcmp(node->data, data, size) == 0) {
             
-            int64_t next = node->next_offset.load(std::memory_order_acquire);
-            
-            if (prev_offset < 0) {
-                header_->front_offset.store(next, std::memory_order_release);
+            if (prev) {
+                prev->next_offset.store(next, std::memory_order_relaxed);
             } else {
-                ShmNode* prev_node = node_at_offset(prev_offset);
-                prev_node->next_offset.store(next, std::memory_order_release);
-            }
-            
-            if (next >= 0) {
-                ShmNode* next_node = node_at_offset(next);
-                next_node->prev_offset.store(prev_offset, std::memory_order_release);
+                first = next;
             }
             
             size_t data_size = node->entry.data_size;
             node->entry.mark_deleted();
             free_node(node, data_size);
-            
-            aba_tag_->fetch_add(1, std::memory_order_relaxed);
-            header_->size.fetch_sub(1, std::memory_order_acq_rel);
-            header_->modified_at = current_timestamp_ns();
-            stats_.size.fetch_sub(1, std::memory_order_relaxed);
-            
-            return true;
+            removed = true;
+        } else {
+            prev = node;
+            last = node;
         }
         
-        prev_offset = current;
-        current = node->next_offset.load(std::memory_order_acquire);
+        current = next;
     }
     
-    return false;
+    release_chain(first, last);
+    
+    if (removed) {
+        header_->size.fetch_sub(1, std::memory_order_acq_rel);
+        stats_.size.fetch_sub(1, std::memory_order_relaxed);
+        touch();
+    }
+    
+    return removed;
 }
 
 void FastStack::clear() {
     IpcScopedLock lock(header_->global_mutex);
     
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    // Nothing goes back, so pops need not wait for the nodes to be freed
+    int64_t current = detach_all();
+    release_chain(ShmNode::NULL_OFFSET, nullptr);
+    size_t cleared = 0;
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -446,21 +735,22 @@ void FastStack::clear() {
         size_t data_size = node->entry.data_size;
         node->entry.mark_deleted();
         free_node(node, data_size);
+        cleared++;
         
         current = next;
     }
     
-    header_->front_offset.store(ShmNode::NULL_OFFSET, std::memory_order_release);
-    header_->size.store(0, std::memory_order_release);
-    header_->modified_at = current_timestamp_ns();
-    
-    aba_tag_->fetch_add(1, std::memory_order_relaxed);
-    stats_.size.store(0, std::memory_order_relaxed);
+    // Pushes that raced with the clear stay, and stay counted
+    header_->size.fetch_sub(cleared, std::memory_order_acq_rel);
+    stats_.size.fetch_sub(cleared, std::memory_order_relaxed);
+    touch();
 }
 
 size_t FastStack::size() const {
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    
     size_t alive = 0;
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    int64_t current = top_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -477,7 +767,9 @@ bool FastStack::isEmpty() const {
 }
 
 void FastStack::forEach(std::function<bool(const uint8_t* data, size_t size)> callback) const {
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    
+    int64_t current = top_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -495,7 +787,9 @@ void FastStack::forEach(std::function<bool(const uint8_t* data, size_t size)> ca
 
 void FastStack::forEachWithTTL(std::function<bool(const uint8_t* data, size_t size,
                                                    int64_t ttl_remaining)> callback) const {
-    int64_t current = header_->front_offset.load(std::memory_order_acquire);
+    IpcSharableLock lock(const_cast<IpcSharedMutex&>(header_->global_mutex));
+    
+    int64_t current = top_offset();
     
     while (current >= 0) {
         ShmNode* node = node_at_offset(current);
@@ -0,0 +1,255 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_swiss.cpp
+ * @brief Implementation of the Swiss table index used by FastMap
+ */
+
+#include "fc_swiss.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FC_SWISS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define FC_SWISS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace fastcollection {
+
+// Keep the table at most 7/8 occupied (full + deleted)
+static constexpr uint64_t MAX_LOAD_NUM = 7;
+static constexpr uint64_t MAX_LOAD_DEN = 8;
+
+SwissTable::SwissTable(MMapFileManager* file_manager, SwissHeader* header)
+    : file_manager_(file_manager)
+    , header_(header) {
+    if (!header_->is_valid()) {
+        throw FastCollectionException(
+            FastCollectionException::ErrorCode::INTERNAL_ERROR,
+            "Invalid swiss table header in file"
+        );
+    }
+
+    if (header_->groups_offset < 0) {
+        SwissGroup* groups = allocate_groups(header_->group_count);
+        header_->groups_offset = reinterpret_cast<uint8_t*>(groups) - base();
+    }
+}
+
+uint32_t SwissTable::groups_for(uint32_t slot_count) {
+    uint32_t groups = std::max<uint32_t>(1, slot_count / SwissGroup::WIDTH);
+    return std::bit_ceil(groups);
+}
+
+uint32_t SwissTable::lowest_bit(uint32_t bits) {
+    return static_cast<uint32_t>(std::countr_zero(bits));
+}
+
+uint32_t SwissTable::match_byte(const uint8_t* ctrl, uint8_t value) {
+#if defined(FC_SWISS_SSE2)
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    __m128i match = _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(value)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(match));
+#elif defined(FC_SWISS_NEON)
+    static const uint8_t lane_bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                          1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t match = vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(value));
+    uint8x16_t masked = vandq_u8(match, vld1q_u8(lane_bits));
+    return static_cast<uint32_t>(vaddv_u8(vget_low_u8(masked))) |
+           (static_cast<uint32_t>(vaddv_u8(vget_high_u8(masked))) << 8);
+#else
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < SwissGroup::WIDTH; i++) {
+        if (ctrl[i] == value) bits |= 1u << i;
+    }
+    return bits;
+#endif
+}
+
+uint32_t SwissTable::match_empty_or_deleted(const uint8_t* ctrl) {
+    // EMPTY and DELETED are the only control bytes with the high bit set
+#if defined(FC_SWISS_SSE2)
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(group));
+#elif defined(FC_SWISS_NEON)
+    static const uint8_t lane_bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                          1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t high = vcltzq_s8(vreinterpretq_s8_u8(vld1q_u8(ctrl)));
+    uint8x16_t masked = vandq_u8(high, vld1q_u8(lane_bits));
+    return static_cast<uint32_t>(vaddv_u8(vget_low_u8(masked))) |
+           (static_cast<uint32_t>(vaddv_u8(vget_high_u8(masked))) << 8);
+#else
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < SwissGroup::WIDTH; i++) {
+        if (ctrl[i] & 0x80) bits |= 1u << i;
+    }
+    return bits;
+#endif
+}
+
+SwissGroup* SwissTable::allocate_groups(uint32_t count) {
+    void* mem = file_manager_->allocate(sizeof(SwissGroup) * count);
+    SwissGroup* groups = static_cast<SwissGroup*>(mem);
+    for (uint32_t g = 0; g < count; g++) {
+        std::memset(groups[g].ctrl, CTRL_EMPTY, SwissGroup::WIDTH);
+    }
+    return groups;
+}
+
+SwissTable::Position SwissTable::find(const uint8_t* key, size_t key_size, uint32_t hash) const {
+    SwissGroup* groups = this->groups();
+    uint32_t mask = header_->group_count - 1;
+    uint32_t g = h1(hash) & mask;
+    uint8_t fingerprint = h2(hash);
+
+    for (uint32_t step = 0; step <= mask; ) {
+        SwissGroup& group = groups[g];
+
+        for (uint32_t bits = match_byte(group.ctrl, fingerprint); bits; bits &= bits - 1) {
+            uint32_t i = lowest_bit(bits);
+            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(base() + group.slots[i]);
+            if (kv->entry.hash_code == hash &&
+                kv->key_size == key_size &&
+                std::memcmp(kv->data, key, key_size) == 0) {
+                return Position{&group, i};
+            }
+        }
+
+        if (match_byte(group.ctrl, CTRL_EMPTY)) break;
+        g = (g + ++step) & mask;
+    }
+
+    return Position{};
+}
+
+void SwissTable::find_hash(uint32_t hash, std::vector<Position>& out) const {
+    SwissGroup* groups = this->groups();
+    uint32_t mask = header_->group_count - 1;
+    uint32_t g = h1(hash) & mask;
+    uint8_t fingerprint = h2(hash);
+
+    for (uint32_t step = 0; step <= mask; ) {
+        SwissGroup& group = groups[g];
+
+        for (uint32_t bits = match_byte(group.ctrl, fingerprint); bits; bits &= bits - 1) {
+            uint32_t i = lowest_bit(bits);
+            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(base() + group.slots[i]);
+            if (kv->entry.hash_code == hash) {
+                out.push_back(Position{&group, i});
+            }
+        }
+
+        if (match_byte(group.ctrl, CTRL_EMPTY)) break;
+        g = (g + ++step) & mask;
+    }
+}
+
+void SwissTable::for_each_homed(uint32_t home, const std::function<void(const Position&)>& fn) const {
+    SwissGroup* groups = this->groups();
+    uint32_t mask = header_->group_count - 1;
+    uint32_t g = home;
+
+    // A key homed here went to the first group on this sequence with a free
+    // slot, so every group before it was full. erase() never gives a group
+    // without an EMPTY slot one, so the walk cannot stop short of the key
+    for (uint32_t step = 0; step <= mask; ) {
+        SwissGroup& group = groups[g];
+
+        for (uint32_t bits = match_full(group.ctrl); bits; bits &= bits - 1) {
+            uint32_t i = lowest_bit(bits);
+            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(base() + group.slots[i]);
+            if ((h1(kv->entry.hash_code) & mask) == home) {
+                fn(Position{&group, i});
+            }
+        }
+
+        if (match_byte(group.ctrl, CTRL_EMPTY)) break;
+        g = (g + ++step) & mask;
+    }
+}
+
+void SwissTable::place(SwissGroup* groups, uint32_t group_count, uint32_t hash, int64_t offset) {
+    uint32_t mask = group_count - 1;
+    uint32_t g = h1(hash) & mask;
+
+    for (uint32_t step = 0; ; ) {
+        uint32_t bits = match_empty_or_deleted(groups[g].ctrl);
+        if (bits) {
+            uint32_t i = lowest_bit(bits);
+            if (groups[g].ctrl[i] == CTRL_DELETED) header_->deleted_slots--;
+            groups[g].slots[i] = offset;
+            groups[g].ctrl[i] = h2(hash);
+            header_->full_slots++;
+            return;
+        }
+        g = (g + ++step) & mask;
+    }
+}
+
+void SwissTable::insert(uint32_t hash, ShmKeyValue* kv) {
+    uint64_t capacity = static_cast<uint64_t>(header_->group_count) * SwissGroup::WIDTH;
+    uint64_t used = header_->full_slots + header_->deleted_slots + 1;
+
+    if (used * MAX_LOAD_DEN > capacity * MAX_LOAD_NUM) {
+        // Mostly tombstones: rehash in place; otherwise double
+        bool grow = (header_->full_slots + 1) * MAX_LOAD_DEN * 2 > capacity * MAX_LOAD_NUM;
+        rehash(grow ? header_->group_count * 2 : header_->group_count);
+    }
+
+    place(groups(), header_->group_count, hash, reinterpret_cast<uint8_t*>(kv) - base());
+}
+
+void SwissTable::set(const Position& pos, ShmKeyValue* kv) {
+    pos.group->slots[pos.index] = reinterpret_cast<uint8_t*>(kv) - base();
+}
+
+void SwissTable::erase(const Position& pos) {
+    // No probe continues past a group with an empty slot, so the slot can be
+    // reused outright; otherwise leave a tombstone to keep probe chains intact
+    if (match_byte(pos.group->ctrl, CTRL_EMPTY)) {
+        pos.group->ctrl[pos.index] = CTRL_EMPTY;
+    } else {
+        pos.group->ctrl[pos.index] = CTRL_DELETED;
+        header_->deleted_slots++;
+    }
+    header_->full_slots--;
+}
+
+void SwissTable::reset() {
+    SwissGroup* groups = this->groups();
+    for (uint32_t g = 0; g < header_->group_count; g++) {
+        std::memset(groups[g].ctrl, CTRL_EMPTY, SwissGroup::WIDTH);
+    }
+    header_->full_slots = 0;
+    header_->deleted_slots = 0;
+}
+
+void SwissTable::rehash(uint32_t new_group_count) {
+    SwissGroup* new_groups = allocate_groups(new_group_count);
+    SwissGroup* old_groups = groups();
+    uint32_t old_count = header_->group_count;
+
+    header_->full_slots = 0;
+    header_->deleted_slots = 0;
+
+    for (uint32_t g = 0; g < old_count; g++) {
+        for (uint32_t bits = match_full(old_groups[g].ctrl); bits; bits &= bits - 1) {
+            int64_t offset = old_groups[g].slots[lowest_bit(bits)];
+            const ShmKeyValue* kv = reinterpret_cast<const ShmKeyValue*>(base() + offset);
+            place(new_groups, new_group_count, kv->entry.hash_code, offset);
+        }
+    }
+
+    header_->groups_offset = reinterpret_cast<uint8_t*>(new_groups) - base();
+    header_->group_count = new_group_count;
+    file_manager_->deallocate(old_groups);
+}
+
+} // namespace fastcollection
@@ -0,0 +1,169 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ *
+ * @file fc_thread_pool.cpp
+ * @brief Implementation of the work-stealing thread pool
+ */
+
+#include "fc_thread_pool.h"
+#include <algorithm>
+
+namespace fastcollection {
+
+namespace {
+
+// Set while this thread runs a task, so nested jobs run inline
+thread_local bool in_task = false;
+
+} // anonymous namespace
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t parallelism)
+    : parallelism_(resolve(parallelism)) {
+}
+
+ThreadPool::~ThreadPool() {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    stop_workers();
+}
+
+size_t ThreadPool::resolve(size_t parallelism) {
+    if (parallelism > 0) return parallelism;
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+size_t ThreadPool::parallelism() const {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    return parallelism_;
+}
+
+void ThreadPool::set_parallelism(size_t parallelism) {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    parallelism = resolve(parallelism);
+    if (parallelism == parallelism_) return;
+    
+    // Workers are restarted by the next job
+    stop_workers();
+    parallelism_ = parallelism;
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (in_task) {
+        for (size_t i = 0; i < count; i++) fn(i);
+        return;
+    }
+    
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    
+    Job job;
+    job.fn = &fn;
+    job.lanes = std::min(parallelism_, count);
+    job.ranges.reset(new Range[job.lanes]);
+    for (size_t lane = 0; lane < job.lanes; lane++) {
+        job.ranges[lane].next.store(count * lane / job.lanes, std::memory_order_relaxed);
+        job.ranges[lane].end = count * (lane + 1) / job.lanes;
+    }
+    
+    if (job.lanes > 1) {
+        start_workers();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            generation_++;
+        }
+        wake_.notify_all();
+    }
+    
+    run_lane(job, 0);
+    
+    if (job.lanes > 1) {
+        // Workers that have not picked up the job by now find nothing left;
+        // the ones inside it must leave before job goes out of scope
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_ = nullptr;
+        done_.wait(lock, [this] { return active_ == 0; });
+    }
+    
+    if (job.error) std::rethrow_exception(job.error);
+}
+
+void ThreadPool::run_lane(Job& job, size_t lane) {
+    in_task = true;
+    
+    // Own range first, then steal from the others in turn
+    for (size_t n = 0; n < job.lanes; n++) {
+        Range& range = job.ranges[(lane + n) % job.lanes];
+        
+        while (!job.failed.load(std::memory_order_relaxed)) {
+            size_t index = range.next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= range.end) break;
+            
+            try {
+                (*job.fn)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.error_mutex);
+                if (!job.error) job.error = std::current_exception();
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    in_task = false;
+}
+
+void ThreadPool::worker_loop(size_t lane, uint64_t seen) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) return;
+        seen = generation_;
+        
+        Job* job = job_;
+        if (!job || lane >= job->lanes) continue;
+        
+        active_++;
+        lock.unlock();
+        run_lane(*job, lane);
+        lock.lock();
+        if (--active_ == 0) done_.notify_all();
+    }
+}
+
+void ThreadPool::start_workers() {
+    if (workers_.size() + 1 >= parallelism_) return;
+    
+    // A new worker must not skip the job about to be posted
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        generation = generation_;
+    }
+    for (size_t lane = workers_.size() + 1; lane < parallelism_; lane++) {
+        workers_.emplace_back([this, lane, generation] { worker_loop(lane, generation); });
+    }
+}
+
+void ThreadPool::stop_workers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+} // namespace fastcollection
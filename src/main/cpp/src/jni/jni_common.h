@@ -12,6 +12,7 @@
 #define FASTCOLLECTION_JNI_COMMON_H
 
 #include <jni.h>
+#include <optional>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -77,6 +78,63 @@ inline jbyteArray vectorToJbyteArray(JNIEnv* env, const std::vector<uint8_t>& ve
     return result;
 }
 
+/**
+ * @brief Convert Java byte[][] to native byte vectors (null elements become empty)
+ */
+inline std::vector<std::vector<uint8_t>> jobjectArrayToVectors(JNIEnv* env, jobjectArray jarray) {
+    std::vector<std::vector<uint8_t>> result;
+    if (jarray == nullptr) return result;
+    
+    jsize count = env->GetArrayLength(jarray);
+    result.reserve(count);
+    for (jsize i = 0; i < count; i++) {
+        jbyteArray element = static_cast<jbyteArray>(env->GetObjectArrayElement(jarray, i));
+        result.push_back(jbyteArrayToVector(env, element));
+        env->DeleteLocalRef(element);
+    }
+    return result;
+}
+
+/**
+ * @brief Convert native lookup results to Java byte[][] (misses become null)
+ */
+inline jobjectArray optionalVectorsToJobjectArray(
+    JNIEnv* env, const std::vector<std::optional<std::vector<uint8_t>>>& vecs) {
+    jclass byteArrayClass = env->FindClass("[B");
+    if (byteArrayClass == nullptr) return nullptr;
+    
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(vecs.size()), byteArrayClass, nullptr);
+    if (result == nullptr) return nullptr;
+    
+    for (size_t i = 0; i < vecs.size(); i++) {
+        if (!vecs[i]) continue;
+        jbyteArray element = vectorToJbyteArray(env, *vecs[i]);
+        if (element == nullptr) return nullptr;
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), element);
+        env->DeleteLocalRef(element);
+    }
+    return result;
+}
+
+/**
+ * @brief Convert native byte vectors to Java byte[][]
+ */
+inline jobjectArray vectorsToJobjectArray(JNIEnv* env, const std::vector<std::vector<uint8_t>>& vecs) {
+    jclass byteArrayClass = env->FindClass("[B");
+    if (byteArrayClass == nullptr) return nullptr;
+    
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(vecs.size()), byteArrayClass, nullptr);
+    if (result == nullptr) return nullptr;
+    
+    for (size_t i = 0; i < vecs.size(); i++) {
+        jbyteArray element = vectorToJbyteArray(env, vecs[i]);
+        if (element == nullptr) return nullptr;
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), element);
+        env->DeleteLocalRef(element);
+    }
+    return result;
+}
+
 /**
  * @brief Get native byte array data without copying
  */
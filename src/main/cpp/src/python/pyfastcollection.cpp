@@ -15,6 +15,7 @@
 #include "fc_list.h"
 #include "fc_set.h"
 #include "fc_map.h"
+#include "fc_sorted_map.h"
 #include "fc_queue.h"
 #include "fc_stack.h"
 
@@ -32,6 +33,61 @@ py::bytes vector_to_bytes(const std::vector<uint8_t>& v) {
     return py::bytes(reinterpret_cast<const char*>(v.data()), v.size());
 }
 
+// Helper to build a reaper config from keyword arguments
+ReaperConfig make_reaper_config(uint64_t interval_ms, size_t batch_size,
+                                uint32_t cpu_budget_percent) {
+    ReaperConfig config;
+    config.interval_ms = interval_ms;
+    config.batch_size = batch_size;
+    config.cpu_budget_percent = cpu_budget_percent;
+    return config;
+}
+
+// Helper to pass mapped data to a Python callback as a read-only memoryview.
+// The data is only pinned for the duration of the call, so the view is
+// released as soon as the callback returns.
+py::object call_with_view(const py::function& fn, const uint8_t* data, size_t size) {
+    py::memoryview view = py::memoryview::from_memory(data, static_cast<py::ssize_t>(size));
+    py::object result = fn(view);
+    view.attr("release")();
+    return result;
+}
+
+// Iterator that streams a FastMap or FastSet in cursor-scan batches, so
+// iterating never copies the whole collection into Python at once.
+struct ScanIterator {
+    std::function<uint64_t(uint64_t, py::list&)> fetch;
+    py::list batch;
+    size_t index = 0;
+    uint64_t cursor = 0;
+    bool done = false;
+    
+    py::object next() {
+        while (index >= batch.size() && !done) {
+            batch = py::list();
+            index = 0;
+            cursor = fetch(cursor, batch);
+            done = cursor == 0;
+        }
+        if (index >= batch.size()) throw py::stop_iteration();
+        return batch[index++];
+    }
+};
+
+ScanIterator map_scan_iterator(const FastMap& map, bool with_values) {
+    ScanIterator it;
+    it.fetch = [&map, with_values](uint64_t cursor, py::list& out) {
+        std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> batch;
+        uint64_t next = map.scan(cursor, SCAN_DEFAULT_COUNT, batch);
+        for (const auto& [k, v] : batch) {
+            if (with_values) out.append(py::make_tuple(vector_to_bytes(k), vector_to_bytes(v)));
+            else out.append(vector_to_bytes(k));
+        }
+        return next;
+    };
+    return it;
+}
+
 PYBIND11_MODULE(fastcollection, m) {
     m.doc() = R"pbdoc(
         FastCollection - Ultra High-Performance Memory-Mapped Collections with TTL
@@ -43,7 +99,9 @@ PYBIND11_MODULE(fastcollection, m) {
             - FastList: Doubly-linked list with O(1) head/tail operations
             - FastSet: Hash set with O(1) lookups
             - FastMap: Key-value store with atomic operations
+            - FastSortedMap: Ordered key-value store with range and prefix scans
             - FastQueue: FIFO queue with deque operations
+            - FastRingQueue: Bounded lock-free FIFO ring with backpressure
             - FastStack: LIFO stack with lock-free push/pop
         
         TTL Support:
@@ -63,9 +121,21 @@ PYBIND11_MODULE(fastcollection, m) {
     // TTL constant
     m.attr("TTL_INFINITE") = TTL_INFINITE;
     
+    // Thread pool used by the parallel_* operations
+    m.def("set_parallelism", [](size_t parallelism) {
+        ThreadPool::instance().set_parallelism(parallelism);
+    }, py::arg("parallelism") = 0,
+       "Set the number of threads parallel sweeps use; 0 means one per CPU.");
+    m.def("get_parallelism", []() { return ThreadPool::instance().parallelism(); });
+    
     // Exception
     py::register_exception<FastCollectionException>(m, "FastCollectionException");
     
+    // Batched iterator returned by FastMap and FastSet
+    py::class_<ScanIterator>(m, "ScanIterator")
+        .def("__iter__", [](ScanIterator& self) -> ScanIterator& { return self; })
+        .def("__next__", &ScanIterator::next);
+    
     // ========================================================================
     // FastList
     // ========================================================================
@@ -106,13 +176,23 @@ PYBIND11_MODULE(fastcollection, m) {
         }, py::arg("data"), py::arg("ttl") = TTL_INFINITE)
         
         .def("get", [](FastList& self, size_t index) -> py::object {
-            std::vector<uint8_t> result;
-            if (self.get(index, result)) {
-                return vector_to_bytes(result);
-            }
-            return py::none();
+            py::object result = py::none();
+            self.getWith(index, [&](const uint8_t* data, size_t size) {
+                result = py::bytes(reinterpret_cast<const char*>(data), size);
+            });
+            return result;
         }, py::arg("index"))
         
+        .def("get_with", [](FastList& self, size_t index, const py::function& fn) -> py::object {
+            py::object result = py::none();
+            self.getWith(index, [&](const uint8_t* data, size_t size) {
+                result = call_with_view(fn, data, size);
+            });
+            return result;
+        }, py::arg("index"), py::arg("fn"),
+           "Call fn with a read-only memoryview of the element, valid only during the call. "
+           "Returns fn's result, or None if there is no such element.")
+        
         .def("get_first", [](FastList& self) -> py::object {
             std::vector<uint8_t> result;
             if (self.getFirst(result)) return vector_to_bytes(result);
@@ -130,6 +210,21 @@ PYBIND11_MODULE(fastcollection, m) {
             return self.set(index, vec.data(), vec.size(), ttl);
         }, py::arg("index"), py::arg("data"), py::arg("ttl") = TTL_INFINITE)
         
+        .def("get_with_version", [](FastList& self, size_t index) -> py::object {
+            std::vector<uint8_t> result;
+            uint64_t version = 0;
+            if (!self.getWithVersion(index, result, version)) return py::none();
+            return py::make_tuple(vector_to_bytes(result), version);
+        }, py::arg("index"), "(data, version) of the element at index, or None")
+        
+        .def("set_if_version", [](FastList& self, size_t index, const py::bytes& data,
+                                  uint64_t expected_version, int32_t ttl) {
+            auto vec = bytes_to_vector(data);
+            return self.setIfVersion(index, vec.data(), vec.size(), expected_version, ttl);
+        }, py::arg("index"), py::arg("data"), py::arg("expected_version"),
+           py::arg("ttl") = TTL_INFINITE,
+           "Set the element only if it is still at expected_version")
+        
         .def("remove", [](FastList& self, size_t index) -> py::object {
             std::vector<uint8_t> result;
             if (self.remove(index, &result)) return vector_to_bytes(result);
@@ -162,8 +257,18 @@ PYBIND11_MODULE(fastcollection, m) {
              "Get remaining TTL. Returns -1 if infinite, 0 if expired.")
         .def("set_ttl", &FastList::setTTL, py::arg("index"), py::arg("ttl_seconds"))
         .def("remove_expired", &FastList::removeExpired)
+        .def("start_reaper", [](FastList& self, uint64_t interval_ms, size_t batch_size,
+                                uint32_t cpu_budget_percent) {
+            self.startReaper(make_reaper_config(interval_ms, batch_size, cpu_budget_percent));
+        }, py::arg("interval_ms") = TTL_CLEANUP_INTERVAL_MS,
+           py::arg("batch_size") = TTL_CLEANUP_BATCH_SIZE,
+           py::arg("cpu_budget_percent") = 10,
+           "Remove expired elements on a background thread, one process per file.")
+        .def("stop_reaper", &FastList::stopReaper)
+        .def("is_reaping", &FastList::isReaping)
         .def("clear", &FastList::clear)
         .def("size", &FastList::size)
+        .def("exact_size", &FastList::exactSize)
         .def("is_empty", &FastList::isEmpty)
         .def("flush", &FastList::flush)
         .def("filename", &FastList::filename)
@@ -207,11 +312,42 @@ PYBIND11_MODULE(fastcollection, m) {
         }, py::arg("data"), py::arg("ttl_seconds"))
         
         .def("remove_expired", &FastSet::removeExpired)
+        .def("parallel_remove_expired", &FastSet::parallelRemoveExpired,
+             "Remove expired elements with a full sweep spread over the thread pool.")
+        .def("start_reaper", [](FastSet& self, uint64_t interval_ms, size_t batch_size,
+                                uint32_t cpu_budget_percent) {
+            self.startReaper(make_reaper_config(interval_ms, batch_size, cpu_budget_percent));
+        }, py::arg("interval_ms") = TTL_CLEANUP_INTERVAL_MS,
+           py::arg("batch_size") = TTL_CLEANUP_BATCH_SIZE,
+           py::arg("cpu_budget_percent") = 10,
+           "Remove expired elements on a background thread, one process per file.")
+        .def("stop_reaper", &FastSet::stopReaper)
+        .def("is_reaping", &FastSet::isReaping)
         .def("clear", &FastSet::clear)
+        .def("parallel_clear", &FastSet::parallelClear)
         .def("size", &FastSet::size)
+        .def("exact_size", &FastSet::exactSize)
         .def("is_empty", &FastSet::isEmpty)
         .def("flush", &FastSet::flush)
+        .def("scan", [](FastSet& self, uint64_t cursor, size_t count) {
+            std::vector<std::vector<uint8_t>> batch;
+            uint64_t next = self.scan(cursor, count, batch);
+            py::list result;
+            for (const auto& e : batch) result.append(vector_to_bytes(e));
+            return py::make_tuple(next, result);
+        }, py::arg("cursor") = 0, py::arg("count") = SCAN_DEFAULT_COUNT,
+           "Return (next_cursor, elements) for one batch; iteration is done when next_cursor is 0.")
         .def("__len__", &FastSet::size)
+        .def("__iter__", [](const FastSet& self) {
+            ScanIterator it;
+            it.fetch = [&self](uint64_t cursor, py::list& out) {
+                std::vector<std::vector<uint8_t>> batch;
+                uint64_t next = self.scan(cursor, SCAN_DEFAULT_COUNT, batch);
+                for (const auto& e : batch) out.append(vector_to_bytes(e));
+                return next;
+            };
+            return it;
+        }, py::keep_alive<0, 1>())
         .def("__contains__", [](FastSet& self, const py::bytes& data) {
             auto vec = bytes_to_vector(data);
             return self.contains(vec.data(), vec.size());
@@ -242,13 +378,41 @@ PYBIND11_MODULE(fastcollection, m) {
         
         .def("get", [](FastMap& self, const py::bytes& key) -> py::object {
             auto k = bytes_to_vector(key);
-            std::vector<uint8_t> result;
-            if (self.get(k.data(), k.size(), result)) {
-                return vector_to_bytes(result);
-            }
-            return py::none();
+            py::object result = py::none();
+            self.getWith(k.data(), k.size(), [&](const uint8_t* value, size_t size) {
+                result = py::bytes(reinterpret_cast<const char*>(value), size);
+            });
+            return result;
         }, py::arg("key"))
         
+        .def("get_with_version", [](FastMap& self, const py::bytes& key) -> py::object {
+            auto k = bytes_to_vector(key);
+            std::vector<uint8_t> result;
+            uint64_t version = 0;
+            if (!self.getWithVersion(k.data(), k.size(), result, version)) return py::none();
+            return py::make_tuple(vector_to_bytes(result), version);
+        }, py::arg("key"), "(value, version) for key, or None if missing")
+        
+        .def("put_if_version", [](FastMap& self, const py::bytes& key, const py::bytes& value,
+                                  uint64_t expected_version, int32_t ttl) {
+            auto k = bytes_to_vector(key);
+            auto v = bytes_to_vector(value);
+            return self.putIfVersion(k.data(), k.size(), v.data(), v.size(), expected_version, ttl);
+        }, py::arg("key"), py::arg("value"), py::arg("expected_version"),
+           py::arg("ttl") = TTL_INFINITE,
+           "Store value only if key is still at expected_version (0 = absent)")
+        
+        .def("get_with", [](FastMap& self, const py::bytes& key, const py::function& fn) -> py::object {
+            auto k = bytes_to_vector(key);
+            py::object result = py::none();
+            self.getWith(k.data(), k.size(), [&](const uint8_t* value, size_t size) {
+                result = call_with_view(fn, value, size);
+            });
+            return result;
+        }, py::arg("key"), py::arg("fn"),
+           "Call fn with a read-only memoryview of the value, valid only during the call. "
+           "Returns fn's result, or None if the key is missing.")
+        
         .def("remove", [](FastMap& self, const py::bytes& key) {
             auto k = bytes_to_vector(key);
             return self.remove(k.data(), k.size());
@@ -269,12 +433,106 @@ PYBIND11_MODULE(fastcollection, m) {
             return self.setTTL(k.data(), k.size(), ttl);
         }, py::arg("key"), py::arg("ttl_seconds"))
         
+        .def("increment_by", [](FastMap& self, const py::bytes& key, int64_t delta, int32_t ttl) {
+            auto k = bytes_to_vector(key);
+            return self.incrementBy(k.data(), k.size(), delta, ttl);
+        }, py::arg("key"), py::arg("delta") = 1, py::arg("ttl") = TTL_INFINITE,
+           "Atomically add delta to a 64-bit counter, creating it if absent; "
+           "ttl only applies on creation. Returns the new value.")
+        
+        .def("add_and_get", [](FastMap& self, const py::bytes& key, int64_t delta) {
+            auto k = bytes_to_vector(key);
+            return self.addAndGet(k.data(), k.size(), delta);
+        }, py::arg("key"), py::arg("delta"))
+        
+        .def("get_and_set", [](FastMap& self, const py::bytes& key, int64_t value, int32_t ttl) {
+            auto k = bytes_to_vector(key);
+            return self.getAndSet(k.data(), k.size(), value, ttl);
+        }, py::arg("key"), py::arg("value"), py::arg("ttl") = TTL_INFINITE,
+           "Atomically set a counter. Returns the previous value, or 0 if absent.")
+        
+        .def("compare_and_set", [](FastMap& self, const py::bytes& key,
+                                   int64_t expected, int64_t desired) {
+            auto k = bytes_to_vector(key);
+            return self.compareAndSet(k.data(), k.size(), expected, desired);
+        }, py::arg("key"), py::arg("expected"), py::arg("desired"))
+        
+        .def("get_counter", [](FastMap& self, const py::bytes& key) -> py::object {
+            auto k = bytes_to_vector(key);
+            auto value = self.getCounter(k.data(), k.size());
+            if (!value) return py::none();
+            return py::int_(*value);
+        }, py::arg("key"), "Counter value, or None if the key is missing")
+        
+        .def("multi_get", [](FastMap& self, const std::vector<py::bytes>& keys) {
+            std::vector<std::vector<uint8_t>> ks;
+            ks.reserve(keys.size());
+            for (const auto& key : keys) ks.push_back(bytes_to_vector(key));
+            
+            py::list result;
+            for (const auto& value : self.multiGet(ks)) {
+                if (value) {
+                    result.append(vector_to_bytes(*value));
+                } else {
+                    result.append(py::none());
+                }
+            }
+            return result;
+        }, py::arg("keys"),
+           "Look up many keys at once. Returns a list of values, None for missing keys.")
+        
+        .def("multi_put", [](FastMap& self, const py::dict& items, int32_t ttl) {
+            std::vector<std::vector<uint8_t>> ks, vs;
+            ks.reserve(items.size());
+            vs.reserve(items.size());
+            for (auto item : items) {
+                ks.push_back(bytes_to_vector(item.first.cast<py::bytes>()));
+                vs.push_back(bytes_to_vector(item.second.cast<py::bytes>()));
+            }
+            return self.multiPut(ks, vs, ttl);
+        }, py::arg("items"), py::arg("ttl") = TTL_INFINITE,
+           "Store every key/value pair of a dict. Returns the number stored.")
+        
+        .def("multi_remove", [](FastMap& self, const std::vector<py::bytes>& keys) {
+            std::vector<std::vector<uint8_t>> ks;
+            ks.reserve(keys.size());
+            for (const auto& key : keys) ks.push_back(bytes_to_vector(key));
+            return self.multiRemove(ks);
+        }, py::arg("keys"), "Remove many keys at once. Returns the number removed.")
+        
         .def("remove_expired", &FastMap::removeExpired)
+        .def("parallel_remove_expired", &FastMap::parallelRemoveExpired,
+             "Remove expired entries with a full sweep spread over the thread pool.")
+        .def("start_reaper", [](FastMap& self, uint64_t interval_ms, size_t batch_size,
+                                uint32_t cpu_budget_percent) {
+            self.startReaper(make_reaper_config(interval_ms, batch_size, cpu_budget_percent));
+        }, py::arg("interval_ms") = TTL_CLEANUP_INTERVAL_MS,
+           py::arg("batch_size") = TTL_CLEANUP_BATCH_SIZE,
+           py::arg("cpu_budget_percent") = 10,
+           "Remove expired entries on a background thread, one process per file.")
+        .def("stop_reaper", &FastMap::stopReaper)
+        .def("is_reaping", &FastMap::isReaping)
         .def("clear", &FastMap::clear)
+        .def("parallel_clear", &FastMap::parallelClear)
         .def("size", &FastMap::size)
+        .def("exact_size", &FastMap::exactSize)
         .def("is_empty", &FastMap::isEmpty)
         .def("flush", &FastMap::flush)
+        .def("scan", [](FastMap& self, uint64_t cursor, size_t count) {
+            std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> batch;
+            uint64_t next = self.scan(cursor, count, batch);
+            py::list result;
+            for (const auto& [k, v] : batch) {
+                result.append(py::make_tuple(vector_to_bytes(k), vector_to_bytes(v)));
+            }
+            return py::make_tuple(next, result);
+        }, py::arg("cursor") = 0, py::arg("count") = SCAN_DEFAULT_COUNT,
+           "Return (next_cursor, [(key, value), ...]) for one batch; iteration is done when next_cursor is 0.")
+        .def("items", [](const FastMap& self) { return map_scan_iterator(self, true); },
+             py::keep_alive<0, 1>(), "Iterate over (key, value) pairs in batches.")
         .def("__len__", &FastMap::size)
+        .def("__iter__", [](const FastMap& self) { return map_scan_iterator(self, false); },
+             py::keep_alive<0, 1>())
         .def("__getitem__", [](FastMap& self, const py::bytes& key) -> py::object {
             auto k = bytes_to_vector(key);
             std::vector<uint8_t> result;
@@ -294,6 +552,150 @@ PYBIND11_MODULE(fastcollection, m) {
         })
         .def("close", [](FastMap& self) { self.flush(); });
     
+    // ========================================================================
+    // FastSortedMap
+    // ========================================================================
+    py::class_<FastSortedMap>(m, "FastSortedMap",
+                              "Memory-mapped sorted map (B+tree) with range and prefix scans and TTL.")
+        .def(py::init<const std::string&, size_t, bool>(),
+             py::arg("file_path"),
+             py::arg("initial_size") = DEFAULT_INITIAL_SIZE,
+             py::arg("create_new") = false)
+        
+        .def("put", [](FastSortedMap& self, const py::bytes& key, const py::bytes& value, int32_t ttl) {
+            auto k = bytes_to_vector(key);
+            auto v = bytes_to_vector(value);
+            return self.put(k.data(), k.size(), v.data(), v.size(), ttl);
+        }, py::arg("key"), py::arg("value"), py::arg("ttl") = TTL_INFINITE)
+        
+        .def("put_if_absent", [](FastSortedMap& self, const py::bytes& key, const py::bytes& value, int32_t ttl) {
+            auto k = bytes_to_vector(key);
+            auto v = bytes_to_vector(value);
+            return self.putIfAbsent(k.data(), k.size(), v.data(), v.size(), ttl);
+        }, py::arg("key"), py::arg("value"), py::arg("ttl") = TTL_INFINITE)
+        
+        .def("get", [](FastSortedMap& self, const py::bytes& key) -> py::object {
+            auto k = bytes_to_vector(key);
+            py::object result = py::none();
+            self.getWith(k.data(), k.size(), [&](const uint8_t* value, size_t size) {
+                result = py::bytes(reinterpret_cast<const char*>(value), size);
+            });
+            return result;
+        }, py::arg("key"))
+        
+        .def("remove", [](FastSortedMap& self, const py::bytes& key) {
+            auto k = bytes_to_vector(key);
+            return self.remove(k.data(), k.size());
+        }, py::arg("key"))
+        
+        .def("contains_key", [](FastSortedMap& self, const py::bytes& key) {
+            auto k = bytes_to_vector(key);
+            return self.containsKey(k.data(), k.size());
+        }, py::arg("key"))
+        
+        .def("get_ttl", [](FastSortedMap& self, const py::bytes& key) {
+            auto k = bytes_to_vector(key);
+            return self.getTTL(k.data(), k.size());
+        }, py::arg("key"))
+        
+        .def("set_ttl", [](FastSortedMap& self, const py::bytes& key, int32_t ttl) {
+            auto k = bytes_to_vector(key);
+            return self.setTTL(k.data(), k.size(), ttl);
+        }, py::arg("key"), py::arg("ttl_seconds"))
+        
+        .def("first", [](FastSortedMap& self) -> py::object {
+            std::vector<uint8_t> k, v;
+            if (!self.first(k, v)) return py::none();
+            return py::make_tuple(vector_to_bytes(k), vector_to_bytes(v));
+        }, "(key, value) with the smallest key, or None if empty")
+        
+        .def("last", [](FastSortedMap& self) -> py::object {
+            std::vector<uint8_t> k, v;
+            if (!self.last(k, v)) return py::none();
+            return py::make_tuple(vector_to_bytes(k), vector_to_bytes(v));
+        }, "(key, value) with the largest key, or None if empty")
+        
+        .def("floor", [](FastSortedMap& self, const py::bytes& key) -> py::object {
+            auto probe = bytes_to_vector(key);
+            std::vector<uint8_t> k, v;
+            if (!self.floor(probe.data(), probe.size(), k, v)) return py::none();
+            return py::make_tuple(vector_to_bytes(k), vector_to_bytes(v));
+        }, py::arg("key"), "(key, value) with the largest key <= key, or None")
+        
+        .def("ceiling", [](FastSortedMap& self, const py::bytes& key) -> py::object {
+            auto probe = bytes_to_vector(key);
+            std::vector<uint8_t> k, v;
+            if (!self.ceiling(probe.data(), probe.size(), k, v)) return py::none();
+            return py::make_tuple(vector_to_bytes(k), vector_to_bytes(v));
+        }, py::arg("key"), "(key, value) with the smallest key >= key, or None")
+        
+        .def("range", [](FastSortedMap& self, const py::object& from_key, const py::object& to_key,
+                         bool reverse, size_t limit) {
+            std::vector<uint8_t> from, to;
+            if (!from_key.is_none()) from = bytes_to_vector(from_key.cast<py::bytes>());
+            if (!to_key.is_none()) to = bytes_to_vector(to_key.cast<py::bytes>());
+            
+            py::list result;
+            self.range(from.data(), from.size(), to.data(), to.size(),
+                       [&](const uint8_t* key, size_t key_size, const uint8_t* value, size_t value_size) {
+                result.append(py::make_tuple(
+                    py::bytes(reinterpret_cast<const char*>(key), key_size),
+                    py::bytes(reinterpret_cast<const char*>(value), value_size)));
+                return limit == 0 || result.size() < limit;
+            }, reverse);
+            return result;
+        }, py::arg("from_key") = py::none(), py::arg("to_key") = py::none(),
+           py::arg("reverse") = false, py::arg("limit") = 0,
+           "List of (key, value) with from_key <= key < to_key; None leaves a bound open")
+        
+        .def("prefix", [](FastSortedMap& self, const py::bytes& prefix, bool reverse, size_t limit) {
+            auto p = bytes_to_vector(prefix);
+            py::list result;
+            self.prefix(p.data(), p.size(),
+                        [&](const uint8_t* key, size_t key_size, const uint8_t* value, size_t value_size) {
+                result.append(py::make_tuple(
+                    py::bytes(reinterpret_cast<const char*>(key), key_size),
+                    py::bytes(reinterpret_cast<const char*>(value), value_size)));
+                return limit == 0 || result.size() < limit;
+            }, reverse);
+            return result;
+        }, py::arg("prefix"), py::arg("reverse") = false, py::arg("limit") = 0,
+           "List of (key, value) whose key starts with prefix")
+        
+        .def("items", [](FastSortedMap& self, bool reverse) {
+            py::list result;
+            self.forEach([&](const uint8_t* key, size_t key_size, const uint8_t* value, size_t value_size) {
+                result.append(py::make_tuple(
+                    py::bytes(reinterpret_cast<const char*>(key), key_size),
+                    py::bytes(reinterpret_cast<const char*>(value), value_size)));
+                return true;
+            }, reverse);
+            return result;
+        }, py::arg("reverse") = false)
+        
+        .def("remove_expired", &FastSortedMap::removeExpired)
+        .def("start_reaper", [](FastSortedMap& self, uint64_t interval_ms, size_t batch_size,
+                                uint32_t cpu_budget_percent) {
+            self.startReaper(make_reaper_config(interval_ms, batch_size, cpu_budget_percent));
+        }, py::arg("interval_ms") = TTL_CLEANUP_INTERVAL_MS,
+           py::arg("batch_size") = TTL_CLEANUP_BATCH_SIZE,
+           py::arg("cpu_budget_percent") = 10,
+           "Remove expired entries on a background thread, one process per file.")
+        .def("stop_reaper", &FastSortedMap::stopReaper)
+        .def("is_reaping", &FastSortedMap::isReaping)
+        .def("clear", &FastSortedMap::clear)
+        .def("size", &FastSortedMap::size)
+        .def("exact_size", &FastSortedMap::exactSize)
+        .def("is_empty", &FastSortedMap::isEmpty)
+        .def("height", &FastSortedMap::height)
+        .def("flush", &FastSortedMap::flush)
+        .def("__len__", &FastSortedMap::size)
+        .def("__contains__", [](FastSortedMap& self, const py::bytes& key) {
+            auto k = bytes_to_vector(key);
+            return self.containsKey(k.data(), k.size());
+        })
+        .def("close", [](FastSortedMap& self) { self.flush(); });
+    
     // ========================================================================
     // FastQueue
     // ========================================================================
@@ -326,11 +728,56 @@ PYBIND11_MODULE(fastcollection, m) {
         })
         
         .def("peek", [](FastQueue& self) -> py::object {
-            std::vector<uint8_t> result;
-            if (self.peek(result)) return vector_to_bytes(result);
-            return py::none();
+            py::object result = py::none();
+            self.peekWith([&](const uint8_t* data, size_t size) {
+                result = py::bytes(reinterpret_cast<const char*>(data), size);
+            });
+            return result;
         })
         
+        .def("peek_with", [](FastQueue& self, const py::function& fn) -> py::object {
+            py::object result = py::none();
+            self.peekWith([&](const uint8_t* data, size_t size) {
+                result = call_with_view(fn, data, size);
+            });
+            return result;
+        }, py::arg("fn"),
+           "Call fn with a read-only memoryview of the head element, valid only during the call. "
+           "Returns fn's result, or None if the queue is empty.")
+        
+        .def("offer_all", [](FastQueue& self, const std::vector<py::bytes>& items, int32_t ttl) {
+            std::vector<std::vector<uint8_t>> elements;
+            elements.reserve(items.size());
+            for (const auto& item : items) elements.push_back(bytes_to_vector(item));
+            return self.offerAll(elements, ttl);
+        }, py::arg("items"), py::arg("ttl") = TTL_INFINITE,
+           "Append every element of a list with one lock round-trip. Returns the number added.")
+        
+        .def("poll_batch", [](FastQueue& self, size_t max_elements) {
+            py::list result;
+            self.drainTo([&](const uint8_t* data, size_t size) {
+                result.append(py::bytes(reinterpret_cast<const char*>(data), size));
+            }, max_elements);
+            return result;
+        }, py::arg("max_elements") = 0,
+           "Remove up to max_elements elements (0 = all) from the head, in order.")
+        
+        .def("peek_batch", [](FastQueue& self, size_t max_elements) {
+            std::vector<std::vector<uint8_t>> batch;
+            self.peekBatch(batch, max_elements);
+            py::list result;
+            for (const auto& element : batch) result.append(vector_to_bytes(element));
+            return result;
+        }, py::arg("max_elements") = 0)
+        
+        .def("drain_to", [](FastQueue& self, const py::function& fn, size_t max_elements) {
+            return self.drainTo([&](const uint8_t* data, size_t size) {
+                call_with_view(fn, data, size);
+            }, max_elements);
+        }, py::arg("fn"), py::arg("max_elements") = 0,
+           "Remove up to max_elements elements (0 = all), calling fn with a read-only "
+           "memoryview of each, valid only during the call. Returns the number drained.")
+        
         .def("peek_ttl", &FastQueue::peekTTL)
         .def("remove_expired", &FastQueue::removeExpired)
         .def("clear", &FastQueue::clear)
@@ -340,6 +787,69 @@ PYBIND11_MODULE(fastcollection, m) {
         .def("__len__", &FastQueue::size)
         .def("close", [](FastQueue& self) { self.flush(); });
     
+    // ========================================================================
+    // FastRingQueue
+    // ========================================================================
+    py::class_<FastRingQueue>(m, "FastRingQueue",
+        "Bounded lock-free memory-mapped ring queue with backpressure and TTL.")
+        .def(py::init<const std::string&, size_t, size_t, bool>(),
+             py::arg("file_path"),
+             py::arg("capacity") = FastRingQueue::DEFAULT_CAPACITY,
+             py::arg("slot_bytes") = FastRingQueue::DEFAULT_SLOT_BYTES,
+             py::arg("create_new") = false)
+        
+        .def("offer", [](FastRingQueue& self, const py::bytes& data, int32_t ttl,
+                         uint32_t timeout_ms) {
+            auto vec = bytes_to_vector(data);
+            if (timeout_ms == 0) return self.offer(vec.data(), vec.size(), ttl);
+            py::gil_scoped_release release;
+            return self.offer(vec.data(), vec.size(), timeout_ms, ttl);
+        }, py::arg("data"), py::arg("ttl") = TTL_INFINITE, py::arg("timeout_ms") = 0,
+           "Add a record; False if the ring stays full for timeout_ms (0 = don't wait).")
+        
+        .def("put", [](FastRingQueue& self, const py::bytes& data, int32_t ttl) {
+            auto vec = bytes_to_vector(data);
+            py::gil_scoped_release release;
+            self.put(vec.data(), vec.size(), ttl);
+        }, py::arg("data"), py::arg("ttl") = TTL_INFINITE)
+        
+        .def("poll", [](FastRingQueue& self, uint32_t timeout_ms) -> py::object {
+            std::vector<uint8_t> result;
+            bool found;
+            {
+                py::gil_scoped_release release;
+                found = timeout_ms == 0 ? self.poll(result) : self.poll(result, timeout_ms);
+            }
+            if (found) return vector_to_bytes(result);
+            return py::none();
+        }, py::arg("timeout_ms") = 0)
+        
+        .def("take", [](FastRingQueue& self) {
+            std::vector<uint8_t> result;
+            {
+                py::gil_scoped_release release;
+                result = self.take();
+            }
+            return vector_to_bytes(result);
+        })
+        
+        .def("peek", [](FastRingQueue& self) -> py::object {
+            std::vector<uint8_t> result;
+            if (self.peek(result)) return vector_to_bytes(result);
+            return py::none();
+        })
+        
+        .def("clear", &FastRingQueue::clear)
+        .def("size", &FastRingQueue::size)
+        .def("is_empty", &FastRingQueue::isEmpty)
+        .def("capacity", &FastRingQueue::capacity)
+        .def("slot_bytes", &FastRingQueue::slotBytes)
+        .def("remaining_slots", &FastRingQueue::remainingSlots)
+        .def("max_record_size", &FastRingQueue::maxRecordSize)
+        .def("flush", &FastRingQueue::flush)
+        .def("__len__", &FastRingQueue::size)
+        .def("close", [](FastRingQueue& self) { self.flush(); });
+    
     // ========================================================================
     // FastStack
     // ========================================================================
@@ -13,6 +13,9 @@
 #include <vector>
 #include <random>
 #include <iomanip>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 
 using namespace fastcollection;
 using namespace std::chrono;
@@ -61,10 +64,56 @@ void benchmark_list(size_t ops) {
     }
 }
 
-void benchmark_map(size_t ops) {
-    std::cout << "\n=== FastMap Benchmark ===" << std::endl;
+void benchmark_list_readers(size_t ops) {
+    std::cout << "\n=== FastList / FastQueue Reader Scaling ===" << std::endl;
     
-    FastMap map("/tmp/bench_map.fc", 256 * 1024 * 1024, true);
+    FastList list("/tmp/bench_list_readers.fc", 64 * 1024 * 1024, true);
+    FastQueue queue("/tmp/bench_queue_readers.fc", 64 * 1024 * 1024, true);
+    std::vector<uint8_t> data(100, 'X');
+    const size_t elements = 1024;
+    for (size_t i = 0; i < elements; ++i) {
+        list.add(data.data(), data.size());
+        queue.offer(data.data(), data.size());
+    }
+    
+    // Each thread does the same number of reads; readers share the lock, so
+    // throughput should grow with the thread count up to the core count
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    double base = 0;
+    
+    for (size_t readers = 1; ; readers = std::min(readers * 2, hardware)) {
+        std::vector<std::thread> threads;
+        Timer t;
+        for (size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r]() {
+                std::vector<uint8_t> result;
+                for (size_t i = 0; i < ops; ++i) {
+                    if (i % 4 == 3) {
+                        queue.peek(result);
+                    } else {
+                        list.get((i + r * 97) % elements, result);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        double rate = t.ops_per_sec(ops * readers);
+        
+        if (readers == 1) base = rate;
+        std::cout << "  " << readers << " readers: " << std::fixed << std::setprecision(0)
+                  << rate << " reads/sec (x" << std::setprecision(2) << rate / base << ")"
+                  << std::endl;
+        
+        if (readers == hardware) break;
+    }
+}
+
+void benchmark_map(size_t ops, MapEngine engine) {
+    bool swiss = engine == MapEngine::SWISS;
+    std::cout << "\n=== FastMap Benchmark (" << (swiss ? "swiss" : "chained") << ") ===" << std::endl;
+    
+    FastMap map(swiss ? "/tmp/bench_map_swiss.fc" : "/tmp/bench_map.fc", 256 * 1024 * 1024, true,
+                HashTableHeader::DEFAULT_BUCKET_COUNT, engine);
     std::vector<uint8_t> value(100, 'V');
     
     // Put operations
@@ -90,6 +139,98 @@ void benchmark_map(size_t ops) {
         std::cout << "  Get: " << std::fixed << std::setprecision(0) 
                   << t.ops_per_sec(ops) << " ops/sec" << std::endl;
     }
+    
+    // Batched operations, 256 keys per call
+    const size_t batch = 256;
+    std::vector<std::vector<uint8_t>> keys;
+    for (size_t i = 0; i < ops; ++i) {
+        std::string key = "key_" + std::to_string((i * 7919) % ops);
+        keys.emplace_back(key.begin(), key.end());
+    }
+    {
+        Timer t;
+        for (size_t i = 0; i < ops; i += batch) {
+            size_t n = std::min(batch, ops - i);
+            std::vector<std::vector<uint8_t>> chunk(keys.begin() + i, keys.begin() + i + n);
+            map.multiPut(chunk, std::vector<std::vector<uint8_t>>(n, value));
+        }
+        std::cout << "  MultiPut: " << std::fixed << std::setprecision(0) 
+                  << t.ops_per_sec(ops) << " ops/sec" << std::endl;
+    }
+    {
+        Timer t;
+        for (size_t i = 0; i < ops; i += batch) {
+            size_t n = std::min(batch, ops - i);
+            std::vector<std::vector<uint8_t>> chunk(keys.begin() + i, keys.begin() + i + n);
+            map.multiGet(chunk);
+        }
+        std::cout << "  MultiGet: " << std::fixed << std::setprecision(0) 
+                  << t.ops_per_sec(ops) << " ops/sec" << std::endl;
+    }
+}
+
+void benchmark_map_concurrent(size_t ops, unsigned readers, unsigned writers) {
+    std::cout << "\n=== FastMap Concurrent Benchmark (" << readers << " readers, "
+              << writers << " writers) ===" << std::endl;
+    
+    FastMap map("/tmp/bench_map_mt.fc", 256 * 1024 * 1024, true);
+    const size_t keys = 1024;
+    
+    // Values are filled with their own length, so any read of freed or
+    // half-written memory is detected as a mismatched byte
+    auto put = [&map](size_t k, size_t len) {
+        std::string key = "key_" + std::to_string(k);
+        std::vector<uint8_t> value(len, static_cast<uint8_t>(len % 251));
+        map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(), value.data(), value.size());
+    };
+    for (size_t k = 0; k < keys; ++k) put(k, 100);
+    
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> torn{0};
+    std::vector<std::thread> threads;
+    
+    Timer t;
+    for (unsigned w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (size_t i = 0; i < ops; ++i) {
+                size_t k = (i * 31 + w) % keys;
+                if (i % 4 == 0) {
+                    std::string key = "key_" + std::to_string(k);
+                    map.remove(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+                } else {
+                    put(k, 16 + (i % 512));
+                }
+            }
+        });
+    }
+    for (unsigned r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r]() {
+            std::vector<uint8_t> result;
+            uint64_t local = 0;
+            for (size_t i = r; !stop.load(std::memory_order_relaxed); ++i) {
+                std::string key = "key_" + std::to_string(i % keys);
+                if (map.get(reinterpret_cast<const uint8_t*>(key.data()), key.size(), result)) {
+                    for (uint8_t b : result) {
+                        if (b != static_cast<uint8_t>(result.size() % 251)) { torn++; break; }
+                    }
+                }
+                ++local;
+            }
+            reads += local;
+        });
+    }
+    
+    for (unsigned w = 0; w < writers; ++w) threads[w].join();
+    double ms = t.elapsed_ms();
+    stop.store(true);
+    for (unsigned r = 0; r < readers; ++r) threads[writers + r].join();
+    
+    std::cout << "  Writes: " << std::fixed << std::setprecision(0)
+              << (ops * writers / ms) * 1000.0 << " ops/sec" << std::endl;
+    std::cout << "  Reads:  " << std::fixed << std::setprecision(0)
+              << (reads.load() / ms) * 1000.0 << " ops/sec" << std::endl;
+    std::cout << "  Torn reads: " << torn.load() << std::endl;
 }
 
 void benchmark_queue(size_t ops) {
@@ -118,6 +259,154 @@ void benchmark_queue(size_t ops) {
         std::cout << "  Poll: " << std::fixed << std::setprecision(0) 
                   << t.ops_per_sec(ops) << " ops/sec" << std::endl;
     }
+    
+    // The same elements in batches of 256: one lock round-trip per batch
+    {
+        const size_t batch = 256;
+        std::vector<std::vector<uint8_t>> elements(batch, data);
+        Timer t;
+        for (size_t i = 0; i < ops; i += batch) {
+            queue.offerAll(elements);
+        }
+        std::cout << "  OfferAll: " << std::fixed << std::setprecision(0) 
+                  << t.ops_per_sec(ops) << " ops/sec" << std::endl;
+        
+        std::vector<std::vector<uint8_t>> out;
+        Timer p;
+        for (size_t i = 0; i < ops; i += batch) {
+            out.clear();
+            queue.pollBatch(out, batch);
+        }
+        std::cout << "  PollBatch: " << std::fixed << std::setprecision(0) 
+                  << p.ops_per_sec(ops) << " ops/sec" << std::endl;
+        
+        for (size_t i = 0; i < ops; i += batch) {
+            queue.offerAll(elements);
+        }
+        size_t bytes = 0;
+        Timer d;
+        size_t drained = queue.drainTo([&](const uint8_t*, size_t size) { bytes += size; });
+        std::cout << "  DrainTo (views): " << std::fixed << std::setprecision(0) 
+                  << d.ops_per_sec(drained) << " ops/sec" << std::endl;
+    }
+    
+    // Producers take only the tail lock and consumers only the head lock,
+    // so one side's throughput should hold up however busy the other is
+    {
+        const size_t many = 4;
+        auto run = [&](size_t producers, size_t consumers) {
+            FastQueue split("/tmp/bench_queue_split.fc", 256 * 1024 * 1024, true);
+            size_t per_producer = ops / producers;
+            size_t total = per_producer * producers;
+            std::atomic<size_t> received{0};
+            std::vector<std::thread> workers;
+            Timer t;
+            for (size_t c = 0; c < consumers; ++c) {
+                workers.emplace_back([&]() {
+                    std::vector<uint8_t> result;
+                    while (received.load(std::memory_order_relaxed) < total) {
+                        if (split.poll(result, 10)) received++;
+                    }
+                });
+            }
+            for (size_t p = 0; p < producers; ++p) {
+                workers.emplace_back([&]() {
+                    for (size_t i = 0; i < per_producer; ++i) {
+                        split.offer(data.data(), data.size());
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+            return t.ops_per_sec(total);
+        };
+
+        std::cout << "  1P/" << many << "C transfer: " << std::fixed << std::setprecision(0)
+                  << run(1, many) << " ops/sec" << std::endl;
+        std::cout << "  " << many << "P/1C transfer: " << std::fixed << std::setprecision(0)
+                  << run(many, 1) << " ops/sec" << std::endl;
+    }
+
+    // Ping-pong through two queues: each round trip is two blocked take()
+    // calls woken by an offer from the other thread
+    {
+        FastQueue ping("/tmp/bench_queue_ping.fc", 16 * 1024 * 1024, true);
+        FastQueue pong("/tmp/bench_queue_pong.fc", 16 * 1024 * 1024, true);
+        size_t rounds = std::max<size_t>(1, ops / 100);
+        
+        std::thread echo([&]() {
+            for (size_t i = 0; i < rounds; ++i) {
+                std::vector<uint8_t> msg = ping.take();
+                pong.offer(msg.data(), msg.size());
+            }
+        });
+        Timer t;
+        for (size_t i = 0; i < rounds; ++i) {
+            ping.offer(data.data(), data.size());
+            pong.take();
+        }
+        double us = t.elapsed_ms() * 1000.0 / rounds;
+        echo.join();
+        std::cout << "  Take wakeup round trip: " << std::fixed << std::setprecision(1)
+                  << us << " us" << std::endl;
+    }
+}
+
+void benchmark_ring_queue(size_t ops) {
+    std::cout << "\n=== FastRingQueue Benchmark ===" << std::endl;
+
+    std::vector<uint8_t> data(100, 'R');
+    std::vector<uint8_t> result;
+
+    // Same workload as the FastQueue benchmark, in a ring big enough to hold it
+    {
+        FastRingQueue ring("/tmp/bench_ring.fc", ops, 128, true);
+        Timer t;
+        for (size_t i = 0; i < ops; ++i) {
+            ring.offer(data.data(), data.size());
+        }
+        std::cout << "  Offer: " << std::fixed << std::setprecision(0)
+                  << t.ops_per_sec(ops) << " ops/sec" << std::endl;
+
+        Timer p;
+        for (size_t i = 0; i < ops; ++i) {
+            ring.poll(result);
+        }
+        std::cout << "  Poll: " << std::fixed << std::setprecision(0)
+                  << p.ops_per_sec(ops) << " ops/sec" << std::endl;
+    }
+
+    // Two producers and two consumers streaming through a small ring, which
+    // keeps it alternately full and empty; the same through a FastQueue
+    {
+        const size_t threads = 2;
+        size_t per_thread = ops / threads;
+        FastRingQueue ring("/tmp/bench_ring_mpmc.fc", 1024, 128, true);
+        FastQueue queue("/tmp/bench_ring_queue.fc", 256 * 1024 * 1024, true);
+
+        auto run = [&](auto&& produce, auto&& consume) {
+            std::vector<std::thread> workers;
+            Timer t;
+            for (size_t w = 0; w < threads; ++w) {
+                workers.emplace_back([&]() {
+                    for (size_t i = 0; i < per_thread; ++i) produce();
+                });
+                workers.emplace_back([&]() {
+                    for (size_t i = 0; i < per_thread; ++i) consume();
+                });
+            }
+            for (auto& w : workers) w.join();
+            return t.ops_per_sec(per_thread * threads);
+        };
+
+        double ring_rate = run(
+            [&]() { ring.put(data.data(), data.size()); },
+            [&]() { ring.take(); });
+        double queue_rate = run(
+            [&]() { queue.offer(data.data(), data.size()); },
+            [&]() { queue.take(); });
+        std::cout << "  2P/2C transfer: " << std::fixed << std::setprecision(0)
+                  << ring_rate << " ops/sec (FastQueue: " << queue_rate << ")" << std::endl;
+    }
 }
 
 void benchmark_stack(size_t ops) {
@@ -146,6 +435,48 @@ void benchmark_stack(size_t ops) {
         std::cout << "  Pop: " << std::fixed << std::setprecision(0) 
                   << t.ops_per_sec(ops) << " ops/sec" << std::endl;
     }
+    
+    // The same elements in batches of 256: one CAS on the top per batch
+    {
+        const size_t batch = 256;
+        std::vector<std::tuple<const uint8_t*, size_t, int32_t>> elements(
+            batch, std::make_tuple(data.data(), data.size(), TTL_INFINITE));
+        Timer t;
+        for (size_t i = 0; i < ops; i += batch) {
+            stack.pushAll(elements);
+        }
+        std::cout << "  PushAll: " << std::fixed << std::setprecision(0) 
+                  << t.ops_per_sec(ops) << " ops/sec" << std::endl;
+        
+        std::vector<std::vector<uint8_t>> out;
+        Timer p;
+        for (size_t i = 0; i < ops; i += batch) {
+            out.clear();
+            stack.popAll(out, batch);
+        }
+        std::cout << "  PopAll: " << std::fixed << std::setprecision(0) 
+                  << p.ops_per_sec(ops) << " ops/sec" << std::endl;
+    }
+    
+    // Threads pushing and popping at once: CAS failures back off into the
+    // elimination array, where a push can hand its node straight to a pop
+    for (size_t threads : {4, 8, 16}) {
+        size_t per_thread = ops / threads;
+        std::vector<std::thread> workers;
+        Timer t;
+        for (size_t w = 0; w < threads; ++w) {
+            workers.emplace_back([&]() {
+                std::vector<uint8_t> result;
+                for (size_t i = 0; i < per_thread; ++i) {
+                    stack.push(data.data(), data.size());
+                    stack.pop(result);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        std::cout << "  Push/pop, " << threads << " threads: " << std::fixed << std::setprecision(0)
+                  << t.ops_per_sec(2 * per_thread * threads) << " ops/sec" << std::endl;
+    }
 }
 
 void benchmark_set(size_t ops) {
@@ -176,6 +507,113 @@ void benchmark_set(size_t ops) {
     }
 }
 
+void benchmark_hash(size_t ops) {
+    std::cout << "\n=== Hash Benchmark ===" << std::endl;
+    
+    // Throughput over keys of typical sizes
+    for (size_t key_size : {16, 64, 200}) {
+        std::vector<uint8_t> key(key_size, 'k');
+        volatile uint64_t sink = 0;  // Keeps the hashes from being optimized out
+        
+        Timer fnv;
+        for (size_t i = 0; i < ops; ++i) {
+            key[i % key_size] = static_cast<uint8_t>(i);
+            sink = sink + compute_hash(key.data(), key.size());
+        }
+        double fnv_ops = fnv.ops_per_sec(ops);
+        
+        Timer wy;
+        for (size_t i = 0; i < ops; ++i) {
+            key[i % key_size] = static_cast<uint8_t>(i);
+            sink = sink + compute_hash64(key.data(), key.size());
+        }
+        double wy_ops = wy.ops_per_sec(ops);
+        
+        std::cout << "  " << key_size << "-byte keys: FNV-1a " << std::fixed << std::setprecision(0)
+                  << fnv_ops << " ops/sec, 64-bit " << wy_ops << " ops/sec" << std::endl;
+    }
+    
+    // Chain lengths when the low bits pick one of 16384 buckets, for
+    // sequential keys sharing a long prefix
+    const uint32_t buckets = HashTableHeader::DEFAULT_BUCKET_COUNT;
+    auto chains = [&](const char* name, auto&& hash) {
+        std::vector<uint32_t> counts(buckets, 0);
+        for (size_t i = 0; i < ops; ++i) {
+            std::string key = "tenant:0042:session:" + std::to_string(i);
+            counts[SerializationUtil::bucket_index(
+                hash(reinterpret_cast<const uint8_t*>(key.data()), key.size()), buckets)]++;
+        }
+        
+        double mean = static_cast<double>(ops) / buckets;
+        double variance = 0;
+        uint32_t longest = 0;
+        size_t empty = 0;
+        for (uint32_t c : counts) {
+            variance += (c - mean) * (c - mean);
+            longest = std::max(longest, c);
+            if (c == 0) empty++;
+        }
+        variance /= buckets;
+        
+        // A uniform hash gives a Poisson spread: variance close to the mean
+        std::cout << "  " << name << " chains: mean " << std::setprecision(2) << mean
+                  << ", variance " << variance << ", longest " << longest
+                  << ", empty buckets " << empty << std::endl;
+    };
+    chains("FNV-1a", [](const uint8_t* d, size_t n) { return uint64_t(compute_hash(d, n)); });
+    chains("64-bit", [](const uint8_t* d, size_t n) { return compute_hash64(d, n); });
+}
+
+void benchmark_parallel_sweep(size_t ops) {
+    std::cout << "\n=== Parallel Sweep Benchmark ===" << std::endl;
+    
+    FastMap map("/tmp/bench_map_sweep.fc", 512 * 1024 * 1024, true);
+    FastSet set("/tmp/bench_set_sweep.fc", 256 * 1024 * 1024, true);
+    std::vector<uint8_t> value(100, 'V');
+    for (size_t i = 0; i < ops; ++i) {
+        std::string key = "key_" + std::to_string(i);
+        map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                value.data(), value.size());
+        set.add(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    }
+    
+    // Same sweeps at growing parallelism; retainIf keeps everything, so
+    // each run locks every bucket without changing the set
+    ThreadPool& pool = ThreadPool::instance();
+    size_t saved = pool.parallelism();
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    double base_for_each = 0;
+    double base_retain = 0;
+    
+    for (size_t lanes = 1; ; lanes = std::min(lanes * 2, hardware)) {
+        pool.set_parallelism(lanes);
+        std::atomic<uint64_t> bytes{0};
+        
+        Timer for_each;
+        map.parallelForEach([&](const uint8_t*, size_t, const uint8_t* v, size_t size) {
+            bytes.fetch_add(size + v[0] - 'V', std::memory_order_relaxed);
+            return true;
+        });
+        double for_each_ms = for_each.elapsed_ms();
+        
+        Timer retain;
+        set.parallelRetainIf([](const uint8_t*, size_t) { return true; });
+        double retain_ms = retain.elapsed_ms();
+        
+        if (lanes == 1) {
+            base_for_each = for_each_ms;
+            base_retain = retain_ms;
+        }
+        std::cout << "  " << lanes << " threads: forEach " << std::fixed << std::setprecision(1)
+                  << for_each_ms << " ms (x" << std::setprecision(2) << base_for_each / for_each_ms
+                  << "), retainIf " << std::setprecision(1) << retain_ms << " ms (x"
+                  << std::setprecision(2) << base_retain / retain_ms << ")" << std::endl;
+        
+        if (lanes == hardware) break;
+    }
+    pool.set_parallelism(saved);
+}
+
 int main(int argc, char* argv[]) {
     size_t ops = 100000;
     if (argc > 1) {
@@ -186,11 +624,17 @@ int main(int argc, char* argv[]) {
     std::cout << "Operations per test: " << ops << std::endl;
     std::cout << "Payload size: 100 bytes" << std::endl;
     
+    benchmark_hash(ops);
     benchmark_list(ops);
-    benchmark_map(ops);
+    benchmark_list_readers(ops);
+    benchmark_map(ops, MapEngine::CHAINED);
+    benchmark_map(ops, MapEngine::SWISS);
+    benchmark_map_concurrent(ops, 4, 2);
     benchmark_queue(ops);
+    benchmark_ring_queue(ops);
     benchmark_stack(ops);
     benchmark_set(ops);
+    benchmark_parallel_sweep(ops);
     
     std::cout << "\n=== Benchmark Complete ===" << std::endl;
     return 0;
@@ -11,8 +11,12 @@
 #include <iostream>
 #include <cassert>
 #include <thread>
+#include <atomic>
 #include <chrono>
 #include <cstring>
+#include <string>
+#include <vector>
+#include <random>
 
 using namespace fastcollection;
 
@@ -99,11 +103,12 @@ void test_ttl_expiration() {
     assert(ttl == 0);  // 0 means expired
     
     // Size should report 0 (expired elements don't count)
-    assert(list.size() == 0);
+    assert(list.exactSize() == 0);
     
     // Remove expired
     size_t removed = list.removeExpired();
     assert(removed == 1);
+    assert(list.size() == 0);
     
     std::cout << "  PASSED" << std::endl;
 }
@@ -180,7 +185,274 @@ void test_mixed_ttl() {
     std::this_thread::sleep_for(std::chrono::seconds(2));
     
     // Size should be 2 now
+    assert(list.exactSize() == 2);
     assert(list.size() == 2);
+    assert(list.exactSize() == 2);
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_expiry_index() {
+    std::cout << "Testing expiry index..." << std::endl;
+    
+    const char* path = "/tmp/test_list_expiry.fc";
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    
+    {
+        FastList list(path, 16 * 1024 * 1024, true);
+        
+        // Even elements expire in 1 second, odd ones in a minute
+        for (int i = 0; i < 300; i++) {
+            std::string data = "e" + std::to_string(i);
+            list.add(bytes(data), data.size(), i % 2 == 0 ? 1 : 60);
+        }
+        
+        // Extend, replace with a different size, and remove some due elements
+        assert(list.setTTL(2, 60));
+        std::string replacement = "replacement";
+        assert(list.set(4, bytes(replacement), replacement.size(), TTL_INFINITE));
+        assert(list.remove(6));
+        
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+        
+        assert(list.removeExpired() == 147);
+        assert(list.removeExpired() == 0);
+        assert(list.size() == 152);
+        
+        std::vector<uint8_t> out;
+        assert(list.get(0, out) && std::string(out.begin(), out.end()) == "e1");
+        assert(list.get(1, out) && std::string(out.begin(), out.end()) == "e2");
+        assert(list.get(3, out) && std::string(out.begin(), out.end()) == "replacement");
+        
+        std::string data = "reopen";
+        list.addFirst(bytes(data), data.size(), 1);
+    }
+    
+    // The index lives in the file
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    FastList reopened(path, 16 * 1024 * 1024, false);
+    assert(reopened.removeExpired() == 1);
+    assert(reopened.size() == 152);
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_background_reaper() {
+    std::cout << "Testing background reaper..." << std::endl;
+    
+    const char* path = "/tmp/test_list_reaper.fc";
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    
+    FastList list(path, 16 * 1024 * 1024, true);
+    for (int i = 0; i < 300; i++) {
+        std::string data = "e" + std::to_string(i);
+        list.add(bytes(data), data.size(), i % 3 == 0 ? TTL_INFINITE : 1);
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    
+    assert(list.reapExpired(50) == 50);
+    
+    ReaperConfig config;
+    config.interval_ms = 10;
+    config.batch_size = 25;
+    config.cpu_budget_percent = 50;
+    list.startReaper(config);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    assert(list.isReaping());
+    assert(list.removeExpired() == 0);
+    assert(list.size() == 100);
+    
+    list.stopReaper();
+    assert(!list.isReaping());
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_versioned_set() {
+    std::cout << "Testing version-checked set..." << std::endl;
+    
+    FastList list("/tmp/test_list_versions.fc", 16 * 1024 * 1024, true);
+    
+    std::string a = "alpha", b = "beta", c = "gamma-longer";
+    list.add(reinterpret_cast<const uint8_t*>(a.data()), a.size());
+    list.add(reinterpret_cast<const uint8_t*>(b.data()), b.size());
+    
+    std::vector<uint8_t> out;
+    uint64_t version = 0;
+    assert(list.getWithVersion(0, out, version));
+    assert(std::string(out.begin(), out.end()) == "alpha" && version > 0);
+    
+    // Same-size and resizing updates both need the current version
+    assert(list.setIfVersion(0, reinterpret_cast<const uint8_t*>(c.data()), c.size(), version));
+    assert(!list.setIfVersion(0, reinterpret_cast<const uint8_t*>(a.data()), a.size(), version));
+    assert(list.getWithVersion(0, out, version));
+    assert(std::string(out.begin(), out.end()) == "gamma-longer");
+    
+    // Another element moving into the position is a conflict as well
+    list.addFirst(reinterpret_cast<const uint8_t*>(b.data()), b.size());
+    assert(!list.setIfVersion(0, reinterpret_cast<const uint8_t*>(a.data()), a.size(), version));
+    assert(list.getWithVersion(1, out, version));
+    assert(list.setIfVersion(1, reinterpret_cast<const uint8_t*>(a.data()), a.size(), version));
+    assert(list.get(1, out));
+    assert(std::string(out.begin(), out.end()) == "alpha");
+    
+    assert(!list.getWithVersion(10, out, version));
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent_readers() {
+    std::cout << "Testing concurrent readers..." << std::endl;
+    
+    FastList list("/tmp/test_list_readers.fc", 16 * 1024 * 1024, true);
+    const int count = 500;
+    for (int i = 0; i < count; i++) {
+        std::string s = "item_" + std::to_string(i);
+        list.add(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+    }
+    
+    // Readers walk both ways while a writer appends;
+    // existing positions never move, so every read must see its own item
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&list, &failed]() {
+            std::vector<uint8_t> out;
+            for (int round = 0; round < 20; round++) {
+                for (int i = 0; i < count; i++) {
+                    int index = (round % 2 == 0) ? i : count - 1 - i;
+                    std::string expected = "item_" + std::to_string(index);
+                    if (!list.get(index, out) ||
+                        std::string(out.begin(), out.end()) != expected) {
+                        failed = true;
+                    }
+                }
+                if (list.indexOf(reinterpret_cast<const uint8_t*>("item_42"), 7) != 42) failed = true;
+            }
+        });
+    }
+    threads.emplace_back([&list]() {
+        for (int i = 0; i < 200; i++) {
+            std::string s = "extra_" + std::to_string(i);
+            list.add(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+        }
+    });
+    for (auto& thread : threads) thread.join();
+    assert(!failed);
+    
+    // A removal by another thread shifts later positions for this one
+    std::vector<uint8_t> out;
+    assert(list.get(5, out));
+    std::thread([&list]() { list.remove(0); }).join();
+    assert(list.get(6, out));
+    assert(std::string(out.begin(), out.end()) == "item_7");
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_positional_access() {
+    std::cout << "Testing positional access..." << std::endl;
+    
+    const char* path = "/tmp/test_list_positions.fc";
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    std::vector<std::string> model;
+    
+    auto verify = [&model](FastList& list) {
+        assert(list.size() == model.size());
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < model.size(); i++) {
+            assert(list.get(i, out));
+            assert(std::string(out.begin(), out.end()) == model[i]);
+        }
+        assert(!list.get(model.size(), out));
+    };
+    
+    {
+        FastList list(path, 64 * 1024 * 1024, true);
+        for (int i = 0; i < 5000; i++) {
+            std::string s = "base_" + std::to_string(i);
+            list.add(bytes(s), s.size());
+            model.push_back(s);
+        }
+        verify(list);
+        
+        // Random edits anywhere in the list, mirrored in a vector
+        std::mt19937 rng(42);
+        std::vector<uint8_t> out;
+        for (int op = 0; op < 20000; op++) {
+            std::string s = "v" + std::to_string(op) + std::string(rng() % 24, 'x');
+            size_t index = model.empty() ? 0 : rng() % model.size();
+            switch (rng() % 7) {
+                case 0:
+                    index = model.empty() ? 0 : rng() % (model.size() + 1);
+                    assert(list.add(index, bytes(s), s.size()));
+                    model.insert(model.begin() + index, s);
+                    break;
+                case 1:
+                    if (model.empty()) break;
+                    assert(list.remove(index, &out));
+                    assert(std::string(out.begin(), out.end()) == model[index]);
+                    model.erase(model.begin() + index);
+                    break;
+                case 2:
+                    // Sizes vary, so some sets swap in a new node
+                    if (model.empty()) break;
+                    assert(list.set(index, bytes(s), s.size()));
+                    model[index] = s;
+                    break;
+                case 3:
+                    list.addFirst(bytes(s), s.size());
+                    model.insert(model.begin(), s);
+                    break;
+                case 4:
+                    if (model.empty()) break;
+                    assert(list.removeLast(&out));
+                    model.pop_back();
+                    break;
+                case 5:
+                    if (model.empty()) break;
+                    assert(list.removeElement(bytes(model[index]), model[index].size()));
+                    model.erase(model.begin() + index);
+                    break;
+                default:
+                    if (model.empty()) break;
+                    assert(list.get(index, out));
+                    assert(std::string(out.begin(), out.end()) == model[index]);
+                    break;
+            }
+        }
+        verify(list);
+        
+        // Drain from the front, then refill from both ends
+        while (model.size() > 100) {
+            assert(list.removeFirst());
+            model.erase(model.begin());
+        }
+        for (int i = 0; i < 1000; i++) {
+            std::string s = "end_" + std::to_string(i);
+            if (i % 2 == 0) {
+                list.add(bytes(s), s.size());
+                model.push_back(s);
+            } else {
+                list.addFirst(bytes(s), s.size());
+                model.insert(model.begin(), s);
+            }
+        }
+        verify(list);
+    }
+    
+    // The index lives in the file
+    FastList reopened(path, 64 * 1024 * 1024, false);
+    verify(reopened);
+    
+    reopened.clear();
+    model.clear();
+    verify(reopened);
+    std::string s = "after_clear";
+    assert(reopened.add(0, bytes(s), s.size()));
+    model.push_back(s);
+    verify(reopened);
     
     std::cout << "  PASSED" << std::endl;
 }
@@ -196,6 +468,11 @@ int main() {
         test_ttl_update();
         test_persistence();
         test_mixed_ttl();
+        test_expiry_index();
+        test_background_reaper();
+        test_versioned_set();
+        test_concurrent_readers();
+        test_positional_access();
         
         std::cout << "\n=== All tests PASSED ===" << std::endl;
         return 0;
@@ -12,6 +12,12 @@
 #include <cassert>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <set>
 
 using namespace fastcollection;
 
@@ -90,6 +96,1351 @@ void test_put_if_absent() {
     std::cout << "  PASSED" << std::endl;
 }
 
+void test_incremental_rehash() {
+    std::cout << "Testing incremental rehash..." << std::endl;
+    
+    const int count = 5000;
+    auto key_of = [](int i) { return "key" + std::to_string(i); };
+    
+    {
+        // Start tiny so the table has to double many times
+        FastMap map("/tmp/test_map_rehash.fc", 32 * 1024 * 1024, true, 16);
+        
+        std::atomic<bool> done{false};
+        std::atomic<int> published{0};
+        std::thread reader([&]() {
+            std::vector<uint8_t> out;
+            while (!done.load()) {
+                int n = published.load();
+                for (int i = 0; i < n; i += 7) {
+                    std::string key = key_of(i);
+                    assert(map.get(reinterpret_cast<const uint8_t*>(key.data()), key.size(), out));
+                }
+            }
+        });
+        
+        for (int i = 0; i < count; i++) {
+            std::string key = key_of(i);
+            std::string value = "value" + std::to_string(i);
+            assert(map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                           reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+            published.store(i + 1);
+        }
+        done.store(true);
+        reader.join();
+        
+        assert(map.size() == static_cast<size_t>(count));
+        for (int i = 0; i < count; i += 2) {
+            std::string key = key_of(i);
+            assert(map.remove(reinterpret_cast<const uint8_t*>(key.data()), key.size()));
+        }
+        assert(map.size() == static_cast<size_t>(count / 2));
+    }
+    
+    // Reopen: the grown table must be found again
+    FastMap map("/tmp/test_map_rehash.fc", 32 * 1024 * 1024, false, 16);
+    assert(map.size() == static_cast<size_t>(count / 2));
+    
+    std::vector<uint8_t> out;
+    for (int i = 0; i < count; i++) {
+        std::string key = key_of(i);
+        bool found = map.get(reinterpret_cast<const uint8_t*>(key.data()), key.size(), out);
+        assert(found == (i % 2 == 1));
+        if (found) {
+            assert(std::string(out.begin(), out.end()) == "value" + std::to_string(i));
+        }
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_scan_cursor() {
+    std::cout << "Testing scan cursor..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        // Few buckets, so the writes between steps keep resizing the table
+        FastMap map("/tmp/test_map_scan.fc", 32 * 1024 * 1024, true, 16, engine);
+        
+        const int initial = 2000;
+        for (int i = 0; i < initial; i++) {
+            auto key = bytes("key" + std::to_string(i));
+            auto value = bytes("value" + std::to_string(i));
+            map.put(key.data(), key.size(), value.data(), value.size());
+        }
+        
+        std::set<std::string> seen;
+        std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> batch;
+        uint64_t cursor = 0;
+        int steps = 0;
+        int added = 0;
+        do {
+            cursor = map.scan(cursor, 50, batch);
+            assert(batch.size() <= 50 + 64);  // Bounded by count plus one chain or probe run
+            for (const auto& [key, value] : batch) {
+                std::string k(key.begin(), key.end());
+                if (k.rfind("key", 0) == 0) {
+                    assert(std::string(value.begin(), value.end()) == "value" + k.substr(3));
+                }
+                seen.insert(k);
+            }
+            
+            // Grow the table between steps; the cursor must survive it
+            for (int i = 0; i < 100; i++) {
+                auto key = bytes("extra" + std::to_string(added++));
+                map.put(key.data(), key.size(), key.data(), key.size());
+            }
+            steps++;
+        } while (cursor != 0);
+        
+        assert(steps > 1);
+        for (int i = 0; i < initial; i++) {
+            assert(seen.count("key" + std::to_string(i)) == 1);
+        }
+        
+        // A scan of an unchanging map returns every entry exactly once
+        size_t total = 0;
+        cursor = 0;
+        do {
+            cursor = map.scan(cursor, 100, batch);
+            total += batch.size();
+        } while (cursor != 0);
+        assert(total == map.size());
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_swiss_engine() {
+    std::cout << "Testing swiss engine..." << std::endl;
+    
+    const int count = 3000;
+    auto key_of = [](int i) { return "key" + std::to_string(i); };
+    
+    {
+        // Small initial table forces several rehashes
+        FastMap map("/tmp/test_map_swiss.fc", 32 * 1024 * 1024, true, 16, MapEngine::SWISS);
+        assert(map.engine() == MapEngine::SWISS);
+        
+        for (int i = 0; i < count; i++) {
+            std::string key = key_of(i);
+            std::string value = "value" + std::to_string(i);
+            assert(map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                           reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+        }
+        assert(map.size() == static_cast<size_t>(count));
+        
+        // Overwrite with a different-sized value
+        std::string key = key_of(1);
+        std::string longer = "a much longer replacement value";
+        assert(map.replace(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                           reinterpret_cast<const uint8_t*>(longer.data()), longer.size()));
+        
+        std::string absent = "absent";
+        assert(!map.putIfAbsent(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                                reinterpret_cast<const uint8_t*>(absent.data()), absent.size()));
+        
+        // Remove every even key, leaving tombstones behind
+        for (int i = 0; i < count; i += 2) {
+            std::string k = key_of(i);
+            assert(map.remove(reinterpret_cast<const uint8_t*>(k.data()), k.size()));
+        }
+        assert(map.size() == static_cast<size_t>(count / 2));
+        
+        // Expired entries are invisible and swept by removeExpired
+        std::string temp = "temp";
+        assert(map.put(reinterpret_cast<const uint8_t*>(temp.data()), temp.size(),
+                       reinterpret_cast<const uint8_t*>(temp.data()), temp.size(), 0));
+        assert(!map.containsKey(reinterpret_cast<const uint8_t*>(temp.data()), temp.size()));
+        assert(map.removeExpired() == 1);
+    }
+    
+    // Reopen: the engine is detected from the file regardless of the argument
+    FastMap map("/tmp/test_map_swiss.fc", 32 * 1024 * 1024, false);
+    assert(map.engine() == MapEngine::SWISS);
+    assert(map.size() == static_cast<size_t>(count / 2));
+    
+    std::vector<uint8_t> out;
+    for (int i = 0; i < count; i++) {
+        std::string key = key_of(i);
+        bool found = map.get(reinterpret_cast<const uint8_t*>(key.data()), key.size(), out);
+        assert(found == (i % 2 == 1));
+    }
+    std::string key = key_of(1);
+    map.get(reinterpret_cast<const uint8_t*>(key.data()), key.size(), out);
+    assert(std::string(out.begin(), out.end()) == "a much longer replacement value");
+    
+    map.clear();
+    assert(map.isEmpty());
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent_readers() {
+    std::cout << "Testing lock-free reads under concurrent writes..." << std::endl;
+    
+    FastMap map("/tmp/test_map_epoch.fc", 64 * 1024 * 1024, true, 16);
+    const int keys = 16;
+    
+    // Each value is filled with its own length, so a read of freed or
+    // half-written memory shows up as a mismatched byte
+    auto write = [&map](int k, size_t len) {
+        std::string key = "key" + std::to_string(k);
+        std::vector<uint8_t> value(len, static_cast<uint8_t>(len % 251));
+        map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(), value.data(), value.size());
+    };
+    for (int k = 0; k < keys; k++) write(k, 8);
+    
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> torn{0};
+    std::vector<std::thread> threads;
+    
+    for (int r = 0; r < 4; r++) {
+        threads.emplace_back([&, r]() {
+            std::vector<uint8_t> out;
+            for (int i = r; !stop.load(std::memory_order_relaxed); i++) {
+                std::string key = "key" + std::to_string(i % keys);
+                if (!map.get(reinterpret_cast<const uint8_t*>(key.data()), key.size(), out)) continue;
+                for (uint8_t b : out) {
+                    if (b != static_cast<uint8_t>(out.size() % 251)) { torn++; break; }
+                }
+            }
+        });
+    }
+    for (int w = 0; w < 2; w++) {
+        threads.emplace_back([&, w]() {
+            for (int i = 0; i < 40000; i++) {
+                int k = (i * 7 + w) % keys;
+                if (i % 5 == 0) {
+                    std::string key = "key" + std::to_string(k);
+                    map.remove(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+                } else {
+                    write(k, 8 + (i % 2000));
+                }
+            }
+        });
+    }
+    
+    threads[4].join();
+    threads[5].join();
+    stop.store(true);
+    for (int r = 0; r < 4; r++) threads[r].join();
+    
+    assert(torn.load() == 0);
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent_resize() {
+    std::cout << "Testing concurrent writers across resizes..." << std::endl;
+    
+    // A tiny initial table resizes many times in quick succession, so
+    // writers often route through an array that was just replaced
+    FastMap map("/tmp/test_map_resize.fc", 64 * 1024 * 1024, true, 16);
+    const int per_thread = 3000;
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&map, t]() {
+            for (int i = 0; i < 4 * per_thread; i++) {
+                std::string key = std::to_string(t) + "_" + std::to_string(i % per_thread);
+                map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                        reinterpret_cast<const uint8_t*>(key.data()), key.size());
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    
+    assert(map.size() == 4 * per_thread);
+    assert(map.exactSize() == 4 * per_thread);
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_nested_iteration() {
+    std::cout << "Testing iteration with nested reads and writes..." << std::endl;
+    
+    const int count = 200;
+    
+    // A tiny table resizes while the outer sweep is running; the callback
+    // iterates again and writes, so no sweep lock may be held around it
+    FastMap map("/tmp/test_map_nested.fc", 32 * 1024 * 1024, true, 16);
+    for (int i = 0; i < count; i++) {
+        std::string key = "key" + std::to_string(i);
+        map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    }
+    
+    std::multiset<std::string> seen;
+    int extra = 0;
+    map.forEach([&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+        std::string k(reinterpret_cast<const char*>(key), key_size);
+        if (k.compare(0, 3, "key") != 0) return true;
+        seen.insert(k);
+        
+        assert(map.keySet().size() >= static_cast<size_t>(count));
+        for (int i = 0; i < 20; i++) {
+            std::string added = "extra" + std::to_string(extra++);
+            map.put(reinterpret_cast<const uint8_t*>(added.data()), added.size(),
+                    reinterpret_cast<const uint8_t*>(added.data()), added.size());
+        }
+        return true;
+    });
+    
+    // Every key present throughout is visited exactly once across the resizes
+    assert(seen.size() == static_cast<size_t>(count));
+    assert(std::set<std::string>(seen.begin(), seen.end()).size() == static_cast<size_t>(count));
+    assert(map.size() == static_cast<size_t>(count + extra));
+    
+    FastSet set("/tmp/test_set_nested.fc", 32 * 1024 * 1024, true, 16);
+    for (int i = 0; i < count; i++) {
+        std::string element = "element" + std::to_string(i);
+        set.add(reinterpret_cast<const uint8_t*>(element.data()), element.size());
+    }
+    
+    size_t visited = 0;
+    set.forEach([&](const uint8_t* data, size_t size) {
+        if (std::string(reinterpret_cast<const char*>(data), size).compare(0, 7, "element") != 0) {
+            return true;
+        }
+        visited++;
+        assert(set.toArray().size() >= static_cast<size_t>(count));
+        std::string added = "added" + std::to_string(visited);
+        set.add(reinterpret_cast<const uint8_t*>(added.data()), added.size());
+        return true;
+    });
+    assert(visited == static_cast<size_t>(count));
+    assert(set.size() == static_cast<size_t>(2 * count));
+    
+    // Removing elements ahead of the sweep and adding new ones of the same
+    // size must not hand a removed element's block back to the sweep
+    FastSet churn("/tmp/test_set_churn.fc", 32 * 1024 * 1024, true, 1024);
+    std::set<std::string> pending;
+    for (int i = 0; i < 200; i++) {
+        std::string element = "key" + std::to_string(1000 + i);
+        churn.add(reinterpret_cast<const uint8_t*>(element.data()), element.size());
+        pending.insert(element);
+    }
+    
+    std::vector<std::string> swept;
+    int fresh = 0;
+    churn.forEach([&](const uint8_t* data, size_t size) {
+        std::string element(reinterpret_cast<const char*>(data), size);
+        swept.push_back(element);
+        pending.erase(element);
+        if (!pending.empty()) {
+            std::string ahead = *pending.rbegin();
+            pending.erase(ahead);
+            assert(churn.remove(reinterpret_cast<const uint8_t*>(ahead.data()), ahead.size()));
+            std::string added = "new" + std::to_string(1000 + fresh++);
+            churn.add(reinterpret_cast<const uint8_t*>(added.data()), added.size());
+        }
+        return true;
+    });
+    assert(std::set<std::string>(swept.begin(), swept.end()).size() == swept.size());
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_many_readers() {
+    std::cout << "Testing more concurrent readers than epoch slots..." << std::endl;
+    
+    const char* path = "/tmp/test_map_readers.fc";
+    const int readers = EpochHeader::MAX_READERS + 40;
+    {
+        FastMap map(path, 16 * 1024 * 1024, true, 64);
+        std::string key = "key";
+        map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                reinterpret_cast<const uint8_t*>(key.data()), key.size());
+        
+        // Every reader stays inside its read section until all have entered
+        std::atomic<int> inside{0};
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; r++) {
+            threads.emplace_back([&]() {
+                map.forEach([&](const uint8_t*, size_t, const uint8_t*, size_t) {
+                    inside++;
+                    while (inside.load() < readers) std::this_thread::yield();
+                    return true;
+                });
+            });
+        }
+        for (auto& t : threads) t.join();
+        assert(inside.load() == readers);
+        
+        // Slots are handed back as sections end, so new threads still read
+        for (int r = 0; r < readers; r++) {
+            std::thread([&]() {
+                assert(map.containsKey(reinterpret_cast<const uint8_t*>(key.data()), key.size()));
+            }).join();
+        }
+    }
+    
+    MMapFileManager file(path, 16 * 1024 * 1024, false);
+    EpochHeader* epoch = file.find<EpochHeader>("map_epoch_domain").first;
+    for (uint32_t i = 0; i < EpochHeader::LIMBO_LISTS; i++) {
+        assert(epoch->overflow[i].load() == 0);
+    }
+    for (uint32_t i = 0; i < EpochHeader::MAX_READERS; i++) {
+        assert(epoch->slots[i].owner.load() == 0);
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_writes_from_callbacks() {
+    std::cout << "Testing writes from iteration callbacks..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        FastMap map("/tmp/test_map_callback_writes.fc", 32 * 1024 * 1024, true, 64, engine);
+        for (int i = 0; i < 500; i++) {
+            std::string key = "key" + std::to_string(i);
+            map.put(bytes(key), key.size(), bytes(key), key.size());
+        }
+        
+        // Each sweep writes the map it is iterating
+        size_t visited = 0;
+        map.forEach([&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+            std::string name(reinterpret_cast<const char*>(key), key_size);
+            if (name.compare(0, 5, "copy_") == 0) return true;
+            std::string copy = "copy_" + name;
+            map.put(bytes(copy), copy.size(), bytes(copy), copy.size());
+            visited++;
+            return true;
+        });
+        assert(visited == 500);
+        assert(map.size() == 1000);
+        
+        map.forEachWithTTL([&](const uint8_t* key, size_t key_size, const uint8_t*, size_t,
+                               int64_t ttl) {
+            assert(ttl == -1);
+            std::string name(reinterpret_cast<const char*>(key), key_size);
+            if (name.compare(0, 5, "copy_") == 0) map.remove(key, key_size);
+            return true;
+        });
+        assert(map.size() == 500);
+        
+        std::atomic<size_t> updated{0};
+        map.parallelForEach([&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+            std::string value = "updated";
+            map.put(key, key_size, bytes(value), value.size());
+            updated++;
+            return true;
+        });
+        assert(updated.load() == 500);
+        
+        std::string value = "updated";
+        assert(map.containsValue(bytes(value), value.size()));
+        value = "key7";
+        assert(!map.containsValue(bytes(value), value.size()));
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_constant_time_size() {
+    std::cout << "Testing constant-time size..." << std::endl;
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        const char* path = "/tmp/test_map_size.fc";
+        {
+            FastMap map(path, 16 * 1024 * 1024, true, 1024, engine);
+            
+            for (int i = 0; i < 100; i++) {
+                std::string key = "perm_" + std::to_string(i);
+                map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                        reinterpret_cast<const uint8_t*>(key.data()), key.size());
+            }
+            for (int i = 0; i < 10; i++) {
+                std::string key = "temp_" + std::to_string(i);
+                map.put(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+                        reinterpret_cast<const uint8_t*>(key.data()), key.size(), 1);
+            }
+            
+            // Shortening a TTL must lower the expiry bound too
+            std::string key = "perm_0";
+            assert(map.setTTL(reinterpret_cast<const uint8_t*>(key.data()), key.size(), 1));
+            
+            assert(map.size() == 110);
+            assert(map.exactSize() == 110);
+            
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            
+            assert(map.exactSize() == 99);
+            assert(map.size() == 99);
+            assert(!map.isEmpty());
+            
+            // size() only reads, so it works inside a callback and leaves
+            // the reaping to removeExpired()
+            size_t seen = 0;
+            map.forEach([&](const uint8_t*, size_t, const uint8_t*, size_t) {
+                assert(map.size() == 99);
+                return ++seen < 5;
+            });
+            assert(seen == 5);
+            assert(map.removeExpired() == 11);
+            assert(map.size() == 99);
+        }
+        
+        // The count lives in the file
+        FastMap reopened(path, 16 * 1024 * 1024, false);
+        assert(reopened.size() == 99);
+        assert(reopened.exactSize() == 99);
+        
+        reopened.clear();
+        assert(reopened.isEmpty());
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_size_after_ttl_changes() {
+    std::cout << "Testing size after TTL changes..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    const std::string a = "a";
+    const std::string b = "b";
+    
+    // A key whose short TTL was dropped must not be discounted when that
+    // TTL runs out, nor hide another key
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        FastMap removed("/tmp/test_map_size_removed.fc", 16 * 1024 * 1024, true, 1024, engine);
+        removed.put(bytes(a), a.size(), bytes(a), a.size(), 1);
+        assert(removed.remove(bytes(a), a.size()));
+        removed.put(bytes(b), b.size(), bytes(b), b.size());
+        
+        FastMap overwritten("/tmp/test_map_size_overwritten.fc", 16 * 1024 * 1024, true, 1024,
+                            engine);
+        overwritten.put(bytes(a), a.size(), bytes(a), a.size(), 1);
+        overwritten.put(bytes(a), a.size(), bytes(a), a.size());
+        overwritten.put(bytes(b), b.size(), bytes(b), b.size());
+        
+        FastMap extended("/tmp/test_map_size_extended.fc", 16 * 1024 * 1024, true, 1024, engine);
+        extended.put(bytes(a), a.size(), bytes(a), a.size(), 1);
+        assert(extended.setTTL(bytes(a), a.size(), 60));
+        
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+        
+        assert(removed.size() == 1);
+        assert(!removed.isEmpty());
+        assert(overwritten.size() == 2);
+        assert(extended.size() == 1);
+        assert(removed.removeExpired() == 0);
+        assert(overwritten.removeExpired() == 0);
+        assert(extended.removeExpired() == 0);
+    }
+    
+    FastSet set("/tmp/test_set_size_removed.fc", 16 * 1024 * 1024, true, 1024);
+    set.add(bytes(a), a.size(), 1);
+    assert(set.remove(bytes(a), a.size()));
+    set.add(bytes(b), b.size());
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    assert(set.size() == 1);
+    assert(!set.isEmpty());
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_batch_operations() {
+    std::cout << "Testing multiGet/multiPut/multiRemove..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        // Few buckets so the batch also drives an incremental resize
+        FastMap map("/tmp/test_map_batch.fc", 16 * 1024 * 1024, true, 16, engine);
+        
+        std::vector<std::vector<uint8_t>> keys;
+        std::vector<std::vector<uint8_t>> values;
+        for (int i = 0; i < 500; i++) {
+            keys.push_back(bytes("key_" + std::to_string(i)));
+            values.push_back(bytes("value_" + std::to_string(i)));
+        }
+        // A repeated key keeps the last value
+        keys.push_back(bytes("key_7"));
+        values.push_back(bytes("latest"));
+        
+        assert(map.multiPut(keys, values) == 501);
+        assert(map.size() == 500);
+        
+        std::vector<std::vector<uint8_t>> lookup = {
+            bytes("key_0"), bytes("missing"), bytes("key_7"), {}, bytes("key_499")
+        };
+        auto found = map.multiGet(lookup);
+        assert(found.size() == lookup.size());
+        assert(found[0] && *found[0] == bytes("value_0"));
+        assert(!found[1]);
+        assert(found[2] && *found[2] == bytes("latest"));
+        assert(!found[3]);
+        assert(found[4] && *found[4] == bytes("value_499"));
+        
+        std::vector<std::vector<uint8_t>> doomed(keys.begin(), keys.begin() + 250);
+        doomed.push_back(bytes("missing"));
+        assert(map.multiRemove(doomed) == 250);
+        assert(map.size() == 250);
+        
+        auto after = map.multiGet(keys);
+        for (size_t i = 0; i < 500; i++) {
+            assert(static_cast<bool>(after[i]) == (i >= 250));
+        }
+        
+        bool threw = false;
+        try {
+            map.multiPut(keys, {});
+        } catch (const FastCollectionException&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_get_with() {
+    std::cout << "Testing zero-copy getWith..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        FastMap map("/tmp/test_map_get_with.fc", 16 * 1024 * 1024, true, 64, engine);
+        
+        auto key = bytes("key");
+        auto value = bytes("a value read in place");
+        assert(map.put(key.data(), key.size(), value.data(), value.size()));
+        
+        const uint8_t* first = nullptr;
+        std::vector<uint8_t> seen;
+        assert(map.getWith(key.data(), key.size(), [&](const uint8_t* data, size_t size) {
+            first = data;
+            seen.assign(data, data + size);
+        }));
+        assert(seen == value);
+        
+        // Repeated reads see the same mapped bytes rather than fresh copies
+        const uint8_t* second = nullptr;
+        assert(map.getWith(key.data(), key.size(), [&](const uint8_t* data, size_t) {
+            second = data;
+        }));
+        assert(first == second);
+        
+        auto missing = bytes("missing");
+        bool called = false;
+        assert(!map.getWith(missing.data(), missing.size(), [&](const uint8_t*, size_t) {
+            called = true;
+        }));
+        assert(!called);
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_cache_mode() {
+    std::cout << "Testing cache mode eviction..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+    auto put = [&](FastMap& map, const std::string& k, const std::string& v) {
+        auto key = bytes(k);
+        auto value = bytes(v);
+        return map.put(key.data(), key.size(), value.data(), value.size());
+    };
+    auto contains = [&](FastMap& map, const std::string& k) {
+        auto key = bytes(k);
+        return map.containsKey(key.data(), key.size());
+    };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        // CLOCK with an entry budget: recently read keys survive
+        {
+            CacheConfig config;
+            config.max_entries = 100;
+            FastMap map("/tmp/test_map_cache.fc", 16 * 1024 * 1024, true, 64, engine, config);
+            
+            for (int i = 0; i < 100; i++) {
+                assert(put(map, "key_" + std::to_string(i), "value"));
+            }
+            std::vector<uint8_t> out;
+            for (int i = 0; i < 50; i++) {
+                auto key = bytes("key_" + std::to_string(i));
+                assert(map.get(key.data(), key.size(), out));
+            }
+            for (int i = 100; i < 150; i++) {
+                assert(put(map, "key_" + std::to_string(i), "value"));
+            }
+            
+            assert(map.size() == 100);
+            assert(map.stats().eviction_count == 50);
+            for (int i = 0; i < 50; i++) {
+                assert(contains(map, "key_" + std::to_string(i)));
+            }
+        }
+        
+        // Reopening keeps the budget and policy chosen at creation
+        {
+            FastMap map("/tmp/test_map_cache.fc", 16 * 1024 * 1024, false);
+            assert(map.cacheConfig().max_entries == 100);
+            assert(map.cacheConfig().policy == EvictionPolicy::CLOCK);
+            assert(put(map, "one_more", "value"));
+            assert(map.size() == 100);
+        }
+        
+        // Byte budget: stored entries never add up to more than max_bytes
+        {
+            CacheConfig config;
+            config.max_bytes = 64 * 1024;
+            FastMap map("/tmp/test_map_cache_bytes.fc", 16 * 1024 * 1024, true, 64, engine, config);
+            
+            std::string value(512, 'v');
+            for (int i = 0; i < 500; i++) {
+                put(map, "key_" + std::to_string(i), value);
+            }
+            
+            size_t stored = 0;
+            map.forEach([&](const uint8_t*, size_t key_size, const uint8_t*, size_t value_size) {
+                stored += ShmKeyValue::total_size(key_size, value_size);
+                return true;
+            });
+            assert(stored > 0 && stored <= config.max_bytes);
+            assert(map.stats().eviction_count > 0);
+        }
+        
+        // TinyLFU: a one-off scan does not displace frequently read keys
+        {
+            CacheConfig config;
+            config.max_entries = 100;
+            config.policy = EvictionPolicy::TINY_LFU;
+            FastMap map("/tmp/test_map_cache_lfu.fc", 16 * 1024 * 1024, true, 64, engine, config);
+            
+            std::vector<uint8_t> out;
+            for (int i = 0; i < 100; i++) {
+                assert(put(map, "hot_" + std::to_string(i), "value"));
+            }
+            for (int round = 0; round < 5; round++) {
+                for (int i = 0; i < 100; i++) {
+                    auto key = bytes("hot_" + std::to_string(i));
+                    assert(map.get(key.data(), key.size(), out));
+                }
+            }
+            for (int i = 0; i < 1000; i++) {
+                put(map, "scan_" + std::to_string(i), "value");
+            }
+            
+            size_t hot = 0;
+            for (int i = 0; i < 100; i++) {
+                if (contains(map, "hot_" + std::to_string(i))) hot++;
+            }
+            assert(hot >= 90);
+            assert(map.size() == 100);
+            assert(map.stats().rejection_count > 0);
+            assert(map.stats().hit_count == 500);
+        }
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_expiry_index() {
+    std::cout << "Testing expiry index..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        const char* path = "/tmp/test_map_expiry.fc";
+        {
+            FastMap map(path, 16 * 1024 * 1024, true, 1024, engine);
+            
+            for (int i = 0; i < 1000; i++) {
+                std::string key = "perm_" + std::to_string(i);
+                map.put(bytes(key), key.size(), bytes(key), key.size());
+            }
+            for (int i = 0; i < 50; i++) {
+                std::string key = "temp_" + std::to_string(i);
+                map.put(bytes(key), key.size(), bytes(key), key.size(), 1);
+            }
+            
+            // Entries whose due records went stale before they were popped
+            for (int i = 0; i < 10; i++) {
+                std::string key = "extended_" + std::to_string(i);
+                map.put(bytes(key), key.size(), bytes(key), key.size(), 1);
+                assert(map.setTTL(bytes(key), key.size(), 60));
+                
+                key = "overwritten_" + std::to_string(i);
+                map.put(bytes(key), key.size(), bytes(key), key.size(), 1);
+                map.put(bytes(key), key.size(), bytes(key), key.size());
+                
+                key = "removed_" + std::to_string(i);
+                map.put(bytes(key), key.size(), bytes(key), key.size(), 1);
+                assert(map.remove(bytes(key), key.size()));
+            }
+            
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            
+            assert(map.size() == 1020);
+            assert(map.removeExpired() == 50);
+            assert(map.removeExpired() == 0);
+            assert(map.size() == 1020);
+            
+            std::string key = "extended_3";
+            assert(map.containsKey(bytes(key), key.size()));
+            key = "overwritten_7";
+            assert(map.getTTL(bytes(key), key.size()) == -1);
+            
+            // The index restarts empty after clear
+            map.clear();
+            key = "after_clear";
+            map.put(bytes(key), key.size(), bytes(key), key.size(), 0);
+            assert(map.removeExpired() == 1);
+            
+            key = "reopen";
+            map.put(bytes(key), key.size(), bytes(key), key.size(), 1);
+        }
+        
+        // The index lives in the file
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+        FastMap reopened(path, 16 * 1024 * 1024, false);
+        assert(reopened.removeExpired() == 1);
+        assert(reopened.isEmpty());
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_background_reaper() {
+    std::cout << "Testing background reaper..." << std::endl;
+    
+    const char* path = "/tmp/test_map_reaper.fc";
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    auto wait_for = [](const std::function<bool()>& done) {
+        for (int i = 0; i < 200 && !done(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return done();
+    };
+    
+    FastMap map(path, 16 * 1024 * 1024, true, 4096);
+    for (int i = 0; i < 500; i++) {
+        std::string key = "temp_" + std::to_string(i);
+        map.put(bytes(key), key.size(), bytes(key), key.size(), 0);
+    }
+    for (int i = 0; i < 100; i++) {
+        std::string key = "perm_" + std::to_string(i);
+        map.put(bytes(key), key.size(), bytes(key), key.size());
+    }
+    
+    // A step takes whole buckets, so it may overshoot the limit a little
+    size_t removed = map.reapExpired(100);
+    assert(removed >= 100 && removed < 200);
+    
+    ReaperConfig config;
+    config.interval_ms = 10;
+    config.batch_size = 50;
+    config.cpu_budget_percent = 50;
+    
+    // Two handles on one file: only one of them reaps
+    FastMap other(path, 16 * 1024 * 1024, false);
+    map.startReaper(config);
+    assert(wait_for([&] { return map.isReaping(); }));
+    other.startReaper(config);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!other.isReaping());
+    
+    // The whole backlog goes without anyone calling removeExpired()
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    assert(other.removeExpired() == 0);
+    assert(map.size() == 100);
+    
+    // Stopping hands the file over
+    map.stopReaper();
+    assert(!map.isReaping());
+    assert(wait_for([&] { return other.isReaping(); }));
+    
+    std::string key = "late";
+    map.put(bytes(key), key.size(), bytes(key), key.size(), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(map.removeExpired() == 0);
+    assert(!map.containsKey(bytes(key), key.size()));
+    
+    // Moving a map stops its reaper
+    FastMap moved = std::move(other);
+    assert(!moved.isReaping());
+    
+    config.cpu_budget_percent = 0;
+    bool threw = false;
+    try {
+        map.startReaper(config);
+    } catch (const FastCollectionException&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_hash_algorithms() {
+    std::cout << "Testing hash algorithms..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    
+    // Every length takes a different path through compute_hash64
+    std::string text(128, 'a');
+    std::vector<uint64_t> seen;
+    for (size_t n = 0; n <= text.size(); n++) {
+        uint64_t hash = compute_hash64(bytes(text), n);
+        assert(hash == compute_hash64(bytes(text), n));
+        seen.push_back(hash);
+    }
+    std::sort(seen.begin(), seen.end());
+    assert(std::unique(seen.begin(), seen.end()) == seen.end());
+    
+    // Entries of FNV-1a files may hold anything in the high half
+    ShmEntry entry;
+    entry.set_hash(0x1234567890ABCDEFull);
+    assert(Hasher(HashAlgorithm::WYHASH_64).matches(entry, 0x1234567890ABCDEFull));
+    assert(!Hasher(HashAlgorithm::WYHASH_64).matches(entry, 0x0000000090ABCDEFull));
+    assert(Hasher(HashAlgorithm::FNV1A_32).matches(entry, 0x0000000090ABCDEFull));
+    
+    const char* path = "/tmp/test_map_hash.fc";
+    for (HashAlgorithm algo : {HashAlgorithm::FNV1A_32, HashAlgorithm::WYHASH_64}) {
+        {
+            // Stand in for a file whose algorithm was recorded earlier
+            MMapFileManager file(path, 16 * 1024 * 1024, true);
+            file.find_or_construct<HashHeader>("map_hash", algo);
+        }
+        {
+            FastMap map(path, 16 * 1024 * 1024, false, 64);
+            for (int i = 0; i < 500; i++) {
+                std::string key = "key_" + std::to_string(i);
+                assert(map.put(bytes(key), key.size(), bytes(key), key.size()));
+            }
+            std::string key = "key_7";
+            assert(map.remove(bytes(key), key.size()));
+        }
+        
+        FastMap reopened(path, 16 * 1024 * 1024, false);
+        assert(reopened.size() == 499);
+        for (int i = 0; i < 500; i++) {
+            std::string key = "key_" + std::to_string(i);
+            std::vector<uint8_t> value;
+            assert(reopened.get(bytes(key), key.size(), value) == (i != 7));
+        }
+        
+        MMapFileManager file(path, 16 * 1024 * 1024, false);
+        assert(file.find<HashHeader>("map_hash").first->algorithm == static_cast<uint32_t>(algo));
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_atomic_counters() {
+    std::cout << "Testing atomic counters..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        FastMap map("/tmp/test_map_counters.fc", 16 * 1024 * 1024, true, 64, engine);
+        
+        // Key lengths that leave the value slot aligned and unaligned, so both
+        // the in-place and the copy-on-write update paths are exercised
+        for (const std::string& name : {std::string("counter1"), std::string("hits")}) {
+            auto key = bytes(name);
+            assert(!map.getCounter(key.data(), key.size()));
+            
+            assert(map.incrementBy(key.data(), key.size(), 5, 60) == 5);
+            assert(map.addAndGet(key.data(), key.size(), -7) == -2);
+            assert(*map.getCounter(key.data(), key.size()) == -2);
+            
+            // Updates keep the TTL the counter was created with
+            int64_t ttl = map.getTTL(key.data(), key.size());
+            assert(ttl > 0 && ttl <= 60);
+            
+            assert(map.getAndSet(key.data(), key.size(), 100) == -2);
+            assert(!map.compareAndSet(key.data(), key.size(), 99, 1));
+            assert(map.compareAndSet(key.data(), key.size(), 100, 1));
+            assert(*map.getCounter(key.data(), key.size()) == 1);
+            
+            // The value is a plain native-order int64 to every other API
+            std::vector<uint8_t> raw;
+            assert(map.get(key.data(), key.size(), raw) && raw.size() == sizeof(int64_t));
+            int64_t stored;
+            std::memcpy(&stored, raw.data(), sizeof(stored));
+            assert(stored == 1);
+        }
+        
+        auto absent = bytes("absent");
+        assert(!map.compareAndSet(absent.data(), absent.size(), 0, 1));
+        assert(!map.containsKey(absent.data(), absent.size()));
+        assert(map.getAndSet(absent.data(), absent.size(), 9) == 0);
+        
+        // An expired counter starts over
+        auto expired = bytes("expired");
+        map.incrementBy(expired.data(), expired.size(), 41, 0);
+        assert(map.incrementBy(expired.data(), expired.size(), 1) == 1);
+        
+        auto text = bytes("text");
+        auto value = bytes("abc");
+        map.put(text.data(), text.size(), value.data(), value.size());
+        bool threw = false;
+        try {
+            map.incrementBy(text.data(), text.size(), 1);
+        } catch (const FastCollectionException& e) {
+            threw = e.code() == FastCollectionException::ErrorCode::INVALID_ARGUMENT;
+        }
+        assert(threw);
+        
+        // Concurrent increments are never lost
+        auto shared = bytes("shared");
+        const int threads_count = 4;
+        const int per_thread = 5000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threads_count; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < per_thread; i++) {
+                    map.incrementBy(shared.data(), shared.size(), 1);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        assert(*map.getCounter(shared.data(), shared.size()) == threads_count * per_thread);
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_versioned_updates() {
+    std::cout << "Testing version-checked updates..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+    
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        uint64_t last_version = 0;
+        {
+            FastMap map("/tmp/test_map_versions.fc", 16 * 1024 * 1024, true, 64, engine);
+            
+            auto key = bytes("session");
+            auto v1 = bytes("one");
+            auto v2 = bytes("two, longer");
+            std::vector<uint8_t> out;
+            uint64_t version = 0;
+            
+            // Version 0 means absent: it creates once and then conflicts
+            assert(!map.getWithVersion(key.data(), key.size(), out, version));
+            assert(map.putIfVersion(key.data(), key.size(), v1.data(), v1.size(), 0));
+            assert(!map.putIfVersion(key.data(), key.size(), v1.data(), v1.size(), 0));
+            
+            assert(map.getWithVersion(key.data(), key.size(), out, version));
+            assert(out == v1 && version > 0);
+            uint64_t first = version;
+            
+            // A write in between makes the version stale
+            map.put(key.data(), key.size(), v2.data(), v2.size());
+            assert(!map.putIfVersion(key.data(), key.size(), v1.data(), v1.size(), first));
+            assert(map.getWithVersion(key.data(), key.size(), out, version));
+            assert(out == v2 && version > first);
+            assert(map.putIfVersion(key.data(), key.size(), v1.data(), v1.size(), version));
+            
+            // TTL changes are not writes
+            assert(map.getWithVersion(key.data(), key.size(), out, version));
+            assert(map.setTTL(key.data(), key.size(), 600));
+            uint64_t after_ttl = 0;
+            assert(map.getWithVersion(key.data(), key.size(), out, after_ttl));
+            assert(after_ttl == version);
+            
+            // Removing and re-adding a key does not bring an old version back
+            map.remove(key.data(), key.size());
+            assert(!map.putIfVersion(key.data(), key.size(), v1.data(), v1.size(), version));
+            map.put(key.data(), key.size(), v1.data(), v1.size());
+            assert(map.getWithVersion(key.data(), key.size(), out, last_version));
+            assert(last_version > version);
+            
+            // In-place counter updates are versioned too
+            auto counter = bytes("counter1");
+            map.incrementBy(counter.data(), counter.size(), 1);
+            assert(map.getWithVersion(counter.data(), counter.size(), out, version));
+            map.incrementBy(counter.data(), counter.size(), 1);
+            uint64_t bumped = 0;
+            assert(map.getWithVersion(counter.data(), counter.size(), out, bumped));
+            assert(bumped > version);
+            last_version = bumped;
+            
+            // Optimistic read-modify-write loops lose no updates
+            auto shared = bytes("shared");
+            auto zero = bytes("0");
+            map.put(shared.data(), shared.size(), zero.data(), zero.size());
+            std::atomic<int> conflicts{0};
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; t++) {
+                threads.emplace_back([&]() {
+                    std::vector<uint8_t> current;
+                    uint64_t v = 0;
+                    for (int i = 0; i < 500; i++) {
+                        for (;;) {
+                            map.getWithVersion(shared.data(), shared.size(), current, v);
+                            auto next = bytes(std::to_string(
+                                std::stoi(std::string(current.begin(), current.end())) + 1));
+                            if (map.putIfVersion(shared.data(), shared.size(),
+                                                 next.data(), next.size(), v)) {
+                                break;
+                            }
+                            conflicts++;
+                        }
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+            assert(map.get(shared.data(), shared.size(), out));
+            assert(std::string(out.begin(), out.end()) == "2000");
+        }
+        
+        // The clock is persisted, so versions keep growing after a reopen
+        FastMap reopened("/tmp/test_map_versions.fc", 16 * 1024 * 1024, false);
+        auto key = bytes("after_reopen");
+        auto value = bytes("x");
+        reopened.put(key.data(), key.size(), value.data(), value.size());
+        std::vector<uint8_t> out;
+        uint64_t version = 0;
+        assert(reopened.getWithVersion(key.data(), key.size(), out, version));
+        assert(version > last_version);
+    }
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_parallel_bulk_operations() {
+    std::cout << "Testing parallel bulk operations..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    ThreadPool& pool = ThreadPool::instance();
+    size_t saved_parallelism = pool.parallelism();
+    pool.set_parallelism(4);
+    
+    // Every index runs exactly once, nested jobs run inline, and the first
+    // exception reaches the caller
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallel_for(hits.size(), [&](size_t i) {
+        hits[i]++;
+        pool.parallel_for(2, [](size_t) {});
+    });
+    for (const auto& hit : hits) assert(hit.load() == 1);
+    bool thrown = false;
+    try {
+        pool.parallel_for(100, [](size_t i) {
+            if (i == 42) throw FastCollectionException(
+                FastCollectionException::ErrorCode::INVALID_ARGUMENT, "task failed");
+        });
+    } catch (const FastCollectionException&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    const int permanent = 20000;
+    const int temporary = 1000;
+    std::vector<std::unique_ptr<FastMap>> maps;
+    for (MapEngine engine : {MapEngine::CHAINED, MapEngine::SWISS}) {
+        std::string path = "/tmp/test_map_parallel_" + std::to_string(maps.size()) + ".fc";
+        maps.push_back(std::make_unique<FastMap>(path, 64 * 1024 * 1024, true, 16384, engine));
+        FastMap& map = *maps.back();
+        for (int i = 0; i < permanent; i++) {
+            std::string key = "key" + std::to_string(i);
+            int64_t value = i;
+            map.put(bytes(key), key.size(), reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+        }
+        for (int i = 0; i < temporary; i++) {
+            std::string key = "temp" + std::to_string(i);
+            map.put(bytes(key), key.size(), bytes(key), key.size(), 1);
+        }
+    }
+    
+    FastSet set("/tmp/test_set_parallel.fc", 64 * 1024 * 1024, true, 16384);
+    for (int i = 0; i < permanent; i++) {
+        std::string element = std::to_string(i);
+        set.add(bytes(element), element.size());
+    }
+    for (int i = 0; i < temporary; i++) {
+        std::string element = "temp" + std::to_string(i);
+        set.add(bytes(element), element.size(), 1);
+    }
+    
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    
+    for (auto& map : maps) {
+        assert(map->parallelRemoveExpired() == static_cast<size_t>(temporary));
+        assert(map->removeExpired() == 0);
+        assert(map->size() == static_cast<size_t>(permanent));
+        
+        std::atomic<size_t> visited{0};
+        std::atomic<int64_t> sum{0};
+        map->parallelForEach([&](const uint8_t*, size_t, const uint8_t* value, size_t size) {
+            assert(size == sizeof(int64_t));
+            int64_t v;
+            std::memcpy(&v, value, sizeof(v));
+            sum += v;
+            visited++;
+            return true;
+        });
+        assert(visited == static_cast<size_t>(permanent));
+        assert(sum == static_cast<int64_t>(permanent) * (permanent - 1) / 2);
+        
+        // Stopping early skips the chunks not yet started
+        visited = 0;
+        map->parallelForEach([&](const uint8_t*, size_t, const uint8_t*, size_t) {
+            visited++;
+            return false;
+        });
+        assert(visited > 0 && visited < static_cast<size_t>(permanent));
+        
+        map->parallelClear();
+        assert(map->size() == 0);
+        assert(map->exactSize() == 0);
+        std::string key = "after_clear";
+        assert(map->put(bytes(key), key.size(), bytes(key), key.size()));
+        assert(map->exactSize() == 1);
+    }
+    
+    assert(set.parallelRemoveExpired() == static_cast<size_t>(temporary));
+    assert(set.size() == static_cast<size_t>(permanent));
+    size_t removed = set.parallelRetainIf([](const uint8_t* data, size_t size) {
+        return (data[size - 1] - '0') % 2 == 0;
+    });
+    assert(removed == static_cast<size_t>(permanent / 2));
+    assert(set.size() == static_cast<size_t>(permanent / 2));
+    std::atomic<size_t> odd{0};
+    set.parallelForEach([&](const uint8_t* data, size_t size) {
+        if ((data[size - 1] - '0') % 2 != 0) odd++;
+        return true;
+    });
+    assert(odd == 0);
+    set.parallelClear();
+    assert(set.exactSize() == 0);
+    
+    pool.set_parallelism(saved_parallelism);
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_tagged_buckets() {
+    std::cout << "Testing tagged buckets and lock stripes..." << std::endl;
+    
+    auto bytes = [](const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); };
+    
+    // Short chains are fully tagged; removing one of two equal fingerprints
+    // keeps the other, and past seven entries every lookup walks
+    ShmBucket bucket;
+    assert(!bucket.may_contain(1));
+    for (uint32_t h = 1; h <= 6; h++) bucket.add_entry(h * 0x01000193u);
+    bucket.add_entry(0x01000193u);
+    for (uint32_t h = 1; h <= 6; h++) assert(bucket.may_contain(h * 0x01000193u));
+    assert(ShmBucket::length(bucket.tags.load()) == 7);
+    assert(bucket.remove_entry(0x01000193u));
+    assert(bucket.may_contain(0x01000193u));
+    assert(bucket.remove_entry(0x01000193u));
+    assert(!bucket.may_contain(0x01000193u));
+    assert(bucket.remove_entry(6 * 0x01000193u));
+    for (uint32_t h = 2; h <= 5; h++) assert(bucket.may_contain(h * 0x01000193u));
+    for (uint32_t h = 0; h < 8; h++) bucket.add_entry(h);
+    assert(ShmBucket::length(bucket.tags.load()) == 12);
+    assert(bucket.may_contain(0xDEADBEEFu));
+    assert(bucket.remove_entry(0));
+    
+    // A file written with the old bucket layout is converted on open
+    const char* path = "/tmp/test_map_legacy.fc";
+    const int legacy_entries = 200;
+    {
+        MMapFileManager file(path, 16 * 1024 * 1024, true);
+        HashTableHeader* header = file.find_or_construct<HashTableHeader>("map_header", 16);
+        header->version = 1;
+        file.find_or_construct<HashHeader>("map_hash", HashAlgorithm::WYHASH_64);
+        LegacyShmBucket* buckets = file.construct_array<LegacyShmBucket>("map_buckets", 16);
+        uint8_t* base = reinterpret_cast<uint8_t*>(file.segment_manager());
+        
+        for (int i = 0; i < legacy_entries; i++) {
+            std::string key = "legacy_" + std::to_string(i);
+            uint64_t hash = compute_hash64(bytes(key), key.size());
+            ShmKeyValue* kv = new(file.allocate(ShmKeyValue::total_size(key.size(), key.size())))
+                ShmKeyValue();
+            SerializationUtil::copy_to_kv(kv, hash, bytes(key), key.size(), bytes(key), key.size());
+            
+            LegacyShmBucket& legacy = buckets[hash & 15];
+            int64_t offset = reinterpret_cast<uint8_t*>(kv) - base;
+            int64_t head = legacy.head_offset.load();
+            kv->next_offset.store(head);
+            if (head >= 0) reinterpret_cast<ShmKeyValue*>(base + head)->prev_offset.store(offset);
+            legacy.head_offset.store(offset);
+        }
+        header->size.store(legacy_entries);
+    }
+    {
+        FastMap map(path, 16 * 1024 * 1024, false);
+        assert(map.size() == legacy_entries);
+        for (int i = 0; i < legacy_entries; i++) {
+            std::string key = "legacy_" + std::to_string(i);
+            std::vector<uint8_t> value;
+            assert(map.get(bytes(key), key.size(), value));
+            assert(std::string(value.begin(), value.end()) == key);
+        }
+        for (int i = 0; i < legacy_entries; i += 2) {
+            std::string key = "legacy_" + std::to_string(i);
+            assert(map.remove(bytes(key), key.size()));
+        }
+        for (int i = 0; i < 1000; i++) {
+            std::string key = "fresh_" + std::to_string(i);
+            assert(map.put(bytes(key), key.size(), bytes(key), key.size()));
+        }
+    }
+    {
+        FastMap reopened(path, 16 * 1024 * 1024, false);
+        assert(reopened.size() == legacy_entries / 2 + 1000);
+        for (int i = 0; i < legacy_entries; i++) {
+            std::string key = "legacy_" + std::to_string(i);
+            assert(reopened.containsKey(bytes(key), key.size()) == (i % 2 == 1));
+        }
+        MMapFileManager file(path, 16 * 1024 * 1024, false);
+        assert(file.find<ShmLockStripe>("map_stripes").second == 16);
+        
+        // Converted files carry the new version, which older builds refuse;
+        // this build refuses versions it does not know in turn
+        HashTableHeader* header = file.find<HashTableHeader>("map_header").first;
+        assert(header->version == CollectionHeader::CURRENT_VERSION);
+        header->version = CollectionHeader::CURRENT_VERSION + 1;
+    }
+    {
+        bool rejected = false;
+        try {
+            FastMap newer(path, 16 * 1024 * 1024, false);
+        } catch (const FastCollectionException&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+    
+    // Writers churn their own keys while the table grows; tags must never
+    // hide a key that is present or keep one that is gone
+    FastMap map("/tmp/test_map_tags.fc", 64 * 1024 * 1024, true, 16);
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&map, &failed, &bytes, t]() {
+            for (int round = 0; round < 3; round++) {
+                for (int i = 0; i < 2000; i++) {
+                    std::string key = std::to_string(t) + "_" + std::to_string(i);
+                    map.put(bytes(key), key.size(), bytes(key), key.size());
+                    if (!map.containsKey(bytes(key), key.size())) failed = true;
+                }
+                for (int i = 0; i < 2000; i += 3) {
+                    std::string key = std::to_string(t) + "_" + std::to_string(i);
+                    if (!map.remove(bytes(key), key.size())) failed = true;
+                    if (map.containsKey(bytes(key), key.size())) failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert(!failed);
+    assert(map.size() == 4 * (2000 - 667));
+    
+    std::cout << "  PASSED" << std::endl;
+}
+
 int main() {
     std::cout << "\n=== FastCollection Map Tests ===" << std::endl;
     
@@ -97,6 +1448,26 @@ int main() {
         test_basic_operations();
         test_ttl();
         test_put_if_absent();
+        test_incremental_rehash();
+        test_scan_cursor();
+        test_swiss_engine();
+        test_concurrent_readers();
+        test_concurrent_resize();
+        test_nested_iteration();
+        test_writes_from_callbacks();
+        test_many_readers();
+        test_constant_time_size();
+        test_size_after_ttl_changes();
+        test_batch_operations();
+        test_get_with();
+        test_cache_mode();
+        test_expiry_index();
+        test_background_reaper();
+        test_hash_algorithms();
+        test_atomic_counters();
+        test_versioned_updates();
+        test_parallel_bulk_operations();
+        test_tagged_buckets();
         
         std::cout << "\n=== All tests PASSED ===" << std::endl;
         return 0;
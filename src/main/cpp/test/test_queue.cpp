@@ -0,0 +1,465 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ * Patent Pending
+ *
+ * @file test_queue.cpp
+ * @brief Tests for FastQueue: batches, split head/tail locks, blocking take/poll across processes
+ */
+
+#include "fastcollection.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace fastcollection;
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string text(const std::vector<uint8_t>& v) {
+    return std::string(v.begin(), v.end());
+}
+
+using Clock = std::chrono::steady_clock;
+
+} // anonymous namespace
+
+void test_basic_operations() {
+    std::cout << "Testing basic queue operations..." << std::endl;
+
+    FastQueue queue("/tmp/test_queue_basic.fc", 16 * 1024 * 1024, true);
+
+    for (int i = 0; i < 10; i++) {
+        std::string s = "item_" + std::to_string(i);
+        assert(queue.offer(bytes(s), s.size()));
+    }
+    std::string first = "first";
+    assert(queue.offerFirst(bytes(first), first.size()));
+    assert(queue.size() == 11);
+
+    std::vector<uint8_t> out;
+    assert(queue.peek(out) && text(out) == "first");
+    assert(queue.poll(out) && text(out) == "first");
+    assert(queue.pollLast(out) && text(out) == "item_9");
+    for (int i = 0; i < 9; i++) {
+        assert(queue.poll(out) && text(out) == "item_" + std::to_string(i));
+    }
+    assert(!queue.poll(out));
+    assert(queue.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_batch_operations() {
+    std::cout << "Testing batch operations..." << std::endl;
+
+    FastQueue queue("/tmp/test_queue_batch.fc", 16 * 1024 * 1024, true);
+
+    // A batch lands behind existing elements, in order, skipping empties
+    std::string first = "single";
+    queue.offer(bytes(first), first.size());
+    std::vector<std::vector<uint8_t>> batch;
+    for (int i = 0; i < 1000; i++) {
+        std::string s = "batch_" + std::to_string(i);
+        batch.emplace_back(s.begin(), s.end());
+        if (i == 500) batch.emplace_back();
+    }
+    assert(queue.offerAll(batch) == 1000);
+    assert(queue.offerAll({}) == 0);
+    assert(queue.size() == 1001);
+
+    std::vector<std::vector<uint8_t>> out;
+    assert(queue.peekBatch(out, 3) == 3);
+    assert(text(out[0]) == "single" && text(out[2]) == "batch_1");
+    assert(queue.size() == 1001);
+
+    out.clear();
+    assert(queue.pollBatch(out, 2) == 2);
+    assert(text(out[0]) == "single" && text(out[1]) == "batch_0");
+
+    // Views arrive in order, and the callback may use the queue again
+    int expected = 1;
+    size_t drained = queue.drainTo([&](const uint8_t* data, size_t size) {
+        assert(std::string(reinterpret_cast<const char*>(data), size) ==
+               "batch_" + std::to_string(expected++));
+        assert(queue.size() == 999 - 10);
+    }, 10);
+    assert(drained == 10);
+
+    // The copying drainTo still works, and elements offered one by one
+    // mix with the batch
+    std::string tail = "tail";
+    queue.offer(bytes(tail), tail.size());
+    std::vector<std::string> rest;
+    queue.drainTo([&](std::vector<uint8_t>&& data) { rest.push_back(text(data)); });
+    assert(rest.size() == 990);
+    assert(rest.front() == "batch_11" && rest[988] == "batch_999" && rest.back() == "tail");
+    assert(queue.isEmpty());
+
+    // Expired elements inside a polled run are dropped, not returned
+    std::vector<std::vector<uint8_t>> expiring = {{'a'}, {'b'}};
+    queue.offerAll(expiring, 0);
+    std::string live = "live";
+    queue.offer(bytes(live), live.size());
+    queue.offerAll(expiring, 0);
+    out.clear();
+    assert(queue.peekBatch(out, 0) == 1);
+    out.clear();
+    assert(queue.pollBatch(out, 0) == 1 && text(out[0]) == "live");
+    assert(queue.isEmpty());
+
+    // A throwing callback leaves the queue consistent
+    queue.offerAll(batch);
+    bool threw = false;
+    try {
+        queue.drainTo([](const uint8_t*, size_t) { throw std::runtime_error("stop"); }, 5);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(queue.size() == 995);
+    queue.clear();
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_batch_wakeup() {
+    std::cout << "Testing a batch waking several consumers..." << std::endl;
+
+    FastQueue queue("/tmp/test_queue_batch_wake.fc", 16 * 1024 * 1024, true);
+    const int consumers = 3;
+
+    std::atomic<int> received{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            queue.take();
+            received++;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::vector<uint8_t>> batch(consumers, std::vector<uint8_t>{'x'});
+    assert(queue.offerAll(batch) == consumers);
+    for (auto& t : threads) t.join();
+    assert(received == consumers);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_dummy_node() {
+    std::cout << "Testing both ends of an emptied queue..." << std::endl;
+
+    const char* path = "/tmp/test_queue_dummy.fc";
+    std::vector<uint8_t> out;
+    {
+        FastQueue queue(path, 16 * 1024 * 1024, true);
+
+        // Every way of emptying the queue leaves a usable back
+        std::string a = "a", b = "b";
+        assert(!queue.pollLast(out) && !queue.peekLast(out));
+        assert(queue.offerFirst(bytes(a), a.size()));
+        assert(queue.peekLast(out) && text(out) == "a");
+        assert(queue.pollLast(out) && text(out) == "a");
+        assert(queue.offer(bytes(a), a.size()) && queue.poll(out));
+        assert(queue.offer(bytes(b), b.size()));
+        assert(queue.removeElement(bytes(b), b.size()));
+        queue.offer(bytes(a), a.size(), 0);
+        assert(queue.removeExpired() == 1);
+        queue.offer(bytes(a), a.size());
+        queue.clear();
+        std::vector<std::vector<uint8_t>> batch = {{'x'}, {'y'}};
+        queue.offerAll(batch);
+        std::vector<std::vector<uint8_t>> polled;
+        assert(queue.pollBatch(polled, 0) == 2);
+        assert(queue.isEmpty());
+
+        assert(queue.offer(bytes(a), a.size()));
+        assert(queue.offerFirst(bytes(b), b.size()));
+        assert(queue.peekLast(out) && text(out) == "a");
+    }
+    {
+        FastQueue reopened(path, 16 * 1024 * 1024, false);
+        assert(reopened.size() == 2);
+        assert(reopened.poll(out) && text(out) == "b");
+        assert(reopened.poll(out) && text(out) == "a");
+    }
+
+    // A file written before the dummy node gets one when it is opened
+    const char* legacy_path = "/tmp/test_queue_legacy.fc";
+    const int legacy_elements = 50;
+    {
+        MMapFileManager file(legacy_path, 16 * 1024 * 1024, true);
+        DequeHeader* header = file.find_or_construct<DequeHeader>("queue_header");
+        file.find_or_construct<HashHeader>("queue_hash", HashAlgorithm::WYHASH_64);
+        uint8_t* base = reinterpret_cast<uint8_t*>(file.segment_manager());
+
+        for (int i = 0; i < legacy_elements; i++) {
+            std::string s = "legacy_" + std::to_string(i);
+            ShmNode* node = new(file.allocate(ShmNode::total_size(s.size()))) ShmNode();
+            SerializationUtil::copy_to_node(node, compute_hash64(bytes(s), s.size()),
+                                            bytes(s), s.size());
+            int64_t offset = reinterpret_cast<uint8_t*>(node) - base;
+            int64_t back = header->back_offset.load();
+            node->prev_offset.store(back);
+            if (back >= 0) {
+                reinterpret_cast<ShmNode*>(base + back)->next_offset.store(offset);
+            } else {
+                header->front_offset.store(offset);
+            }
+            header->back_offset.store(offset);
+        }
+        header->size.store(legacy_elements);
+    }
+    {
+        FastQueue queue(legacy_path, 16 * 1024 * 1024, false);
+        assert(queue.size() == legacy_elements);
+        std::string first = "legacy_0";
+        assert(queue.contains(bytes(first), first.size()));
+        assert(queue.peekLast(out) && text(out) == "legacy_49");
+        for (int i = 0; i < legacy_elements / 2; i++) {
+            assert(queue.poll(out) && text(out) == "legacy_" + std::to_string(i));
+        }
+        std::string fresh = "fresh";
+        queue.offer(bytes(fresh), fresh.size());
+    }
+    {
+        FastQueue reopened(legacy_path, 16 * 1024 * 1024, false);
+        assert(reopened.size() == legacy_elements / 2 + 1);
+        assert(reopened.pollLast(out) && text(out) == "fresh");
+        for (int i = legacy_elements / 2; i < legacy_elements; i++) {
+            assert(reopened.poll(out) && text(out) == "legacy_" + std::to_string(i));
+        }
+        assert(reopened.isEmpty());
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_split_locks() {
+    std::cout << "Testing producers and consumers on separate locks..." << std::endl;
+
+    // Producers never wait for consumers now, so check that nothing is lost
+    // or reordered: each producer's elements arrive in the order it sent
+    // them, whichever end is busier
+    auto run = [](int producers, int consumers, int per_producer) {
+        FastQueue queue("/tmp/test_queue_split.fc", 64 * 1024 * 1024, true);
+        std::atomic<bool> failed{false};
+        std::atomic<int> received{0};
+        const int total = producers * per_producer;
+
+        std::vector<std::thread> threads;
+        for (int c = 0; c < consumers; c++) {
+            threads.emplace_back([&]() {
+                std::vector<int> last_seen(producers, -1);
+                std::vector<uint8_t> out;
+                while (received.load() < total) {
+                    if (!queue.poll(out, 10)) continue;
+                    received++;
+                    std::string s = text(out);
+                    size_t split = s.find('_');
+                    int p = std::stoi(s.substr(0, split));
+                    int i = std::stoi(s.substr(split + 1));
+                    if (i <= last_seen[p]) failed = true;
+                    last_seen[p] = i;
+                }
+            });
+        }
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                for (int i = 0; i < per_producer; i++) {
+                    std::string s = std::to_string(p) + "_" + std::to_string(i);
+                    queue.offer(bytes(s), s.size());
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        assert(!failed);
+        assert(received == total);
+        assert(queue.isEmpty());
+    };
+
+    run(1, 4, 20000);  // One producer, several consumers
+    run(4, 1, 5000);   // Several producers, one consumer
+    run(3, 3, 5000);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_take_wakeup() {
+    std::cout << "Testing take() wakeup..." << std::endl;
+
+    FastQueue queue("/tmp/test_queue_take.fc", 16 * 1024 * 1024, true);
+
+    // The consumer is asleep well before the offer arrives
+    std::atomic<int64_t> woke_at{0};
+    std::string received;
+    std::thread consumer([&]() {
+        received = text(queue.take());
+        woke_at = Clock::now().time_since_epoch().count();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::string s = "wake";
+    int64_t offered_at = Clock::now().time_since_epoch().count();
+    assert(queue.offer(bytes(s), s.size()));
+    consumer.join();
+
+    assert(received == "wake");
+    auto latency = std::chrono::nanoseconds(woke_at.load() - offered_at);
+    std::cout << "  Wakeup latency: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(latency).count()
+              << " us" << std::endl;
+    assert(latency < std::chrono::milliseconds(50));
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_poll_timeout() {
+    std::cout << "Testing poll with timeout..." << std::endl;
+
+    FastQueue queue("/tmp/test_queue_timeout.fc", 16 * 1024 * 1024, true);
+    std::vector<uint8_t> out;
+
+    // Nothing arrives: the full timeout passes
+    auto start = Clock::now();
+    assert(!queue.poll(out, 100));
+    assert(Clock::now() - start >= std::chrono::milliseconds(100));
+
+    // An offer part way through ends the wait early
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::string s = "late";
+        queue.offer(bytes(s), s.size());
+    });
+    start = Clock::now();
+    assert(queue.poll(out, 5000));
+    assert(text(out) == "late");
+    assert(Clock::now() - start < std::chrono::milliseconds(2500));
+    producer.join();
+
+    // Expired elements are skipped, so the wait continues past them
+    std::string gone = "gone";
+    queue.offer(bytes(gone), gone.size(), 0);
+    assert(!queue.poll(out, 20));
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_many_consumers() {
+    std::cout << "Testing blocked consumers and producers..." << std::endl;
+
+    FastQueue queue("/tmp/test_queue_mpmc.fc", 64 * 1024 * 1024, true);
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 5000;
+
+    // Consumers block in take() until a stop marker; a lost wakeup would
+    // leave one asleep with elements still queued
+    std::atomic<int> received{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            while (text(queue.take()) != "stop") {
+                received++;
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int p = 0; p < producers; p++) {
+        writers.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; i++) {
+                std::string s = "p" + std::to_string(p) + "_" + std::to_string(i);
+                queue.offer(bytes(s), s.size());
+                if (i % 512 == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+
+    std::string stop = "stop";
+    for (int c = 0; c < consumers; c++) {
+        queue.offer(bytes(stop), stop.size());
+    }
+    for (auto& t : threads) t.join();
+
+    assert(received == producers * per_producer);
+    assert(queue.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_cross_process_wakeup() {
+    std::cout << "Testing take() woken from another process..." << std::endl;
+
+    const char* path = "/tmp/test_queue_ipc.fc";
+    const int count = 100;
+    {
+        FastQueue queue(path, 16 * 1024 * 1024, true);
+    }
+
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        // Consumer process: block for every element the parent sends
+        int status = 0;
+        try {
+            FastQueue queue(path, 16 * 1024 * 1024, false);
+            for (int i = 0; i < count; i++) {
+                if (text(queue.take()) != "msg_" + std::to_string(i)) status = 1;
+            }
+        } catch (...) {
+            status = 2;
+        }
+        _exit(status);
+    }
+
+    FastQueue queue(path, 16 * 1024 * 1024, false);
+    for (int i = 0; i < count; i++) {
+        // Give the child time to fall asleep before some of the offers
+        if (i % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::string s = "msg_" + std::to_string(i);
+        queue.offer(bytes(s), s.size());
+    }
+
+    int status = 0;
+    assert(waitpid(child, &status, 0) == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(queue.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+int main() {
+    std::cout << "\n=== FastCollection Queue Tests ===" << std::endl;
+
+    try {
+        test_basic_operations();
+        test_batch_operations();
+        test_batch_wakeup();
+        test_dummy_node();
+        test_split_locks();
+        test_take_wakeup();
+        test_poll_timeout();
+        test_many_consumers();
+        test_cross_process_wakeup();
+
+        std::cout << "\n=== All tests PASSED ===" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,298 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ * Patent Pending
+ *
+ * @file test_ring_queue.cpp
+ * @brief Tests for FastRingQueue: slot protocol, backpressure, MPMC and IPC
+ */
+
+#include "fastcollection.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace fastcollection;
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string text(const std::vector<uint8_t>& v) {
+    return std::string(v.begin(), v.end());
+}
+
+using Clock = std::chrono::steady_clock;
+
+} // anonymous namespace
+
+void test_basic_operations() {
+    std::cout << "Testing basic ring operations..." << std::endl;
+
+    FastRingQueue ring("/tmp/test_ring_basic.fc", 100, 30, true);
+    assert(ring.capacity() == 128);
+    assert(ring.slotBytes() == 32);
+    assert(ring.isEmpty());
+
+    std::vector<uint8_t> out;
+    assert(!ring.poll(out));
+    assert(!ring.peek(out));
+    assert(!ring.offer(nullptr, 0));
+
+    for (int i = 0; i < 10; i++) {
+        std::string s = "item_" + std::to_string(i);
+        assert(ring.offer(bytes(s), s.size()));
+    }
+    assert(ring.size() == 10);
+    assert(ring.remainingSlots() == 118);
+
+    assert(ring.peek(out) && text(out) == "item_0");
+    for (int i = 0; i < 10; i++) {
+        assert(ring.poll(out) && text(out) == "item_" + std::to_string(i));
+    }
+    assert(!ring.poll(out));
+    assert(ring.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_backpressure() {
+    std::cout << "Testing full ring and wraparound..." << std::endl;
+
+    FastRingQueue ring("/tmp/test_ring_full.fc", 8, 16, true);
+    std::vector<uint8_t> out;
+
+    // Many laps around the ring, filling it completely each time
+    for (int lap = 0; lap < 50; lap++) {
+        for (int i = 0; i < 8; i++) {
+            std::string s = std::to_string(lap) + ":" + std::to_string(i);
+            assert(ring.offer(bytes(s), s.size()));
+        }
+        std::string extra = "extra";
+        assert(!ring.offer(bytes(extra), extra.size()));
+        assert(ring.remainingSlots() == 0);
+
+        for (int i = 0; i < 8; i++) {
+            assert(ring.poll(out));
+            assert(text(out) == std::to_string(lap) + ":" + std::to_string(i));
+        }
+    }
+
+    // A timed offer gives up on a full ring
+    std::string s(16, 'x');
+    for (int i = 0; i < 8; i++) assert(ring.offer(bytes(s), s.size()));
+    auto start = Clock::now();
+    assert(!ring.offer(bytes(s), s.size(), 50u, TTL_INFINITE));
+    assert(Clock::now() - start >= std::chrono::milliseconds(50));
+
+    // ...and succeeds as soon as a consumer makes room
+    std::thread consumer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        std::vector<uint8_t> taken;
+        ring.poll(taken);
+    });
+    assert(ring.offer(bytes(s), s.size(), 5000u, TTL_INFINITE));
+    consumer.join();
+
+    ring.clear();
+    assert(ring.isEmpty());
+    assert(ring.remainingSlots() == 8);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_large_records() {
+    std::cout << "Testing records spanning several slots..." << std::endl;
+
+    FastRingQueue ring("/tmp/test_ring_large.fc", 16, 8, true);
+    assert(ring.maxRecordSize() == 128);
+
+    std::string too_big(129, 'z');
+    bool threw = false;
+    try {
+        ring.offer(bytes(too_big), too_big.size());
+    } catch (const FastCollectionException&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Mixed sizes land at every offset, so records wrap across the end
+    std::vector<uint8_t> out;
+    for (int round = 0; round < 200; round++) {
+        size_t length = 1 + (round * 37) % 60;
+        std::string s(length, static_cast<char>('a' + round % 26));
+        s[0] = '#';
+        assert(ring.offer(bytes(s), s.size()));
+        if (round % 3 == 0) {
+            std::string small = "s" + std::to_string(round);
+            assert(ring.offer(bytes(small), small.size()));
+        }
+
+        assert(ring.peek(out) && text(out) == s);
+        assert(ring.poll(out) && text(out) == s);
+        if (round % 3 == 0) {
+            assert(ring.poll(out) && text(out) == "s" + std::to_string(round));
+        }
+        assert(ring.isEmpty());
+    }
+
+    // A record filling the whole ring
+    std::string whole(128, 'w');
+    assert(ring.offer(bytes(whole), whole.size()));
+    std::string one = "1";
+    assert(!ring.offer(bytes(one), one.size()));
+    assert(ring.poll(out) && text(out) == whole);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_ttl() {
+    std::cout << "Testing TTL expiration..." << std::endl;
+
+    FastRingQueue ring("/tmp/test_ring_ttl.fc", 16, 32, true);
+    std::string gone = "gone";
+    std::string kept = "kept";
+    assert(ring.offer(bytes(gone), gone.size(), 0));
+    assert(ring.offer(bytes(kept), kept.size()));
+    assert(ring.size() == 2);
+
+    // peek skips the expired record without dropping it
+    std::vector<uint8_t> out;
+    assert(ring.peek(out) && text(out) == "kept");
+    assert(ring.size() == 2);
+
+    // poll drops it on the way
+    assert(ring.poll(out) && text(out) == "kept");
+    assert(ring.isEmpty());
+
+    // A timed poll keeps waiting past expired records
+    assert(ring.offer(bytes(gone), gone.size(), 0));
+    assert(!ring.poll(out, 20));
+    assert(ring.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_mpmc() {
+    std::cout << "Testing concurrent producers and consumers..." << std::endl;
+
+    // A small ring, so producers regularly find it full and wait
+    FastRingQueue ring("/tmp/test_ring_mpmc.fc", 64, 16, true);
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20000;
+
+    std::atomic<int> received{0};
+    std::atomic<int64_t> checksum{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            std::vector<int> last(producers, -1);
+            while (true) {
+                std::string s = text(ring.take());
+                if (s == "stop") break;
+                // Each producer's records arrive in the order it sent them
+                int p = std::stoi(s.substr(1, s.find('_') - 1));
+                int i = std::stoi(s.substr(s.find('_') + 1));
+                assert(i > last[p]);
+                last[p] = i;
+                checksum += i;
+                received++;
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int p = 0; p < producers; p++) {
+        writers.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; i++) {
+                // Some records span two slots
+                std::string s = "p" + std::to_string(p) + "_" + std::to_string(i);
+                if (i % 4 == 0) s += std::string(12, '.');
+                ring.put(bytes(s), s.size());
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+
+    std::string stop = "stop";
+    for (int c = 0; c < consumers; c++) {
+        ring.put(bytes(stop), stop.size());
+    }
+    for (auto& t : threads) t.join();
+
+    int64_t expected = int64_t(producers) * per_producer * (per_producer - 1) / 2;
+    assert(received == producers * per_producer);
+    assert(checksum == expected);
+    assert(ring.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_cross_process() {
+    std::cout << "Testing a ring shared with another process..." << std::endl;
+
+    const char* path = "/tmp/test_ring_ipc.fc";
+    const int count = 2000;
+    {
+        FastRingQueue ring(path, 32, 64, true);
+    }
+
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        // Consumer process: block for every record the parent sends
+        int status = 0;
+        try {
+            FastRingQueue ring(path);
+            if (ring.capacity() != 32) status = 3;
+            for (int i = 0; i < count; i++) {
+                if (text(ring.take()) != "msg_" + std::to_string(i)) status = 1;
+            }
+        } catch (...) {
+            status = 2;
+        }
+        _exit(status);
+    }
+
+    // The ring is much smaller than the stream, so the parent waits for room
+    FastRingQueue ring(path);
+    for (int i = 0; i < count; i++) {
+        if (i % 500 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::string s = "msg_" + std::to_string(i);
+        ring.put(bytes(s), s.size());
+    }
+
+    int status = 0;
+    assert(waitpid(child, &status, 0) == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(ring.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+int main() {
+    std::cout << "\n=== FastCollection Ring Queue Tests ===" << std::endl;
+
+    try {
+        test_basic_operations();
+        test_backpressure();
+        test_large_records();
+        test_ttl();
+        test_mpmc();
+        test_cross_process();
+
+        std::cout << "\n=== All tests PASSED ===" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+}
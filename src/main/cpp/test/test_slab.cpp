@@ -0,0 +1,225 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ * Patent Pending
+ *
+ * @file test_slab.cpp
+ * @brief Tests for the size-class slab allocator in the mapped file
+ */
+
+#include "fastcollection.h"
+#include "fc_slab.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace fastcollection;
+
+void test_size_classes() {
+    std::cout << "Testing size classes and reuse..." << std::endl;
+
+    MMapFileManager file("/tmp/test_slab_classes.fc", 16 * 1024 * 1024, true);
+
+    // Blocks are 64-byte aligned and as large as their class
+    std::vector<void*> blocks;
+    for (size_t bytes : {1, 64, 65, 128, 200, 1000, 2048}) {
+        void* block = file.allocate(bytes);
+        assert(reinterpret_cast<uintptr_t>(block) % 64 == 0);
+        std::memset(block, 0xab, (bytes + 63) & ~size_t(63));
+        blocks.push_back(block);
+    }
+
+    // A freed block is the next one handed out in its class
+    void* block = file.allocate(ShmNode::total_size(40));
+    file.deallocate(block);
+    assert(file.allocate(ShmNode::total_size(40)) == block);
+
+    // Blocks of one class never overlap
+    std::set<uint8_t*> seen;
+    for (int i = 0; i < 2000; i++) {
+        uint8_t* b = static_cast<uint8_t*>(file.allocate(192));
+        assert(seen.insert(b).second);
+    }
+    std::vector<uint8_t*> sorted(seen.begin(), seen.end());
+    for (size_t i = 1; i < sorted.size(); i++) {
+        assert(sorted[i] - sorted[i - 1] >= 192);
+    }
+
+    // Large blocks still come from Boost and go back to it
+    size_t before = file.free_space();
+    void* large = file.allocate(64 * 1024);
+    assert(file.free_space() < before);
+    file.deallocate(large);
+    assert(file.free_space() == before);
+
+    for (void* b : blocks) file.deallocate(b);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_legacy_blocks() {
+    std::cout << "Testing blocks allocated before the slabs..." << std::endl;
+
+    // A file written by an older build holds nodes straight from Boost
+    const char* path = "/tmp/test_slab_legacy.fc";
+    bip::file_mapping::remove(path);
+    std::vector<int64_t> offsets;
+    {
+        bip::managed_mapped_file file(bip::create_only, path, 4 * 1024 * 1024);
+        for (int i = 0; i < 100; i++) {
+            void* block = file.allocate(ShmNode::total_size(32));
+            offsets.push_back(static_cast<uint8_t*>(block) -
+                              reinterpret_cast<uint8_t*>(file.get_segment_manager()));
+        }
+    }
+
+    MMapFileManager file(path, 4 * 1024 * 1024, false);
+    uint8_t* base = reinterpret_cast<uint8_t*>(file.segment_manager());
+    void* fresh = file.allocate(ShmNode::total_size(32));
+
+    // Freeing the old nodes returns them to Boost, not to a class list
+    size_t before = file.free_space();
+    for (int64_t offset : offsets) file.deallocate(base + offset);
+    assert(file.free_space() > before);
+
+    void* again = file.allocate(ShmNode::total_size(32));
+    assert(again != fresh);
+    assert(std::find(offsets.begin(), offsets.end(),
+                     static_cast<uint8_t*>(again) - base) == offsets.end());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_reopen() {
+    std::cout << "Testing free lists kept in the file..." << std::endl;
+
+    const char* path = "/tmp/test_slab_reopen.fc";
+    int64_t freed;
+    {
+        MMapFileManager file(path, 16 * 1024 * 1024, true);
+        void* keep = file.allocate(256);
+        void* drop = file.allocate(256);
+        assert(keep != drop);
+        freed = static_cast<uint8_t*>(drop) - reinterpret_cast<uint8_t*>(file.segment_manager());
+        file.deallocate(drop);
+    }
+    {
+        MMapFileManager file(path, 16 * 1024 * 1024, false);
+        void* block = file.allocate(256);
+        assert(static_cast<uint8_t*>(block) - reinterpret_cast<uint8_t*>(file.segment_manager()) == freed);
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent() {
+    std::cout << "Testing concurrent allocate/deallocate..." << std::endl;
+
+    MMapFileManager file("/tmp/test_slab_mt.fc", 64 * 1024 * 1024, true);
+    const int threads = 8;
+    const int rounds = 20000;
+
+    // Each thread stamps its blocks and checks the stamp before freeing, so
+    // a block handed to two threads at once shows up as a torn stamp
+    std::atomic<int> failures{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::vector<std::pair<uint64_t*, size_t>> held;
+            uint64_t stamp = static_cast<uint64_t>(t + 1) << 32;
+            for (int i = 0; i < rounds; i++) {
+                size_t bytes = 64 * (1 + (i + t) % 6);
+                uint64_t* block = static_cast<uint64_t*>(file.allocate(bytes));
+                for (size_t w = 0; w < bytes / 8; w++) block[w] = stamp + i;
+                held.emplace_back(block, bytes);
+
+                if (held.size() > 16 || i % 3 == 0) {
+                    auto [victim, size] = held[(i * 7) % held.size()];
+                    for (size_t w = 1; w < size / 8; w++) {
+                        if (victim[w] != victim[0]) failures++;
+                    }
+                    held.erase(std::find(held.begin(), held.end(), std::make_pair(victim, size)));
+                    file.deallocate(victim);
+                }
+            }
+            for (auto& [block, size] : held) file.deallocate(block);
+        });
+    }
+    for (auto& w : workers) w.join();
+    assert(failures == 0);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_churn() {
+    std::cout << "Testing that churn stays within its chunks..." << std::endl;
+
+    // Allocating and freeing a run of nodes repeatedly reuses the same blocks, so
+    // Boost's free space stops moving after the first round
+    MMapFileManager file("/tmp/test_slab_churn.fc", 16 * 1024 * 1024, true);
+    std::vector<void*> blocks;
+    size_t after_first = 0;
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 5000; i++) {
+            blocks.push_back(file.allocate(ShmNode::total_size(100 + i % 3)));
+        }
+        for (void* b : blocks) file.deallocate(b);
+        blocks.clear();
+        if (round == 0) after_first = file.free_space();
+        assert(file.free_space() == after_first);
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_format_version() {
+    std::cout << "Testing that opened files are stamped for the slabs..." << std::endl;
+
+    // A queue file last written by a build from before the slabs
+    const char* path = "/tmp/test_slab_version.fc";
+    std::string item = "item";
+    {
+        FastQueue queue(path, 16 * 1024 * 1024, true);
+        queue.offer(reinterpret_cast<const uint8_t*>(item.data()), item.size());
+    }
+    {
+        MMapFileManager file(path, 16 * 1024 * 1024, false);
+        file.find<DequeHeader>("queue_header").first->version = 2;
+    }
+
+    // Opening it takes it to the slab version, which older builds refuse
+    {
+        FastQueue queue(path, 16 * 1024 * 1024, false);
+        std::vector<uint8_t> out;
+        assert(queue.poll(out) && std::string(out.begin(), out.end()) == item);
+    }
+    MMapFileManager file(path, 16 * 1024 * 1024, false);
+    assert(file.find<DequeHeader>("queue_header").first->version == CollectionHeader::CURRENT_VERSION);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+int main() {
+    std::cout << "\n=== FastCollection Slab Allocator Tests ===" << std::endl;
+
+    try {
+        test_size_classes();
+        test_legacy_blocks();
+        test_reopen();
+        test_concurrent();
+        test_churn();
+        test_format_version();
+
+        std::cout << "\n=== All tests PASSED ===" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+}
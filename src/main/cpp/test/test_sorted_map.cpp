@@ -0,0 +1,400 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ * Patent Pending
+ *
+ * @file test_sorted_map.cpp
+ * @brief Tests for FastSortedMap ordering, range scans and TTL
+ */
+
+#include "fastcollection.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cstdio>
+
+using namespace fastcollection;
+
+static std::vector<uint8_t> bytes(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static std::string str(const std::vector<uint8_t>& v) {
+    return std::string(v.begin(), v.end());
+}
+
+static bool put(FastSortedMap& map, const std::string& k, const std::string& v, int32_t ttl = TTL_INFINITE) {
+    auto key = bytes(k);
+    auto value = bytes(v);
+    return map.put(key.data(), key.size(), value.data(), value.size(), ttl);
+}
+
+// Keys of a scan, in the order visited
+static std::vector<std::string> range_keys(const FastSortedMap& map, const std::string& from,
+                                           const std::string& to, bool reverse) {
+    std::vector<std::string> keys;
+    auto f = bytes(from);
+    auto t = bytes(to);
+    map.range(f.data(), f.size(), t.data(), t.size(),
+              [&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+                  keys.emplace_back(reinterpret_cast<const char*>(key), key_size);
+                  return true;
+              }, reverse);
+    return keys;
+}
+
+void test_basic_operations() {
+    std::cout << "Testing basic sorted map operations..." << std::endl;
+
+    FastSortedMap map("/tmp/test_sorted_map.fc", 16 * 1024 * 1024, true);
+
+    assert(map.isEmpty());
+    assert(put(map, "banana", "yellow"));
+    assert(put(map, "apple", "red"));
+    assert(put(map, "cherry", "dark red"));
+    assert(map.size() == 3);
+
+    std::vector<uint8_t> out;
+    auto key = bytes("apple");
+    assert(map.get(key.data(), key.size(), out));
+    assert(str(out) == "red");
+
+    // Overwrite keeps the size
+    assert(put(map, "apple", "green"));
+    assert(map.size() == 3);
+    assert(map.get(key.data(), key.size(), out));
+    assert(str(out) == "green");
+
+    auto value = bytes("other");
+    assert(!map.putIfAbsent(key.data(), key.size(), value.data(), value.size()));
+
+    assert(map.remove(key.data(), key.size(), &out));
+    assert(str(out) == "green");
+    assert(!map.containsKey(key.data(), key.size()));
+    assert(map.size() == 2);
+
+    // Empty keys are rejected
+    assert(!map.put(key.data(), 0, value.data(), value.size()));
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_ordering_across_splits() {
+    std::cout << "Testing ordering across node splits..." << std::endl;
+
+    for (bool sequential : {true, false}) {
+        FastSortedMap map("/tmp/test_sorted_map_splits.fc", 64 * 1024 * 1024, true);
+        std::map<std::string, std::string> expected;
+
+        std::mt19937 rng(42);
+        const int n = 20000;
+        for (int i = 0; i < n; i++) {
+            int k = sequential ? i : static_cast<int>(rng() % 100000);
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "user:%06d", k);
+            put(map, buf, std::to_string(k));
+            expected[buf] = std::to_string(k);
+        }
+
+        assert(map.size() == expected.size());
+        assert(map.exactSize() == expected.size());
+        assert(map.height() > 2);
+
+        // A full forward and reverse walk matches std::map
+        std::vector<std::string> keys;
+        map.forEach([&](const uint8_t* key, size_t key_size, const uint8_t* value, size_t value_size) {
+            std::string k(reinterpret_cast<const char*>(key), key_size);
+            assert(expected[k] == std::string(reinterpret_cast<const char*>(value), value_size));
+            keys.push_back(k);
+            return true;
+        });
+        assert(keys.size() == expected.size());
+        auto it = expected.begin();
+        for (const auto& k : keys) assert(k == (it++)->first);
+
+        std::vector<std::string> reversed;
+        map.forEach([&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+            reversed.emplace_back(reinterpret_cast<const char*>(key), key_size);
+            return true;
+        }, true);
+        assert(std::equal(reversed.begin(), reversed.end(), keys.rbegin()));
+
+        // Every key is found by point lookup
+        for (const auto& [k, v] : expected) {
+            std::vector<uint8_t> out;
+            auto key = bytes(k);
+            assert(map.get(key.data(), key.size(), out));
+            assert(str(out) == v);
+        }
+
+        // Remove every other key and walk again
+        size_t i = 0;
+        for (auto e = expected.begin(); e != expected.end(); i++) {
+            if (i % 2 == 0) {
+                auto key = bytes(e->first);
+                assert(map.remove(key.data(), key.size()));
+                e = expected.erase(e);
+            } else {
+                ++e;
+            }
+        }
+        assert(map.size() == expected.size());
+        keys.clear();
+        map.forEach([&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+            keys.emplace_back(reinterpret_cast<const char*>(key), key_size);
+            return true;
+        });
+        it = expected.begin();
+        assert(keys.size() == expected.size());
+        for (const auto& k : keys) assert(k == (it++)->first);
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_ordered_access() {
+    std::cout << "Testing first/last/floor/ceiling..." << std::endl;
+
+    FastSortedMap map("/tmp/test_sorted_map_nav.fc", 16 * 1024 * 1024, true);
+    std::vector<uint8_t> k, v;
+
+    assert(!map.first(k, v));
+    assert(!map.last(k, v));
+
+    for (int i = 10; i <= 90; i += 10) {
+        put(map, "k" + std::to_string(i), "v" + std::to_string(i));
+    }
+
+    assert(map.first(k, v) && str(k) == "k10" && str(v) == "v10");
+    assert(map.last(k, v) && str(k) == "k90");
+
+    auto probe = bytes("k35");
+    assert(map.floor(probe.data(), probe.size(), k, v) && str(k) == "k30");
+    assert(map.ceiling(probe.data(), probe.size(), k, v) && str(k) == "k40");
+
+    // Exact matches are their own floor and ceiling
+    probe = bytes("k50");
+    assert(map.floor(probe.data(), probe.size(), k, v) && str(k) == "k50");
+    assert(map.ceiling(probe.data(), probe.size(), k, v) && str(k) == "k50");
+
+    probe = bytes("k0");
+    assert(!map.floor(probe.data(), probe.size(), k, v));
+    probe = bytes("k95");
+    assert(!map.ceiling(probe.data(), probe.size(), k, v));
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_range_and_prefix() {
+    std::cout << "Testing range and prefix scans..." << std::endl;
+
+    FastSortedMap map("/tmp/test_sorted_map_range.fc", 16 * 1024 * 1024, true);
+
+    for (int day = 1; day <= 3; day++) {
+        for (int event = 0; event < 100; event++) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "2025-06-0%d/%03d", day, event);
+            put(map, buf, "e");
+        }
+    }
+
+    // [from, to) forward; reverse visits the same keys backwards
+    auto forward = range_keys(map, "2025-06-01/050", "2025-06-02/010", false);
+    assert(forward.size() == 60);
+    assert(forward.front() == "2025-06-01/050");
+    assert(forward.back() == "2025-06-02/009");
+    auto backward = range_keys(map, "2025-06-01/050", "2025-06-02/010", true);
+    assert(std::equal(backward.begin(), backward.end(), forward.rbegin(), forward.rend()));
+
+    // Unbounded ends
+    assert(range_keys(map, "", "2025-06-01/010", false).size() == 10);
+    assert(range_keys(map, "2025-06-03/090", "", false).size() == 10);
+    assert(range_keys(map, "", "", true).front() == "2025-06-03/099");
+
+    // Prefix scans, with early stop
+    auto p = bytes("2025-06-02");
+    size_t count = 0;
+    map.prefix(p.data(), p.size(), [&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+        assert(std::string(reinterpret_cast<const char*>(key), key_size).rfind("2025-06-02", 0) == 0);
+        count++;
+        return true;
+    });
+    assert(count == 100);
+
+    std::string last_key;
+    map.prefix(p.data(), p.size(), [&](const uint8_t* key, size_t key_size, const uint8_t*, size_t) {
+        last_key.assign(reinterpret_cast<const char*>(key), key_size);
+        return false;
+    }, true);
+    assert(last_key == "2025-06-02/099");
+
+    // Prefixes ending in 0xFF
+    std::vector<uint8_t> high = {0x01, 0xFF};
+    std::vector<uint8_t> inside = {0x01, 0xFF, 0x05};
+    std::vector<uint8_t> after = {0x02};
+    std::vector<uint8_t> value = {0};
+    map.put(inside.data(), inside.size(), value.data(), value.size());
+    map.put(after.data(), after.size(), value.data(), value.size());
+    count = 0;
+    map.prefix(high.data(), high.size(), [&](const uint8_t*, size_t, const uint8_t*, size_t) {
+        count++;
+        return true;
+    });
+    assert(count == 1);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_ttl() {
+    std::cout << "Testing sorted map TTL..." << std::endl;
+
+    FastSortedMap map("/tmp/test_sorted_map_ttl.fc", 16 * 1024 * 1024, true);
+
+    put(map, "a", "1");
+    put(map, "b", "2", 1);
+    put(map, "c", "3");
+    auto key = bytes("c");
+    assert(map.setTTL(key.data(), key.size(), 60));
+    assert(map.getTTL(key.data(), key.size()) > 50);
+    assert(map.setTTL(key.data(), key.size(), 1));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    // Expired entries are skipped by lookups and scans before they are reaped
+    assert(!map.containsKey(key.data(), key.size()));
+    assert(range_keys(map, "", "", false) == std::vector<std::string>{"a"});
+
+    assert(map.removeExpired() == 2);
+    assert(map.size() == 1);
+
+    // An expired key can be written again
+    key = bytes("b");
+    auto value = bytes("again");
+    put(map, "d", "4", 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    assert(map.size() == 1);
+    assert(map.putIfAbsent(key.data(), key.size(), value.data(), value.size()));
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_clear_and_reopen() {
+    std::cout << "Testing clear and reopen..." << std::endl;
+
+    const char* path = "/tmp/test_sorted_map_reopen.fc";
+    {
+        FastSortedMap map(path, 16 * 1024 * 1024, true);
+        for (int i = 0; i < 1000; i++) put(map, "x" + std::to_string(i), "old");
+        map.clear();
+        assert(map.isEmpty());
+        assert(map.height() == 1);
+
+        for (int i = 0; i < 1000; i++) {
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), "k%04d", i);
+            put(map, buf, std::to_string(i));
+        }
+    }
+    {
+        FastSortedMap map(path, 16 * 1024 * 1024, false);
+        assert(map.size() == 1000);
+        std::vector<uint8_t> k, v;
+        assert(map.first(k, v) && str(k) == "k0000");
+        assert(map.last(k, v) && str(k) == "k0999" && str(v) == "999");
+        assert(range_keys(map, "k0100", "k0200", false).size() == 100);
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent_readers() {
+    std::cout << "Testing readers alongside a writer..." << std::endl;
+
+    FastSortedMap map("/tmp/test_sorted_map_concurrent.fc", 64 * 1024 * 1024, true);
+
+    // Even keys stay put; the writer inserts and removes odd keys around them
+    const int n = 4000;
+    auto key_of = [](int i) {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%06d", i);
+        return std::string(buf);
+    };
+    for (int i = 0; i < n; i += 2) put(map, key_of(i), key_of(i));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+
+    std::thread writer([&]() {
+        std::mt19937 rng(7);
+        for (int round = 0; round < 20000; round++) {
+            int i = static_cast<int>(rng() % (n / 2)) * 2 + 1;
+            auto key = bytes(key_of(i));
+            if (round % 3 == 2) {
+                map.remove(key.data(), key.size());
+            } else {
+                map.put(key.data(), key.size(), key.data(), key.size());
+            }
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&, t]() {
+            while (!done) {
+                // Scans stay ordered and see every stable key
+                std::string previous;
+                int evens = 0;
+                map.forEach([&](const uint8_t* key, size_t key_size, const uint8_t* value, size_t value_size) {
+                    std::string k(reinterpret_cast<const char*>(key), key_size);
+                    if (!previous.empty() && (t == 1 ? k >= previous : k <= previous)) errors++;
+                    if (std::string(reinterpret_cast<const char*>(value), value_size) != k) errors++;
+                    if (std::stoi(k) % 2 == 0) evens++;
+                    previous = k;
+                    return true;
+                }, t == 1);
+                if (evens != n / 2) errors++;
+
+                for (int i = 0; i < n; i += 98) {
+                    std::vector<uint8_t> out;
+                    auto key = bytes(key_of(i));
+                    if (!map.get(key.data(), key.size(), out) || str(out) != key_of(i)) errors++;
+                }
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& r : readers) r.join();
+
+    assert(errors == 0);
+    assert(map.exactSize() == map.size());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+int main() {
+    std::cout << "\n=== FastCollection Sorted Map Tests ===" << std::endl;
+
+    try {
+        test_basic_operations();
+        test_ordering_across_splits();
+        test_ordered_access();
+        test_range_and_prefix();
+        test_ttl();
+        test_clear_and_reopen();
+        test_concurrent_readers();
+
+        std::cout << "\n=== All tests PASSED ===" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+}
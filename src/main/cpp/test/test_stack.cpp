@@ -0,0 +1,463 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ * Patent Pending
+ *
+ * @file test_stack.cpp
+ * @brief Tests for FastStack: tagged top pointer, elimination and concurrent use
+ */
+
+#include "fastcollection.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace fastcollection;
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string text(const std::vector<uint8_t>& v) {
+    return std::string(v.begin(), v.end());
+}
+
+// Fixed-width payloads, so freed nodes are reused at the same offsets
+std::string payload(int id) {
+    std::string s = std::to_string(id);
+    return std::string(12 - s.size(), '0') + s;
+}
+
+} // anonymous namespace
+
+void test_basic_operations() {
+    std::cout << "Testing basic stack operations..." << std::endl;
+
+    FastStack stack("/tmp/test_stack_basic.fc", 16 * 1024 * 1024, true);
+    std::vector<uint8_t> out;
+
+    assert(!stack.pop(out) && !stack.peek(out));
+    for (int i = 0; i < 10; i++) {
+        std::string s = "item_" + std::to_string(i);
+        assert(stack.push(bytes(s), s.size()));
+    }
+    assert(stack.size() == 10);
+    assert(stack.peek(out) && text(out) == "item_9");
+    assert(stack.search(bytes(std::string("item_7")), 6) == 3);
+
+    // Removal from the middle keeps the order of the rest
+    std::string middle = "item_5";
+    assert(stack.removeElement(bytes(middle), middle.size()));
+    assert(!stack.removeElement(bytes(middle), middle.size()));
+    assert(stack.size() == 9);
+
+    // Expired elements are skipped by peek and pop, and reaped
+    std::string gone = "gone";
+    stack.push(bytes(gone), gone.size(), 0);
+    assert(stack.peek(out) && text(out) == "item_9");
+    assert(stack.peekTTL() == -1);
+    stack.push(bytes(gone), gone.size(), 0);
+    assert(stack.removeExpired() == 2);
+
+    for (int i = 9; i >= 0; i--) {
+        if (i == 5) continue;
+        assert(stack.pop(out) && text(out) == "item_" + std::to_string(i));
+    }
+    assert(!stack.pop(out));
+
+    stack.push(bytes(gone), gone.size(), 0);
+    assert(!stack.pop(out));
+    assert(stack.isEmpty());
+
+    stack.push(bytes(gone), gone.size());
+    stack.clear();
+    assert(stack.isEmpty() && !stack.peek(out));
+    stack.push(bytes(gone), gone.size());
+    assert(stack.pop(out) && text(out) == "gone");
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_legacy_top() {
+    std::cout << "Testing a stack file written before the tagged top..." << std::endl;
+
+    // Old files hold a plain offset in front_offset, or -1 when empty
+    const char* path = "/tmp/test_stack_legacy.fc";
+    const int legacy_elements = 20;
+    {
+        MMapFileManager file(path, 16 * 1024 * 1024, true);
+        DequeHeader* header = file.find_or_construct<DequeHeader>("stack_header");
+        file.find_or_construct<HashHeader>("stack_hash", HashAlgorithm::WYHASH_64);
+        file.find_or_construct<std::atomic<uint64_t>>("stack_aba_tag", 12345);
+        uint8_t* base = reinterpret_cast<uint8_t*>(file.segment_manager());
+
+        for (int i = 0; i < legacy_elements; i++) {
+            std::string s = "legacy_" + std::to_string(i);
+            ShmNode* node = new(file.allocate(ShmNode::total_size(s.size()))) ShmNode();
+            SerializationUtil::copy_to_node(node, compute_hash64(bytes(s), s.size()),
+                                            bytes(s), s.size());
+            node->next_offset.store(header->front_offset.load());
+            header->front_offset.store(reinterpret_cast<uint8_t*>(node) - base);
+        }
+        header->size.store(legacy_elements);
+    }
+    {
+        FastStack stack(path, 16 * 1024 * 1024, false);
+        assert(stack.size() == legacy_elements);
+        std::vector<uint8_t> out;
+        assert(stack.peek(out) && text(out) == "legacy_19");
+        std::string fresh = "fresh";
+        stack.push(bytes(fresh), fresh.size());
+        assert(stack.pop(out) && text(out) == "fresh");
+        for (int i = legacy_elements - 1; i >= 0; i--) {
+            assert(stack.pop(out) && text(out) == "legacy_" + std::to_string(i));
+        }
+        assert(!stack.pop(out));
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent_push_pop() {
+    std::cout << "Testing concurrent push/pop with node reuse..." << std::endl;
+
+    FastStack stack("/tmp/test_stack_mpmc.fc", 64 * 1024 * 1024, true);
+    const int threads = 8;
+    const int per_thread = 20000;
+
+    // Every thread pushes its own ids and pops whatever it finds; with
+    // equal-sized nodes freed and reallocated constantly, an ABA on the top
+    // would lose or duplicate ids. A reaper lifting the chain off and
+    // splicing it back runs throughout
+    std::vector<std::vector<int>> popped(threads);
+    std::atomic<bool> done{false};
+    std::thread reaper([&]() {
+        while (!done) {
+            stack.removeExpired();
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::vector<uint8_t> out;
+            for (int i = 0; i < per_thread; i++) {
+                std::string s = payload(t * per_thread + i);
+                stack.push(bytes(s), s.size());
+                if (i % 3 != 2 && stack.pop(out)) {
+                    popped[t].push_back(std::stoi(text(out)));
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    done = true;
+    reaper.join();
+
+    std::vector<int> all;
+    for (auto& p : popped) all.insert(all.end(), p.begin(), p.end());
+    std::vector<uint8_t> out;
+    while (stack.pop(out)) all.push_back(std::stoi(text(out)));
+
+    std::sort(all.begin(), all.end());
+    assert(all.size() == static_cast<size_t>(threads * per_thread));
+    for (int i = 0; i < threads * per_thread; i++) {
+        assert(all[i] == i);
+    }
+    assert(stack.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_elimination_pairs() {
+    std::cout << "Testing pushes handed straight to pops..." << std::endl;
+
+    FastStack stack("/tmp/test_stack_elim.fc", 64 * 1024 * 1024, true);
+    const int pairs = 4;
+    const int per_thread = 20000;
+
+    // Producers only push and consumers only pop, so CAS failures send both
+    // sides to the elimination array; each id must still arrive exactly once
+    std::atomic<int> received{0};
+    std::vector<std::vector<int>> popped(pairs);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < pairs; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < per_thread; i++) {
+                std::string s = payload(p * per_thread + i);
+                stack.push(bytes(s), s.size());
+            }
+        });
+        threads.emplace_back([&, p]() {
+            std::vector<uint8_t> out;
+            while (received.load() < pairs * per_thread) {
+                if (stack.pop(out)) {
+                    popped[p].push_back(std::stoi(text(out)));
+                    received++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::vector<int> all;
+    for (auto& p : popped) all.insert(all.end(), p.begin(), p.end());
+    std::sort(all.begin(), all.end());
+    assert(all.size() == static_cast<size_t>(pairs * per_thread));
+    for (int i = 0; i < pairs * per_thread; i++) {
+        assert(all[i] == i);
+    }
+    assert(stack.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_bulk_operations() {
+    std::cout << "Testing pushAll/popAll..." << std::endl;
+
+    FastStack stack("/tmp/test_stack_bulk.fc", 16 * 1024 * 1024, true);
+    std::vector<std::string> items = {"a", "b", "", "c", "d"};
+    std::vector<std::tuple<const uint8_t*, size_t, int32_t>> elements;
+    for (const auto& s : items) elements.emplace_back(bytes(s), s.size(), TTL_INFINITE);
+
+    // The empty element is skipped and the last one ends up on top
+    assert(stack.pushAll(elements) == 4);
+    assert(stack.size() == 4);
+    std::vector<uint8_t> out;
+    assert(stack.peek(out) && text(out) == "d");
+
+    std::vector<std::vector<uint8_t>> popped;
+    assert(stack.popAll(popped, 3) == 3);
+    assert(popped.size() == 3 && text(popped[0]) == "d" && text(popped[2]) == "b");
+    assert(stack.size() == 1);
+
+    // Expired nodes in the unlinked run are dropped and made up from below
+    std::string gone = "gone";
+    stack.push(bytes(gone), gone.size(), 0);
+    stack.pushAll({{bytes(items[0]), 1, TTL_INFINITE}, {bytes(gone), gone.size(), 0}});
+    popped.clear();
+    assert(stack.popAll(popped, 2) == 2);
+    assert(text(popped[0]) == "a" && text(popped[1]) == "a");
+    assert(stack.isEmpty() && stack.popAll(popped, 10) == 0);
+
+    // A max_count past the size takes everything in one go
+    stack.pushAll(elements);
+    popped.clear();
+    assert(stack.popAll(popped, SIZE_MAX) == 4);
+    assert(!stack.pop(out));
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_concurrent_bulk() {
+    std::cout << "Testing concurrent pushAll/popAll..." << std::endl;
+
+    FastStack stack("/tmp/test_stack_bulk_mt.fc", 64 * 1024 * 1024, true);
+    const int producers = 4;
+    const int batches = 500;
+    const int batch = 32;
+    const int total = producers * batches * batch;
+
+    // Batches go in whole; consumers take partial runs, single pops and
+    // everything at once, while a reaper detaches and splices the chain
+    std::atomic<int> received{0};
+    std::atomic<bool> done{false};
+    std::vector<std::vector<int>> popped(3);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            std::vector<std::string> ids(batch);
+            std::vector<std::tuple<const uint8_t*, size_t, int32_t>> elements(batch);
+            for (int b = 0; b < batches; b++) {
+                for (int i = 0; i < batch; i++) {
+                    ids[i] = payload((p * batches + b) * batch + i);
+                    elements[i] = std::make_tuple(bytes(ids[i]), ids[i].size(), TTL_INFINITE);
+                }
+                assert(stack.pushAll(elements) == static_cast<size_t>(batch));
+            }
+        });
+    }
+    for (int c = 0; c < 3; c++) {
+        threads.emplace_back([&, c]() {
+            std::vector<std::vector<uint8_t>> out;
+            std::vector<uint8_t> one;
+            while (received.load() < total) {
+                out.clear();
+                if (c == 0) {
+                    stack.popAll(out, 7);
+                } else if (c == 1) {
+                    stack.popAll(out, SIZE_MAX);
+                } else if (stack.pop(one)) {
+                    out.push_back(one);
+                }
+                for (const auto& v : out) popped[c].push_back(std::stoi(text(v)));
+                received += static_cast<int>(out.size());
+            }
+        });
+    }
+    std::thread reaper([&]() {
+        while (!done) {
+            stack.removeExpired();
+            std::this_thread::yield();
+        }
+    });
+    for (auto& t : threads) t.join();
+    done = true;
+    reaper.join();
+
+    std::vector<int> all;
+    for (auto& p : popped) all.insert(all.end(), p.begin(), p.end());
+    std::sort(all.begin(), all.end());
+    assert(all.size() == static_cast<size_t>(total));
+    for (int i = 0; i < total; i++) {
+        assert(all[i] == i);
+    }
+    assert(stack.isEmpty());
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_detached_order() {
+    std::cout << "Testing LIFO order across removeExpired/removeElement..." << std::endl;
+
+    FastStack stack("/tmp/test_stack_detach.fc", 64 * 1024 * 1024, true);
+    const int old_items = 200000;
+    const int new_items = 100;
+
+    for (int round = 0; round < 2; round++) {
+        // Expired nodes every tenth slot for removeExpired; one plain victim for removeElement
+        std::string victim = payload(5);
+        for (int i = 0; i < old_items; i++) {
+            std::string id = payload(i);
+            stack.push(bytes(id), id.size(), round == 0 && i % 10 == 0 ? 0 : TTL_INFINITE);
+        }
+
+        std::atomic<bool> started{false};
+        std::thread editor([&]() {
+            started = true;
+            if (round == 0) {
+                stack.removeExpired();
+            } else {
+                assert(stack.removeElement(bytes(victim), victim.size()));
+            }
+        });
+        while (!started) std::this_thread::yield();
+
+        // Whether or not the chain is lifted off right now, the newest push
+        // is what a pop sees
+        std::vector<uint8_t> out;
+        for (int i = 0; i < new_items; i++) {
+            std::string id = payload(1000000 + i);
+            stack.push(bytes(id), id.size());
+        }
+        assert(stack.pop(out) && std::stoi(text(out)) == 1000000 + new_items - 1);
+        editor.join();
+
+        // Everything pushed meanwhile stays above the survivors, in order
+        for (int i = new_items - 2; i >= 0; i--) {
+            assert(stack.pop(out) && std::stoi(text(out)) == 1000000 + i);
+        }
+        for (int i = old_items - 1; i >= 0; i--) {
+            if (round == 0 ? i % 10 == 0 : i == 5) continue;
+            assert(stack.pop(out) && std::stoi(text(out)) == i);
+        }
+        assert(!stack.pop(out) && stack.isEmpty());
+    }
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+void test_cross_process() {
+    std::cout << "Testing push/pop from two processes..." << std::endl;
+
+    const char* path = "/tmp/test_stack_ipc.fc";
+    const int per_process = 20000;
+    {
+        FastStack stack(path, 64 * 1024 * 1024, true);
+    }
+
+    int fds[2];
+    assert(pipe(fds) == 0);
+
+    // Each process pushes its own ids and pops some; the child reports the
+    // count and sum of what it popped
+    auto work = [&](int first_id, int64_t& count, int64_t& sum) {
+        FastStack stack(path, 64 * 1024 * 1024, false);
+        std::vector<uint8_t> out;
+        count = sum = 0;
+        for (int i = 0; i < per_process; i++) {
+            std::string s = payload(first_id + i);
+            stack.push(bytes(s), s.size());
+            if (i % 2 == 0 && stack.pop(out)) {
+                count++;
+                sum += std::stoll(text(out));
+            }
+        }
+    };
+
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        close(fds[0]);
+        int64_t result[2] = {0, 0};
+        work(per_process, result[0], result[1]);
+        _exit(write(fds[1], result, sizeof(result)) == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    int64_t count = 0, sum = 0;
+    work(0, count, sum);
+
+    int64_t child_result[2] = {0, 0};
+    assert(read(fds[0], child_result, sizeof(child_result)) == sizeof(child_result));
+    close(fds[0]);
+    int status = 0;
+    assert(waitpid(child, &status, 0) == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    FastStack stack(path, 64 * 1024 * 1024, false);
+    std::vector<uint8_t> out;
+    count += child_result[0];
+    sum += child_result[1];
+    while (stack.pop(out)) {
+        count++;
+        sum += std::stoll(text(out));
+    }
+
+    int64_t total = 2 * per_process;
+    assert(count == total);
+    assert(sum == total * (total - 1) / 2);
+
+    std::cout << "  PASSED" << std::endl;
+}
+
+int main() {
+    std::cout << "\n=== FastCollection Stack Tests ===" << std::endl;
+
+    try {
+        test_basic_operations();
+        test_legacy_top();
+        test_concurrent_push_pop();
+        test_elimination_pairs();
+        test_bulk_operations();
+        test_concurrent_bulk();
+        test_detached_order();
+        test_cross_process();
+
+        std::cout << "\n=== All tests PASSED ===" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+}
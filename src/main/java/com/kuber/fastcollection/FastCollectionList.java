@@ -93,6 +93,9 @@ public class FastCollectionList<T extends Serializable> implements List<T>, Clos
     private native byte[] nativeGetFirst(long handle);
     private native byte[] nativeGetLast(long handle);
     private native boolean nativeSet(long handle, int index, byte[] data, int ttlSeconds);
+    private native byte[] nativeGetWithVersion(long handle, int index, long[] versionOut);
+    private native boolean nativeSetIfVersion(long handle, int index, byte[] data,
+                                              long expectedVersion, int ttlSeconds);
     private native byte[] nativeRemove(long handle, int index);
     private native byte[] nativeRemoveFirst(long handle);
     private native byte[] nativeRemoveLast(long handle);
@@ -259,6 +262,40 @@ public class FastCollectionList<T extends Serializable> implements List<T>, Clos
         return set(index, element, TTL_INFINITE);
     }
     
+    /**
+     * Get the element at index together with its version.
+     * <p>
+     * The version changes with every write to the position, including a
+     * different element shifting into it.
+     * 
+     * @param index the index
+     * @return the element and version, or null if out of range or expired
+     */
+    public Versioned<T> getWithVersion(int index) {
+        checkClosed();
+        long[] version = new long[1];
+        byte[] data = nativeGetWithVersion(nativeHandle, index, version);
+        return data == null ? null : new Versioned<>(deserialize(data), version[0]);
+    }
+    
+    /**
+     * Replace the element at index only if it is still at the expected version.
+     * 
+     * @param index the index
+     * @param element the new element
+     * @param expectedVersion version from {@link #getWithVersion}
+     * @param ttlSeconds TTL in seconds (-1 for infinite)
+     * @return true if replaced, false if the position was written in between
+     */
+    public boolean setIfVersion(int index, T element, long expectedVersion, int ttlSeconds) {
+        checkClosed();
+        return nativeSetIfVersion(nativeHandle, index, serialize(element), expectedVersion, ttlSeconds);
+    }
+    
+    public boolean setIfVersion(int index, T element, long expectedVersion) {
+        return setIfVersion(index, element, expectedVersion, TTL_INFINITE);
+    }
+    
     @Override
     public T remove(int index) {
         checkClosed();
@@ -45,6 +45,9 @@ public class FastCollectionMap<K extends Serializable, V extends Serializable>
     /** Default initial size for the memory-mapped file (64 MB). */
     public static final long DEFAULT_INITIAL_SIZE = 64L * 1024 * 1024;
     
+    /** Entries fetched per native call while iterating. */
+    private static final int SCAN_BATCH = 256;
+    
     private final long nativeHandle;
     private final String filePath;
     private volatile boolean closed = false;
@@ -56,10 +59,21 @@ public class FastCollectionMap<K extends Serializable, V extends Serializable>
     private native boolean nativePut(long handle, byte[] key, byte[] value, int ttlSeconds);
     private native boolean nativePutIfAbsent(long handle, byte[] key, byte[] value, int ttlSeconds);
     private native byte[] nativeGet(long handle, byte[] key);
+    private native byte[] nativeGetWithVersion(long handle, byte[] key, long[] versionOut);
+    private native boolean nativePutIfVersion(long handle, byte[] key, byte[] value,
+                                              long expectedVersion, int ttlSeconds);
     private native boolean nativeRemove(long handle, byte[] key);
     private native boolean nativeContainsKey(long handle, byte[] key);
     private native long nativeGetTTL(long handle, byte[] key);
     private native boolean nativeSetTTL(long handle, byte[] key, int ttlSeconds);
+    private native long nativeIncrementBy(long handle, byte[] key, long delta, int ttlSeconds);
+    private native long nativeGetAndSet(long handle, byte[] key, long value, int ttlSeconds);
+    private native boolean nativeCompareAndSet(long handle, byte[] key, long expected, long desired);
+    private native long nativeGetCounter(long handle, byte[] key);
+    private native byte[][] nativeMultiGet(long handle, byte[][] keys);
+    private native int nativeMultiPut(long handle, byte[][] keys, byte[][] values, int ttlSeconds);
+    private native int nativeMultiRemove(long handle, byte[][] keys);
+    private native byte[][] nativeScan(long handle, long cursor, int count, long[] cursorOut);
     private native int nativeRemoveExpired(long handle);
     private native void nativeClear(long handle);
     private native int nativeSize(long handle);
@@ -190,6 +204,252 @@ public class FastCollectionMap<K extends Serializable, V extends Serializable>
         return nativeSetTTL(nativeHandle, serialize(key), ttlSeconds);
     }
     
+    // ========================================================================
+    // Optimistic concurrency
+    // ========================================================================
+    
+    // Every write stamps its entry with a new version; TTL changes do not.
+    // Read with getWithVersion(), compute without holding any lock, and
+    // store with putIfVersion(), retrying only when it reports a conflict.
+    
+    /**
+     * Get a value together with its version.
+     * 
+     * @param key the key
+     * @return the value and version, or null if absent or expired
+     */
+    public Versioned<V> getWithVersion(K key) {
+        checkClosed();
+        long[] version = new long[1];
+        byte[] data = nativeGetWithVersion(nativeHandle, serialize(key), version);
+        return data == null ? null : new Versioned<>(deserialize(data), version[0]);
+    }
+    
+    /**
+     * Store a value only if the key is still at the expected version.
+     * 
+     * @param key the key
+     * @param value the value to store
+     * @param expectedVersion version from {@link #getWithVersion}, or 0 to
+     *        store only if the key is absent
+     * @param ttlSeconds TTL in seconds (-1 for infinite)
+     * @return true if stored, false if the key was written in between
+     */
+    public boolean putIfVersion(K key, V value, long expectedVersion, int ttlSeconds) {
+        checkClosed();
+        return nativePutIfVersion(nativeHandle, serialize(key), serialize(value),
+                                  expectedVersion, ttlSeconds);
+    }
+    
+    public boolean putIfVersion(K key, V value, long expectedVersion) {
+        return putIfVersion(key, value, expectedVersion, TTL_INFINITE);
+    }
+    
+    // ========================================================================
+    // Atomic counters
+    // ========================================================================
+    
+    // A counter holds a native 64-bit integer instead of a serialized V, so
+    // it is only read and written through these methods. Each call is one
+    // atomic step in native code, even across processes. The TTL applies
+    // when a call creates the counter; updates keep the existing expiry.
+    
+    /**
+     * Add delta to a counter, creating it at delta if absent.
+     * 
+     * @param key the key
+     * @param delta amount to add (may be negative)
+     * @param ttlSeconds TTL if the counter is created (-1 for infinite)
+     * @return the counter value after the addition
+     */
+    public long incrementBy(K key, long delta, int ttlSeconds) {
+        checkClosed();
+        return nativeIncrementBy(nativeHandle, serialize(key), delta, ttlSeconds);
+    }
+    
+    public long incrementBy(K key, long delta) {
+        return incrementBy(key, delta, TTL_INFINITE);
+    }
+    
+    /**
+     * Same as {@link #incrementBy(Object, long)}, named after AtomicLong.
+     */
+    public long addAndGet(K key, long delta) {
+        return incrementBy(key, delta, TTL_INFINITE);
+    }
+    
+    /**
+     * Set a counter, creating it if absent.
+     * 
+     * @return the previous value, or 0 if the counter did not exist
+     */
+    public long getAndSet(K key, long value, int ttlSeconds) {
+        checkClosed();
+        return nativeGetAndSet(nativeHandle, serialize(key), value, ttlSeconds);
+    }
+    
+    public long getAndSet(K key, long value) {
+        return getAndSet(key, value, TTL_INFINITE);
+    }
+    
+    /**
+     * Set an existing counter to desired if it currently holds expected.
+     * 
+     * @return true if the counter existed, held expected and was updated
+     */
+    public boolean compareAndSet(K key, long expected, long desired) {
+        checkClosed();
+        return nativeCompareAndSet(nativeHandle, serialize(key), expected, desired);
+    }
+    
+    /**
+     * Read a counter.
+     * 
+     * @return the current value, or 0 if the counter does not exist
+     */
+    public long getCounter(K key) {
+        checkClosed();
+        return nativeGetCounter(nativeHandle, serialize(key));
+    }
+    
+    /**
+     * Look up many keys with a single native call.
+     * <p>
+     * The native side hashes every key and prefetches their buckets before
+     * walking any chain, which is much faster than calling {@link #get} in a loop.
+     * 
+     * @param keys the keys to look up
+     * @return the keys that were found with their values; missing and expired
+     *         keys are left out
+     */
+    public Map<K, V> getAll(Collection<? extends K> keys) {
+        checkClosed();
+        List<K> keyList = new ArrayList<>(keys);
+        byte[][] data = nativeMultiGet(nativeHandle, serializeAll(keyList));
+        
+        Map<K, V> result = new HashMap<>();
+        for (int i = 0; i < data.length; i++) {
+            if (data[i] != null) result.put(keyList.get(i), deserialize(data[i]));
+        }
+        return result;
+    }
+    
+    /**
+     * Store many entries with a single native call.
+     * <p>
+     * Each bucket lock is taken once per batch. The batch is not atomic as a whole.
+     * 
+     * @param m entries to store
+     * @param ttlSeconds TTL applied to every entry (-1 for infinite)
+     * @return number of entries added or updated
+     */
+    public int putAll(Map<? extends K, ? extends V> m, int ttlSeconds) {
+        checkClosed();
+        byte[][] keys = new byte[m.size()][];
+        byte[][] values = new byte[m.size()][];
+        int i = 0;
+        for (Map.Entry<? extends K, ? extends V> e : m.entrySet()) {
+            keys[i] = serialize(e.getKey());
+            values[i] = serialize(e.getValue());
+            i++;
+        }
+        return nativeMultiPut(nativeHandle, keys, values, ttlSeconds);
+    }
+    
+    /**
+     * Remove many keys with a single native call.
+     * 
+     * @param keys the keys to remove
+     * @return number of keys that were present and removed
+     */
+    public int removeAll(Collection<? extends K> keys) {
+        checkClosed();
+        return nativeMultiRemove(nativeHandle, serializeAll(new ArrayList<>(keys)));
+    }
+    
+    // ========================================================================
+    // Iteration
+    // ========================================================================
+    
+    // Iterators fetch SCAN_BATCH entries per native call with a resumable
+    // cursor, so the map is never copied as a whole and no lock is held
+    // between calls. Entries present for the whole iteration are returned
+    // at least once; entries added or removed meanwhile may or may not be.
+    
+    /**
+     * Iterate over the entries in batches.
+     * 
+     * @return an iterator over copies of the live entries
+     */
+    public Iterator<Map.Entry<K, V>> entryIterator() {
+        checkClosed();
+        return new ScanIterator();
+    }
+    
+    @Override
+    public Set<Entry<K, V>> entrySet() {
+        return new AbstractSet<Entry<K, V>>() {
+            @Override public Iterator<Entry<K, V>> iterator() { return entryIterator(); }
+            @Override public int size() { return FastCollectionMap.this.size(); }
+        };
+    }
+    
+    @Override
+    public Set<K> keySet() {
+        return new AbstractSet<K>() {
+            @Override public Iterator<K> iterator() {
+                Iterator<Entry<K, V>> entries = entryIterator();
+                return new Iterator<K>() {
+                    @Override public boolean hasNext() { return entries.hasNext(); }
+                    @Override public K next() { return entries.next().getKey(); }
+                };
+            }
+            @Override public int size() { return FastCollectionMap.this.size(); }
+            @Override public boolean contains(Object o) { return containsKey(o); }
+        };
+    }
+    
+    @Override
+    public Collection<V> values() {
+        return new AbstractCollection<V>() {
+            @Override public Iterator<V> iterator() {
+                Iterator<Entry<K, V>> entries = entryIterator();
+                return new Iterator<V>() {
+                    @Override public boolean hasNext() { return entries.hasNext(); }
+                    @Override public V next() { return entries.next().getValue(); }
+                };
+            }
+            @Override public int size() { return FastCollectionMap.this.size(); }
+        };
+    }
+    
+    private class ScanIterator implements Iterator<Map.Entry<K, V>> {
+        private final long[] cursor = new long[1];
+        private byte[][] batch = new byte[0][];
+        private int index = 0;
+        private boolean done = false;
+        
+        @Override
+        public boolean hasNext() {
+            while (index >= batch.length && !done) {
+                checkClosed();
+                batch = nativeScan(nativeHandle, cursor[0], SCAN_BATCH, cursor);
+                index = 0;
+                done = cursor[0] == 0;
+            }
+            return index < batch.length;
+        }
+        
+        @Override
+        public Map.Entry<K, V> next() {
+            if (!hasNext()) throw new NoSuchElementException();
+            K key = deserialize(batch[index]);
+            V value = deserialize(batch[index + 1]);
+            index += 2;
+            return new AbstractMap.SimpleImmutableEntry<>(key, value);
+        }
+    }
+    
     /**
      * Remove all expired entries.
      * 
@@ -236,6 +496,14 @@ public class FastCollectionMap<K extends Serializable, V extends Serializable>
         }
     }
     
+    private byte[][] serializeAll(List<? extends K> keys) {
+        byte[][] result = new byte[keys.size()][];
+        for (int i = 0; i < result.length; i++) {
+            result[i] = serialize(keys.get(i));
+        }
+        return result;
+    }
+    
     private byte[] serialize(Object obj) {
         try (ByteArrayOutputStream bos = new ByteArrayOutputStream();
              ObjectOutputStream oos = new ObjectOutputStream(bos)) {
@@ -248,8 +516,5 @@ public class FastCollectionMap<K extends Serializable, V extends Serializable>
     
     // Unsupported Map operations
     @Override public boolean containsValue(Object v) { throw new UnsupportedOperationException(); }
-    @Override public void putAll(Map<? extends K, ? extends V> m) { m.forEach(this::put); }
-    @Override public Set<K> keySet() { throw new UnsupportedOperationException(); }
-    @Override public Collection<V> values() { throw new UnsupportedOperationException(); }
-    @Override public Set<Entry<K, V>> entrySet() { throw new UnsupportedOperationException(); }
+    @Override public void putAll(Map<? extends K, ? extends V> m) { putAll(m, TTL_INFINITE); }
 }
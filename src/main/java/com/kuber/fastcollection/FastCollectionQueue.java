@@ -44,6 +44,9 @@ public class FastCollectionQueue<T extends Serializable> implements Queue<T>, De
     private native byte[] nativePoll(long handle);
     private native byte[] nativePollLast(long handle);
     private native byte[] nativePeek(long handle);
+    private native int nativeOfferAll(long handle, byte[][] elements, int ttlSeconds);
+    private native byte[][] nativePollBatch(long handle, int maxElements);
+    private native byte[][] nativePeekBatch(long handle, int maxElements);
     private native long nativePeekTTL(long handle);
     private native int nativeRemoveExpired(long handle);
     private native void nativeClear(long handle);
@@ -119,6 +122,63 @@ public class FastCollectionQueue<T extends Serializable> implements Queue<T>, De
     @Override public void push(T e) { addFirst(e); }
     @Override public T pop() { return removeFirst(); }
     
+    // ========================================================================
+    // Batch Operations
+    // ========================================================================
+    
+    /**
+     * Add many elements to the tail with a single native call.
+     * <p>
+     * The native side takes the queue lock once and links the whole batch
+     * in one step, so consumers see it all at once, in iteration order.
+     * 
+     * @param elements elements to add
+     * @param ttlSeconds TTL applied to every element (-1 for infinite)
+     * @return number of elements added
+     */
+    public int offerAll(Collection<? extends T> elements, int ttlSeconds) {
+        checkClosed();
+        byte[][] data = new byte[elements.size()][];
+        int i = 0;
+        for (T e : elements) data[i++] = serialize(e);
+        return nativeOfferAll(nativeHandle, data, ttlSeconds);
+    }
+    
+    /**
+     * Remove up to {@code maxElements} elements from the head with a single native call.
+     * 
+     * @param maxElements maximum number of elements to remove (0 for all)
+     * @return the removed elements in queue order; expired ones are dropped
+     */
+    public List<T> pollBatch(int maxElements) {
+        checkClosed();
+        return deserializeAll(nativePollBatch(nativeHandle, maxElements));
+    }
+    
+    /**
+     * Read up to {@code maxElements} elements from the head without removing them.
+     * 
+     * @param maxElements maximum number of elements to read (0 for all)
+     * @return the elements in queue order
+     */
+    public List<T> peekBatch(int maxElements) {
+        checkClosed();
+        return deserializeAll(nativePeekBatch(nativeHandle, maxElements));
+    }
+    
+    /**
+     * Move up to {@code maxElements} elements into a collection with a single native call.
+     * 
+     * @param target collection receiving the elements
+     * @param maxElements maximum number of elements to move (0 for all)
+     * @return number of elements moved
+     */
+    public int drainTo(Collection<? super T> target, int maxElements) {
+        List<T> batch = pollBatch(maxElements);
+        target.addAll(batch);
+        return batch.size();
+    }
+    
     /**
      * Get the TTL of the head element.
      * 
@@ -158,6 +218,12 @@ public class FastCollectionQueue<T extends Serializable> implements Queue<T>, De
         } catch (Exception e) { throw new FastCollectionException("Deserialization failed", e); }
     }
     
+    private List<T> deserializeAll(byte[][] data) {
+        List<T> result = new ArrayList<>(data.length);
+        for (byte[] d : data) result.add(deserialize(d));
+        return result;
+    }
+    
     private byte[] serialize(Object obj) {
         try (ByteArrayOutputStream bos = new ByteArrayOutputStream();
              ObjectOutputStream oos = new ObjectOutputStream(bos)) {
@@ -174,7 +240,7 @@ public class FastCollectionQueue<T extends Serializable> implements Queue<T>, De
     @Override public Object[] toArray() { throw new UnsupportedOperationException(); }
     @Override public <U> U[] toArray(U[] a) { throw new UnsupportedOperationException(); }
     @Override public boolean containsAll(Collection<?> c) { throw new UnsupportedOperationException(); }
-    @Override public boolean addAll(Collection<? extends T> c) { boolean m = false; for (T e : c) if (add(e)) m = true; return m; }
+    @Override public boolean addAll(Collection<? extends T> c) { return offerAll(c, TTL_INFINITE) > 0; }
     @Override public boolean removeAll(Collection<?> c) { throw new UnsupportedOperationException(); }
     @Override public boolean retainAll(Collection<?> c) { throw new UnsupportedOperationException(); }
 }
@@ -22,6 +22,9 @@ public class FastCollectionSet<T extends Serializable> implements Set<T>, Closea
     /** Default initial size for the memory-mapped file (64 MB). */
     public static final long DEFAULT_INITIAL_SIZE = 64L * 1024 * 1024;
     
+    /** Elements fetched per native call while iterating. */
+    private static final int SCAN_BATCH = 256;
+    
     private final long nativeHandle;
     private final String filePath;
     private volatile boolean closed = false;
@@ -35,6 +38,7 @@ public class FastCollectionSet<T extends Serializable> implements Set<T>, Closea
     private native boolean nativeContains(long handle, byte[] data);
     private native long nativeGetTTL(long handle, byte[] data);
     private native boolean nativeSetTTL(long handle, byte[] data, int ttlSeconds);
+    private native byte[][] nativeScan(long handle, long cursor, int count, long[] cursorOut);
     private native int nativeRemoveExpired(long handle);
     private native void nativeClear(long handle);
     private native int nativeSize(long handle);
@@ -138,9 +142,50 @@ public class FastCollectionSet<T extends Serializable> implements Set<T>, Closea
         } catch (Exception e) { throw new FastCollectionException("Serialization failed", e); }
     }
     
-    @Override public Iterator<T> iterator() { throw new UnsupportedOperationException(); }
-    @Override public Object[] toArray() { throw new UnsupportedOperationException(); }
-    @Override public <U> U[] toArray(U[] a) { throw new UnsupportedOperationException(); }
+    @SuppressWarnings("unchecked")
+    private T deserialize(byte[] data) {
+        try (ByteArrayInputStream bis = new ByteArrayInputStream(data);
+             ObjectInputStream ois = new ObjectInputStream(bis)) {
+            return (T) ois.readObject();
+        } catch (Exception e) { throw new FastCollectionException("Deserialization failed", e); }
+    }
+    
+    /**
+     * Iterate over the elements, fetching them from native code in batches
+     * with a resumable cursor. Elements present for the whole iteration are
+     * returned at least once; elements added or removed meanwhile may or may
+     * not be. Removal through the iterator is not supported.
+     */
+    @Override
+    public Iterator<T> iterator() {
+        checkClosed();
+        return new Iterator<T>() {
+            private final long[] cursor = new long[1];
+            private byte[][] batch = new byte[0][];
+            private int index = 0;
+            private boolean done = false;
+            
+            @Override
+            public boolean hasNext() {
+                while (index >= batch.length && !done) {
+                    checkClosed();
+                    batch = nativeScan(nativeHandle, cursor[0], SCAN_BATCH, cursor);
+                    index = 0;
+                    done = cursor[0] == 0;
+                }
+                return index < batch.length;
+            }
+            
+            @Override
+            public T next() {
+                if (!hasNext()) throw new NoSuchElementException();
+                return deserialize(batch[index++]);
+            }
+        };
+    }
+    
+    @Override public Object[] toArray() { List<T> l = new ArrayList<>(); for (T e : this) l.add(e); return l.toArray(); }
+    @Override public <U> U[] toArray(U[] a) { List<T> l = new ArrayList<>(); for (T e : this) l.add(e); return l.toArray(a); }
     @Override public boolean containsAll(Collection<?> c) { for (Object o : c) if (!contains(o)) return false; return true; }
     @Override public boolean addAll(Collection<? extends T> c) { boolean m = false; for (T e : c) if (add(e)) m = true; return m; }
     @Override public boolean retainAll(Collection<?> c) { throw new UnsupportedOperationException(); }
@@ -0,0 +1,363 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ *
+ * Patent Pending
+ */
+package com.kuber.fastcollection;
+
+import java.io.*;
+import java.nio.charset.StandardCharsets;
+import java.util.*;
+
+/**
+ * Memory-mapped sorted map with range and prefix scans and TTL support.
+ * <p>
+ * FastCollectionSortedMap keeps its entries in a B+tree ordered by the
+ * unsigned bytes of the encoded key. Lookups are O(log n); range and prefix
+ * scans walk the linked leaves in either direction.
+ *
+ * <h2>Key Encoding</h2>
+ * Keys are encoded with a {@link KeyCodec} whose byte order matches the
+ * order wanted for the keys. Values use Java serialization like
+ * {@link FastCollectionMap}.
+ * <pre>
+ * FastCollectionSortedMap&lt;String, Event&gt; events = new FastCollectionSortedMap&lt;&gt;(
+ *     "/tmp/events.fc", FastCollectionSortedMap.KeyCodec.STRING);
+ * events.put("2025-06-01T12:00:00Z", event, 86400);
+ * List&lt;Map.Entry&lt;String, Event&gt;&gt; day = events.prefix("2025-06-01");
+ * List&lt;Map.Entry&lt;String, Event&gt;&gt; latest = events.range(null, null, true, 10);
+ * </pre>
+ *
+ * @param <K> key type
+ * @param <V> value type (must be Serializable)
+ * @author Ashutosh Sinha
+ * @since 1.0
+ */
+public class FastCollectionSortedMap<K, V extends Serializable> implements Closeable {
+
+    /**
+     * Encodes keys to bytes whose unsigned lexicographic order is the key order.
+     *
+     * @param <K> key type
+     */
+    public interface KeyCodec<K> {
+        byte[] encode(K key);
+        K decode(byte[] data);
+
+        /** UTF-8 strings, ordered by code point. */
+        KeyCodec<String> STRING = new KeyCodec<String>() {
+            @Override public byte[] encode(String key) { return key.getBytes(StandardCharsets.UTF_8); }
+            @Override public String decode(byte[] data) { return new String(data, StandardCharsets.UTF_8); }
+        };
+
+        /** Signed longs, big-endian with the sign bit flipped so negatives sort first. */
+        KeyCodec<Long> LONG = new KeyCodec<Long>() {
+            @Override public byte[] encode(Long key) {
+                long v = key ^ Long.MIN_VALUE;
+                byte[] data = new byte[8];
+                for (int i = 7; i >= 0; i--) {
+                    data[i] = (byte) v;
+                    v >>>= 8;
+                }
+                return data;
+            }
+            @Override public Long decode(byte[] data) {
+                long v = 0;
+                for (int i = 0; i < 8; i++) {
+                    v = (v << 8) | (data[i] & 0xFF);
+                }
+                return v ^ Long.MIN_VALUE;
+            }
+        };
+
+        /** Raw bytes, for keys the caller encodes itself. */
+        KeyCodec<byte[]> BYTES = new KeyCodec<byte[]>() {
+            @Override public byte[] encode(byte[] key) { return key; }
+            @Override public byte[] decode(byte[] data) { return data; }
+        };
+    }
+
+    /** Constant indicating infinite TTL (entry never expires). */
+    public static final int TTL_INFINITE = -1;
+
+    /** Default initial size for the memory-mapped file (64 MB). */
+    public static final long DEFAULT_INITIAL_SIZE = 64L * 1024 * 1024;
+
+    private final long nativeHandle;
+    private final String filePath;
+    private final KeyCodec<K> codec;
+    private volatile boolean closed = false;
+
+    static { NativeLibraryLoader.load(); }
+
+    private static native long nativeCreate(String filePath, long initialSize, boolean createNew);
+    private static native void nativeDestroy(long handle);
+    private native boolean nativePut(long handle, byte[] key, byte[] value, int ttlSeconds);
+    private native boolean nativePutIfAbsent(long handle, byte[] key, byte[] value, int ttlSeconds);
+    private native byte[] nativeGet(long handle, byte[] key);
+    private native boolean nativeRemove(long handle, byte[] key);
+    private native boolean nativeContainsKey(long handle, byte[] key);
+    private native long nativeGetTTL(long handle, byte[] key);
+    private native boolean nativeSetTTL(long handle, byte[] key, int ttlSeconds);
+    private native byte[][] nativeFirst(long handle);
+    private native byte[][] nativeLast(long handle);
+    private native byte[][] nativeFloor(long handle, byte[] key);
+    private native byte[][] nativeCeiling(long handle, byte[] key);
+    private native byte[][] nativeRange(long handle, byte[] from, byte[] to, boolean descending, int limit);
+    private native byte[][] nativePrefix(long handle, byte[] prefix, boolean descending, int limit);
+    private native int nativeRemoveExpired(long handle);
+    private native void nativeClear(long handle);
+    private native int nativeSize(long handle);
+    private native boolean nativeIsEmpty(long handle);
+    private native void nativeFlush(long handle);
+
+    /**
+     * Create or open a sorted map with default settings.
+     *
+     * @param filePath path to the memory-mapped file
+     * @param codec key encoding
+     */
+    public FastCollectionSortedMap(String filePath, KeyCodec<K> codec) {
+        this(filePath, codec, DEFAULT_INITIAL_SIZE, false);
+    }
+
+    /**
+     * Create or open a sorted map with custom settings.
+     *
+     * @param filePath path to the memory-mapped file
+     * @param codec key encoding
+     * @param initialSize initial size of the memory-mapped file in bytes
+     * @param createNew if true, create a new file (overwrite existing)
+     */
+    public FastCollectionSortedMap(String filePath, KeyCodec<K> codec, long initialSize, boolean createNew) {
+        this.filePath = filePath;
+        this.codec = codec;
+        this.nativeHandle = nativeCreate(filePath, initialSize, createNew);
+        if (this.nativeHandle == 0) {
+            throw new FastCollectionException("Failed to create/open sorted map: " + filePath);
+        }
+    }
+
+    /**
+     * Put key-value pair with TTL.
+     *
+     * @param key the key (must encode to at least one byte)
+     * @param value the value
+     * @param ttlSeconds TTL in seconds (-1 for infinite, never expires)
+     * @return true if stored
+     */
+    public boolean put(K key, V value, int ttlSeconds) {
+        checkClosed();
+        return nativePut(nativeHandle, codec.encode(key), serialize(value), ttlSeconds);
+    }
+
+    public boolean put(K key, V value) {
+        return put(key, value, TTL_INFINITE);
+    }
+
+    /**
+     * Put if key doesn't exist, with TTL.
+     *
+     * @return true if added, false if key exists
+     */
+    public boolean putIfAbsent(K key, V value, int ttlSeconds) {
+        checkClosed();
+        return nativePutIfAbsent(nativeHandle, codec.encode(key), serialize(value), ttlSeconds);
+    }
+
+    public boolean putIfAbsent(K key, V value) {
+        return putIfAbsent(key, value, TTL_INFINITE);
+    }
+
+    /**
+     * Get the value for a key.
+     *
+     * @return the value, or null if absent or expired
+     */
+    public V get(K key) {
+        checkClosed();
+        byte[] data = nativeGet(nativeHandle, codec.encode(key));
+        return data != null ? deserialize(data) : null;
+    }
+
+    /**
+     * Remove a key.
+     *
+     * @return true if the key was present and not expired
+     */
+    public boolean remove(K key) {
+        checkClosed();
+        return nativeRemove(nativeHandle, codec.encode(key));
+    }
+
+    public boolean containsKey(K key) {
+        checkClosed();
+        return nativeContainsKey(nativeHandle, codec.encode(key));
+    }
+
+    /**
+     * Get remaining TTL for a key.
+     *
+     * @return remaining seconds, -1 if infinite, 0 if expired/not found
+     */
+    public long getTTL(K key) {
+        checkClosed();
+        return nativeGetTTL(nativeHandle, codec.encode(key));
+    }
+
+    /**
+     * Update TTL for a key.
+     *
+     * @return true if key exists and TTL updated
+     */
+    public boolean setTTL(K key, int ttlSeconds) {
+        checkClosed();
+        return nativeSetTTL(nativeHandle, codec.encode(key), ttlSeconds);
+    }
+
+    // ========================================================================
+    // Ordered access
+    // ========================================================================
+
+    /** Entry with the smallest key, or null if the map is empty. */
+    public Map.Entry<K, V> firstEntry() {
+        checkClosed();
+        return toEntry(nativeFirst(nativeHandle));
+    }
+
+    /** Entry with the largest key, or null if the map is empty. */
+    public Map.Entry<K, V> lastEntry() {
+        checkClosed();
+        return toEntry(nativeLast(nativeHandle));
+    }
+
+    /** Entry with the largest key &lt;= key, or null. */
+    public Map.Entry<K, V> floorEntry(K key) {
+        checkClosed();
+        return toEntry(nativeFloor(nativeHandle, codec.encode(key)));
+    }
+
+    /** Entry with the smallest key &gt;= key, or null. */
+    public Map.Entry<K, V> ceilingEntry(K key) {
+        checkClosed();
+        return toEntry(nativeCeiling(nativeHandle, codec.encode(key)));
+    }
+
+    /**
+     * Entries with from &lt;= key &lt; to, in key order.
+     *
+     * @param from lower bound (inclusive), or null for none
+     * @param to upper bound (exclusive), or null for none
+     * @return the entries, copied out in one native call
+     */
+    public List<Map.Entry<K, V>> range(K from, K to) {
+        return range(from, to, false, 0);
+    }
+
+    /**
+     * Entries with from &lt;= key &lt; to.
+     *
+     * @param from lower bound (inclusive), or null for none
+     * @param to upper bound (exclusive), or null for none
+     * @param descending if true, start at the largest key
+     * @param limit maximum number of entries (0 for no limit)
+     * @return the entries, in scan order
+     */
+    public List<Map.Entry<K, V>> range(K from, K to, boolean descending, int limit) {
+        checkClosed();
+        byte[] fromKey = from != null ? codec.encode(from) : null;
+        byte[] toKey = to != null ? codec.encode(to) : null;
+        return toEntries(nativeRange(nativeHandle, fromKey, toKey, descending, limit));
+    }
+
+    /**
+     * Entries whose encoded key starts with the encoded prefix, in key order.
+     */
+    public List<Map.Entry<K, V>> prefix(K prefix) {
+        return prefix(prefix, false, 0);
+    }
+
+    /**
+     * Entries whose encoded key starts with the encoded prefix.
+     *
+     * @param prefix the key prefix
+     * @param descending if true, start at the largest key
+     * @param limit maximum number of entries (0 for no limit)
+     * @return the entries, in scan order
+     */
+    public List<Map.Entry<K, V>> prefix(K prefix, boolean descending, int limit) {
+        checkClosed();
+        return toEntries(nativePrefix(nativeHandle, codec.encode(prefix), descending, limit));
+    }
+
+    /**
+     * Remove all expired entries.
+     *
+     * @return number of entries removed
+     */
+    public int removeExpired() {
+        checkClosed();
+        return nativeRemoveExpired(nativeHandle);
+    }
+
+    public void clear() { checkClosed(); nativeClear(nativeHandle); }
+    public int size() { checkClosed(); return nativeSize(nativeHandle); }
+    public boolean isEmpty() { checkClosed(); return nativeIsEmpty(nativeHandle); }
+
+    /** Flush pending changes to disk. */
+    public void flush() { checkClosed(); nativeFlush(nativeHandle); }
+
+    /**
+     * Get the file path for this map.
+     *
+     * @return the file path
+     */
+    public String getFilePath() { return filePath; }
+
+    @Override
+    public void close() {
+        if (!closed) {
+            closed = true;
+            nativeDestroy(nativeHandle);
+        }
+    }
+
+    private void checkClosed() {
+        if (closed) throw new IllegalStateException("Sorted map is closed");
+    }
+
+    private Map.Entry<K, V> toEntry(byte[][] pair) {
+        if (pair == null) return null;
+        return new AbstractMap.SimpleImmutableEntry<>(codec.decode(pair[0]), deserialize(pair[1]));
+    }
+
+    // Scans return key, value, key, value, ...
+    private List<Map.Entry<K, V>> toEntries(byte[][] flat) {
+        List<Map.Entry<K, V>> result = new ArrayList<>(flat.length / 2);
+        for (int i = 0; i + 1 < flat.length; i += 2) {
+            result.add(new AbstractMap.SimpleImmutableEntry<>(codec.decode(flat[i]), deserialize(flat[i + 1])));
+        }
+        return result;
+    }
+
+    @SuppressWarnings("unchecked")
+    private <T> T deserialize(byte[] data) {
+        try (ByteArrayInputStream bis = new ByteArrayInputStream(data);
+             ObjectInputStream ois = new ObjectInputStream(bis)) {
+            return (T) ois.readObject();
+        } catch (Exception e) {
+            throw new FastCollectionException("Deserialization failed", e);
+        }
+    }
+
+    private byte[] serialize(Object obj) {
+        try (ByteArrayOutputStream bos = new ByteArrayOutputStream();
+             ObjectOutputStream oos = new ObjectOutputStream(bos)) {
+            oos.writeObject(obj);
+            return bos.toByteArray();
+        } catch (Exception e) {
+            throw new FastCollectionException("Serialization failed", e);
+        }
+    }
+}
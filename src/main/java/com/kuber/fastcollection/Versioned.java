@@ -0,0 +1,47 @@
+/**
+ * Copyright © 2025-2030, All Rights Reserved
+ * Ashutosh Sinha | Email: ajsinha@gmail.com
+ * 
+ * Patent Pending
+ */
+package com.kuber.fastcollection;
+
+/**
+ * A value read together with the version of the write that stored it.
+ * <p>
+ * Pass the version back to a version-checked write
+ * ({@link FastCollectionMap#putIfVersion}, {@link FastCollectionList#setIfVersion})
+ * to store an update only if nobody wrote the entry in between:
+ * <pre>
+ * for (;;) {
+ *     Versioned&lt;Session&gt; current = map.getWithVersion(id);
+ *     Session updated = current.getValue().touch();
+ *     if (map.putIfVersion(id, updated, current.getVersion(), 1800)) break;
+ * }
+ * </pre>
+ * 
+ * @param <V> value type
+ * @author Ashutosh Sinha
+ * @since 1.0
+ */
+public final class Versioned<V> {
+    
+    private final V value;
+    private final long version;
+    
+    public Versioned(V value, long version) {
+        this.value = value;
+        this.version = version;
+    }
+    
+    /** @return the value */
+    public V getValue() { return value; }
+    
+    /** @return the version, always greater than 0 */
+    public long getVersion() { return version; }
+    
+    @Override
+    public String toString() {
+        return "Versioned{value=" + value + ", version=" + version + "}";
+    }
+}
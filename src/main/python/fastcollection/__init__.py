@@ -8,7 +8,9 @@ Collections:
     - FastList: Doubly-linked list with O(1) head/tail operations
     - FastSet: Hash set with O(1) lookups  
     - FastMap: Key-value store with atomic operations
+    - FastSortedMap: Ordered key-value store with range and prefix scans
     - FastQueue: FIFO queue with deque operations
+    - FastRingQueue: Bounded lock-free FIFO ring with backpressure
     - FastStack: LIFO stack with lock-free push/pop
 
 TTL Support:
@@ -39,10 +41,14 @@ try:
         FastList,
         FastSet,
         FastMap,
+        FastSortedMap,
         FastQueue,
+        FastRingQueue,
         FastStack,
         FastCollectionException,
         TTL_INFINITE,
+        set_parallelism,
+        get_parallelism,
     )
 except ImportError:
     # Native module not built yet
@@ -55,6 +61,12 @@ except ImportError:
     # Provide stub for IDE support
     TTL_INFINITE = -1
     
+    def set_parallelism(parallelism=0):
+        raise NotImplementedError("Native module not built")
+    
+    def get_parallelism():
+        raise NotImplementedError("Native module not built")
+    
     class FastCollectionException(Exception):
         pass
     
@@ -70,10 +82,18 @@ except ImportError:
         def __init__(self, file_path, initial_size=67108864, create_new=False, bucket_count=16384):
             raise NotImplementedError("Native module not built")
     
+    class FastSortedMap:
+        def __init__(self, file_path, initial_size=67108864, create_new=False):
+            raise NotImplementedError("Native module not built")
+    
     class FastQueue:
         def __init__(self, file_path, initial_size=67108864, create_new=False):
             raise NotImplementedError("Native module not built")
     
+    class FastRingQueue:
+        def __init__(self, file_path, capacity=65536, slot_bytes=128, create_new=False):
+            raise NotImplementedError("Native module not built")
+    
     class FastStack:
         def __init__(self, file_path, initial_size=67108864, create_new=False):
             raise NotImplementedError("Native module not built")
@@ -85,8 +105,12 @@ __all__ = [
     "FastList",
     "FastSet", 
     "FastMap",
+    "FastSortedMap",
     "FastQueue",
+    "FastRingQueue",
     "FastStack",
     "FastCollectionException",
     "TTL_INFINITE",
+    "set_parallelism",
+    "get_parallelism",
 ]
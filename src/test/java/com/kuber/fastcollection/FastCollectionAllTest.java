@@ -7,6 +7,9 @@ package com.kuber.fastcollection;
 
 import org.junit.jupiter.api.*;
 import java.io.File;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
 import static org.junit.jupiter.api.Assertions.*;
 
 public class FastCollectionAllTest {
@@ -125,6 +128,21 @@ public class FastCollectionAllTest {
             assertEquals("last", queue.pollLast());
             assertEquals("middle", queue.poll());
         }
+        
+        @Test
+        @Order(5)
+        void testBatchOperations() {
+            queue.offer("first");
+            assertEquals(3, queue.offerAll(Arrays.asList("a", "b", "c"), FastCollectionQueue.TTL_INFINITE));
+            
+            assertEquals(Arrays.asList("first", "a"), queue.peekBatch(2));
+            assertEquals(Arrays.asList("first", "a"), queue.pollBatch(2));
+            
+            List<String> rest = new ArrayList<>();
+            assertEquals(2, queue.drainTo(rest, 0));
+            assertEquals(Arrays.asList("b", "c"), rest);
+            assertTrue(queue.isEmpty());
+        }
     }
 
     // ========== FastStack Tests ==========